@@ -0,0 +1,77 @@
+/***********************************************************************************************************************
+ * File Name    : adaptive_sampling.c
+ * Description  : Adaptive Temperature Sample Scheduler - slow while stable and far from a threshold,
+ *                fast on a trend toward a boundary or close to one
+ **********************************************************************************************************************/
+
+#include <math.h>
+#include "adaptive_sampling.h"
+
+/**
+ * @brief Reset the scheduler - sampling starts at the fastest rate until the trend has settled
+ * @param[in] p_sched         Scheduler state
+ * @param[in] min_interval_ms Fastest sampling (ms)
+ * @param[in] max_interval_ms Slowest sampling (ms)
+ */
+void adaptive_sampling_init(adaptive_sampling_t *p_sched, uint32_t min_interval_ms, uint32_t max_interval_ms)
+{
+    p_sched->min_interval_ms = min_interval_ms;
+    p_sched->max_interval_ms = (max_interval_ms < min_interval_ms) ? min_interval_ms : max_interval_ms;
+    p_sched->interval_ms = min_interval_ms;
+}
+
+/**
+ * @brief Drop to the fastest rate (e.g. after a failed read); the interval grows back sample by sample
+ * @param[in] p_sched Scheduler state
+ */
+void adaptive_sampling_restart(adaptive_sampling_t *p_sched)
+{
+    p_sched->interval_ms = p_sched->min_interval_ms;
+}
+
+/**
+ * @brief Choose the interval until the next sample
+ * @param[in] p_sched        Scheduler state
+ * @param[in] level          Filtered temperature (°C)
+ * @param[in] slope          Temperature trend (°C/s)
+ * @param[in] p_boundary     Temperatures where control behaviour changes (level thresholds, alert), any order
+ * @param[in] num_boundaries Number of boundaries
+ * @return Interval (ms)
+ */
+uint32_t adaptive_sampling_next(adaptive_sampling_t *p_sched, float level, float slope, float const *p_boundary,
+                                uint8_t num_boundaries)
+{
+    float limit_s = (float)p_sched->max_interval_ms / 1000.0f;
+    float distance;
+    float candidate_s;
+    uint32_t interval_ms;
+    uint32_t grown_ms;
+
+    for (uint8_t i = 0; i < num_boundaries; i++)
+    {
+        distance = p_boundary[i] - level;
+
+        /* Guard: a change at the plausible maximum rate must not reach the boundary between samples.
+         * Applies on both sides - just past a boundary the noisy reading may still cross back. */
+        candidate_s = fabsf(distance) / ADAPTIVE_GUARD_RISE_C_PER_S;
+        limit_s = (candidate_s < limit_s) ? candidate_s : limit_s;
+
+        /* Trend: heading for this boundary from either side */
+        if (((distance > 0.0f) && (slope >= ADAPTIVE_MIN_SLOPE_C_PER_S)) ||
+            ((distance < 0.0f) && (slope <= -ADAPTIVE_MIN_SLOPE_C_PER_S)))
+        {
+            candidate_s = (distance / slope) / ADAPTIVE_SAMPLES_PER_CROSSING;
+            limit_s = (candidate_s < limit_s) ? candidate_s : limit_s;
+        }
+    }
+
+    interval_ms = (uint32_t)(limit_s * 1000.0f);
+    interval_ms = (interval_ms < p_sched->min_interval_ms) ? p_sched->min_interval_ms : interval_ms;
+
+    /* Speed up at once, slow down gradually - one calm sample is not a settled rack */
+    grown_ms = p_sched->interval_ms * ADAPTIVE_MAX_GROWTH;
+    interval_ms = (interval_ms > grown_ms) ? grown_ms : interval_ms;
+
+    p_sched->interval_ms = interval_ms;
+    return interval_ms;
+}
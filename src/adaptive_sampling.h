@@ -0,0 +1,36 @@
+/***********************************************************************************************************************
+ * File Name    : adaptive_sampling.h
+ * Description  : Adaptive Temperature Sample Scheduler - slow while stable and far from a threshold,
+ *                fast on a trend toward a boundary or close to one
+ **********************************************************************************************************************/
+
+#ifndef ADAPTIVE_SAMPLING_H_
+#define ADAPTIVE_SAMPLING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Scheduling Rules - the next interval is the shortest of
+ *   guard: distance to the nearest boundary / ADAPTIVE_GUARD_RISE_C_PER_S, so even a rise the trend has
+ *          not picked up yet is sampled before it gets there
+ *   trend: time for the trend to reach the boundary it is heading for / ADAPTIVE_SAMPLES_PER_CROSSING
+ * clamped to [min, max]. A shorter interval applies at once; a longer one at most doubles per sample. */
+#define ADAPTIVE_GUARD_RISE_C_PER_S     (0.2f)      /* Fastest plausible change short of a sensor fault (fan stall at load) */
+#define ADAPTIVE_SAMPLES_PER_CROSSING   (10.0f)     /* Samples the trend gets before a predicted crossing */
+#define ADAPTIVE_MIN_SLOPE_C_PER_S      (0.005f)    /* Trends below this are sensor noise */
+#define ADAPTIVE_MAX_GROWTH             (2U)        /* Interval growth limit per sample */
+
+/* Scheduler State */
+typedef struct {
+    uint32_t min_interval_ms;
+    uint32_t max_interval_ms;
+    uint32_t interval_ms;       /* Interval until the next sample */
+} adaptive_sampling_t;
+
+/* Function Declarations */
+void adaptive_sampling_init(adaptive_sampling_t *p_sched, uint32_t min_interval_ms, uint32_t max_interval_ms);
+void adaptive_sampling_restart(adaptive_sampling_t *p_sched);
+uint32_t adaptive_sampling_next(adaptive_sampling_t *p_sched, float level, float slope, float const *p_boundary,
+                                uint8_t num_boundaries);
+
+#endif /* ADAPTIVE_SAMPLING_H_ */
@@ -0,0 +1,372 @@
+/***********************************************************************************************************************
+ * File Name    : autotune.c
+ * Description  : Step-Response Autotune - duty step experiment, first-order-plus-dead-time identification,
+ *                controller parameters derived from the model
+ *
+ * Identification uses the area method: with the response normalised to the step size, the area between the
+ * final value and the response is dead time + tau, and the area under the response up to that time is tau / e.
+ * Both are sums over the trace, so noise averages out instead of landing on a single 28%/63% crossing, and the
+ * whole computation is one pass over a fixed-size buffer.
+ **********************************************************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "autotune.h"
+
+#define AUTOTUNE_E                      (2.718281828f)
+
+/**
+ * @brief Start an empty trace
+ * @param[in] p_trace    Trace
+ * @param[in] spacing_ms Time each point covers until the trace first fills (the sample interval)
+ */
+static void autotune_trace_reset(autotune_trace_t *p_trace, uint32_t spacing_ms)
+{
+    memset(p_trace, 0, sizeof(*p_trace));
+    p_trace->spacing_ms = (0U == spacing_ms) ? 1U : spacing_ms;
+}
+
+/**
+ * @brief Add a sample to the trace
+ * @param[in] p_trace     Trace
+ * @param[in] temperature Sample (°C)
+ * @param[in] dt_ms       Time the sample stands for
+ */
+static void autotune_trace_add(autotune_trace_t *p_trace, float temperature, uint32_t dt_ms)
+{
+    p_trace->pending_sum += temperature * (float)dt_ms;
+    p_trace->pending_ms += dt_ms;
+    if (p_trace->pending_ms < p_trace->spacing_ms)
+    {
+        return;
+    }
+
+    p_trace->point[p_trace->count++] = (int16_t)lroundf((p_trace->pending_sum / (float)p_trace->pending_ms) * 100.0f);
+    p_trace->pending_sum = 0.0f;
+    p_trace->pending_ms = 0;
+
+    if (AUTOTUNE_TRACE_LEN == p_trace->count)
+    {
+        /* Full - merge neighbours, so the same memory covers twice the time */
+        for (uint16_t i = 0; i < (AUTOTUNE_TRACE_LEN / 2U); i++)
+        {
+            p_trace->point[i] = (int16_t)(((int32_t)p_trace->point[2U * i] + p_trace->point[(2U * i) + 1U]) / 2);
+        }
+        p_trace->count = AUTOTUNE_TRACE_LEN / 2U;
+        p_trace->spacing_ms *= 2U;
+    }
+}
+
+/**
+ * @brief Mean of trace points [from, to)
+ */
+static float autotune_trace_mean(autotune_trace_t const *p_trace, uint16_t from, uint16_t to)
+{
+    int32_t sum = 0;
+
+    for (uint16_t i = from; i < to; i++)
+    {
+        sum += p_trace->point[i];
+    }
+    return (to > from) ? ((float)sum / (float)(to - from)) / 100.0f : 0.0f;
+}
+
+/**
+ * @brief Whether the traced phase has settled
+ * @param[in]  p_trace   Trace
+ * @param[in]  reference Level the phase started from (°C) - the band widens with the distance moved
+ * @param[out] p_level   Recent mean (valid when true is returned)
+ * @param[out] p_drift   Recent mean minus the one before it
+ * @param[out] p_half_s  Time each of the two means covers (s)
+ * @return true if the newer half of the last half of the phase (at least AUTOTUNE_STEADY_MIN_MS) matches the
+ *         older half within the band
+ */
+static bool autotune_trace_steady(autotune_trace_t const *p_trace, float reference, float *p_level, float *p_drift,
+                                  float *p_half_s)
+{
+    uint32_t window = p_trace->count / 2U;
+    uint32_t min_window = (AUTOTUNE_STEADY_MIN_MS + p_trace->spacing_ms - 1U) / p_trace->spacing_ms;
+    uint16_t half;
+    float older;
+
+    window = (window < min_window) ? min_window : window;
+    if ((window > p_trace->count) || (window < 2U))
+    {
+        return false;
+    }
+
+    half = (uint16_t)(window / 2U);
+    older = autotune_trace_mean(p_trace, (uint16_t)(p_trace->count - (2U * half)), (uint16_t)(p_trace->count - half));
+    *p_level = autotune_trace_mean(p_trace, (uint16_t)(p_trace->count - half), p_trace->count);
+    *p_drift = *p_level - older;
+    *p_half_s = ((float)half * (float)p_trace->spacing_ms) / 1000.0f;
+
+    return fabsf(*p_drift) < fmaxf(AUTOTUNE_STEADY_BAND_C, AUTOTUNE_STEADY_BAND_REL * fabsf(*p_level - reference));
+}
+
+/**
+ * @brief End the experiment
+ */
+static void autotune_fail(autotune_t *p_tune, autotune_error_t error)
+{
+    p_tune->state = AUTOTUNE_FAILED;
+    p_tune->error = error;
+}
+
+/**
+ * @brief Reset to idle with no model
+ * @param[in] p_tune Autotune state
+ */
+void autotune_init(autotune_t *p_tune)
+{
+    memset(p_tune, 0, sizeof(*p_tune));
+}
+
+/**
+ * @brief Begin an experiment
+ * @param[in] p_tune             Autotune state
+ * @param[in] base_duty          Duty held until steady (%)
+ * @param[in] step_duty          Duty step (%), positive = more airflow
+ * @param[in] limit_temp         Abort at or above this temperature (°C)
+ * @param[in] margin_c           Energy trim margin the derived trim step is sized for (°C)
+ * @param[in] sample_interval_ms Interval the caller will sample at
+ * @return false if already running or the duties are out of range
+ */
+bool autotune_start(autotune_t *p_tune, uint8_t base_duty, int8_t step_duty, float limit_temp, float margin_c,
+                    uint32_t sample_interval_ms)
+{
+    int16_t step_to = (int16_t)((int16_t)base_duty + step_duty);
+
+    if (autotune_active(p_tune) || (0 == step_duty) || (base_duty > 100U) || (step_to < 0) || (step_to > 100))
+    {
+        return false;
+    }
+
+    autotune_init(p_tune);
+    p_tune->state = AUTOTUNE_BASELINE;
+    p_tune->base_duty = base_duty;
+    p_tune->step_duty = step_duty;
+    p_tune->limit_temp = limit_temp;
+    p_tune->margin_c = margin_c;
+    autotune_trace_reset(&p_tune->trace, sample_interval_ms);
+    return true;
+}
+
+/**
+ * @brief Stop a running experiment (the caller takes the fans back)
+ * @param[in] p_tune Autotune state
+ */
+void autotune_abort(autotune_t *p_tune)
+{
+    if (autotune_active(p_tune))
+    {
+        autotune_fail(p_tune, AUTOTUNE_ERR_ABORTED);
+    }
+}
+
+/**
+ * @brief Whether the experiment owns the fan duty
+ */
+bool autotune_active(autotune_t const *p_tune)
+{
+    return (AUTOTUNE_BASELINE == p_tune->state) || (AUTOTUNE_STEP == p_tune->state);
+}
+
+/**
+ * @brief Feed a temperature sample and get the duty to hold
+ * @param[in] p_tune      Autotune state
+ * @param[in] temperature Sample (°C)
+ * @param[in] dt_ms       Time since the previous sample
+ * @return Duty to apply (%); meaningless once autotune_active() turns false
+ */
+uint8_t autotune_update(autotune_t *p_tune, float temperature, uint32_t dt_ms)
+{
+    float level;
+    float drift;
+    float half_s;
+    float tail;
+
+    if (!autotune_active(p_tune))
+    {
+        return p_tune->base_duty;
+    }
+
+    if (temperature >= p_tune->limit_temp)
+    {
+        autotune_fail(p_tune, AUTOTUNE_ERR_LIMIT);
+        return p_tune->base_duty;
+    }
+
+    p_tune->phase_ms += dt_ms;
+    autotune_trace_add(&p_tune->trace, temperature, dt_ms);
+
+    if (AUTOTUNE_BASELINE == p_tune->state)
+    {
+        if (autotune_trace_steady(&p_tune->trace, temperature, &level, &drift, &half_s))
+        {
+            /* Steady - step now; the trace restarts at the step */
+            p_tune->baseline = level;
+            p_tune->state = AUTOTUNE_STEP;
+            p_tune->phase_ms = 0;
+            autotune_trace_reset(&p_tune->trace, dt_ms);
+        }
+        else if (p_tune->phase_ms >= AUTOTUNE_BASELINE_MAX_MS)
+        {
+            autotune_fail(p_tune, AUTOTUNE_ERR_UNSTEADY);
+        }
+    }
+    else
+    {
+        /* Steady only counts once the response has shown - the dead time looks steady too */
+        if (autotune_trace_steady(&p_tune->trace, p_tune->baseline, &level, &drift, &half_s) &&
+            (fabsf(level - p_tune->baseline) >= AUTOTUNE_MIN_RESPONSE_C))
+        {
+            p_tune->final = level;
+            p_tune->error = autotune_identify(&p_tune->trace, p_tune->baseline, level, (float)p_tune->step_duty,
+                                              &p_tune->model);
+            if (AUTOTUNE_ERR_NONE == p_tune->error)
+            {
+                /* "Steady" still leaves part of the tail to come, and the final value biases both areas. For a
+                 * first-order tail each half-window mean sits e^(-half/tau) closer than the one before, so the
+                 * remainder follows from the last drift - refit once with the extrapolated final value. */
+                tail = fminf(expf(-half_s / p_tune->model.tau_s), 0.5f);
+                p_tune->final = level + ((drift * tail) / (1.0f - tail));
+                p_tune->error = autotune_identify(&p_tune->trace, p_tune->baseline, p_tune->final,
+                                                  (float)p_tune->step_duty, &p_tune->model);
+            }
+            if (AUTOTUNE_ERR_NONE == p_tune->error)
+            {
+                autotune_derive(&p_tune->model, p_tune->margin_c, &p_tune->params);
+                p_tune->state = AUTOTUNE_DONE;
+            }
+            else
+            {
+                p_tune->state = AUTOTUNE_FAILED;
+            }
+        }
+        else if (p_tune->phase_ms >= AUTOTUNE_STEP_MAX_MS)
+        {
+            level = autotune_trace_mean(&p_tune->trace, (uint16_t)(p_tune->trace.count - (p_tune->trace.count / 4U)),
+                                        p_tune->trace.count);
+            autotune_fail(p_tune, (fabsf(level - p_tune->baseline) >= AUTOTUNE_MIN_RESPONSE_C) ?
+                                  AUTOTUNE_ERR_TIMEOUT : AUTOTUNE_ERR_NO_RESPONSE);
+        }
+    }
+
+    return (AUTOTUNE_STEP == p_tune->state) ? (uint8_t)((int16_t)p_tune->base_duty + p_tune->step_duty)
+                                            : p_tune->base_duty;
+}
+
+/**
+ * @brief Fit a first-order-plus-dead-time model to a step response
+ * @param[in]  p_trace   Response from the step on, in block means
+ * @param[in]  baseline  Steady temperature before the step (°C)
+ * @param[in]  final     Steady temperature after the step (°C)
+ * @param[in]  step_duty Duty step (%)
+ * @param[out] p_model   Identified model
+ * @return AUTOTUNE_ERR_NONE, or why the response does not give a model
+ */
+autotune_error_t autotune_identify(autotune_trace_t const *p_trace, float baseline, float final, float step_duty,
+                                   autotune_model_t *p_model)
+{
+    float dy = final - baseline;
+    float dt_s = (float)p_trace->spacing_ms / 1000.0f;
+    float area_residual = 0.0f;     /* Area between the final value and the response */
+    float area_response = 0.0f;     /* Area under the response up to the mean residence time */
+    float residence_s;
+    float t_s;
+    float tau_s;
+
+    if ((fabsf(dy) < AUTOTUNE_MIN_RESPONSE_C) || (0.0f == step_duty) || (p_trace->count < 4U))
+    {
+        return AUTOTUNE_ERR_NO_RESPONSE;
+    }
+
+    for (uint16_t i = 0; i < p_trace->count; i++)
+    {
+        area_residual += (final - ((float)p_trace->point[i] / 100.0f)) * dt_s;
+    }
+
+    /* Mean residence time = dead time + tau */
+    residence_s = area_residual / dy;
+    if ((residence_s <= 0.0f) || (residence_s >= ((float)p_trace->count * dt_s)))
+    {
+        return AUTOTUNE_ERR_MODEL;
+    }
+
+    for (uint16_t i = 0; i < p_trace->count; i++)
+    {
+        t_s = (float)i * dt_s;
+        if (t_s >= residence_s)
+        {
+            break;
+        }
+        area_response += (((float)p_trace->point[i] / 100.0f) - baseline) * fminf(dt_s, residence_s - t_s);
+    }
+
+    tau_s = AUTOTUNE_E * area_response / dy;
+    if (tau_s <= 0.0f)
+    {
+        return AUTOTUNE_ERR_MODEL;
+    }
+
+    p_model->gain = dy / step_duty;
+    /* A response that leads a pure lag (noise, or a faster-than-first-order plant) gets no dead time */
+    p_model->tau_s = fminf(tau_s, residence_s);
+    p_model->dead_time_s = residence_s - p_model->tau_s;
+    return AUTOTUNE_ERR_NONE;
+}
+
+/**
+ * @brief Controller parameters from the plant model
+ * @param[in]  p_model  Identified model
+ * @param[in]  margin_c Energy trim margin (°C)
+ * @param[out] p_params Derived parameters, clamped to sane ranges
+ */
+void autotune_derive(autotune_model_t const *p_model, float margin_c, autotune_params_t *p_params)
+{
+    float settle_ms = (p_model->dead_time_s + (3.0f * p_model->tau_s)) * 1000.0f;
+    float trim = (0.0f != p_model->gain) ? (margin_c / (2.0f * fabsf(p_model->gain))) : (float)AUTOTUNE_TRIM_STEP_MAX;
+
+    p_params->predict_horizon_s = fminf(fmaxf(p_model->dead_time_s + p_model->tau_s, AUTOTUNE_HORIZON_MIN_S),
+                                        AUTOTUNE_HORIZON_MAX_S);
+    p_params->settle_ms = (uint32_t)fminf(fmaxf(settle_ms, (float)AUTOTUNE_SETTLE_MIN_MS), (float)AUTOTUNE_SETTLE_MAX_MS);
+    p_params->trim_step = (uint8_t)fminf(fmaxf(floorf(trim), (float)AUTOTUNE_TRIM_STEP_MIN), (float)AUTOTUNE_TRIM_STEP_MAX);
+}
+
+/**
+ * @brief Pack state, model and parameters for the autotune characteristic
+ * @param[in]  p_tune  Autotune state
+ * @param[out] p_buf   Output buffer
+ * @param[in]  buf_len Buffer size (>= AUTOTUNE_WIRE_SIZE)
+ * @return Bytes written (0 if the buffer is too small)
+ */
+uint16_t autotune_serialize(autotune_t const *p_tune, uint8_t *p_buf, uint16_t buf_len)
+{
+    int16_t gain = (int16_t)fminf(fmaxf(p_tune->model.gain * 1000.0f, -32768.0f), 32767.0f);
+    uint16_t tau = (uint16_t)fminf(p_tune->model.tau_s, 65535.0f);
+    uint16_t dead_time = (uint16_t)fminf(p_tune->model.dead_time_s, 65535.0f);
+    uint16_t horizon = (uint16_t)p_tune->params.predict_horizon_s;
+    uint16_t settle = (uint16_t)(p_tune->params.settle_ms / 1000U);
+
+    if (buf_len < AUTOTUNE_WIRE_SIZE)
+    {
+        return 0;
+    }
+
+    p_buf[0] = (uint8_t)p_tune->state;
+    p_buf[1] = (uint8_t)p_tune->error;
+    p_buf[2] = (uint8_t)(gain & 0xFF);
+    p_buf[3] = (uint8_t)((gain >> 8) & 0xFF);
+    p_buf[4] = (uint8_t)(tau & 0xFF);
+    p_buf[5] = (uint8_t)(tau >> 8);
+    p_buf[6] = (uint8_t)(dead_time & 0xFF);
+    p_buf[7] = (uint8_t)(dead_time >> 8);
+    p_buf[8] = (uint8_t)(horizon & 0xFF);
+    p_buf[9] = (uint8_t)(horizon >> 8);
+    p_buf[10] = (uint8_t)(settle & 0xFF);
+    p_buf[11] = (uint8_t)(settle >> 8);
+    p_buf[12] = p_tune->params.trim_step;
+
+    return AUTOTUNE_WIRE_SIZE;
+}
@@ -0,0 +1,116 @@
+/***********************************************************************************************************************
+ * File Name    : autotune.h
+ * Description  : Step-Response Autotune - duty step experiment, first-order-plus-dead-time identification,
+ *                controller parameters derived from the model
+ **********************************************************************************************************************/
+
+#ifndef AUTOTUNE_H_
+#define AUTOTUNE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Experiment - hold the base duty until the temperature is steady, step the duty, record the response until
+ * it is steady again. Steady: over the last half of the phase (at least AUTOTUNE_STEADY_MIN_MS) the mean of
+ * the newer half differs from the older half by less than the band - for a first-order response that is
+ * about 6 time constants in, leaving well under 1% of the step to come. Comparing means rather than a
+ * min/max range keeps sensor noise from holding the experiment open. */
+#define AUTOTUNE_STEADY_MIN_MS          (60000U)
+#define AUTOTUNE_STEADY_BAND_C          (0.05f)
+#define AUTOTUNE_STEADY_BAND_REL        (0.02f)     /* Of the distance moved since the phase began */
+#define AUTOTUNE_BASELINE_MAX_MS        (1800000U)  /* 30 min to settle at the base duty */
+#define AUTOTUNE_STEP_MAX_MS            (3600000U)  /* 60 min for the step response */
+#define AUTOTUNE_MIN_RESPONSE_C         (0.5f)      /* Smaller responses are lost in noise and load changes */
+
+/* Response Trace - block means, bounded memory: when it fills, neighbouring points merge and the spacing doubles,
+ * so any phase length fits in AUTOTUNE_TRACE_LEN points */
+#define AUTOTUNE_TRACE_LEN              (128U)
+
+/* Derived Parameter Limits */
+#define AUTOTUNE_HORIZON_MIN_S          (10.0f)
+#define AUTOTUNE_HORIZON_MAX_S          (300.0f)
+#define AUTOTUNE_SETTLE_MIN_MS          (10000U)
+#define AUTOTUNE_SETTLE_MAX_MS          (600000U)
+#define AUTOTUNE_TRIM_STEP_MIN          (1U)
+#define AUTOTUNE_TRIM_STEP_MAX          (10U)
+
+/* GATT Wire Format (little-endian, 13 bytes)
+ *   [0] autotune_state_t   [1] autotune_error_t
+ *   [2..3]  gain, m°C per % duty (int16)   [4..5] time constant (s)   [6..7] dead time (s)
+ *   [8..9]  predictive horizon (s)         [10..11] energy trim settle time (s)   [12] energy trim step (%) */
+#define AUTOTUNE_WIRE_SIZE              (13U)
+
+/* Commands written to the autotune characteristic */
+#define AUTOTUNE_CMD_ABORT              (0x00U)
+#define AUTOTUNE_CMD_START              (0x01U)
+
+typedef enum {
+    AUTOTUNE_IDLE = 0,
+    AUTOTUNE_BASELINE,          /* Holding the base duty until steady */
+    AUTOTUNE_STEP,              /* Step applied, recording the response */
+    AUTOTUNE_DONE,              /* Model identified, parameters derived */
+    AUTOTUNE_FAILED,
+} autotune_state_t;
+
+typedef enum {
+    AUTOTUNE_ERR_NONE = 0,
+    AUTOTUNE_ERR_ABORTED,       /* Command, sensor fault or shutdown */
+    AUTOTUNE_ERR_LIMIT,         /* Temperature reached the limit */
+    AUTOTUNE_ERR_UNSTEADY,      /* Never settled at the base duty */
+    AUTOTUNE_ERR_TIMEOUT,       /* Step response never settled */
+    AUTOTUNE_ERR_NO_RESPONSE,   /* Step moved the temperature less than AUTOTUNE_MIN_RESPONSE_C */
+    AUTOTUNE_ERR_MODEL,         /* Response does not fit a first-order-plus-dead-time model */
+} autotune_error_t;
+
+/* Plant Model: temperature change = gain * duty change, after dead_time_s, with time constant tau_s */
+typedef struct {
+    float gain;                 /* °C per % duty (negative: more airflow cools) */
+    float tau_s;
+    float dead_time_s;
+} autotune_model_t;
+
+/* Controller Parameters - what the level controller can use from the model */
+typedef struct {
+    float predict_horizon_s;    /* Feed-forward ramp lead: a duty change takes dead time + tau to act (63%) */
+    uint32_t settle_ms;         /* Energy trim hold: dead time + 3 tau (95% settled) */
+    uint8_t trim_step;          /* Energy trim step (%): moves the temperature by half the margin at most */
+} autotune_params_t;
+
+/* Running Mean Trace of the current phase */
+typedef struct {
+    int16_t point[AUTOTUNE_TRACE_LEN];  /* Block means, °C x100 */
+    uint16_t count;
+    uint32_t spacing_ms;        /* Time each point covers */
+    uint32_t pending_ms;        /* Time accumulated toward the next point */
+    float pending_sum;          /* Temperature x ms accumulated toward the next point */
+} autotune_trace_t;
+
+/* Autotune State */
+typedef struct {
+    autotune_state_t state;
+    autotune_error_t error;
+    uint8_t base_duty;
+    int8_t step_duty;
+    float limit_temp;           /* Abort at or above */
+    float margin_c;             /* Energy trim margin the trim step is sized for */
+    uint32_t phase_ms;          /* Time in the current phase */
+    float baseline;             /* Steady temperature at the base duty */
+    float final;                /* Steady temperature after the step */
+    autotune_trace_t trace;
+    autotune_model_t model;
+    autotune_params_t params;
+} autotune_t;
+
+/* Function Declarations */
+void autotune_init(autotune_t *p_tune);
+bool autotune_start(autotune_t *p_tune, uint8_t base_duty, int8_t step_duty, float limit_temp, float margin_c,
+                    uint32_t sample_interval_ms);
+void autotune_abort(autotune_t *p_tune);
+bool autotune_active(autotune_t const *p_tune);
+uint8_t autotune_update(autotune_t *p_tune, float temperature, uint32_t dt_ms);
+autotune_error_t autotune_identify(autotune_trace_t const *p_trace, float baseline, float final, float step_duty,
+                                   autotune_model_t *p_model);
+void autotune_derive(autotune_model_t const *p_model, float margin_c, autotune_params_t *p_params);
+uint16_t autotune_serialize(autotune_t const *p_tune, uint8_t *p_buf, uint16_t buf_len);
+
+#endif /* AUTOTUNE_H_ */
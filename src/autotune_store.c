@@ -0,0 +1,112 @@
+/***********************************************************************************************************************
+ * File Name    : autotune_store.c
+ * Description  : Autotune Result Storage - identified plant model and derived controller parameters in data flash
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stddef.h>
+#include "common_utils.h"
+#include "autotune_store.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+_Static_assert(sizeof(autotune_record_t) <= AUTOTUNE_FLASH_BLOCK_SIZE, "autotune_record_t must fit one data flash block");
+
+/* Flash Instance */
+extern flash_ctrl_t g_flash0_ctrl;
+extern const flash_cfg_t g_flash0_cfg;
+
+/**
+ * @brief CRC-32 (IEEE, bitwise - only runs on load/store)
+ */
+static uint32_t autotune_store_crc(autotune_record_t const *p_record)
+{
+    uint8_t const *p_byte = (uint8_t const *)p_record;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0; i < offsetof(autotune_record_t, crc); i++)
+    {
+        crc ^= p_byte[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Check stored parameters are ones autotune_derive() can produce
+ */
+static bool autotune_store_valid(autotune_params_t const *p_params)
+{
+    return (p_params->predict_horizon_s >= AUTOTUNE_HORIZON_MIN_S) &&
+           (p_params->predict_horizon_s <= AUTOTUNE_HORIZON_MAX_S) &&
+           (p_params->settle_ms >= AUTOTUNE_SETTLE_MIN_MS) && (p_params->settle_ms <= AUTOTUNE_SETTLE_MAX_MS) &&
+           (p_params->trim_step >= AUTOTUNE_TRIM_STEP_MIN) && (p_params->trim_step <= AUTOTUNE_TRIM_STEP_MAX);
+}
+
+/**
+ * @brief Fetch the stored autotune result
+ * @param[out] p_record Stored record (valid only when true is returned)
+ * @return true if a valid result is stored
+ */
+bool autotune_store_load(autotune_record_t *p_record)
+{
+    autotune_record_t const *p_stored = (autotune_record_t const *)AUTOTUNE_FLASH_ADDR;
+    fsp_err_t err = R_FLASH_HP_Open(&g_flash0_ctrl, &g_flash0_cfg);
+
+    if (((FSP_SUCCESS != err) && (FSP_ERR_ALREADY_OPEN != err)) || (AUTOTUNE_RECORD_MAGIC != p_stored->magic) ||
+        (autotune_store_crc(p_stored) != p_stored->crc) || !autotune_store_valid(&p_stored->params))
+    {
+        return false;
+    }
+
+    *p_record = *p_stored;
+    return true;
+}
+
+/**
+ * @brief Store a finished autotune result
+ * @note  Blocking erase+write of one data flash block; call outside the control step
+ * @param[in] p_tune Autotune state (AUTOTUNE_DONE)
+ * @return FSP_ERR_INVALID_ARGUMENT if there is no result to store
+ */
+fsp_err_t autotune_store_save(autotune_t const *p_tune)
+{
+    fsp_err_t err;
+    autotune_record_t record;
+    uint32_t block[AUTOTUNE_FLASH_BLOCK_SIZE / sizeof(uint32_t)];
+
+    if ((AUTOTUNE_DONE != p_tune->state) || !autotune_store_valid(&p_tune->params))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.magic = AUTOTUNE_RECORD_MAGIC;
+    record.model = p_tune->model;
+    record.params = p_tune->params;
+    record.base_duty = p_tune->base_duty;
+    record.step_duty = p_tune->step_duty;
+    record.crc = autotune_store_crc(&record);
+
+    memset(block, 0xFF, sizeof(block));
+    memcpy(block, &record, sizeof(record));
+
+    err = R_FLASH_HP_Open(&g_flash0_ctrl, &g_flash0_cfg);
+    err = (FSP_ERR_ALREADY_OPEN == err) ? FSP_SUCCESS : err;
+    if (FSP_SUCCESS == err)
+    {
+        err = R_FLASH_HP_Erase(&g_flash0_ctrl, AUTOTUNE_FLASH_ADDR, 1);
+    }
+    if (FSP_SUCCESS == err)
+    {
+        err = R_FLASH_HP_Write(&g_flash0_ctrl, (uint32_t)block, AUTOTUNE_FLASH_ADDR, sizeof(block));
+    }
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Autotune: flash write FAILED\r\n");
+    }
+    return err;
+}
@@ -0,0 +1,33 @@
+/***********************************************************************************************************************
+ * File Name    : autotune_store.h
+ * Description  : Autotune Result Storage - identified plant model and derived controller parameters in data flash
+ **********************************************************************************************************************/
+
+#ifndef AUTOTUNE_STORE_H_
+#define AUTOTUNE_STORE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+#include "autotune.h"
+
+/* Storage */
+#define AUTOTUNE_FLASH_ADDR             (0x080000C0UL)      /* Data flash block after the NTC calibration */
+#define AUTOTUNE_FLASH_BLOCK_SIZE       (64U)
+#define AUTOTUNE_RECORD_MAGIC           (0x4154554EUL)      /* "ATUN" */
+
+typedef struct {
+    uint32_t magic;
+    autotune_model_t model;
+    autotune_params_t params;
+    uint8_t base_duty;          /* Operating point the model was identified at */
+    int8_t step_duty;
+    uint16_t reserved;
+    uint32_t crc;               /* CRC-32 over everything above */
+} autotune_record_t;
+
+/* Function Declarations */
+bool autotune_store_load(autotune_record_t *p_record);
+fsp_err_t autotune_store_save(autotune_t const *p_tune);
+
+#endif /* AUTOTUNE_STORE_H_ */
@@ -14,20 +14,32 @@
 #include "hal_data.h"
 #include "common_utils.h"
 #include "main_application.h"
-#include "log_disabled.h"
+#include "ble_app.h"
+#include "thermal_config.h"
+#include "rack_aggregator.h"
+#include "ble_ota.h"
+#include "thermal_stats.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
 
 /* BLE Configuration Constants */
 #define BLE_LOG_TAG "ble_app"
 #define BLE_GATTS_QUEUE_ELEMENTS_SIZE   (14)
 #define BLE_GATTS_QUEUE_BUFFER_LEN      (245)
 #define BLE_GATTS_QUEUE_NUM             (1)
-#define BLE_OPTIMAL_MTU                 101
+#define BLE_OPTIMAL_MTU                 247     /* Large MTU for firmware update streaming */
 #define MAX_ADV_DATA_LENGTH             (20)
 #define PRE_ADV_DATA_LEN                (6)  /* "US000-" */
 
-/* Global variables */
-uint16_t g_conn_hdl = BLE_GAP_INVALID_CONN_HDL;
-static bool g_ble_connected = false;
+/* Connection table - one slot per concurrent central */
+static ble_conn_t gs_conn_table[BLE_MAX_CONNECTIONS];
+static uint8_t gs_conn_count = 0;
+static bool gs_advertising = false;
+static ble_pump_stats_t gs_pump_stats;
+static uint16_t gs_ota_conn_hdl = BLE_GAP_INVALID_CONN_HDL;  /* Central driving the firmware update */
+static bool gs_status_subscribed = false;   /* A link just enabled rack status notifications */
+static volatile bool gs_autotune_pending = false;   /* Autotune command written, not yet taken */
+static volatile uint8_t gs_autotune_cmd;
 
 /* Advertisement data */
 static const char pre_adv_data[] = "US000-";
@@ -38,6 +50,9 @@ static uint8_t gs_advertising_data[] = {
     0x13, 0x09, 'T', 'E', 'M', 'P', '_', 'S', 'E', 'N', 'S', 'O', 'R', 0x00, 0x00, 0x00, 0x00, 0x00
 };
 
+/* Scan response - rack status for row aggregators (refreshed by ble_update_adv_status) */
+static uint8_t gs_scan_response_data[RACK_ADV_AD_LEN];
+
 /* BLE Advertising Parameters */
 ble_abs_legacy_advertising_parameter_t g_ble_advertising_parameter = {
     .p_peer_address             = NULL,
@@ -45,12 +60,41 @@ ble_abs_legacy_advertising_parameter_t g_ble_advertising_parameter = {
     .slow_advertising_period    = 0x0000,
     .p_advertising_data         = gs_advertising_data,
     .advertising_data_length    = sizeof(gs_advertising_data),
+    .p_scan_response_data       = gs_scan_response_data,
+    .scan_response_data_length  = sizeof(gs_scan_response_data),
     .advertising_filter_policy  = BLE_ABS_ADVERTISING_FILTER_ALLOW_ANY,
     .advertising_channel_map    = (BLE_GAP_ADV_CH_37 | BLE_GAP_ADV_CH_38 | BLE_GAP_ADV_CH_39),
     .own_bluetooth_address_type = BLE_GAP_ADDR_RAND,
     .own_bluetooth_address      = { 0 }
 };
 
+#if BLE_AGGREGATOR_ENABLE
+/* Aggregator scan: active (status is in the scan response), continuous, no duplicate filtering */
+static ble_abs_scan_phy_parameter_t gs_scan_phy_parameter = {
+    .fast_scan_interval = 0x0060,   /* 60ms */
+    .fast_scan_window   = 0x0030,   /* 30ms - leaves airtime for advertising and links */
+    .slow_scan_interval = 0x0060,
+    .slow_scan_window   = 0x0030,
+    .active_scan_enable = BLE_GAP_SCAN_ACTIVE,
+};
+
+static ble_abs_scan_parameter_t gs_scan_parameter = {
+    .p_phy_parameter_1M        = &gs_scan_phy_parameter,
+    .p_phy_parameter_coded     = NULL,
+    .fast_scan_period          = 0x0000,
+    .slow_scan_period          = 0x0000,
+    .p_filter_data             = NULL,
+    .filter_data_length        = 0,
+    .filter_ad_type            = 0,
+    .device_scan_filter_policy = 0,
+    .filter_duplicate          = BLE_GAP_SCAN_FILT_DUPLIC_DISABLE,
+};
+
+static uint32_t gs_ble_now_ms = 0;
+static uint32_t gs_ble_clock_cycles = 0;
+static uint32_t gs_last_summary_ms = 0;
+#endif
+
 /* GATT Server Queue */
 static st_ble_gatt_queue_elm_t  gs_queue_elms[BLE_GATTS_QUEUE_ELEMENTS_SIZE];
 static uint8_t gs_buffer[BLE_GATTS_QUEUE_BUFFER_LEN];
@@ -85,6 +129,143 @@ ble_abs_gatt_client_callback_set_t gs_abs_gattc_cb_param[] = {
     }
 };
 
+/*******************************************************************************
+ * Connection Table
+ *******************************************************************************/
+
+/**
+ * @brief Find the table slot for a connection handle
+ * @param[in] conn_hdl Connection handle (BLE_GAP_INVALID_CONN_HDL finds a free slot)
+ * @return Slot, or NULL if not found
+ */
+static ble_conn_t *ble_conn_find(uint16_t conn_hdl)
+{
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+        if (gs_conn_table[i].conn_hdl == conn_hdl)
+        {
+            return &gs_conn_table[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Release a slot and clear its subscription state
+ */
+static void ble_conn_reset(ble_conn_t *p_conn)
+{
+    memset(p_conn, 0, sizeof(*p_conn));
+    p_conn->conn_hdl = BLE_GAP_INVALID_CONN_HDL;
+    p_conn->mtu = BLE_DEFAULT_MTU;
+}
+
+/**
+ * @brief Subscription word for a characteristic on one connection
+ * @param[in] p_conn   Connection slot (may be NULL)
+ * @param[in] attr_hdl CCCD or value handle of a notifying characteristic
+ * @return Pointer to the slot's CCCD value, or NULL if not tracked
+ */
+static uint16_t *ble_conn_cccd(ble_conn_t *p_conn, uint16_t attr_hdl)
+{
+    if (NULL == p_conn)
+    {
+        return NULL;
+    }
+
+    switch (attr_hdl)
+    {
+        case BLE_RACK_STATUS_VAL_HDL:
+        case BLE_RACK_STATUS_CCCD_HDL:
+            return &p_conn->cccd_rack_status;
+
+        case BLE_ROW_SUMMARY_VAL_HDL:
+        case BLE_ROW_SUMMARY_CCCD_HDL:
+            return &p_conn->cccd_row_summary;
+
+        case BLE_OTA_CONTROL_VAL_HDL:
+        case BLE_OTA_CONTROL_CCCD_HDL:
+            return &p_conn->cccd_ota_control;
+
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Advertise only while a slot is free and advertising is not already running
+ */
+static void ble_advertising_resume(void)
+{
+    if (!gs_advertising && (gs_conn_count < BLE_MAX_CONNECTIONS))
+    {
+        if (FSP_SUCCESS == RM_BLE_ABS_StartLegacyAdvertising(&g_ble_abs0_ctrl, &g_ble_advertising_parameter))
+        {
+            gs_advertising = true;
+        }
+    }
+}
+
+/**
+ * @brief Update a characteristic and fan the same buffer out to every link subscribed to it
+ * @param[in] attr_hdl Value handle
+ * @param[in] p_data   Encoded payload
+ * @param[in] len      Payload length
+ * @return Subscribed links that did not get it (MTU too small or stack queue full)
+ */
+static uint8_t ble_notify_subscribers(uint16_t attr_hdl, uint8_t *p_data, uint16_t len)
+{
+    st_ble_gatt_hdl_value_pair_t hdl_value_pair;
+    ble_status_t status;
+    uint8_t missed = 0;
+
+    hdl_value_pair.attr_hdl        = attr_hdl;
+    hdl_value_pair.value.p_value   = p_data;
+    hdl_value_pair.value.value_len = len;
+
+    /* Keep the attribute current for reads, subscribed or not */
+    R_BLE_GATTS_SetAttr(BLE_GAP_INVALID_CONN_HDL, attr_hdl, &hdl_value_pair.value);
+
+    if (0U == gs_conn_count)
+    {
+        log_debug("BLE not connected, notification not sent\r\n");
+        return 0;
+    }
+
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+        ble_conn_t *p_conn = &gs_conn_table[i];
+        uint16_t *p_cccd = ble_conn_cccd(p_conn, attr_hdl);
+
+        if ((BLE_GAP_INVALID_CONN_HDL == p_conn->conn_hdl) || (NULL == p_cccd) || (0U == (*p_cccd & BLE_CCCD_NOTIFY)))
+        {
+            continue;
+        }
+
+        if ((uint32_t)len + BLE_ATT_NTF_OVERHEAD > p_conn->mtu)
+        {
+            p_conn->tx_failures++;
+            missed++;
+            continue;
+        }
+
+        status = R_BLE_GATTS_Notification(p_conn->conn_hdl, &hdl_value_pair);
+        if (BLE_SUCCESS == status)
+        {
+            p_conn->tx_notifications++;
+            p_conn->tx_bytes += len;
+        }
+        else
+        {
+            p_conn->tx_failures++;
+            missed++;
+            log_debug("BLE Notification failed: 0x%04x on handle 0x%04x\r\n", status, p_conn->conn_hdl);
+        }
+    }
+
+    return missed;
+}
+
 /*******************************************************************************
  * Callback Functions
  *******************************************************************************/
@@ -105,29 +286,82 @@ void gap_cb(uint16_t type, ble_status_t result, st_ble_evt_data_t *p_data)
 
         case BLE_GAP_EVENT_CONN_IND:
         {
+            /* Legacy advertising stops when a connection is established */
+            gs_advertising = false;
+
             if (BLE_SUCCESS == result)
             {
                 st_ble_gap_conn_evt_t *p_gap_conn_evt_param = (st_ble_gap_conn_evt_t *)p_data->p_param;
-                g_conn_hdl = p_gap_conn_evt_param->conn_hdl;
-                g_ble_connected = true;
-                log_info("BLE Connected, handle: 0x%04x\r\n", g_conn_hdl);
+                ble_conn_t *p_conn = ble_conn_find(BLE_GAP_INVALID_CONN_HDL);
+
+                if (NULL != p_conn)
+                {
+                    p_conn->conn_hdl = p_gap_conn_evt_param->conn_hdl;
+                    gs_conn_count++;
+                    log_info("BLE Connected, handle: 0x%04x (%d/%d)\r\n",
+                             p_conn->conn_hdl, gs_conn_count, BLE_MAX_CONNECTIONS);
+
+                    /* Long LL packets so a full-MTU write fits one connection event slot */
+                    R_BLE_GAP_SetDataLen(p_conn->conn_hdl, BLE_MAX_TX_OCTETS, BLE_MAX_TX_TIME_US);
+                }
+                else
+                {
+                    /* Stack allowed more links than the table holds - refuse the extra one */
+                    log_error("BLE connection table full\r\n");
+                    R_BLE_GAP_Disconnect(p_gap_conn_evt_param->conn_hdl, 0x13);
+                }
             }
             else
             {
                 log_error("BLE Connection failed\r\n");
-                RM_BLE_ABS_StartLegacyAdvertising(&g_ble_abs0_ctrl, &g_ble_advertising_parameter);
             }
+
+            ble_advertising_resume();
         }
         break;
 
         case BLE_GAP_EVENT_DISCONN_IND:
         {
-            g_conn_hdl = BLE_GAP_INVALID_CONN_HDL;
-            g_ble_connected = false;
-            log_info("BLE Disconnected\r\n");
-            RM_BLE_ABS_StartLegacyAdvertising(&g_ble_abs0_ctrl, &g_ble_advertising_parameter);
+            st_ble_gap_disconn_evt_t *p_disconn_evt_param = (st_ble_gap_disconn_evt_t *)p_data->p_param;
+            ble_conn_t *p_conn = ble_conn_find(p_disconn_evt_param->conn_hdl);
+
+            if (NULL != p_conn)
+            {
+                ble_conn_reset(p_conn);
+                gs_conn_count--;
+            }
+            if (p_disconn_evt_param->conn_hdl == gs_ota_conn_hdl)
+            {
+                ble_ota_abort();
+                gs_ota_conn_hdl = BLE_GAP_INVALID_CONN_HDL;
+            }
+            log_info("BLE Disconnected, handle: 0x%04x (%d/%d)\r\n",
+                     p_disconn_evt_param->conn_hdl, gs_conn_count, BLE_MAX_CONNECTIONS);
+
+            /* Only restarts if it stopped because the table was full */
+            ble_advertising_resume();
+        }
+        break;
+
+        case BLE_GAP_EVENT_ADV_OFF:
+        {
+            gs_advertising = false;
+        }
+        break;
+
+#if BLE_AGGREGATOR_ENABLE
+        case BLE_GAP_EVENT_ADV_REPT_IND:
+        {
+            st_ble_gap_adv_rept_evt_t *p_adv_rept = (st_ble_gap_adv_rept_evt_t *)p_data->p_param;
+
+            if (BLE_GAP_ADV_RPT_TYPE_LEGACY == p_adv_rept->adv_rpt_type)
+            {
+                st_ble_gap_adv_rpt_t *p_rpt = p_adv_rept->param.p_adv_rpt;
+                rack_aggregator_parse_adv(p_rpt->p_data, p_rpt->len, p_rpt->rssi, gs_ble_now_ms);
+            }
         }
         break;
+#endif
 
         case BLE_GAP_EVENT_CONN_PARAM_UPD_REQ:
         {
@@ -162,7 +396,84 @@ void gatts_cb(uint16_t type, ble_status_t result, st_ble_gatts_evt_data_t *p_dat
     {
         case BLE_GATTS_EVENT_DB_ACCESS_IND:
         {
+            st_ble_gatts_db_access_evt_t *p_db_access = (st_ble_gatts_db_access_evt_t *)p_data->p_param;
+
             log_debug("GATT DB Access\r\n");
+
+            if ((BLE_GATTS_OP_CHAR_PEER_CLI_CNFG_WRITE_REQ == p_db_access->p_handle->db_op) &&
+                (p_db_access->p_handle->value.value_len >= 2U))
+            {
+                /* Subscription is per link - the stack keeps a CCCD value per connection too */
+                uint16_t *p_cccd = ble_conn_cccd(ble_conn_find(p_data->conn_hdl), p_db_access->p_handle->attr_hdl);
+                if (NULL != p_cccd)
+                {
+                    uint16_t previous = *p_cccd;
+                    *p_cccd = (uint16_t)(p_db_access->p_handle->value.p_value[0] |
+                                         (p_db_access->p_handle->value.p_value[1] << 8));
+
+                    /* Status is sent by exception - a new subscriber is owed the current state now */
+                    if ((BLE_RACK_STATUS_CCCD_HDL == p_db_access->p_handle->attr_hdl) &&
+                        (0U == (previous & BLE_CCCD_NOTIFY)) && (0U != (*p_cccd & BLE_CCCD_NOTIFY)))
+                    {
+                        gs_status_subscribed = true;
+                    }
+                    log_debug("CCCD 0x%04x = 0x%04x on handle 0x%04x\r\n",
+                              p_db_access->p_handle->attr_hdl, *p_cccd, p_data->conn_hdl);
+                }
+            }
+            else if ((BLE_OTA_DATA_VAL_HDL == p_db_access->p_handle->attr_hdl) &&
+                     (p_data->conn_hdl == gs_ota_conn_hdl))
+            {
+                /* Hot path: one packet per write without response, no response to build */
+                ble_ota_data(p_db_access->p_handle->value.p_value, p_db_access->p_handle->value.value_len);
+            }
+            else if ((BLE_OTA_CONTROL_VAL_HDL == p_db_access->p_handle->attr_hdl) &&
+                     (BLE_GATTS_OP_CHAR_PEER_WRITE_REQ == p_db_access->p_handle->db_op))
+            {
+                /* One updater at a time - START claims the transfer for this link */
+                if (!ble_ota_busy() || (p_data->conn_hdl == gs_ota_conn_hdl))
+                {
+                    if ((p_db_access->p_handle->value.value_len > 0U) &&
+                        (OTA_CMD_START == p_db_access->p_handle->value.p_value[0]))
+                    {
+                        gs_ota_conn_hdl = p_data->conn_hdl;
+                    }
+                    ble_ota_control(p_db_access->p_handle->value.p_value, p_db_access->p_handle->value.value_len);
+                }
+            }
+            else if ((BLE_THERMAL_CONFIG_VAL_HDL == p_db_access->p_handle->attr_hdl) &&
+                ((BLE_GATTS_OP_CHAR_PEER_WRITE_REQ == p_db_access->p_handle->db_op) ||
+                 (BLE_GATTS_OP_CHAR_PEER_WRITE_CMD == p_db_access->p_handle->db_op)))
+            {
+                /* Validated into staging here; the control loop swaps it in between iterations */
+                if (FSP_SUCCESS != thermal_config_stage(p_db_access->p_handle->value.p_value,
+                                                        p_db_access->p_handle->value.value_len))
+                {
+                    log_error("Thermal config write rejected\r\n");
+                    ble_publish_thermal_config();
+                }
+            }
+            else if ((BLE_AUTOTUNE_VAL_HDL == p_db_access->p_handle->attr_hdl) &&
+                     (BLE_GATTS_OP_CHAR_PEER_WRITE_REQ == p_db_access->p_handle->db_op) &&
+                     (p_db_access->p_handle->value.value_len >= 1U))
+            {
+                /* The experiment takes the fans - only the control loop may start or stop it */
+                gs_autotune_cmd = p_db_access->p_handle->value.p_value[0];
+                gs_autotune_pending = true;
+            }
+        }
+        break;
+
+        case BLE_GATTS_EVENT_EX_MTU_REQ:
+        {
+            st_ble_gatts_ex_mtu_req_evt_t *p_mtu_req = (st_ble_gatts_ex_mtu_req_evt_t *)p_data->p_param;
+            ble_conn_t *p_conn = ble_conn_find(p_data->conn_hdl);
+
+            R_BLE_GATTS_RspExMtu(p_data->conn_hdl, BLE_OPTIMAL_MTU);
+            if (NULL != p_conn)
+            {
+                p_conn->mtu = (p_mtu_req->mtu < BLE_OPTIMAL_MTU) ? p_mtu_req->mtu : BLE_OPTIMAL_MTU;
+            }
         }
         break;
 
@@ -201,7 +512,11 @@ void vs_cb(uint16_t type, ble_status_t result, st_ble_vs_evt_data_t *p_data)
             memcpy(g_ble_advertising_parameter.own_bluetooth_address, 
                    get_address->addr.addr, BLE_BD_ADDR_LEN);
             log_info("Starting BLE Advertisement\r\n");
-            RM_BLE_ABS_StartLegacyAdvertising(&g_ble_abs0_ctrl, &g_ble_advertising_parameter);
+            ble_advertising_resume();
+#if BLE_AGGREGATOR_ENABLE
+            log_info("Starting row aggregator scan\r\n");
+            RM_BLE_ABS_StartScanning(&g_ble_abs0_ctrl, &gs_scan_parameter);
+#endif
         }
         break;
 
@@ -219,6 +534,110 @@ static void qc_svcs_cb(uint16_t type, ble_status_t result, st_ble_servs_evt_data
     FSP_PARAMETER_NOT_USED(p_data);
 }
 
+/**
+ * @brief Refresh the configuration characteristic from the active configuration
+ */
+void ble_publish_thermal_config(void)
+{
+    uint8_t buf[THERMAL_CONFIG_WIRE_SIZE];
+    st_ble_gatt_value_t value;
+
+    value.p_value = buf;
+    value.value_len = thermal_config_serialize(thermal_config_get(), buf, sizeof(buf));
+    R_BLE_GATTS_SetAttr(BLE_GAP_INVALID_CONN_HDL, BLE_THERMAL_CONFIG_VAL_HDL, &value);
+}
+
+/**
+ * @brief Refresh the rolling statistics characteristic (read by the gateway, no notifications)
+ * @param[in] status Temperature status (TEMP_STATUS_*)
+ */
+void ble_publish_thermal_stats(uint8_t status)
+{
+    uint8_t buf[THERMAL_STATS_WIRE_SIZE];
+    st_ble_gatt_value_t value;
+
+    value.p_value = buf;
+    value.value_len = thermal_stats_serialize(status, buf, sizeof(buf));
+    R_BLE_GATTS_SetAttr(BLE_GAP_INVALID_CONN_HDL, BLE_THERMAL_STATS_VAL_HDL, &value);
+}
+
+/**
+ * @brief Refresh the autotune characteristic (state, identified model, derived parameters)
+ * @param[in] p_data Serialized autotune state (autotune_serialize())
+ * @param[in] len    Length
+ */
+void ble_publish_autotune(uint8_t const *p_data, uint16_t len)
+{
+    st_ble_gatt_value_t value;
+
+    value.p_value = (uint8_t *)p_data;
+    value.value_len = len;
+    R_BLE_GATTS_SetAttr(BLE_GAP_INVALID_CONN_HDL, BLE_AUTOTUNE_VAL_HDL, &value);
+}
+
+/**
+ * @brief Refresh this rack's status in the scan response (seen by row aggregators)
+ * @param[in] temperature   °C × 100
+ * @param[in] cooling_level Cooling level
+ * @param[in] duty          Fan duty (%)
+ * @param[in] alert         SYSTEM_ALERT_* bits
+ */
+void ble_update_adv_status(int16_t temperature, uint8_t cooling_level, uint8_t duty, uint8_t alert)
+{
+    uint8_t ad[RACK_ADV_AD_LEN];
+    st_ble_gap_adv_data_t sres;
+
+    rack_aggregator_encode_adv(ad, BLE_RACK_ID, temperature, cooling_level, duty, alert);
+
+#if BLE_AGGREGATOR_ENABLE
+    /* The aggregator counts itself in the row */
+    rack_aggregator_parse_adv(ad, sizeof(ad), 0, gs_ble_now_ms);
+#endif
+
+    /* Skip the controller update when nothing changed */
+    if (0 == memcmp(ad, gs_scan_response_data, sizeof(ad)))
+    {
+        return;
+    }
+    memcpy(gs_scan_response_data, ad, sizeof(ad));
+
+    sres.adv_hdl          = 0;
+    sres.data_type        = BLE_GAP_SCAN_RSP_DATA_MODE;
+    sres.data_length      = sizeof(gs_scan_response_data);
+    sres.p_data           = gs_scan_response_data;
+    sres.zero_length_flag = 0;
+    R_BLE_GAP_SetAdvSresData(&sres);
+}
+
+#if BLE_AGGREGATOR_ENABLE
+/**
+ * @brief Millisecond clock for rack ages, extended from the cycle counter on every ble_app_run()
+ */
+static void ble_clock_update(void)
+{
+    uint32_t cycles_per_ms = SystemCoreClock / 1000U;
+    uint32_t now = DWT->CYCCNT;
+    uint32_t elapsed = now - gs_ble_clock_cycles;
+
+    gs_ble_now_ms += elapsed / cycles_per_ms;
+    gs_ble_clock_cycles = now - (elapsed % cycles_per_ms);
+}
+
+/**
+ * @brief Summarise the row and publish it to readers and subscribers
+ */
+static void ble_publish_row_summary(void)
+{
+    row_summary_t summary;
+    uint8_t buf[ROW_SUMMARY_WIRE_SIZE];
+    uint16_t len;
+
+    rack_aggregator_summarize(gs_ble_now_ms, &summary);
+    len = rack_aggregator_serialize_summary(&summary, buf);
+    ble_notify_subscribers(BLE_ROW_SUMMARY_VAL_HDL, buf, len);
+}
+#endif
+
 /*******************************************************************************
  * BLE Initialization
  *******************************************************************************/
@@ -233,6 +652,17 @@ ble_status_t ble_init(void)
 
     log_info("Initializing BLE\r\n");
 
+    for (uint8_t i = 0; i < BLE_MAX_CONNECTIONS; i++)
+    {
+        ble_conn_reset(&gs_conn_table[i]);
+    }
+    gs_conn_count = 0;
+    gs_advertising = false;
+    rack_aggregator_encode_adv(gs_scan_response_data, BLE_RACK_ID, 0, 0, 0, 0);
+#if BLE_AGGREGATOR_ENABLE
+    rack_aggregator_init();
+#endif
+
     /* Initialize BLE */
     err = RM_BLE_ABS_Open(&g_ble_abs0_ctrl, &g_ble_abs0_cfg);
     if (FSP_SUCCESS != err)
@@ -268,6 +698,9 @@ ble_status_t ble_init(void)
     /* Set Prepare Write Queue */
     R_BLE_GATTS_SetPrepareQueue(gs_queue, BLE_GATTS_QUEUE_NUM);
 
+    /* Expose the active thermal configuration for reads */
+    ble_publish_thermal_config();
+
     /* Initialize Quick Connect Service */
     status = R_BLE_QC_SVCS_Init(qc_svcs_cb);
     if (BLE_SUCCESS != status)
@@ -294,12 +727,75 @@ void ble_app_init(void)
 }
 
 /**
- * @brief BLE Application Main Loop (No-RTOS Polling)
+ * @brief BLE Application Main Loop (No-RTOS Polling) - service the stack within a cycle budget
+ * @note  R_BLE_Execute() is not preemptible, so the budget is checked between passes: one pass that
+ *        starts inside the budget always completes. Pending work left over is picked up next call.
+ * @param[in] budget_cycles Cycles available this call (0 = skip, the control loop needs the time)
+ * @return true if stack work is still pending
  */
-void ble_app_run(void)
+bool ble_app_run(uint32_t budget_cycles)
 {
-    /* Process BLE events */
-    R_BLE_Execute();
+    uint32_t start = DWT->CYCCNT;
+    uint32_t busy;
+    uint8_t ota_status[OTA_STATUS_WIRE_SIZE];
+    uint16_t ota_len;
+
+    gs_pump_stats.calls++;
+
+    if (0U == budget_cycles)
+    {
+        gs_pump_stats.skipped++;
+        return (0U == R_BLE_IsTaskFree());
+    }
+
+#if BLE_AGGREGATOR_ENABLE
+    ble_clock_update();
+#endif
+
+    /* Process BLE events until idle or out of budget */
+    do
+    {
+        R_BLE_Execute();
+        gs_pump_stats.executes++;
+    } while ((0U == R_BLE_IsTaskFree()) && ((DWT->CYCCNT - start) < budget_cycles));
+
+#if BLE_AGGREGATOR_ENABLE
+    if ((gs_ble_now_ms - gs_last_summary_ms) >= BLE_ROW_SUMMARY_PUBLISH_MS)
+    {
+        gs_last_summary_ms = gs_ble_now_ms;
+        ble_publish_row_summary();
+    }
+#endif
+
+    /* Firmware update progress / result, then any deferred reboot */
+    ota_len = ble_ota_take_status(ota_status);
+    if (ota_len > 0U)
+    {
+        ble_notify_subscribers(BLE_OTA_CONTROL_VAL_HDL, ota_status, ota_len);
+    }
+    ble_ota_service();
+
+    busy = DWT->CYCCNT - start;
+    gs_pump_stats.busy_cycles_last = busy;
+    if (busy > gs_pump_stats.busy_cycles_max)
+    {
+        gs_pump_stats.busy_cycles_max = busy;
+    }
+
+    if (0U == R_BLE_IsTaskFree())
+    {
+        gs_pump_stats.deferrals++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Snapshot event pump statistics
+ */
+void ble_get_pump_stats(ble_pump_stats_t *p_stats)
+{
+    *p_stats = gs_pump_stats;
 }
 
 /**
@@ -311,32 +807,68 @@ void ble_app_close(void)
 }
 
 /**
- * @brief Send Temperature Data via BLE Notification
+ * @brief Send Rack Status via BLE Notification to every subscribed central
+ * @param[in] p_data Encoded payload (encoded once by the caller, shared by all links)
+ * @param[in] len    Payload length
+ * @return Subscribed centrals that did not get it (0 when none are subscribed)
  */
-void ble_send_notification(uint8_t *p_data, uint16_t len)
+uint8_t ble_send_notification(uint8_t *p_data, uint16_t len)
 {
-    if (!g_ble_connected || g_conn_hdl == BLE_GAP_INVALID_CONN_HDL)
-    {
-        log_debug("BLE not connected, notification not sent\r\n");
-        return;
-    }
+    return ble_notify_subscribers(BLE_RACK_STATUS_VAL_HDL, p_data, len);
+}
 
-    st_ble_gatt_hdl_value_pair_t hdl_value_pair;
-    hdl_value_pair.attr_hdl        = 0;  /* Update with actual characteristic handle */
-    hdl_value_pair.value.p_value   = p_data;
-    hdl_value_pair.value.value_len = len;
+/**
+ * @brief Whether a central enabled rack status notifications since the last call
+ * @return true once per new subscription
+ */
+bool ble_take_status_subscriber(void)
+{
+    bool subscribed = gs_status_subscribed;
 
-    ble_status_t status = R_BLE_GATTS_Notification(g_conn_hdl, &hdl_value_pair);
-    if (BLE_SUCCESS != status)
+    gs_status_subscribed = false;
+    return subscribed;
+}
+
+/**
+ * @brief Take an autotune command written by a central
+ * @param[out] p_cmd AUTOTUNE_CMD_* (valid when true is returned)
+ * @return true once per write
+ */
+bool ble_take_autotune_command(uint8_t *p_cmd)
+{
+    if (!gs_autotune_pending)
     {
-        log_debug("BLE Notification failed: 0x%04x\r\n", status);
+        return false;
     }
+
+    *p_cmd = gs_autotune_cmd;
+    gs_autotune_pending = false;
+    return true;
 }
 
 /**
  * @brief Get BLE Connection Status
+ * @return true if at least one central is connected
  */
 bool ble_is_connected(void)
 {
-    return g_ble_connected;
+    return (gs_conn_count > 0U);
+}
+
+/**
+ * @brief Number of connected centrals
+ */
+uint8_t ble_get_connection_count(void)
+{
+    return gs_conn_count;
+}
+
+/**
+ * @brief Connection table entry (for diagnostics / TX accounting)
+ * @param[in] index Slot 0..BLE_MAX_CONNECTIONS-1
+ * @return Slot (conn_hdl is BLE_GAP_INVALID_CONN_HDL when free), or NULL if index is out of range
+ */
+ble_conn_t const *ble_get_connection(uint8_t index)
+{
+    return (index < BLE_MAX_CONNECTIONS) ? &gs_conn_table[index] : NULL;
 }
@@ -8,17 +8,77 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "r_ble_api.h"
 
 /* ========================================
    Bluetooth Remote Monitoring Interface
    ======================================== */
 
+/* GATT Attribute Handles (must match gatt_db.c generated by the QE for BLE tool) */
+#define BLE_RACK_STATUS_VAL_HDL         (0x0012U)   /* Rack status - notify */
+#define BLE_RACK_STATUS_CCCD_HDL        (0x0013U)   /* Rack status - client characteristic configuration */
+#define BLE_THERMAL_CONFIG_VAL_HDL      (0x0015U)   /* Thermal configuration - read/write */
+#define BLE_ROW_SUMMARY_VAL_HDL         (0x0018U)   /* Row summary (aggregator role) - read/notify */
+#define BLE_ROW_SUMMARY_CCCD_HDL        (0x0019U)
+#define BLE_OTA_CONTROL_VAL_HDL         (0x001BU)   /* Firmware update control point - write/notify */
+#define BLE_OTA_CONTROL_CCCD_HDL        (0x001CU)
+#define BLE_OTA_DATA_VAL_HDL            (0x001EU)   /* Firmware update data - write without response */
+#define BLE_THERMAL_STATS_VAL_HDL       (0x0021U)   /* Rolling statistics 1 min / 1 h / 24 h - read */
+#define BLE_AUTOTUNE_VAL_HDL            (0x0024U)   /* Autotune command (write) / state and result (read) */
+
+/* Row Aggregator Role - this node also scans for neighbouring racks' status advertisements */
+#define BLE_AGGREGATOR_ENABLE           (0)
+#define BLE_RACK_ID                     (0U)        /* Position in the row, 0..AGGREGATOR_MAX_RACKS-1 */
+#define BLE_ROW_SUMMARY_PUBLISH_MS      (1000U)
+
+/* Concurrent centrals (must not exceed the stack's BLE_CFG_RF_CONN_MAX) */
+#define BLE_MAX_CONNECTIONS             (4U)
+#define BLE_DEFAULT_MTU                 (23U)
+#define BLE_MAX_TX_OCTETS               (251U)      /* LE data length extension - one 247-byte ATT PDU per LL packet */
+#define BLE_MAX_TX_TIME_US              (2120U)
+#define BLE_ATT_NTF_OVERHEAD            (3U)        /* Opcode + attribute handle */
+
+/* CCCD subscription bits */
+#define BLE_CCCD_NOTIFY                 (0x0001U)
+#define BLE_CCCD_INDICATE               (0x0002U)
+
+/* Event pump statistics */
+typedef struct {
+    uint32_t calls;             /* ble_app_run() invocations */
+    uint32_t executes;          /* R_BLE_Execute() passes */
+    uint32_t deferrals;         /* Calls that returned with stack work still pending */
+    uint32_t skipped;           /* Calls with no budget left at all */
+    uint32_t busy_cycles_last;  /* Cycles spent in the last call */
+    uint32_t busy_cycles_max;   /* Worst-case cycles in one call (one pass can exceed the budget) */
+} ble_pump_stats_t;
+
+/* Per-connection state */
+typedef struct {
+    uint16_t conn_hdl;          /* BLE_GAP_INVALID_CONN_HDL when the slot is free */
+    uint16_t mtu;               /* Negotiated ATT MTU */
+    uint16_t cccd_rack_status;  /* BLE_CCCD_* for the rack status characteristic */
+    uint16_t cccd_row_summary;  /* BLE_CCCD_* for the row summary characteristic */
+    uint16_t cccd_ota_control;  /* BLE_CCCD_* for the firmware update control point */
+    uint32_t tx_notifications;  /* Notifications accepted by the stack */
+    uint32_t tx_bytes;          /* Payload bytes accepted by the stack */
+    uint32_t tx_failures;       /* Rejected (queue full, payload > MTU) */
+} ble_conn_t;
+
 /* BLE Function Declarations */
 void ble_app_init(void);
-void ble_app_run(void);
+bool ble_app_run(uint32_t budget_cycles);
+void ble_get_pump_stats(ble_pump_stats_t *p_stats);
 void ble_app_close(void);
-void ble_send_notification(uint8_t *p_data, uint16_t len);
+uint8_t ble_send_notification(uint8_t *p_data, uint16_t len);
 bool ble_is_connected(void);
+bool ble_take_status_subscriber(void);
+bool ble_take_autotune_command(uint8_t *p_cmd);
+uint8_t ble_get_connection_count(void);
+ble_conn_t const *ble_get_connection(uint8_t index);
+void ble_publish_thermal_config(void);
+void ble_publish_thermal_stats(uint8_t status);
+void ble_publish_autotune(uint8_t const *p_data, uint16_t len);
+void ble_update_adv_status(int16_t temperature, uint8_t cooling_level, uint8_t duty, uint8_t alert);
 
 /* BLE Callback Functions */
 void gap_cb(uint16_t type, ble_status_t result, st_ble_evt_data_t *p_data);
@@ -26,9 +86,6 @@ void gatts_cb(uint16_t type, ble_status_t result, st_ble_gatts_evt_data_t *p_dat
 void gattc_cb(uint16_t type, ble_status_t result, st_ble_gattc_evt_data_t *p_data);
 void vs_cb(uint16_t type, ble_status_t result, st_ble_vs_evt_data_t *p_data);
 
-/* Global BLE Variables */
-extern uint16_t g_conn_hdl;
-
 /* Rack Status Notification Structure */
 typedef struct {
     int16_t temperature;        /* Temperature in °C × 100 */
@@ -36,6 +93,9 @@ typedef struct {
     uint8_t pwm_duty_cycle;     /* PWM 0-100% */
     uint8_t system_alert;       /* Alert flag */
     uint16_t sample_count;      /* Samples taken */
+    uint32_t fan_energy_j;      /* Cumulative fan energy (J) */
+    uint16_t report_seq;        /* Frames sent - sent by exception, so gaps here (not in sample_count) are losses */
+    uint32_t sample_time_ms;    /* Timebase time the temperature was measured (ms since boot, wrapping) */
 } ble_rack_status_t;
 
 #endif /* BLE_APP_H_ */
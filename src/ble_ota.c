@@ -0,0 +1,576 @@
+/***********************************************************************************************************************
+ * File Name    : ble_ota.c
+ * Description  : Firmware Update over BLE - streams an image into the inactive code flash bank,
+ *                verifies it incrementally, swaps banks on reboot and rolls back an image that never confirms
+ *
+ * Flash work never runs in the GATT callbacks - a code flash erase or program stalls the CPU, and the callbacks
+ * run from the main loop's BLE pump between control iterations. START and data packets only validate and queue;
+ * ble_ota_service(), called once per pump, does at most one block erase or one OTA_WRITE_UNIT program per call,
+ * so the longest stall the control loop and fail-safe see is one block erase instead of the whole bank.
+ *
+ * START erases the blocks the image covers, one per service call. Data packets are sequence-checked, folded
+ * into a running CRC-32 and queued; full write units are programmed from the queue. FINISH checks the running
+ * CRC, then the service programs the tail, re-reads the bank in slices to check what actually landed in flash,
+ * records a trial boot in data flash and arms the bank swap.
+ *
+ * The new image must call ble_ota_confirm(). Rollback happens in ble_ota_boot_check(), so it needs a reset:
+ * the independent watchdog (auto-started from OFS0, refreshed once per main loop iteration) resets an image that
+ * hangs, and after OTA_MAX_TRIAL_BOOTS unconfirmed boots the previous image is swapped back. An image that runs
+ * but never confirms stays on trial until the next reset of any kind.
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stddef.h>
+#include "common_utils.h"
+#include "ble_ota.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/* Flash Instance */
+extern flash_ctrl_t g_flash0_ctrl;
+extern const flash_cfg_t g_flash0_cfg;
+
+/* Boot record (data flash) */
+typedef struct {
+    uint32_t magic;
+    uint32_t state;             /* OTA_BOOT_* */
+    uint32_t boot_attempts;
+    uint32_t image_size;
+    uint32_t image_crc;
+    uint32_t crc;               /* CRC-32 over everything above */
+} ota_boot_record_t;
+
+/* Static variables */
+static ota_status_t gs_status;
+static uint32_t gs_expected_crc;
+static uint32_t gs_running_crc;
+static uint16_t gs_next_seq;
+static uint32_t gs_erase_addr;          /* Next block to erase */
+static uint32_t gs_write_addr;          /* Next write unit to program */
+static uint8_t gs_queue[OTA_WRITE_QUEUE_UNITS * OTA_WRITE_UNIT] __attribute__((aligned(4)));
+static uint32_t gs_queue_head;          /* Offset of the next unit to program (unit aligned) */
+static uint32_t gs_queue_fill;          /* Bytes queued */
+static uint32_t gs_verify_offset;       /* Bytes re-read so far */
+static uint32_t gs_verify_crc;
+static uint32_t gs_last_status_bytes;
+static bool gs_status_pending;
+static bool gs_flash_open;
+static uint64_t gs_elapsed_cycles;
+static uint32_t gs_last_cycles;
+static uint32_t gs_reboot_cycles;
+
+/**
+ * @brief CRC-32 (IEEE, reflected) - incremental, pass ~0 to start and complement the result
+ */
+static uint32_t ota_crc32_update(uint32_t crc, uint8_t const *p_data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= p_data[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Advance the transfer clock (cycle counter extended to 64 bits - transfers outlast its wrap)
+ */
+static void ota_clock_update(void)
+{
+    uint32_t now = DWT->CYCCNT;
+
+    gs_elapsed_cycles += (uint32_t)(now - gs_last_cycles);
+    gs_last_cycles = now;
+    gs_status.elapsed_ms = (uint32_t)(gs_elapsed_cycles / (SystemCoreClock / 1000U));
+    if (gs_status.elapsed_ms > 0U)
+    {
+        gs_status.throughput_bps = (uint32_t)(((uint64_t)gs_status.bytes_received * 1000U) / gs_status.elapsed_ms);
+    }
+}
+
+/**
+ * @brief Enter the error state and queue a status notification
+ */
+static fsp_err_t ota_fail(ota_error_t error)
+{
+    gs_status.state = OTA_STATE_ERROR;
+    gs_status.error = error;
+    gs_status_pending = true;
+    log_error("OTA: failed, error %d at %u bytes\r\n", error, gs_status.bytes_received);
+    return FSP_ERR_ABORTED;
+}
+
+/**
+ * @brief CRC of a boot record (its crc field excluded)
+ */
+static uint32_t ota_record_crc(ota_boot_record_t const *p_record)
+{
+    return ~ota_crc32_update(0xFFFFFFFFUL, (uint8_t const *)p_record, offsetof(ota_boot_record_t, crc));
+}
+
+/**
+ * @brief Read the boot record, or a confirmed default if none is stored
+ * @note  A record that fails its CRC (write cut short by a reset) reads as no pending update. The trial record
+ *        is written before the bank swap is armed, so a torn one leaves the old image running, as it should.
+ */
+static void ota_record_read(ota_boot_record_t *p_record)
+{
+    ota_boot_record_t const *p_stored = (ota_boot_record_t const *)OTA_RECORD_FLASH_ADDR;
+
+    if ((OTA_RECORD_MAGIC == p_stored->magic) && (ota_record_crc(p_stored) == p_stored->crc))
+    {
+        *p_record = *p_stored;
+    }
+    else
+    {
+        memset(p_record, 0, sizeof(*p_record));
+        p_record->magic = OTA_RECORD_MAGIC;
+        p_record->state = OTA_BOOT_CONFIRMED;
+    }
+}
+
+/**
+ * @brief Seal and write the boot record (one data flash block)
+ */
+static fsp_err_t ota_record_write(ota_boot_record_t *p_record)
+{
+    fsp_err_t err;
+
+    if (!gs_flash_open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+
+    p_record->crc = ota_record_crc(p_record);
+    err = R_FLASH_HP_Erase(&g_flash0_ctrl, OTA_RECORD_FLASH_ADDR, 1);
+    if (FSP_SUCCESS == err)
+    {
+        err = R_FLASH_HP_Write(&g_flash0_ctrl, (uint32_t)p_record, OTA_RECORD_FLASH_ADDR, sizeof(*p_record));
+    }
+    return err;
+}
+
+/**
+ * @brief Erase the next block the image covers (8 KB blocks, then 32 KB blocks) - RECEIVING after the last one
+ */
+static void ota_erase_step(void)
+{
+    uint32_t block_size = ((gs_erase_addr - OTA_BANK_INACTIVE_ADDR) < (OTA_SMALL_BLOCK_COUNT * OTA_SMALL_BLOCK_SIZE)) ?
+                          OTA_SMALL_BLOCK_SIZE : OTA_LARGE_BLOCK_SIZE;
+
+    if (FSP_SUCCESS != R_FLASH_HP_Erase(&g_flash0_ctrl, gs_erase_addr, 1))
+    {
+        ota_fail(OTA_ERROR_FLASH);
+        return;
+    }
+
+    gs_erase_addr += block_size;
+    if ((gs_erase_addr - OTA_BANK_INACTIVE_ADDR) >= gs_status.image_size)
+    {
+        /* The transfer clock starts when the central may send */
+        gs_elapsed_cycles = 0;
+        gs_last_cycles = DWT->CYCCNT;
+        gs_status.state = OTA_STATE_RECEIVING;
+        gs_status_pending = true;
+        log_info("OTA: erased, receiving %u bytes\r\n", gs_status.image_size);
+    }
+}
+
+/**
+ * @brief Program the unit at the head of the queue - once it is full, or padded with erased-state bytes
+ *        when the transfer is complete
+ */
+static void ota_program_step(void)
+{
+    uint32_t take = (gs_queue_fill < OTA_WRITE_UNIT) ? gs_queue_fill : OTA_WRITE_UNIT;
+
+    if ((0U == take) || ((take < OTA_WRITE_UNIT) && (OTA_STATE_VERIFYING != gs_status.state)))
+    {
+        return;
+    }
+
+    memset(&gs_queue[gs_queue_head + take], 0xFF, OTA_WRITE_UNIT - take);
+    if (FSP_SUCCESS != R_FLASH_HP_Write(&g_flash0_ctrl, (uint32_t)&gs_queue[gs_queue_head], gs_write_addr,
+                                        OTA_WRITE_UNIT))
+    {
+        ota_fail(OTA_ERROR_FLASH);
+        return;
+    }
+
+    gs_write_addr += OTA_WRITE_UNIT;
+    gs_queue_head = (gs_queue_head + OTA_WRITE_UNIT) % sizeof(gs_queue);
+    gs_queue_fill -= take;
+}
+
+/**
+ * @brief Queue image bytes behind what is waiting to be programmed (caller checked the room)
+ */
+static void ota_queue_put(uint8_t const *p_data, uint32_t len)
+{
+    uint32_t tail = (gs_queue_head + gs_queue_fill) % sizeof(gs_queue);
+    uint32_t first = sizeof(gs_queue) - tail;
+
+    first = (first < len) ? first : len;
+    memcpy(&gs_queue[tail], p_data, first);
+    memcpy(gs_queue, p_data + first, len - first);
+    gs_queue_fill += len;
+}
+
+/**
+ * @brief Re-read the next slice of the programmed image; after the last, commit: trial record, bank swap, READY
+ */
+static void ota_verify_step(void)
+{
+    uint32_t slice = gs_status.image_size - gs_verify_offset;
+
+    if (slice > 0U)
+    {
+        slice = (slice < OTA_VERIFY_SLICE) ? slice : OTA_VERIFY_SLICE;
+        gs_verify_crc = ota_crc32_update(gs_verify_crc, (uint8_t const *)(OTA_BANK_INACTIVE_ADDR + gs_verify_offset),
+                                         slice);
+        gs_verify_offset += slice;
+        return;
+    }
+
+    /* Running CRC covered what was received; the re-read covers what was programmed */
+    if (~gs_verify_crc != gs_expected_crc)
+    {
+        ota_fail(OTA_ERROR_CRC);
+        return;
+    }
+
+    ota_boot_record_t record = {
+        .magic         = OTA_RECORD_MAGIC,
+        .state         = OTA_BOOT_TRIAL,
+        .boot_attempts = 0,
+        .image_size    = gs_status.image_size,
+        .image_crc     = gs_expected_crc,
+        .crc           = 0
+    };
+    if ((FSP_SUCCESS != ota_record_write(&record)) || (FSP_SUCCESS != R_FLASH_HP_BankSwap(&g_flash0_ctrl)))
+    {
+        ota_fail(OTA_ERROR_FLASH);
+        return;
+    }
+
+    gs_status.state = OTA_STATE_READY;
+    gs_status_pending = true;
+    gs_reboot_cycles = DWT->CYCCNT;
+    log_info("OTA: %u bytes in %u ms (%.1f KB/s), rebooting into new bank\r\n",
+             gs_status.bytes_received, gs_status.elapsed_ms, ble_ota_throughput_kbps());
+}
+
+/**
+ * @brief Open flash for OTA use (shares the instance with the thermal configuration)
+ */
+void ble_ota_init(void)
+{
+    fsp_err_t err = R_FLASH_HP_Open(&g_flash0_ctrl, &g_flash0_cfg);
+
+    gs_flash_open = (FSP_SUCCESS == err) || (FSP_ERR_ALREADY_OPEN == err);
+    memset(&gs_status, 0, sizeof(gs_status));
+    gs_status_pending = false;
+    gs_reboot_cycles = 0;
+}
+
+/**
+ * @brief Early boot: count an unconfirmed boot of a new image and roll back when it keeps failing
+ * @note  Call once per boot, after ble_ota_init() and before starting the control loop
+ */
+void ble_ota_boot_check(void)
+{
+    ota_boot_record_t record;
+
+    ota_record_read(&record);
+    if (OTA_BOOT_TRIAL != record.state)
+    {
+        return;
+    }
+
+    record.boot_attempts++;
+    if (record.boot_attempts > OTA_MAX_TRIAL_BOOTS)
+    {
+        log_error("OTA: image never confirmed after %u boots - rolling back\r\n", OTA_MAX_TRIAL_BOOTS);
+        record.state = OTA_BOOT_ROLLED_BACK;
+        if ((FSP_SUCCESS == ota_record_write(&record)) && (FSP_SUCCESS == R_FLASH_HP_BankSwap(&g_flash0_ctrl)))
+        {
+            NVIC_SystemReset();
+        }
+        return;
+    }
+
+    log_info("OTA: trial boot %u of %u\r\n", record.boot_attempts, OTA_MAX_TRIAL_BOOTS);
+    ota_record_write(&record);
+}
+
+/**
+ * @brief Mark the running image good - ends the trial, no-op otherwise
+ */
+void ble_ota_confirm(void)
+{
+    ota_boot_record_t record;
+
+    ota_record_read(&record);
+    if (OTA_BOOT_TRIAL != record.state)
+    {
+        return;
+    }
+
+    record.state = OTA_BOOT_CONFIRMED;
+    record.boot_attempts = 0;
+    if (FSP_SUCCESS == ota_record_write(&record))
+    {
+        log_info("OTA: image confirmed\r\n");
+    }
+}
+
+/**
+ * @brief Handle a control point write
+ * @param[in] p_data Command
+ * @param[in] len    Command length
+ * @return FSP_SUCCESS if accepted
+ */
+fsp_err_t ble_ota_control(uint8_t const *p_data, uint16_t len)
+{
+    if (0U == len)
+    {
+        return FSP_ERR_INVALID_SIZE;
+    }
+
+    switch (p_data[0])
+    {
+        case OTA_CMD_START:
+        {
+            if ((OTA_CMD_START_LEN != len) || (OTA_STATE_READY == gs_status.state))
+            {
+                return ota_fail(OTA_ERROR_STATE);
+            }
+
+            memset(&gs_status, 0, sizeof(gs_status));
+            gs_status.image_size = (uint32_t)p_data[1] | ((uint32_t)p_data[2] << 8) |
+                                   ((uint32_t)p_data[3] << 16) | ((uint32_t)p_data[4] << 24);
+            gs_expected_crc = (uint32_t)p_data[5] | ((uint32_t)p_data[6] << 8) |
+                              ((uint32_t)p_data[7] << 16) | ((uint32_t)p_data[8] << 24);
+            if ((0U == gs_status.image_size) || (gs_status.image_size > OTA_BANK_SIZE))
+            {
+                return ota_fail(OTA_ERROR_SIZE);
+            }
+            if (!gs_flash_open)
+            {
+                return ota_fail(OTA_ERROR_FLASH);
+            }
+
+            /* Erased from ble_ota_service(), a block per call */
+            gs_running_crc = 0xFFFFFFFFUL;
+            gs_next_seq = 0;
+            gs_erase_addr = OTA_BANK_INACTIVE_ADDR;
+            gs_write_addr = OTA_BANK_INACTIVE_ADDR;
+            gs_queue_head = 0;
+            gs_queue_fill = 0;
+            gs_last_status_bytes = 0;
+            gs_status.state = OTA_STATE_ERASING;
+            gs_status_pending = true;
+        }
+        break;
+
+        case OTA_CMD_FINISH:
+        {
+            if ((OTA_STATE_RECEIVING != gs_status.state) || (gs_status.bytes_received != gs_status.image_size))
+            {
+                return ota_fail(OTA_ERROR_STATE);
+            }
+            ota_clock_update();
+            if (~gs_running_crc != gs_expected_crc)
+            {
+                return ota_fail(OTA_ERROR_CRC);
+            }
+
+            /* Tail programmed, bank re-read and swap armed from ble_ota_service() */
+            gs_verify_offset = 0;
+            gs_verify_crc = 0xFFFFFFFFUL;
+            gs_status.state = OTA_STATE_VERIFYING;
+            gs_status_pending = true;
+        }
+        break;
+
+        case OTA_CMD_ABORT:
+        {
+            ble_ota_abort();
+        }
+        break;
+
+        default:
+            return FSP_ERR_UNSUPPORTED;
+    }
+
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Handle an image data packet
+ * @param[in] p_data Sequence number + image bytes
+ * @param[in] len    Packet length
+ * @return FSP_SUCCESS if consumed
+ */
+fsp_err_t ble_ota_data(uint8_t const *p_data, uint16_t len)
+{
+    uint16_t seq;
+
+    if ((OTA_STATE_RECEIVING != gs_status.state) || (len <= OTA_DATA_HEADER_LEN))
+    {
+        return FSP_ERR_INVALID_STATE;
+    }
+
+    seq = (uint16_t)(p_data[0] | (p_data[1] << 8));
+    if (seq != gs_next_seq)
+    {
+        /* Write without response can drop packets - report where to resume, keep what we have */
+        gs_status.error = OTA_ERROR_SEQUENCE;
+        gs_status_pending = true;
+        return FSP_ERR_INVALID_DATA;
+    }
+
+    p_data += OTA_DATA_HEADER_LEN;
+    len = (uint16_t)(len - OTA_DATA_HEADER_LEN);
+    if ((gs_status.bytes_received + len) > gs_status.image_size)
+    {
+        return ota_fail(OTA_ERROR_OVERRUN);
+    }
+
+    if (len > (sizeof(gs_queue) - gs_queue_fill))
+    {
+        /* Programming has not caught up - drop it like a lost packet, the central resumes from gs_next_seq */
+        gs_status.error = OTA_ERROR_BUSY;
+        gs_status_pending = true;
+        return FSP_ERR_IN_USE;
+    }
+
+    gs_running_crc = ota_crc32_update(gs_running_crc, p_data, len);
+    ota_queue_put(p_data, len);
+    gs_status.bytes_received += len;
+    gs_status.error = OTA_ERROR_NONE;
+    gs_next_seq++;
+
+    /* Progress, and completion - a lost last packet is otherwise invisible to the central */
+    ota_clock_update();
+    if (((gs_status.bytes_received - gs_last_status_bytes) >= OTA_STATUS_EVERY_BYTES) ||
+        (gs_status.bytes_received == gs_status.image_size))
+    {
+        gs_last_status_bytes = gs_status.bytes_received;
+        gs_status_pending = true;
+    }
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Abandon a transfer (peer request or the updating central disconnected)
+ * @note  After FINISH the image is complete - verification runs to the end even if the central has left
+ */
+void ble_ota_abort(void)
+{
+    if ((OTA_STATE_ERASING == gs_status.state) || (OTA_STATE_RECEIVING == gs_status.state))
+    {
+        gs_status.state = OTA_STATE_IDLE;
+        gs_status.error = OTA_ERROR_ABORTED;
+        gs_status_pending = true;
+        log_info("OTA: aborted at %u bytes\r\n", gs_status.bytes_received);
+    }
+}
+
+/**
+ * @brief Transfer in progress or reboot pending
+ */
+bool ble_ota_busy(void)
+{
+    return (OTA_STATE_IDLE != gs_status.state) && (OTA_STATE_ERROR != gs_status.state);
+}
+
+/**
+ * @brief Deferred work, one flash operation at most per call: erase a block, program a unit, re-read a slice or
+ *        commit the image - then, once the final status has had time to go out, reboot into the new bank
+ * @note  Call once per main loop iteration (from the BLE pump)
+ */
+void ble_ota_service(void)
+{
+    switch (gs_status.state)
+    {
+        case OTA_STATE_ERASING:
+            ota_erase_step();
+            break;
+
+        case OTA_STATE_RECEIVING:
+            ota_program_step();
+            break;
+
+        case OTA_STATE_VERIFYING:
+            if (gs_queue_fill > 0U)
+            {
+                ota_program_step();
+            }
+            else
+            {
+                ota_verify_step();
+            }
+            break;
+
+        case OTA_STATE_READY:
+            if (!gs_status_pending &&
+                ((DWT->CYCCNT - gs_reboot_cycles) >= (OTA_REBOOT_DELAY_MS * (SystemCoreClock / 1000U))))
+            {
+                NVIC_SystemReset();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Fetch a queued status notification
+ * @param[out] p_buf At least OTA_STATUS_WIRE_SIZE bytes
+ * @return Bytes written, 0 if no status is pending
+ */
+uint16_t ble_ota_take_status(uint8_t *p_buf)
+{
+    if (!gs_status_pending)
+    {
+        return 0;
+    }
+    gs_status_pending = false;
+
+    p_buf[0] = (uint8_t)gs_status.state;
+    p_buf[1] = (uint8_t)gs_status.error;
+    p_buf[2] = (uint8_t)(gs_next_seq & 0xFF);
+    p_buf[3] = (uint8_t)(gs_next_seq >> 8);
+    p_buf[4] = (uint8_t)(gs_status.bytes_received & 0xFF);
+    p_buf[5] = (uint8_t)((gs_status.bytes_received >> 8) & 0xFF);
+    p_buf[6] = (uint8_t)((gs_status.bytes_received >> 16) & 0xFF);
+    p_buf[7] = (uint8_t)((gs_status.bytes_received >> 24) & 0xFF);
+    p_buf[8] = (uint8_t)(gs_status.throughput_bps & 0xFF);
+    p_buf[9] = (uint8_t)((gs_status.throughput_bps >> 8) & 0xFF);
+    p_buf[10] = (uint8_t)((gs_status.throughput_bps >> 16) & 0xFF);
+    p_buf[11] = (uint8_t)((gs_status.throughput_bps >> 24) & 0xFF);
+
+    return OTA_STATUS_WIRE_SIZE;
+}
+
+/**
+ * @brief Snapshot transfer status
+ */
+void ble_ota_get_status(ota_status_t *p_status)
+{
+    *p_status = gs_status;
+}
+
+/**
+ * @brief Transfer throughput
+ * @return KB/s (1 KB = 1024 bytes)
+ */
+float ble_ota_throughput_kbps(void)
+{
+    return (float)gs_status.throughput_bps / 1024.0f;
+}
@@ -0,0 +1,102 @@
+/***********************************************************************************************************************
+ * File Name    : ble_ota.h
+ * Description  : Firmware Update over BLE - streams an image into the inactive code flash bank,
+ *                verifies it incrementally, swaps banks on reboot and rolls back an image that never confirms
+ **********************************************************************************************************************/
+
+#ifndef BLE_OTA_H_
+#define BLE_OTA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+/* Code Flash Layout - dual bank mode, the inactive bank is always mapped at the same address */
+#define OTA_BANK_INACTIVE_ADDR          (0x00200000UL)
+#define OTA_BANK_SIZE                   (128UL * 1024UL)
+#define OTA_SMALL_BLOCK_SIZE            (8UL * 1024UL)      /* First 64 KB of a bank */
+#define OTA_SMALL_BLOCK_COUNT           (8U)
+#define OTA_LARGE_BLOCK_SIZE            (32UL * 1024UL)
+#define OTA_WRITE_UNIT                  (128U)              /* Code flash program unit */
+#define OTA_WRITE_QUEUE_UNITS           (8U)                /* Received, not yet programmed - four full-MTU packets */
+#define OTA_VERIFY_SLICE                (2048U)             /* Bytes re-read per service call when verifying */
+
+/* Boot Record - data flash block after the thermal configuration */
+#define OTA_RECORD_FLASH_ADDR           (0x08000040UL)
+#define OTA_RECORD_MAGIC                (0x4F544142UL)      /* "OTAB" */
+#define OTA_MAX_TRIAL_BOOTS             (3U)                /* Unconfirmed boots before rolling back */
+#define OTA_CONFIRM_SAMPLES             (10U)               /* Good control samples that confirm a new image */
+
+/* Control Point Commands (write with response)
+ *   START  [0]=0x01 [1..4] image size (LE) [5..8] image CRC-32 (LE)
+ *          status goes ERASING, then RECEIVING once the blocks the image covers are erased - send data after that
+ *   FINISH [0]=0x02
+ *          status goes VERIFYING, then READY (reboots into the new bank) or ERROR
+ *   ABORT  [0]=0x03 */
+#define OTA_CMD_START                   (0x01U)
+#define OTA_CMD_FINISH                  (0x02U)
+#define OTA_CMD_ABORT                   (0x03U)
+#define OTA_CMD_START_LEN               (9U)
+
+/* Data Packets (write without response): [0..1] sequence number (LE), [2..] image bytes */
+#define OTA_DATA_HEADER_LEN             (2U)
+
+/* Status (notified on the control point, 12 bytes)
+ *   [0] state  [1] last error (OTA_ERROR_*)  [2..3] next expected sequence (LE)
+ *   [4..7] bytes received (LE)  [8..11] throughput, bytes/s (LE) */
+#define OTA_STATUS_WIRE_SIZE            (12U)
+#define OTA_STATUS_EVERY_BYTES          (4096U)             /* Progress notification interval (and on the last byte) */
+#define OTA_REBOOT_DELAY_MS             (500U)              /* Lets the final status notification go out */
+
+/* Transfer States */
+typedef enum {
+    OTA_STATE_IDLE = 0,
+    OTA_STATE_RECEIVING,
+    OTA_STATE_READY,            /* Verified, bank swap armed - reboots shortly */
+    OTA_STATE_ERROR,
+    OTA_STATE_ERASING,          /* START accepted, erasing one block per service call */
+    OTA_STATE_VERIFYING         /* FINISH accepted, programming the tail and re-reading the bank */
+} ota_state_t;
+
+/* Errors */
+typedef enum {
+    OTA_ERROR_NONE = 0,
+    OTA_ERROR_SIZE,             /* Image larger than a bank */
+    OTA_ERROR_SEQUENCE,         /* Packet lost - restart from the expected sequence */
+    OTA_ERROR_OVERRUN,          /* More bytes than announced */
+    OTA_ERROR_FLASH,
+    OTA_ERROR_CRC,
+    OTA_ERROR_STATE,            /* Command not valid in this state */
+    OTA_ERROR_ABORTED,
+    OTA_ERROR_BUSY              /* Write queue full - packet dropped, resume from the expected sequence */
+} ota_error_t;
+
+/* Boot record states */
+#define OTA_BOOT_CONFIRMED              (0U)
+#define OTA_BOOT_TRIAL                  (1U)
+#define OTA_BOOT_ROLLED_BACK            (2U)
+
+/* Transfer Statistics */
+typedef struct {
+    ota_state_t state;
+    ota_error_t error;
+    uint32_t image_size;
+    uint32_t bytes_received;
+    uint32_t elapsed_ms;
+    uint32_t throughput_bps;    /* Bytes per second over the transfer */
+} ota_status_t;
+
+/* Function Declarations */
+void ble_ota_init(void);
+void ble_ota_boot_check(void);
+void ble_ota_confirm(void);
+fsp_err_t ble_ota_control(uint8_t const *p_data, uint16_t len);
+fsp_err_t ble_ota_data(uint8_t const *p_data, uint16_t len);
+void ble_ota_abort(void);
+bool ble_ota_busy(void);
+void ble_ota_service(void);
+uint16_t ble_ota_take_status(uint8_t *p_buf);
+void ble_ota_get_status(ota_status_t *p_status);
+float ble_ota_throughput_kbps(void);
+
+#endif /* BLE_OTA_H_ */
@@ -0,0 +1,140 @@
+/***********************************************************************************************************************
+ * File Name    : boot_state.c
+ * Description  : Fast-Boot Support - cooling state retained in RAM across warm resets, boot stage timing
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include "boot_state.h"
+#include "timebase.h"
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/* Static variables */
+static boot_retained_t g_retained BSP_PLACE_IN_SECTION(".noinit");
+static boot_timing_t g_timing;
+static uint32_t g_boot_start;
+static uint32_t g_cycles_per_us;
+
+/* Boot clock - the DWT cycle counter, started here ahead of the timebase GPT; host builds use the virtual
+ * timebase (in µs) so a harness sets every stage time */
+#if TIMEBASE_VIRTUAL
+#define BOOT_CLOCK_NOW()                ((uint32_t)timebase_now_us())
+#define BOOT_CLOCK_PER_US               (1U)
+#else
+#define BOOT_CLOCK_NOW()                (DWT->CYCCNT)
+#define BOOT_CLOCK_PER_US               (SystemCoreClock / 1000000U)
+#endif
+
+/**
+ * @brief Check word over the record's payload
+ */
+static uint32_t boot_retained_check(boot_retained_t const *p_rec)
+{
+    uint32_t state = (uint32_t)p_rec->cooling_level | ((uint32_t)p_rec->pwm_duty_cycle << 8) |
+                     ((uint32_t)p_rec->system_alert << 16);
+
+    return ~(p_rec->magic ^ state ^ p_rec->boot_count);
+}
+
+/**
+ * @brief Start the boot clock - first thing after reset, before any peripheral is touched
+ * @note  Enables the DWT cycle counter early so every stage, fan PWM included, can be timed
+ */
+void boot_state_begin(void)
+{
+#if !TIMEBASE_VIRTUAL
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    memset(&g_timing, 0, sizeof(g_timing));
+    g_cycles_per_us = BOOT_CLOCK_PER_US;
+    g_boot_start = BOOT_CLOCK_NOW();
+}
+
+/**
+ * @brief Fetch the cooling state the previous run left behind
+ * @param[out] p_state Retained record (valid only when true is returned)
+ * @return true after a warm reset with an intact record
+ */
+bool boot_state_restore(boot_retained_t *p_state)
+{
+    bool valid = (BOOT_RETAINED_MAGIC == g_retained.magic) && (boot_retained_check(&g_retained) == g_retained.check) &&
+                 (g_retained.cooling_level <= 4U) && (g_retained.pwm_duty_cycle <= 100U);
+
+    if (valid)
+    {
+        *p_state = g_retained;
+        g_retained.boot_count++;
+    }
+    else
+    {
+        /* Cold boot - start a fresh record at fans-off */
+        g_retained.magic = BOOT_RETAINED_MAGIC;
+        g_retained.cooling_level = 0;
+        g_retained.pwm_duty_cycle = 0;
+        g_retained.system_alert = 0;
+        g_retained.reserved = 0;
+        g_retained.boot_count = 0;
+    }
+    g_retained.check = boot_retained_check(&g_retained);
+
+    g_timing.restored = valid;
+    g_timing.boot_count = g_retained.boot_count;
+    return valid;
+}
+
+/**
+ * @brief Record the cooling state for the next warm boot
+ * @note  A handful of RAM stores - cheap enough for every loop iteration
+ */
+void boot_state_save(uint8_t cooling_level, uint8_t pwm_duty_cycle, uint8_t system_alert)
+{
+    g_retained.cooling_level = cooling_level;
+    g_retained.pwm_duty_cycle = pwm_duty_cycle;
+    g_retained.system_alert = system_alert;
+    g_retained.check = boot_retained_check(&g_retained);
+}
+
+/**
+ * @brief Timestamp a boot stage (first call per stage wins)
+ * @param[in] stage Stage reached
+ */
+void boot_state_mark(boot_stage_t stage)
+{
+    if ((stage >= BOOT_STAGE_COUNT) || (g_timing.reached & (1U << stage)))
+    {
+        return;
+    }
+
+    g_timing.stage_us[stage] = (BOOT_CLOCK_NOW() - g_boot_start) / g_cycles_per_us;
+    g_timing.reached |= (uint8_t)(1U << stage);
+}
+
+/**
+ * @brief Whether a boot stage has been reached
+ */
+bool boot_state_reached(boot_stage_t stage)
+{
+    return (stage < BOOT_STAGE_COUNT) && (0U != (g_timing.reached & (1U << stage)));
+}
+
+/**
+ * @brief Time since boot_state_begin()
+ * @note  Meaningful for the first DWT wrap period (~20s at 200MHz) - boot deadlines only
+ * @return Elapsed time (ms)
+ */
+uint32_t boot_state_elapsed_ms(void)
+{
+    return (BOOT_CLOCK_NOW() - g_boot_start) / (g_cycles_per_us * 1000U);
+}
+
+/**
+ * @brief Boot stage timestamps
+ */
+boot_timing_t const *boot_state_get_timing(void)
+{
+    return &g_timing;
+}
@@ -0,0 +1,52 @@
+/***********************************************************************************************************************
+ * File Name    : boot_state.h
+ * Description  : Fast-Boot Support - cooling state retained in RAM across warm resets, boot stage timing
+ **********************************************************************************************************************/
+
+#ifndef BOOT_STATE_H_
+#define BOOT_STATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+/* Retained Record - lives in .noinit, so it survives watchdog/software resets and brown-outs that kept SRAM
+ * above its retention voltage; a power-on leaves garbage that fails the check word */
+#define BOOT_RETAINED_MAGIC             (0x424F4F54UL)  /* "BOOT" */
+
+typedef struct {
+    uint32_t magic;
+    uint8_t cooling_level;      /* 0-4 */
+    uint8_t pwm_duty_cycle;     /* Last applied duty (%) */
+    uint8_t system_alert;       /* SYSTEM_ALERT_* at the time */
+    uint8_t reserved;
+    uint32_t boot_count;        /* Warm boots since the last power-on */
+    uint32_t check;             /* ~(magic ^ state word ^ boot_count) */
+} boot_retained_t;
+
+/* Boot Stages - timestamps relative to boot_state_begin() */
+typedef enum {
+    BOOT_STAGE_PWM = 0,         /* Safe duty on the fan pins */
+    BOOT_STAGE_FIRST_SAMPLE,    /* First decimated temperature available */
+    BOOT_STAGE_FIRST_DECISION,  /* First control decision applied (or fail-safe took over) */
+    BOOT_STAGE_BLE_UP,          /* BLE stack and telemetry transport opened */
+    BOOT_STAGE_COUNT
+} boot_stage_t;
+
+typedef struct {
+    uint32_t stage_us[BOOT_STAGE_COUNT];    /* 0 = not reached yet */
+    uint8_t reached;                         /* Bit per boot_stage_t */
+    bool restored;                           /* Cooling state came from retained RAM */
+    uint32_t boot_count;
+} boot_timing_t;
+
+/* Function Declarations */
+void boot_state_begin(void);
+bool boot_state_restore(boot_retained_t *p_state);
+void boot_state_save(uint8_t cooling_level, uint8_t pwm_duty_cycle, uint8_t system_alert);
+void boot_state_mark(boot_stage_t stage);
+bool boot_state_reached(boot_stage_t stage);
+uint32_t boot_state_elapsed_ms(void);
+boot_timing_t const *boot_state_get_timing(void);
+
+#endif /* BOOT_STATE_H_ */
@@ -0,0 +1,128 @@
+/***********************************************************************************************************************
+ * File Name    : fan_energy.c
+ * Description  : Cooling Fan Energy Accounting (cube-law power model, integrated over duty history) and the
+ *                energy-optimal duty trim
+ **********************************************************************************************************************/
+
+#include "fan_energy.h"
+
+/**
+ * @brief Reset accounting; fan assumed off
+ * @param[in] p_fan         Fan state
+ * @param[in] cycles_per_ms Timestamp ticks per millisecond
+ * @param[in] now           Current timestamp
+ */
+void fan_energy_init(fan_energy_t *p_fan, uint32_t cycles_per_ms, uint32_t now)
+{
+    p_fan->duty = 0;
+    p_fan->last_timestamp = now;
+    p_fan->cycles_per_ms = cycles_per_ms;
+    p_fan->energy_uj = 0;
+}
+
+/**
+ * @brief Estimated electrical power at a given duty
+ * @param[in] duty Duty cycle (0-100%)
+ * @return Power (mW)
+ */
+uint32_t fan_energy_power_mw(uint8_t duty)
+{
+    uint32_t d = (duty > 100U) ? 100U : duty;
+
+    /* d^3 <= 10^6, times 12000 mW fits in 64 bits only - keep the product in range */
+    return FAN_IDLE_POWER_MW + (uint32_t)(((uint64_t)FAN_RATED_POWER_MW * d * d * d) / 1000000ULL);
+}
+
+/**
+ * @brief Integrate energy at the current duty up to now
+ * @note  Call at least once per timestamp wrap period (DWT: ~20s at 200MHz)
+ * @param[in] p_fan Fan state
+ * @param[in] now   Current timestamp
+ */
+void fan_energy_update(fan_energy_t *p_fan, uint32_t now)
+{
+    uint32_t elapsed_us = (now - p_fan->last_timestamp) / (p_fan->cycles_per_ms / 1000U);
+
+    /* mW * µs = nJ */
+    p_fan->energy_uj += ((uint64_t)fan_energy_power_mw(p_fan->duty) * elapsed_us) / 1000ULL;
+    p_fan->last_timestamp = now;
+}
+
+/**
+ * @brief Close the interval at the old duty and start accounting at the new one
+ * @param[in] p_fan Fan state
+ * @param[in] duty  Newly applied duty (%)
+ * @param[in] now   Current timestamp
+ */
+void fan_energy_set_duty(fan_energy_t *p_fan, uint8_t duty, uint32_t now)
+{
+    fan_energy_update(p_fan, now);
+    p_fan->duty = duty;
+}
+
+/**
+ * @brief Get cumulative energy
+ * @return Energy (J)
+ */
+uint32_t fan_energy_get_joules(fan_energy_t const *p_fan)
+{
+    return (uint32_t)(p_fan->energy_uj / 1000000ULL);
+}
+
+/**
+ * @brief Start the trim over (untrimmed, no settle time) with new tuning
+ * @param[in] p_trim           Trim state
+ * @param[in] settle_period_ms Hold time before probing a step lower
+ * @param[in] step             Duty (%) per probe step
+ */
+void fan_energy_trim_init(fan_energy_trim_t *p_trim, uint32_t settle_period_ms, uint8_t step)
+{
+    p_trim->trim = 0;
+    p_trim->settle_ms = 0;
+    p_trim->step = step;
+    p_trim->settle_period_ms = settle_period_ms;
+}
+
+/**
+ * @brief Advance the trim by one control sample (fan power ~ duty^3, so small cuts save a lot)
+ * @note  A level that must not be trimmed passes floor_duty = duty: the trim then stays at zero.
+ * @param[in] p_trim      Trim state
+ * @param[in] level       Cooling level the duty comes from
+ * @param[in] duty        Table duty of the level (%)
+ * @param[in] floor_duty  Lowest duty the trim may reach (%)
+ * @param[in] margin_held Temperature is clear of the level's threshold by the margin and not rising
+ * @param[in] interval_ms Time the sample stands for (the sample rate is adaptive)
+ * @return Duty (%) to subtract from the table value
+ */
+uint8_t fan_energy_trim_update(fan_energy_trim_t *p_trim, uint8_t level, uint8_t duty, uint8_t floor_duty,
+                               bool margin_held, uint32_t interval_ms)
+{
+    if (level != p_trim->level)
+    {
+        p_trim->level = level;
+        p_trim->trim = 0;
+        p_trim->settle_ms = 0;
+        return 0;
+    }
+
+    if (!margin_held)
+    {
+        /* Margin eaten or heating up - give duty back immediately */
+        p_trim->trim = (p_trim->trim > p_trim->step) ? (uint8_t)(p_trim->trim - p_trim->step) : 0U;
+        p_trim->settle_ms = 0;
+        return p_trim->trim;
+    }
+
+    /* Settle time, not sample count */
+    p_trim->settle_ms += interval_ms;
+    if (p_trim->settle_ms >= p_trim->settle_period_ms)
+    {
+        /* Held the margin for a full settle period - probe one step lower */
+        p_trim->settle_ms = 0;
+        if (((int32_t)duty - (int32_t)p_trim->trim - (int32_t)p_trim->step) >= (int32_t)floor_duty)
+        {
+            p_trim->trim = (uint8_t)(p_trim->trim + p_trim->step);
+        }
+    }
+    return p_trim->trim;
+}
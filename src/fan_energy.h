@@ -0,0 +1,43 @@
+/***********************************************************************************************************************
+ * File Name    : fan_energy.h
+ * Description  : Cooling Fan Energy Accounting (cube-law power model, integrated over duty history)
+ **********************************************************************************************************************/
+
+#ifndef FAN_ENERGY_H_
+#define FAN_ENERGY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Fan Power Model - affinity law: P = P_rated * (duty / 100)^3 */
+#define FAN_RATED_POWER_MW          (12000U)    /* Electrical power at 100% duty */
+#define FAN_IDLE_POWER_MW           (150U)      /* Controller/tach draw with fan stopped */
+
+/* Per-Fan Accounting State */
+typedef struct {
+    uint8_t duty;                   /* Duty (%) applied since last_timestamp */
+    uint32_t last_timestamp;        /* Sample-clock timestamp of the last integration step */
+    uint32_t cycles_per_ms;
+    uint64_t energy_uj;             /* Cumulative energy (µJ) */
+} fan_energy_t;
+
+/* Energy-Optimal Trim - duty taken off a level's table value while the rack holds its margin */
+typedef struct {
+    uint8_t level;                  /* Level the trim was probed at - a new level starts untrimmed */
+    uint8_t trim;                   /* Duty (%) currently taken off */
+    uint8_t step;                   /* Duty (%) per probe step */
+    uint32_t settle_ms;             /* Time the margin has been held since the last step */
+    uint32_t settle_period_ms;      /* Hold time before probing a step lower */
+} fan_energy_trim_t;
+
+/* Function Declarations */
+void fan_energy_init(fan_energy_t *p_fan, uint32_t cycles_per_ms, uint32_t now);
+void fan_energy_update(fan_energy_t *p_fan, uint32_t now);
+void fan_energy_set_duty(fan_energy_t *p_fan, uint8_t duty, uint32_t now);
+uint32_t fan_energy_power_mw(uint8_t duty);
+uint32_t fan_energy_get_joules(fan_energy_t const *p_fan);
+void fan_energy_trim_init(fan_energy_trim_t *p_trim, uint32_t settle_period_ms, uint8_t step);
+uint8_t fan_energy_trim_update(fan_energy_trim_t *p_trim, uint8_t level, uint8_t duty, uint8_t floor_duty,
+                               bool margin_held, uint32_t interval_ms);
+
+#endif /* FAN_ENERGY_H_ */
@@ -10,7 +10,8 @@
 
 #include "common_utils.h"
 #include "gpt_timer.h"
-#include "log_disabled.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
 //#include "log_error.h"
 //#include "log_warning.h"
 //#include "log_info.h"
@@ -129,8 +130,6 @@ fsp_err_t set_timer_Period_and_Dutycycle(uint32_t period_counts ,uint8_t duty_cy
     fsp_err_t err                           = FSP_SUCCESS;
     uint32_t duty_cycle_counts              = RESET_VALUE;
     uint32_t current_period_counts          = RESET_VALUE;
-    timer_info_t info                       = {(timer_direction_t)RESET_VALUE, RESET_VALUE, RESET_VALUE};
-    gpt_instance_ctrl_t * p_instance_ctrl = (gpt_instance_ctrl_t *) p_timer_ctl;
 	/* PeriodSet Set API set the desired intensity on the on-board LED */
 	err = R_GPT_PeriodSet(p_timer_ctl, period_counts);
 	if(FSP_SUCCESS != err)
@@ -166,6 +165,42 @@ fsp_err_t set_timer_Period_and_Dutycycle(uint32_t period_counts ,uint8_t duty_cy
 }
 
 
+/*****************************************************************************************************************
+ *  @brief       Preset counter of a stopped PWM timer so its edges lag a timer started from zero.
+ *  @param[in]   phase_percent   Phase lag as a percentage of the period (0-99).
+ *  @param[in]   p_timer_ctl     Timer instance control structure
+ *  @retval      FSP_SUCCESS on counter set.
+ *  @retval      Any Other Error code apart from FSP_SUCCES on Unsuccessful operation.
+ ****************************************************************************************************************/
+fsp_err_t set_timer_phase_offset(uint8_t phase_percent, timer_ctrl_t * const p_timer_ctl)
+{
+    fsp_err_t err                           = FSP_SUCCESS;
+    uint32_t offset_counts                  = RESET_VALUE;
+    timer_info_t info                       = {(timer_direction_t)RESET_VALUE, RESET_VALUE, RESET_VALUE};
+
+    /* Get the current period setting. */
+    err = R_GPT_InfoGet(p_timer_ctl, &info);
+    if (FSP_SUCCESS != err)
+    {
+        log_error ("\r\n ** R_GPT_InfoGet API failed ** \r\n");
+        return err;
+    }
+
+    /* A counter that starts ahead by (100 - phase)% reaches each edge phase% of a period later. */
+    offset_counts = (uint32_t) (((uint64_t) info.period_counts * (GPT_MAX_PERCENT - (phase_percent % GPT_MAX_PERCENT))) /
+            GPT_MAX_PERCENT);
+    offset_counts = (offset_counts >= info.period_counts) ? RESET_VALUE : offset_counts;
+
+    /* Counter can only be written while the timer is stopped */
+    err = R_GPT_CounterSet(p_timer_ctl, offset_counts);
+    if (FSP_SUCCESS != err)
+    {
+        log_error ("\r\n ** R_GPT_CounterSet API failed ** \r\n");
+    }
+    return err;
+}
+
+
 /*****************************************************************************************************************
  * @brief      Close the GPT HAL driver.
  * @param[in]  p_timer_ctl     Timer instance control structure
@@ -48,6 +48,7 @@ fsp_err_t set_timer_duty_cycle(uint8_t duty_cycle_percent ,timer_ctrl_t * const
 uint32_t  process_input_data(void);
 void deinit_gpt_timer(timer_ctrl_t * const p_timer_ctl);
 void print_timer_menu(void);
+fsp_err_t set_timer_phase_offset(uint8_t phase_percent, timer_ctrl_t * const p_timer_ctl);
 fsp_err_t set_timer_Period_and_Dutycycle(uint32_t period_counts ,uint8_t duty_cycle_percent, timer_ctrl_t * const p_timer_ctl);
 
 #endif /* GPT_TIMER_H_ */
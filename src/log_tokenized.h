@@ -0,0 +1,69 @@
+/***********************************************************************************************************************
+ * File Name    : log_tokenized.h
+ * Description  : log_error/log_warning/log_info/log_debug as tokenized deferred records (see tlog.h).
+ *                Drop-in alternative to log_disabled.h / log_<level>.h - include exactly one of them.
+ *
+ * Each call site places its format string in the .tlog_fmt section and logs only the string's address
+ * plus raw argument words; no formatting happens on the target. Map the section as non-loaded in the
+ * linker script to keep the strings out of flash:
+ *     .tlog_fmt (INFO) : { KEEP(*(.tlog_fmt)) }
+ * tools/tlog_decode.py decodes the stream; tools/tlog_decode.py firmware.elf --dump-tokens lists the token table.
+ **********************************************************************************************************************/
+
+#ifndef LOG_TOKENIZED_H_
+#define LOG_TOKENIZED_H_
+
+#include "tlog.h"
+
+/* Highest level compiled in */
+#ifndef TLOG_LEVEL
+#define TLOG_LEVEL              TLOG_LEVEL_INFO
+#endif
+
+/* Argument counting/mapping (0..TLOG_MAX_ARGS) */
+#define TLOG_NARGS(...)         TLOG_NARGS_(0, ##__VA_ARGS__, 6, 5, 4, 3, 2, 1, 0)
+#define TLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, N, ...) N
+
+#define TLOG_MAP_0()
+#define TLOG_MAP_1(a)                   TLOG_ARG(a),
+#define TLOG_MAP_2(a, b)                TLOG_ARG(a), TLOG_ARG(b),
+#define TLOG_MAP_3(a, b, c)             TLOG_ARG(a), TLOG_ARG(b), TLOG_ARG(c),
+#define TLOG_MAP_4(a, b, c, d)          TLOG_ARG(a), TLOG_ARG(b), TLOG_ARG(c), TLOG_ARG(d),
+#define TLOG_MAP_5(a, b, c, d, e)       TLOG_ARG(a), TLOG_ARG(b), TLOG_ARG(c), TLOG_ARG(d), TLOG_ARG(e),
+#define TLOG_MAP_6(a, b, c, d, e, f)    TLOG_ARG(a), TLOG_ARG(b), TLOG_ARG(c), TLOG_ARG(d), TLOG_ARG(e), TLOG_ARG(f),
+#define TLOG_MAP_N(n, ...)              TLOG_MAP_N_(n, ##__VA_ARGS__)
+#define TLOG_MAP_N_(n, ...)             TLOG_MAP_##n(__VA_ARGS__)
+
+#define TLOG_RECORD(level, fmt, ...)                                                                    \
+    do {                                                                                                \
+        static const char tlog_fmt_[] __attribute__((section(".tlog_fmt"), used)) = fmt;                \
+        const uint32_t tlog_args_[TLOG_NARGS(__VA_ARGS__) + 1] = {                                      \
+            TLOG_MAP_N(TLOG_NARGS(__VA_ARGS__), ##__VA_ARGS__) 0 };                                     \
+        tlog_write((level), (uint32_t)(uintptr_t)tlog_fmt_, TLOG_NARGS(__VA_ARGS__), tlog_args_);       \
+    } while (0)
+
+#if TLOG_LEVEL >= TLOG_LEVEL_ERROR
+#define log_error(fmt, ...)     TLOG_RECORD(TLOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#else
+#define log_error(...)
+#endif
+
+#if TLOG_LEVEL >= TLOG_LEVEL_WARNING
+#define log_warning(fmt, ...)   TLOG_RECORD(TLOG_LEVEL_WARNING, fmt, ##__VA_ARGS__)
+#else
+#define log_warning(...)
+#endif
+
+#if TLOG_LEVEL >= TLOG_LEVEL_INFO
+#define log_info(fmt, ...)      TLOG_RECORD(TLOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#else
+#define log_info(...)
+#endif
+
+#if TLOG_LEVEL >= TLOG_LEVEL_DEBUG
+#define log_debug(fmt, ...)     TLOG_RECORD(TLOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+#else
+#define log_debug(...)
+#endif
+
+#endif /* LOG_TOKENIZED_H_ */
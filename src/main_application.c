@@ -2,15 +2,39 @@
 #include <string.h>
 #include "common_utils.h"
 #include "main_application.h"
+#include "system_config.h"
 #include "gpt_timer.h"
+#include "temperature_sensor.h"
+#include "sensor_fault.h"
+#include "thermal_shutdown.h"
+#include "thermal_trend.h"
+#include "adaptive_sampling.h"
+#include "fan_energy.h"
+#include "thermal_config.h"
+#include "ble_app.h"
+#include "ble_ota.h"
+#include "thermal_stats.h"
+#include "thermal_anomaly.h"
+#include "thermal_policy.h"
+#include "telemetry_transport.h"
+#include "telemetry_report.h"
+#include "boot_state.h"
+#include "timebase.h"
+#include "autotune.h"
+#include "autotune_store.h"
 
 /* Debug logging configuration */
-#include "log_disabled.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
 //#include "log_error.h"
 //#include "log_warning.h"
 //#include "log_info.h"
 //#include "log_debug.h"
 
+_Static_assert((THERMAL_POLICY_ALERT_CRITICAL == SYSTEM_ALERT_CRITICAL_TEMP) &&
+               (THERMAL_POLICY_ALERT_SHUTDOWN == SYSTEM_ALERT_THERMAL_SHUTDOWN),
+               "thermal_policy alert bits must match SYSTEM_ALERT_*");
+
 /* ========================================
    SERVER RACK THERMAL MANAGEMENT SYSTEM
    Real-time Cooling Control
@@ -20,19 +44,75 @@
 static temperature_sensor_data_t g_temp_sensor_data = {
     .current_temp = 0.0f,
     .previous_temp = 0.0f,
+    .temp_slope = 0.0f,
     .sample_count = 0,
+    .sample_interval_ms = TEMP_SAMPLE_INTERVAL_MS,
+    .sample_time_us = 0,
+    .decision_time_us = 0,
     .pwm_duty_cycle = 0,
     .cooling_level = 0,
-    .system_alert_active = 0
+    .system_alert_active = SYSTEM_ALERT_NONE,
+    .fan_energy_j = 0,
+    .sensor_faults = SENSOR_FAULT_NONE,
+    .failsafe_latency_us = 0,
+    .failsafe_latency_max_us = 0
 };
 
-/* Timer variables for periodic sampling */
-static uint32_t g_temp_sample_tick = 0;
-static uint32_t g_ble_tx_tick = 0;
+/* Temperature trend estimator (feeds predictive fan ramp) */
+static thermal_trend_t g_thermal_trend;
+
+/* Control sample scheduler (adaptive rate) */
+static adaptive_sampling_t g_sample_sched;
+
+/* Anomaly detection on the filtered temperature vs. duty band */
+static thermal_anomaly_t g_thermal_anomaly;
+
+/* Rolling statistics summary (1 min window) */
+static temp_sensor_data_t g_temp_stats;
+
+/* Fan energy accounting and energy-optimal duty trim */
+static fan_energy_t g_fan_energy[FAN_COUNT];
+static fan_energy_trim_t g_energy_trim;
+
+/* Step-response autotune and the parameters in force (build defaults until a result is stored) */
+static autotune_t g_autotune;
+static autotune_params_t g_tuning = {
+    .predict_horizon_s = PREDICT_HORIZON_S,
+    .settle_ms = ENERGY_OPT_SETTLE_MS,
+    .trim_step = ENERGY_OPT_STEP_DUTY
+};
+static bool g_autotune_persist = false;
+
+/* Rack status report-by-exception */
+static telemetry_report_t g_status_report;
+
+/* BLE stack is started after the first control decision (fast boot) */
+static bool g_ble_started = false;
+
+#if !REPORT_ON_CHANGE_ENABLE
+/* Fixed-rate BLE status report deadline */
+static uint64_t g_ble_tx_deadline_us = 0;
+#endif
 
 /* External timer control structures (configured in HAL) */
 extern timer_ctrl_t g_timer_pwm_led1_ctrl;
 extern timer_cfg_t g_timer_pwm_led1_cfg;
+extern timer_ctrl_t g_timer_pwm_led2_ctrl;
+extern timer_cfg_t g_timer_pwm_led2_cfg;
+
+/* Fan outputs: intake on GPT1 (P104), exhaust on GPT3 (P112) */
+static timer_ctrl_t * const g_fan_timer_ctrl[FAN_COUNT] = {
+    [FAN_INTAKE]  = &g_timer_pwm_led1_ctrl,
+    [FAN_EXHAUST] = &g_timer_pwm_led2_ctrl
+};
+static timer_cfg_t const * const g_fan_timer_cfg[FAN_COUNT] = {
+    [FAN_INTAKE]  = &g_timer_pwm_led1_cfg,
+    [FAN_EXHAUST] = &g_timer_pwm_led2_cfg
+};
+static const uint8_t g_fan_enabled[FAN_COUNT] = {
+    [FAN_INTAKE]  = INTAKE_FAN_ENABLE,
+    [FAN_EXHAUST] = EXHAUST_FAN_ENABLE
+};
 
 /**
  * @brief Get cooling level based on temperature
@@ -41,43 +121,248 @@ extern timer_cfg_t g_timer_pwm_led1_cfg;
  */
 uint8_t get_cooling_level(float temperature)
 {
-    if (temperature < TEMP_LEVEL_OFF)
+    /* Shared with the host what-if engine (tools/whatif) so candidate configurations are scored by this rule */
+    return thermal_policy_level(thermal_config_get()->level_threshold, temperature);
+}
+
+/**
+ * @brief Map cooling level to PWM duty cycle
+ * @param[in] cooling_level Cooling level (0-4)
+ * @return PWM duty cycle percentage (0-100)
+ */
+static uint8_t cooling_level_to_pwm(uint8_t cooling_level)
+{
+    /* Duty table: OFF / LOW / MEDIUM / HIGH / EMERGENCY (runtime configurable), OFF out of range */
+    return thermal_policy_duty(thermal_config_get()->duty, cooling_level);
+}
+
+/**
+ * @brief Temperature at which a cooling level hands over to the next one
+ * @param[in] cooling_level Cooling level (0-3)
+ * @return Upper threshold of the level
+ */
+static float cooling_level_upper_threshold(uint8_t cooling_level)
+{
+    return thermal_config_get()->level_threshold[(cooling_level > 3) ? 3 : cooling_level];
+}
+
+/**
+ * @brief Feed-forward duty from the temperature trend
+ * @param[in] cooling_level Reactive cooling level
+ * @return Extra duty (%) so the fans reach the next level's duty as the crossing arrives
+ */
+static uint8_t predictive_feedforward(uint8_t cooling_level)
+{
+#if PREDICTIVE_CONTROL_ENABLE
+    float time_to_cross;
+    
+    if ((cooling_level >= 4) || (g_thermal_trend.slope < PREDICT_MIN_SLOPE_C_PER_S))
     {
-        return 0;  /* OFF */
+        return 0;
     }
-    else if (temperature < TEMP_LEVEL_LOW)
+    
+    /* Ramp shared with the host evaluation (tools/host/predictive_ramp_eval.c) */
+    time_to_cross = thermal_trend_time_to_reach(&g_thermal_trend, cooling_level_upper_threshold(cooling_level));
+    return thermal_policy_feedforward(thermal_config_get()->duty, cooling_level, time_to_cross,
+                                      g_tuning.predict_horizon_s);
+#else
+    FSP_PARAMETER_NOT_USED(cooling_level);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Energy-optimal duty trim (fan power ~ duty^3, so small cuts save a lot)
+ * @param[in] cooling_level Reactive cooling level
+ * @param[in] temperature   Current rack temperature
+ * @return Duty (%) to subtract from the table value
+ */
+static uint8_t energy_optimal_trim(uint8_t cooling_level, float temperature)
+{
+#if ENERGY_OPTIMAL_ENABLE
+    uint8_t duty = cooling_level_to_pwm(cooling_level);
+    uint8_t floor_duty = duty;
+    bool margin_held;
+    
+    /* Full cooling and fans-off are never trimmed (floor at the table duty) */
+    if ((cooling_level > 0) && (cooling_level < 4))
     {
-        return 1;  /* LOW */
+        floor_duty = cooling_level_to_pwm((uint8_t)(cooling_level - 1));
+        floor_duty = (floor_duty < ENERGY_OPT_MIN_DUTY) ? ENERGY_OPT_MIN_DUTY : floor_duty;
     }
-    else if (temperature < TEMP_LEVEL_MEDIUM)
+    
+    /* Trim rule shared with the host evaluation (tools/host/energy_trim_eval.c) */
+    margin_held = (temperature <= (cooling_level_upper_threshold(cooling_level) - ENERGY_OPT_MARGIN_C)) &&
+                  (g_thermal_trend.slope < PREDICT_MIN_SLOPE_C_PER_S);
+    return fan_energy_trim_update(&g_energy_trim, cooling_level, duty, floor_duty, margin_held,
+                                  g_temp_sensor_data.sample_interval_ms);
+#else
+    FSP_PARAMETER_NOT_USED(cooling_level);
+    FSP_PARAMETER_NOT_USED(temperature);
+    return 0;
+#endif
+}
+
+/**
+ * @brief Split a commanded duty into per-fan duties
+ * @param[in] fan  FAN_INTAKE or FAN_EXHAUST
+ * @param[in] duty Commanded (intake) duty (%)
+ * @return Duty for that fan (%)
+ */
+static uint8_t fan_duty_for(uint8_t fan, uint8_t duty)
+{
+    if (!g_fan_enabled[fan])
     {
-        return 2;  /* MEDIUM */
+        return 0;
     }
-    else if (temperature < TEMP_LEVEL_HIGH)
+    if ((FAN_EXHAUST == fan) && (duty < PWM_DUTY_CYCLE_EMERGENCY))
     {
-        return 3;  /* HIGH */
+        return (uint8_t)(((uint16_t)duty * FAN_EXHAUST_RATIO_PCT) / 100U);
     }
-    else
+    return duty;
+}
+
+/**
+ * @brief Apply a fan duty to intake and exhaust and account their energy
+ * @param[in] duty Commanded duty cycle (0-100%)
+ * @return FSP_SUCCESS if every enabled timer accepted its duty
+ */
+static fsp_err_t fan_apply_duty(uint8_t duty)
+{
+    fsp_err_t err = FSP_SUCCESS;
+    fsp_err_t fan_err;
+    uint32_t now = (uint32_t)timebase_now_us();
+    uint8_t fan_duty;
+    
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
     {
-        return 4;  /* EMERGENCY */
+        if (!g_fan_enabled[fan])
+        {
+            continue;
+        }
+        
+        fan_duty = fan_duty_for(fan, duty);
+        fan_energy_set_duty(&g_fan_energy[fan], fan_duty, now);
+        fan_err = set_timer_duty_cycle(fan_duty, g_fan_timer_ctrl[fan]);
+        err = (FSP_SUCCESS == err) ? fan_err : err;
     }
+    
+    return err;
 }
 
 /**
- * @brief Map cooling level to PWM duty cycle
- * @param[in] cooling_level Cooling level (0-4)
- * @return PWM duty cycle percentage (0-100)
+ * @brief Total fan energy across all fans
+ * @return Energy (J)
  */
-static uint8_t cooling_level_to_pwm(uint8_t cooling_level)
+static uint32_t fan_energy_total_joules(void)
 {
-    switch (cooling_level)
+    uint32_t total = 0;
+    
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
     {
-        case 0: return PWM_DUTY_CYCLE_OFF;       /* OFF */
-        case 1: return PWM_DUTY_CYCLE_LOW;       /* LOW - 25% */
-        case 2: return PWM_DUTY_CYCLE_MEDIUM;    /* MEDIUM - 50% */
-        case 3: return PWM_DUTY_CYCLE_HIGH;      /* HIGH - 75% */
-        case 4: return PWM_DUTY_CYCLE_EMERGENCY; /* EMERGENCY - 100% */
-        default: return PWM_DUTY_CYCLE_OFF;
+        total += fan_energy_get_joules(&g_fan_energy[fan]);
+    }
+    return total;
+}
+
+/**
+ * @brief Open and start the fan PWM timers once
+ * @note  Exhaust counter is preset so its pulses sit FAN_PHASE_OFFSET_PCT of a period after intake,
+ *        spreading the fans' current pulses on the supply
+ * @return FSP_SUCCESS if the fan outputs are running
+ */
+static fsp_err_t fan_pwm_init(void)
+{
+    fsp_err_t err = FSP_SUCCESS;
+    static uint8_t pwm_initialized = 0;
+    uint8_t fan;
+    
+    if (pwm_initialized)
+    {
+        return FSP_SUCCESS;
+    }
+    
+    for (fan = 0; fan < FAN_COUNT; fan++)
+    {
+        if (!g_fan_enabled[fan])
+        {
+            continue;
+        }
+        
+        err = init_gpt_timer(g_fan_timer_ctrl[fan], g_fan_timer_cfg[fan]);
+        if ((FSP_SUCCESS == err) && (FAN_EXHAUST == fan))
+        {
+            err = set_timer_phase_offset(FAN_PHASE_OFFSET_PCT, g_fan_timer_ctrl[fan]);
+        }
+        if (FSP_SUCCESS != err)
+        {
+            log_error("Fan control initialization FAILED\r\n");
+            break;
+        }
+    }
+    
+    /* Start back to back so the preset phase relationship holds */
+    for (uint8_t i = 0; (FSP_SUCCESS == err) && (i < FAN_COUNT); i++)
+    {
+        if (g_fan_enabled[i])
+        {
+            err = start_gpt_timer(g_fan_timer_ctrl[i]);
+        }
+    }
+    
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Fan control start FAILED\r\n");
+        for (uint8_t i = 0; i < FAN_COUNT; i++)
+        {
+            if (g_fan_enabled[i])
+            {
+                deinit_gpt_timer(g_fan_timer_ctrl[i]);
+            }
+        }
+        return err;
+    }
+    
+    pwm_initialized = 1;
+    log_info("Fan Control System: ONLINE\r\n");
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Force full cooling while the sensor is implausible
+ * @note  Called every loop iteration, so fault-to-fan latency is bounded by one loop period
+ */
+static void thermal_failsafe_update(void)
+{
+    uint32_t faults = temp_sensor_get_faults();
+    uint32_t latency_us;
+    
+    g_temp_sensor_data.sensor_faults = faults;
+    
+    if ((SENSOR_FAULT_NONE != faults) && !(g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_SENSOR_FAULT))
+    {
+        if (FSP_SUCCESS == fan_pwm_init())
+        {
+            fan_apply_duty(PWM_DUTY_CYCLE_EMERGENCY);
+        }
+        
+        latency_us = (TEMP_TIMESTAMP_NOW() - temp_sensor_get_fault_timestamp()) / TEMP_TIMESTAMP_CYCLES_PER_US;
+        g_temp_sensor_data.failsafe_latency_us = latency_us;
+        if (latency_us > g_temp_sensor_data.failsafe_latency_max_us)
+        {
+            g_temp_sensor_data.failsafe_latency_max_us = latency_us;
+        }
+        
+        g_temp_sensor_data.cooling_level = 4;
+        g_temp_sensor_data.pwm_duty_cycle = PWM_DUTY_CYCLE_EMERGENCY;
+        g_temp_sensor_data.system_alert_active |= SYSTEM_ALERT_SENSOR_FAULT;
+        log_error("SENSOR FAULT 0x%02lx - FAIL-SAFE FULL COOLING (%luus)\r\n", faults, latency_us);
+    }
+    else if ((SENSOR_FAULT_NONE == faults) && (g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_SENSOR_FAULT))
+    {
+        /* Normal control resumes on the next valid sample */
+        g_temp_sensor_data.system_alert_active &= (uint8_t)~SYSTEM_ALERT_SENSOR_FAULT;
+        log_info("Sensor fault cleared - resuming thermal control\r\n");
     }
 }
 
@@ -93,10 +378,61 @@ void temp_sensor_init(void)
     log_info("Initializing sensors...\r\n");
     log_info("========================================\r\n");
     
+    /* Arm the hardware shutdown path before the ADC starts scanning */
+    err = thermal_shutdown_init();
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Thermal shutdown path: FAILED\r\n");
+    }
+    
     /* ADC initialization through HAL configuration */
+    err = temp_sensor_adc_init();
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Temperature Sensor: FAILED\r\n");
+        return;
+    }
+    
     log_info("Temperature Sensor: READY\r\n");
     log_info("Monitoring Range: 0-60°C\r\n");
-    log_info("Sample Interval: %dms\r\n", TEMP_SAMPLE_INTERVAL_MS);
+#if ADAPTIVE_SAMPLING_ENABLE
+    log_info("Sample Interval: adaptive %d-%dms\r\n", ADAPTIVE_SAMPLE_MIN_MS, ADAPTIVE_SAMPLE_MAX_MS);
+#else
+    log_info("Sample Interval: %dms\r\n", thermal_config_get()->sample_interval_ms);
+#endif
+}
+
+/**
+ * @brief Interval until the next control sample
+ * @param[in] p_config Active configuration
+ * @return Interval (ms): adaptive to the trend and the distance to the nearest boundary, or the configured
+ *         fixed interval with ADAPTIVE_SAMPLING_ENABLE off
+ */
+static uint32_t sample_interval_next(thermal_config_t const *p_config)
+{
+#if ADAPTIVE_SAMPLING_ENABLE
+    float boundary[6];
+#endif
+    
+    /* The step response is identified from evenly spaced samples */
+    if (autotune_active(&g_autotune))
+    {
+        return AUTOTUNE_SAMPLE_MS;
+    }
+    
+#if ADAPTIVE_SAMPLING_ENABLE
+    /* Everywhere the control output changes: level thresholds, critical alert, hardware shutdown */
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        boundary[i] = p_config->level_threshold[i];
+    }
+    boundary[4] = p_config->critical_temp;
+    boundary[5] = SYSTEM_SHUTDOWN_TEMP;
+    
+    return adaptive_sampling_next(&g_sample_sched, g_thermal_trend.level, g_thermal_trend.slope, boundary, 6);
+#else
+    return p_config->sample_interval_ms;
+#endif
 }
 
 /**
@@ -106,19 +442,232 @@ void temp_sensor_init(void)
  */
 fsp_err_t temp_sensor_read(float *p_temperature)
 {
-    fsp_err_t err = FSP_SUCCESS;
-    uint16_t adc_result = 0;
-    
     if (NULL == p_temperature)
     {
         return FSP_ERR_INVALID_ARGUMENT;
     }
     
-    /* Simplified conversion for demonstration */
-    *p_temperature = 25.5f;  /* Placeholder - replace with actual ADC reading */
+    /* Plausibility-checked, oversampled reading */
+    return temp_sensor_read_adc(p_temperature);
+}
+
+/**
+ * @brief Run the anomaly detector on the filtered temperature and raise/clear SYSTEM_ALERT_ANOMALY
+ */
+static void thermal_anomaly_update_alert(void)
+{
+    uint8_t findings = thermal_anomaly_update(&g_thermal_anomaly, g_thermal_trend.level,
+                                              g_temp_sensor_data.cooling_level, g_temp_sensor_data.sample_interval_ms);
     
-    return err;
+    if ((ANOMALY_NONE != findings) && !(g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_ANOMALY))
+    {
+        log_warning("Thermal anomaly: 0x%02x (z=%.1f, residual=%.2f°C, cusum=%.1f)\r\n", findings,
+                    g_thermal_anomaly.z, g_thermal_anomaly.residual, g_thermal_anomaly.cusum);
+        g_temp_sensor_data.system_alert_active |= SYSTEM_ALERT_ANOMALY;
+    }
+    else if ((ANOMALY_NONE == findings) && (g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_ANOMALY))
+    {
+        log_info("Thermal anomaly: cleared\r\n");
+        g_temp_sensor_data.system_alert_active &= (uint8_t)~SYSTEM_ALERT_ANOMALY;
+    }
+}
+
+#if TELEMETRY_DIAG_ENABLE
+/**
+ * @brief Per-sample diagnostic frame for wired transports: rolling statistics, the detector state, then the
+ *        sample timestamp
+ * @param[in] status Temperature status (TEMP_STATUS_*)
+ */
+static void thermal_send_diagnostics(uint8_t status)
+{
+    uint8_t buf[THERMAL_STATS_WIRE_SIZE + 14U];
+    uint16_t len = thermal_stats_serialize(status, buf, THERMAL_STATS_WIRE_SIZE);
+    int16_t z = (int16_t)(g_thermal_anomaly.z * 100.0f);
+    int16_t residual = (int16_t)(g_thermal_anomaly.residual * 100.0f);
+    int16_t slope = (int16_t)(g_thermal_trend.slope * 10000.0f);    /* 0.1 m°C/s units */
+
+    buf[len++] = (uint8_t)(z & 0xFF);
+    buf[len++] = (uint8_t)((z >> 8) & 0xFF);
+    buf[len++] = (uint8_t)(residual & 0xFF);
+    buf[len++] = (uint8_t)((residual >> 8) & 0xFF);
+    buf[len++] = (uint8_t)(slope & 0xFF);
+    buf[len++] = (uint8_t)((slope >> 8) & 0xFF);
+    
+    /* Sample timestamp (timebase µs, uint64) */
+    for (uint8_t i = 0; i < 8U; i++)
+    {
+        buf[len++] = (uint8_t)((g_temp_sensor_data.sample_time_us >> (8U * i)) & 0xFF);
+    }
+
+    telemetry_transport_send(TELEMETRY_CH_DIAGNOSTIC, buf, len);
 }
+#endif
+
+/**
+ * @brief Refresh the autotune characteristic
+ */
+static void autotune_publish(void)
+{
+    uint8_t buf[AUTOTUNE_WIRE_SIZE];
+    
+    if (g_ble_started)
+    {
+        ble_publish_autotune(buf, autotune_serialize(&g_autotune, buf, sizeof(buf)));
+    }
+}
+
+/**
+ * @brief Adopt a finished experiment's parameters (or keep the current ones if it failed)
+ */
+static void autotune_finish(void)
+{
+    if (AUTOTUNE_DONE == g_autotune.state)
+    {
+        g_tuning = g_autotune.params;
+        g_autotune_persist = true;
+        log_info("Autotune: K=%.3f°C/%%, tau=%.0fs, dead time=%.0fs -> horizon %.0fs, settle %lums, trim %d%%\r\n",
+                 g_autotune.model.gain, g_autotune.model.tau_s, g_autotune.model.dead_time_s,
+                 g_tuning.predict_horizon_s, g_tuning.settle_ms, g_tuning.trim_step);
+    }
+    else
+    {
+        log_warning("Autotune: FAILED (error %d) - parameters unchanged\r\n", g_autotune.error);
+    }
+    
+    /* Trim was probed against the old settle time - start it over */
+    fan_energy_trim_init(&g_energy_trim, g_tuning.settle_ms, g_tuning.trim_step);
+    autotune_publish();
+}
+
+/**
+ * @brief Let a running experiment choose the duty
+ * @param[in]  temperature Current rack temperature
+ * @param[out] p_duty      Duty the experiment holds (valid when true is returned)
+ * @return true while the experiment owns the fans; false once it finishes, so normal control decides this sample
+ */
+static bool autotune_control(float temperature, uint8_t *p_duty)
+{
+    autotune_state_t state = g_autotune.state;
+    
+    if (!autotune_active(&g_autotune))
+    {
+        return false;
+    }
+    
+    *p_duty = autotune_update(&g_autotune, temperature, g_temp_sensor_data.sample_interval_ms);
+    if (autotune_active(&g_autotune))
+    {
+        if (state != g_autotune.state)
+        {
+            log_info("Autotune: steady at %.2f°C - stepping duty to %d%%\r\n", g_autotune.baseline, *p_duty);
+            autotune_publish();
+        }
+        return true;
+    }
+    
+    autotune_finish();
+    return false;
+}
+
+#if AUTOTUNE_ENABLE
+/**
+ * @brief Start a step-response experiment from the current operating point
+ * @param[in] p_config Active configuration
+ * @return true if the experiment started
+ */
+static bool autotune_begin(thermal_config_t const *p_config)
+{
+    uint8_t base_duty = g_temp_sensor_data.pwm_duty_cycle;
+    uint8_t step_duty;
+    
+    /* Only from normal control - never against the fail-safe, a shutdown or a rack already critical */
+    if (g_temp_sensor_data.system_alert_active &
+        (SYSTEM_ALERT_CRITICAL_TEMP | SYSTEM_ALERT_SENSOR_FAULT | SYSTEM_ALERT_THERMAL_SHUTDOWN))
+    {
+        log_warning("Autotune: refused - alert 0x%02x active\r\n", g_temp_sensor_data.system_alert_active);
+        return false;
+    }
+    
+    /* Base with the fans turning so the step is airflow, not spin-up; the step only ever adds cooling */
+    base_duty = (base_duty < PWM_DUTY_CYCLE_LOW) ? PWM_DUTY_CYCLE_LOW : base_duty;
+    step_duty = ((100U - base_duty) < AUTOTUNE_STEP_DUTY) ? (uint8_t)(100U - base_duty) : AUTOTUNE_STEP_DUTY;
+    if ((step_duty < AUTOTUNE_MIN_STEP_DUTY) ||
+        !autotune_start(&g_autotune, base_duty, (int8_t)step_duty, p_config->critical_temp - AUTOTUNE_LIMIT_MARGIN_C,
+                        ENERGY_OPT_MARGIN_C, AUTOTUNE_SAMPLE_MS))
+    {
+        log_warning("Autotune: refused - no room to step from %d%%\r\n", base_duty);
+        return false;
+    }
+    
+    g_temp_sensor_data.pwm_duty_cycle = base_duty;
+    g_temp_sensor_data.sample_interval_ms = AUTOTUNE_SAMPLE_MS;
+    fan_apply_duty(base_duty);
+    log_info("Autotune: started - holding %d%%, then +%d%%\r\n", base_duty, step_duty);
+    autotune_publish();
+    return true;
+}
+
+/**
+ * @brief Take autotune triggers (commissioning button, BLE command) and stop the experiment on a fault
+ * @note  Called every loop iteration, so a fault or abort hands the fans back within one loop period
+ * @param[in] p_config Active configuration
+ * @return true if an experiment was just started (sample now, at the experiment's rate)
+ */
+static bool autotune_service(thermal_config_t const *p_config)
+{
+    static bool button_down = false;
+    bsp_io_level_t level = BSP_IO_LEVEL_HIGH;
+    bool start;
+    bool abort = false;
+    uint8_t cmd;
+    
+    /* Press edge - bounces and a held button land while the experiment is already running */
+    R_IOPORT_PinRead(&g_ioport_ctrl, AUTOTUNE_LOCAL_PIN, &level);
+    start = (BSP_IO_LEVEL_LOW == level) && !button_down;
+    button_down = (BSP_IO_LEVEL_LOW == level);
+    
+    if (g_ble_started && ble_take_autotune_command(&cmd))
+    {
+        start = start || (AUTOTUNE_CMD_START == cmd);
+        abort = (AUTOTUNE_CMD_ABORT == cmd);
+    }
+    
+    if (autotune_active(&g_autotune))
+    {
+        if (abort || (g_temp_sensor_data.system_alert_active & (SYSTEM_ALERT_SENSOR_FAULT | SYSTEM_ALERT_THERMAL_SHUTDOWN)))
+        {
+            autotune_abort(&g_autotune);
+            autotune_finish();
+        }
+        return false;
+    }
+    
+    return start && autotune_begin(p_config);
+}
+
+/**
+ * @brief Arm the commissioning button and adopt a stored autotune result
+ */
+static void autotune_boot(void)
+{
+    autotune_record_t record;
+    
+    R_IOPORT_PinCfg(&g_ioport_ctrl, AUTOTUNE_LOCAL_PIN,
+                    (uint32_t)IOPORT_CFG_PORT_DIRECTION_INPUT | (uint32_t)IOPORT_CFG_PULLUP_ENABLE);
+    
+    if (autotune_store_load(&record))
+    {
+        g_autotune.state = AUTOTUNE_DONE;
+        g_autotune.base_duty = record.base_duty;
+        g_autotune.step_duty = record.step_duty;
+        g_autotune.model = record.model;
+        g_autotune.params = record.params;
+        g_tuning = record.params;
+        log_info("Autotune: stored result - horizon %.0fs, settle %lums, trim %d%%\r\n",
+                 g_tuning.predict_horizon_s, g_tuning.settle_ms, g_tuning.trim_step);
+    }
+}
+#endif
 
 /**
  * @brief Update PWM fan speed based on temperature
@@ -127,44 +676,40 @@ fsp_err_t temp_sensor_read(float *p_temperature)
 void pwm_control_update(float temperature)
 {
     fsp_err_t err = FSP_SUCCESS;
-    static uint8_t pwm_initialized = 0;
+    thermal_config_t const *p_config = thermal_config_get();
     uint8_t new_cooling_level;
     uint8_t new_pwm_duty;
+    uint8_t new_alert;
     
     /* Initialize PWM on first call */
-    if (!pwm_initialized)
+    if (FSP_SUCCESS != fan_pwm_init())
     {
-        err = init_gpt_timer(&g_timer_pwm_led1_ctrl, &g_timer_pwm_led1_cfg);
-        if (FSP_SUCCESS != err)
-        {
-            log_error("Fan control initialization FAILED\r\n");
-            return;
-        }
-        
-        err = start_gpt_timer(&g_timer_pwm_led1_ctrl);
-        if (FSP_SUCCESS != err)
-        {
-            log_error("Fan control start FAILED\r\n");
-            deinit_gpt_timer(&g_timer_pwm_led1_ctrl);
-            return;
-        }
-        
-        pwm_initialized = 1;
-        log_info("Fan Control System: ONLINE\r\n");
+        return;
+    }
+    
+    /* Fail-safe owns the fans while the sensor is implausible */
+    if (g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_SENSOR_FAULT)
+    {
+        return;
     }
     
     /* Determine new cooling level based on temperature */
     new_cooling_level = get_cooling_level(temperature);
-    new_pwm_duty = cooling_level_to_pwm(new_cooling_level);
+    if (!autotune_control(temperature, &new_pwm_duty))
+    {
+        new_pwm_duty = (uint8_t)(cooling_level_to_pwm(new_cooling_level) + predictive_feedforward(new_cooling_level));
+        new_pwm_duty = (uint8_t)(new_pwm_duty - energy_optimal_trim(new_cooling_level, temperature));
+    }
     
-    /* Update only if cooling level changed (reduce noise) */
-    if (new_cooling_level != g_temp_sensor_data.cooling_level)
+    /* Update only if level or duty changed (reduce noise); POEG owns the pins once shutdown latched */
+    if (((new_cooling_level != g_temp_sensor_data.cooling_level) || (new_pwm_duty != g_temp_sensor_data.pwm_duty_cycle))
+        && !thermal_shutdown_is_tripped())
     {
         g_temp_sensor_data.cooling_level = new_cooling_level;
         g_temp_sensor_data.pwm_duty_cycle = new_pwm_duty;
         
         /* Update PWM */
-        err = set_timer_duty_cycle(new_pwm_duty, &g_timer_pwm_led1_ctrl);
+        err = fan_apply_duty(new_pwm_duty);
         
         if (FSP_SUCCESS == err)
         {
@@ -175,32 +720,44 @@ void pwm_control_update(float temperature)
         }
     }
     
-    /* Check for critical conditions */
-    if (temperature >= SYSTEM_CRITICAL_TEMP)
+    /* Check for critical conditions - shutdown first, it is the superset (alert rule shared with thermal_policy) */
+    new_alert = thermal_policy_alert(g_temp_sensor_data.system_alert_active, temperature, p_config->critical_temp,
+                                     p_config->hysteresis, SYSTEM_SHUTDOWN_TEMP);
+    if (temperature >= SYSTEM_SHUTDOWN_TEMP)
     {
-        g_temp_sensor_data.system_alert_active = 1;
-        log_error("⚠️  CRITICAL TEMPERATURE ALERT: %.1f°C\r\n", temperature);
+        /* Software backstop for the ADC window comparator path */
+        thermal_shutdown_trip();
+        log_error("🚨 EMERGENCY: Temperature %.1f°C - THERMAL SHUTDOWN INITIATED\r\n", temperature);
     }
-    else if (temperature >= SYSTEM_SHUTDOWN_TEMP)
+    else if (temperature >= p_config->critical_temp)
     {
-        log_error("🚨 EMERGENCY: Temperature %.1f°C - THERMAL SHUTDOWN INITIATED\r\n", temperature);
-        /* In production: trigger emergency shutdown */
+        log_error("⚠️  CRITICAL TEMPERATURE ALERT: %.1f°C\r\n", temperature);
     }
-    else if (g_temp_sensor_data.system_alert_active && temperature < (SYSTEM_CRITICAL_TEMP - TEMP_HYSTERESIS))
+    else if ((g_temp_sensor_data.system_alert_active & ~new_alert) & SYSTEM_ALERT_CRITICAL_TEMP)
     {
-        g_temp_sensor_data.system_alert_active = 0;
         log_info("✅ Alert cleared - Temperature normalized\r\n");
     }
+    g_temp_sensor_data.system_alert_active = new_alert;
+    
+    /* Hardware path may have fired between samples; the latch holds until reset */
+    if (thermal_shutdown_is_tripped())
+    {
+        g_temp_sensor_data.system_alert_active |= SYSTEM_ALERT_THERMAL_SHUTDOWN;
+        g_temp_sensor_data.cooling_level = 4;
+        g_temp_sensor_data.pwm_duty_cycle = PWM_DUTY_CYCLE_EMERGENCY;
+    }
 }
 
 /**
- * @brief Send rack status via Bluetooth
+ * @brief Send rack status over the telemetry transport (and refresh the advertised summary)
  * @param[in] temperature Current rack temperature
+ * @param[in] report_seq  Frame sequence number
  */
-void ble_send_temperature_data(float temperature)
+void ble_send_temperature_data(float temperature, uint16_t report_seq)
 {
     uint8_t ble_data[MAX_SENSOR_DATA_LEN];
     uint16_t data_len = 0;
+    uint32_t sample_time_ms = (uint32_t)(g_temp_sensor_data.sample_time_us / 1000U);
     
     /* Pack thermal data into BLE packet */
     int16_t temp_int = (int16_t)(temperature * 100);
@@ -214,20 +771,147 @@ void ble_send_temperature_data(float temperature)
     /* PWM duty cycle (0-100) */
     ble_data[3] = g_temp_sensor_data.pwm_duty_cycle;
     
-    /* System alert flag */
+    /* System alert code (SYSTEM_ALERT_* bits) */
     ble_data[4] = g_temp_sensor_data.system_alert_active;
     
     /* Sample count */
     ble_data[5] = (uint8_t)(g_temp_sensor_data.sample_count & 0xFF);
     ble_data[6] = (uint8_t)((g_temp_sensor_data.sample_count >> 8) & 0xFF);
     
-    data_len = 7;
+    /* Cumulative fan energy (J) */
+    ble_data[7] = (uint8_t)(g_temp_sensor_data.fan_energy_j & 0xFF);
+    ble_data[8] = (uint8_t)((g_temp_sensor_data.fan_energy_j >> 8) & 0xFF);
+    ble_data[9] = (uint8_t)((g_temp_sensor_data.fan_energy_j >> 16) & 0xFF);
+    ble_data[10] = (uint8_t)((g_temp_sensor_data.fan_energy_j >> 24) & 0xFF);
+    
+    /* Report sequence - frames are sent by exception, so receivers count losses on this */
+    ble_data[11] = (uint8_t)(report_seq & 0xFF);
+    ble_data[12] = (uint8_t)((report_seq >> 8) & 0xFF);
+    
+    /* Sample timestamp (timebase ms, wrapping) - when the reported temperature was measured */
+    ble_data[13] = (uint8_t)(sample_time_ms & 0xFF);
+    ble_data[14] = (uint8_t)((sample_time_ms >> 8) & 0xFF);
+    ble_data[15] = (uint8_t)((sample_time_ms >> 16) & 0xFF);
+    ble_data[16] = (uint8_t)((sample_time_ms >> 24) & 0xFF);
+    
+    data_len = BLE_TEMP_DATA_SIZE;
+    
+    /* Encoded once; the build-time backend carries it (BLE fans it out to every subscribed central) */
+    telemetry_transport_send(TELEMETRY_CH_RACK_STATUS, ble_data, data_len);
+    ble_update_adv_status(temp_int, g_temp_sensor_data.cooling_level,
+                          g_temp_sensor_data.pwm_duty_cycle, g_temp_sensor_data.system_alert_active);
     
     log_debug("BLE TX: Temp=%.1f°C, Level=%d, PWM=%d%%, Alert=%d\r\n", 
               temperature, g_temp_sensor_data.cooling_level, 
               g_temp_sensor_data.pwm_duty_cycle, g_temp_sensor_data.system_alert_active);
 }
 
+/**
+ * @brief First action after reset: fans to a safe duty, then the last cooling state from retained RAM
+ * @note  Runs before configuration, flash and sensor bring-up, so a watchdog reset or brown-out never
+ *        leaves the rack uncooled while those take their time
+ */
+static void fast_boot_cooling(void)
+{
+    boot_retained_t retained;
+    uint8_t duty = FAST_BOOT_SAFE_DUTY;
+    
+    if (boot_state_restore(&retained))
+    {
+        /* Never below the safe floor until a fresh sample has been judged */
+        g_temp_sensor_data.cooling_level = retained.cooling_level;
+        duty = (retained.pwm_duty_cycle > duty) ? retained.pwm_duty_cycle : duty;
+    }
+    
+    g_temp_sensor_data.pwm_duty_cycle = duty;
+    if (FSP_SUCCESS == fan_pwm_init())
+    {
+        fan_apply_duty(duty);
+        boot_state_mark(BOOT_STAGE_PWM);
+    }
+    
+    if (boot_state_get_timing()->restored)
+    {
+        log_info("Warm boot #%lu: restored level %d, alert 0x%02x - fans at %d%%\r\n",
+                 boot_state_get_timing()->boot_count, retained.cooling_level, retained.system_alert, duty);
+    }
+    else
+    {
+        log_info("Cold boot: fans at safe duty %d%%\r\n", duty);
+    }
+}
+
+/**
+ * @brief Send rack status when there is something to report
+ * @note  Called every loop iteration (1 ms); state changes go out at once, temperature moves beyond
+ *        REPORT_DEADBAND_C no closer than the BLE TX interval, and a heartbeat covers quiet periods
+ * @param[in] temperature Current rack temperature
+ * @param[in] p_config    Active configuration
+ */
+static void ble_report_status(float temperature, thermal_config_t const *p_config)
+{
+    report_reason_t reason = REPORT_NONE;
+    uint64_t now_us = timebase_now_us();
+    
+#if REPORT_ON_CHANGE_ENABLE
+    if (ble_take_status_subscriber())
+    {
+        telemetry_report_force(&g_status_report);
+    }
+    reason = telemetry_report_check(&g_status_report, temperature, g_temp_sensor_data.cooling_level,
+                                    g_temp_sensor_data.pwm_duty_cycle, g_temp_sensor_data.system_alert_active,
+                                    (uint32_t)(now_us / 1000U), REPORT_DEADBAND_C, p_config->ble_tx_interval_ms,
+                                    REPORT_HEARTBEAT_MS);
+#else
+    /* Fixed cadence against absolute deadlines - no drift from the loop's own run time */
+    if (now_us >= g_ble_tx_deadline_us)
+    {
+        timebase_deadline_advance(&g_ble_tx_deadline_us, (uint64_t)p_config->ble_tx_interval_ms * 1000U, now_us);
+        reason = REPORT_HEARTBEAT;
+    }
+#endif
+    
+    if (REPORT_NONE != reason)
+    {
+        ble_send_temperature_data(temperature,
+                                  telemetry_report_sent(&g_status_report, reason, temperature,
+                                                        g_temp_sensor_data.cooling_level,
+                                                        g_temp_sensor_data.pwm_duty_cycle,
+                                                        g_temp_sensor_data.system_alert_active,
+                                                        (uint32_t)(now_us / 1000U)));
+    }
+}
+
+/**
+ * @brief Start BLE and the telemetry transport once cooling is settled
+ * @note  Deferred until the first control decision, or FAST_BOOT_BLE_DEFER_MAX_MS if none is possible
+ */
+static void fast_boot_start_ble(void)
+{
+    boot_timing_t const *p_timing;
+    
+    ble_app_init();
+    telemetry_transport_open(1000U, (uint32_t)timebase_now_us());
+    g_ble_started = true;
+    autotune_publish();
+    boot_state_mark(BOOT_STAGE_BLE_UP);
+    
+    p_timing = boot_state_get_timing();
+    log_info("Boot timing: PWM %luus, first sample %luus, first decision %luus, BLE %luus\r\n",
+             p_timing->stage_us[BOOT_STAGE_PWM], p_timing->stage_us[BOOT_STAGE_FIRST_SAMPLE],
+             p_timing->stage_us[BOOT_STAGE_FIRST_DECISION], p_timing->stage_us[BOOT_STAGE_BLE_UP]);
+    
+    if (!boot_state_reached(BOOT_STAGE_PWM) || (p_timing->stage_us[BOOT_STAGE_PWM] > FAST_BOOT_PWM_BUDGET_US))
+    {
+        log_warning("Boot: safe duty late or not applied (budget %dus)\r\n", FAST_BOOT_PWM_BUDGET_US);
+    }
+    if (!boot_state_reached(BOOT_STAGE_FIRST_DECISION) ||
+        (p_timing->stage_us[BOOT_STAGE_FIRST_DECISION] > (FAST_BOOT_DECISION_BUDGET_MS * 1000U)))
+    {
+        log_warning("Boot: first decision late or missing (budget %dms)\r\n", FAST_BOOT_DECISION_BUDGET_MS);
+    }
+}
+
 /**
  * @brief Main application loop - Server Rack Thermal Management
  */
@@ -235,53 +919,232 @@ void main_application(void)
 {
     fsp_err_t err = FSP_SUCCESS;
     float current_temperature = 0.0f;
-    uint32_t tick_ms = 0;
+    uint64_t now_us = 0;
+    uint64_t next_sample_us = 0;
+    uint64_t loop_deadline_us = 0;
+    uint64_t last_sample_us = 0;
+    thermal_config_t const *p_config = NULL;
+    bool config_applied = false;
+    uint64_t ble_budget_us = 0;
+    
+    /* STAGE 0: logger ring (a memset), boot clock and timebase, then fans to a safe duty before anything slow */
+    tlog_init();
+    boot_state_begin();
+    
+    /* The IWDT counts from reset (OFS0 auto-start, about 4.4 s) - a hang resets into ble_ota_boot_check() */
+    if (FSP_SUCCESS != R_IWDT_Open(&g_wdt0_ctrl, &g_wdt0_cfg))
+    {
+        log_error("Watchdog open failed - it still runs, so the loop will reset\r\n");
+    }
+    if (FSP_SUCCESS != timebase_init())
+    {
+        log_error("Timebase failed to start - timestamps and deadlines stuck at 0\r\n");
+    }
+    for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+    {
+        fan_energy_init(&g_fan_energy[fan], 1000U, (uint32_t)timebase_now_us());
+    }
+    fast_boot_cooling();
     
     log_info("\r\n╔════════════════════════════════════════╗\r\n");
     log_info("║ RACK THERMAL CONTROL SYSTEM - STARTING ║\r\n");
     log_info("╚════════════════════════════════════════╝\r\n\r\n");
     
+    /* Load thresholds/duty table (data flash or build defaults) */
+    thermal_config_init();
+    
+    /* Count this boot if it is a new image on trial - rolls back one that keeps failing */
+    ble_ota_init();
+    ble_ota_boot_check();
+    
     /* Initialize temperature sensor */
     temp_sensor_init();
+    thermal_trend_init(&g_thermal_trend);
+    adaptive_sampling_init(&g_sample_sched, ADAPTIVE_SAMPLE_MIN_MS, ADAPTIVE_SAMPLE_MAX_MS);
+    g_temp_sensor_data.sample_interval_ms = ADAPTIVE_SAMPLING_ENABLE ? g_sample_sched.interval_ms :
+                                            thermal_config_get()->sample_interval_ms;
+    thermal_stats_init();
+    thermal_anomaly_init(&g_thermal_anomaly);
+    telemetry_report_init(&g_status_report);
+    autotune_init(&g_autotune);
+#if AUTOTUNE_ENABLE
+    autotune_boot();
+#endif
+    fan_energy_trim_init(&g_energy_trim, g_tuning.settle_ms, g_tuning.trim_step);
+    
+    /* Remote monitoring is brought up from the loop once the first decision is made */
+    
+    /* Every period below is scheduled against absolute deadlines on the timebase */
+    now_us = timebase_now_us();
+    next_sample_us = now_us;
+    loop_deadline_us = now_us + BLE_PUMP_LOOP_PERIOD_US;
     
     /* Main control loop */
     while (true)
     {
-        tick_ms++;
+        now_us = timebase_now_us();
+        
+        /* Swap in a configuration staged over BLE - only ever between iterations */
+        config_applied = thermal_config_apply_pending();
+        p_config = thermal_config_get();
         
-        /* STEP 1: Environment Sensing (every 1 second) */
-        if (tick_ms >= TEMP_SAMPLE_INTERVAL_MS)
+        /* Drain ADC samples and run plausibility checks every iteration */
+        temp_sensor_service();
+        thermal_failsafe_update();
+        
+#if AUTOTUNE_ENABLE
+        /* Commissioning autotune - a start samples at once, a fault or abort ends it before the next sample */
+        if (autotune_service(p_config))
+        {
+            next_sample_us = now_us;
+        }
+#endif
+        
+        /* STEP 1: Environment Sensing (adaptive interval; every iteration until the first decision) */
+        if ((now_us >= next_sample_us) || !boot_state_reached(BOOT_STAGE_FIRST_DECISION))
         {
-            tick_ms = 0;
-            
             /* Read current rack temperature */
             err = temp_sensor_read(&current_temperature);
             if (FSP_SUCCESS == err)
             {
+                boot_state_mark(BOOT_STAGE_FIRST_SAMPLE);
+                
+                g_temp_sensor_data.sample_time_us = timebase_now_us();
+                g_temp_sensor_data.previous_temp = g_temp_sensor_data.current_temp;
                 g_temp_sensor_data.current_temp = current_temperature;
                 g_temp_sensor_data.sample_count++;
                 
+                /* A new image that can sense and control is good - end its trial */
+                if (OTA_CONFIRM_SAMPLES == g_temp_sensor_data.sample_count)
+                {
+                    ble_ota_confirm();
+                }
+                
+                /* STEP 2: Trend estimation - O(1) per sample, feeds the predictive fan ramp */
+                thermal_trend_update(&g_thermal_trend, current_temperature,
+                                     (float)(g_temp_sensor_data.sample_time_us - last_sample_us) / 1000000.0f);
+                last_sample_us = g_temp_sensor_data.sample_time_us;
+                g_temp_sensor_data.temp_slope = g_thermal_trend.slope;
+                
+                /* Energy accounting - integrate at least once per sample so the 32-bit µs stamps cannot wrap */
+                for (uint8_t fan = 0; fan < FAN_COUNT; fan++)
+                {
+                    fan_energy_update(&g_fan_energy[fan], (uint32_t)g_temp_sensor_data.sample_time_us);
+                }
+                g_temp_sensor_data.fan_energy_j = fan_energy_total_joules();
+                
                 /* STEP 3: Decision & Control - Update cooling */
                 pwm_control_update(current_temperature);
+                g_temp_sensor_data.decision_time_us = timebase_now_us();
+                boot_state_mark(BOOT_STAGE_FIRST_DECISION);
+                
+                /* Anomaly detection - only on samples the control loop acted on normally (not the autotune steps) */
+                if ((0U == (g_temp_sensor_data.system_alert_active & (SYSTEM_ALERT_SENSOR_FAULT | SYSTEM_ALERT_THERMAL_SHUTDOWN))) &&
+                    !autotune_active(&g_autotune))
+                {
+                    thermal_anomaly_update_alert();
+                }
+                
+                /* STEP 4: Rolling statistics - each sample stands for the interval that led up to it */
+                thermal_stats_update(current_temperature, g_temp_sensor_data.sample_interval_ms,
+                                     p_config->critical_temp);
+                thermal_stats_fill(&g_temp_stats, current_temperature, p_config->critical_temp);
+                if (g_ble_started)
+                {
+                    ble_publish_thermal_stats(g_temp_stats.temperature_status);
+#if TELEMETRY_DIAG_ENABLE
+                    thermal_send_diagnostics(g_temp_stats.temperature_status);
+#endif
+                }
+                
+                /* STEP 5: Next sample - sooner when heading for a threshold, later when settled far from one */
+                g_temp_sensor_data.sample_interval_ms = sample_interval_next(p_config);
+                timebase_deadline_advance(&next_sample_us, (uint64_t)g_temp_sensor_data.sample_interval_ms * 1000U,
+                                          timebase_now_us());
                 
-                log_debug("Rack Temperature: %.1f°C | Sample: %d\r\n", 
-                         current_temperature, g_temp_sensor_data.sample_count);
+                log_debug("Rack Temperature: %.1f°C | Sample: %d | Next: %dms\r\n", 
+                         current_temperature, g_temp_sensor_data.sample_count, g_temp_sensor_data.sample_interval_ms);
+            }
+            else if ((FSP_ERR_UNDERFLOW == err) && !boot_state_reached(BOOT_STAGE_FIRST_DECISION))
+            {
+                /* Oversampler still filling after reset - try again next iteration */
             }
             else
             {
                 log_error("Temperature sensor read FAILED\r\n");
+#if ADAPTIVE_SAMPLING_ENABLE
+                /* Retry at the fastest rate; the interval grows back once reads succeed */
+                adaptive_sampling_restart(&g_sample_sched);
+                g_temp_sensor_data.sample_interval_ms = g_sample_sched.interval_ms;
+#endif
+                timebase_deadline_advance(&next_sample_us, (uint64_t)g_temp_sensor_data.sample_interval_ms * 1000U,
+                                          timebase_now_us());
+                if (g_temp_sensor_data.system_alert_active & SYSTEM_ALERT_SENSOR_FAULT)
+                {
+                    /* Fail-safe has decided for us - boot is not waiting on a plausible sample */
+                    boot_state_mark(BOOT_STAGE_FIRST_DECISION);
+                }
             }
         }
         
-        /* STEP 7: Monitoring Output (BLE update every 500ms) */
-        if (tick_ms % BLE_TX_INTERVAL_MS == 0)
+        /* STEP 7: Monitoring Output (report-by-exception: change, deadband, heartbeat) */
+        if (g_ble_started)
+        {
+            ble_report_status(current_temperature, p_config);
+        }
+        
+        /* Persist a newly applied configuration after the control work is done */
+        if (config_applied)
         {
-            ble_send_temperature_data(current_temperature);
+            thermal_config_persist();
         }
         
+        /* Likewise a new autotune result */
+        if (g_autotune_persist)
+        {
+            g_autotune_persist = false;
+            autotune_store_save(&g_autotune);
+        }
+        
+        /* Cooling state for the next warm boot */
+        boot_state_save(g_temp_sensor_data.cooling_level, g_temp_sensor_data.pwm_duty_cycle,
+                        g_temp_sensor_data.system_alert_active);
+        
+        if (!g_ble_started)
+        {
+            /* Fast boot: BLE comes up once cooling is settled, or at the deadline if it cannot be */
+            if (boot_state_reached(BOOT_STAGE_FIRST_DECISION) || (boot_state_elapsed_ms() >= FAST_BOOT_BLE_DEFER_MAX_MS))
+            {
+                fast_boot_start_ble();
+            }
+        }
+        else
+        {
+            /* BLE event pump - gets what the control work left before the loop deadline, capped.
+             * Control deadlines win: with nothing left the pump is skipped and catches up next iteration. */
+            now_us = timebase_now_us();
+            ble_budget_us = (loop_deadline_us > now_us) ? (loop_deadline_us - now_us) : 0U;
+            if (ble_budget_us > BLE_PUMP_BUDGET_US)
+            {
+                ble_budget_us = BLE_PUMP_BUDGET_US;
+            }
+            ble_app_run((uint32_t)ble_budget_us * TEMP_TIMESTAMP_CYCLES_PER_US);
+            
+            /* Kick queued telemetry (UART) and roll the transport's rate window */
+            telemetry_transport_service((uint32_t)timebase_now_us());
+        }
+        
+        /* Drain deferred log records - formatting happens on the host */
+        tlog_flush();
+        
+        /* One refresh per iteration: a stuck loop - or a new image that never gets here - is reset */
+        R_IWDT_Refresh(&g_wdt0_ctrl);
+        
         /* STEP 6: Feedback Loop - Continuous monitoring */
-        /* Maintain 1ms loop cycle for responsive thermal control */
-        R_BSP_SoftwareDelay(1, BSP_DELAY_UNITS_MILLISECONDS);
+        /* 1ms loop period against an absolute deadline: the control work does not stretch the period, and an
+         * overrun skips the missed slots instead of running them back to back */
+        timebase_delay_until(loop_deadline_us);
+        timebase_deadline_advance(&loop_deadline_us, BLE_PUMP_LOOP_PERIOD_US, timebase_now_us());
     }
 }
 
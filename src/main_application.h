@@ -10,9 +10,20 @@
 
 /* Temperature Sensor Configuration */
 #define TEMP_SENSOR_ENABLE          1
-#define TEMP_SAMPLE_INTERVAL_MS     1000       /* Sample every 1 second */
+#define TEMP_SAMPLE_INTERVAL_MS     1000       /* Sample every 1 second (fixed rate, adaptive sampling off) */
 #define TEMP_ADC_CHANNEL            0
 
+/* ========================================
+   ADAPTIVE SAMPLING
+   Control samples slow down while the rack is
+   stable and far from a threshold, and speed up
+   on a trend toward one (adaptive_sampling.h)
+   ======================================== */
+
+#define ADAPTIVE_SAMPLING_ENABLE    1
+#define ADAPTIVE_SAMPLE_MIN_MS      250        /* Fastest: near a boundary or heading for one */
+#define ADAPTIVE_SAMPLE_MAX_MS      10000      /* Slowest: stable, far from every boundary */
+
 /* ========================================
    THERMAL THRESHOLDS (°C)
    Multi-Level Cooling Control
@@ -37,17 +48,76 @@
 #define PWM_DUTY_CYCLE_HIGH         75         /* High cooling */
 #define PWM_DUTY_CYCLE_EMERGENCY    100        /* Maximum cooling + alarm */
 
+/* Fan channels */
+#define FAN_INTAKE                  0          /* GPT1 - g_timer_pwm_led1 */
+#define FAN_EXHAUST                 1          /* GPT3 - g_timer_pwm_led2 */
+#define FAN_COUNT                   2
+
 /* ========================================
    HYSTERESIS (Prevent Rapid Switching)
    ======================================== */
 
 #define TEMP_HYSTERESIS             1.0f       /* ±1°C hysteresis */
 
+/* ========================================
+   PREDICTIVE CONTROL (Feed-Forward)
+   Fans ramp toward the next level's duty as
+   the temperature trend approaches its threshold
+   ======================================== */
+
+#define PREDICTIVE_CONTROL_ENABLE   1
+#define PREDICT_HORIZON_S           60.0f      /* Start ramping this long before a predicted crossing */
+#define PREDICT_MIN_SLOPE_C_PER_S   0.005f     /* Ignore trends below 0.3°C/min (sensor noise) */
+
+/* ========================================
+   ENERGY-OPTIMAL FAN CONTROL
+   Trims duty below the table value while the
+   temperature holds a margin under the next level
+   ======================================== */
+
+#define ENERGY_OPTIMAL_ENABLE       1
+#define ENERGY_OPT_MARGIN_C         2.0f       /* Keep this far below the level's upper threshold */
+#define ENERGY_OPT_STEP_DUTY        5          /* Duty trim step (%) */
+#define ENERGY_OPT_SETTLE_MS        30000      /* Time to hold the margin before trimming further */
+#define ENERGY_OPT_MIN_DUTY         15         /* Never trim below fan stall duty */
+
+/* ========================================
+   STEP-RESPONSE AUTOTUNE
+   Commissioning: hold a duty, step it, fit a
+   dead time + lag model, retune the horizon
+   and the energy trim from it (defaults above
+   until a result is stored)
+   ======================================== */
+
+#define AUTOTUNE_ENABLE             1
+#define AUTOTUNE_STEP_DUTY          25         /* Duty added for the step (more airflow - cooling only) */
+#define AUTOTUNE_MIN_STEP_DUTY      10         /* Refuse to start with less headroom than this */
+#define AUTOTUNE_SAMPLE_MS          1000       /* Fixed sample interval during the experiment */
+#define AUTOTUNE_LIMIT_MARGIN_C     2.0f       /* Abort this far below the critical temperature */
+#define AUTOTUNE_LOCAL_PIN          BSP_IO_PORT_01_PIN_07  /* PMOD1 GPIO2 commissioning button, active low */
+
+/* ========================================
+   FAST BOOT
+   Fans get a safe duty before anything slow
+   runs; BLE comes up after the first decision
+   ======================================== */
+
+#define FAST_BOOT_SAFE_DUTY         PWM_DUTY_CYCLE_MEDIUM  /* Floor until the first decision (also cold boot) */
+#define FAST_BOOT_BLE_DEFER_MAX_MS  1000       /* Start BLE by now even if no decision was possible */
+#define FAST_BOOT_PWM_BUDGET_US     2000       /* Boot -> safe duty on the pins */
+#define FAST_BOOT_DECISION_BUDGET_MS 50        /* Boot -> first control decision */
+
 /* ========================================
    BLUETOOTH CONFIGURATION
    ======================================== */
 
-#define BLE_TX_INTERVAL_MS          500        /* Send status every 500ms */
+#define BLE_TX_INTERVAL_MS          500        /* Minimum spacing of temperature reports (fixed cadence if report-by-exception is off) */
+
+/* Report-by-Exception - status goes out on a level/duty/alert change at once, on a temperature move
+   beyond the deadband, otherwise only as a heartbeat */
+#define REPORT_ON_CHANGE_ENABLE     1
+#define REPORT_DEADBAND_C           0.3f       /* Temperature move worth a report (above probe noise) */
+#define REPORT_HEARTBEAT_MS         5000       /* Longest silence - half of AGGREGATOR_STALE_MS and the gateway's stale timeout */
 #define MAX_SENSOR_DATA_LEN         20
 #define BLE_DEVICE_NAME             "RackCooler"
 
@@ -58,22 +128,37 @@
 #define SYSTEM_CRITICAL_TEMP        58.0f      /* Critical temperature threshold */
 #define SYSTEM_SHUTDOWN_TEMP        65.0f      /* Emergency shutdown temperature */
 
+/* System Alert Codes (bit flags, sent in the BLE status alert byte) */
+#define SYSTEM_ALERT_NONE           0x00
+#define SYSTEM_ALERT_CRITICAL_TEMP  0x01       /* Temperature above SYSTEM_CRITICAL_TEMP */
+#define SYSTEM_ALERT_SENSOR_FAULT   0x02       /* Sensor implausible - fans forced to full */
+#define SYSTEM_ALERT_THERMAL_SHUTDOWN 0x04     /* Shutdown latched - fan outputs forced by POEG */
+#define SYSTEM_ALERT_ANOMALY        0x08       /* Thermal behaviour anomalous (excursion or slow degradation) */
+
 /* Function declarations */
 void main_application(void);
 void temp_sensor_init(void);
 fsp_err_t temp_sensor_read(float *p_temperature);
 void pwm_control_update(float temperature);
-void ble_send_temperature_data(float temperature);
+void ble_send_temperature_data(float temperature, uint16_t report_seq);
 uint8_t get_cooling_level(float temperature);
 
 /* Temperature data structure */
 typedef struct {
     float current_temp;
     float previous_temp;
+    float temp_slope;              /* Estimated trend (°C/s) */
     uint32_t sample_count;
+    uint32_t sample_interval_ms;   /* Interval the current sample stands for (adaptive) */
+    uint64_t sample_time_us;       /* Timebase time the current sample was taken */
+    uint64_t decision_time_us;     /* Timebase time the last control decision was applied */
     uint8_t pwm_duty_cycle;        /* Current PWM duty cycle (0-100) */
     uint8_t cooling_level;         /* 0=OFF, 1=LOW, 2=MEDIUM, 3=HIGH, 4=EMERGENCY */
-    uint8_t system_alert_active;   /* Alert flag for critical conditions */
+    uint8_t system_alert_active;   /* SYSTEM_ALERT_* bits */
+    uint32_t fan_energy_j;         /* Cumulative estimated fan energy (J) */
+    uint32_t sensor_faults;        /* SENSOR_FAULT_* bits latched by the plausibility layer */
+    uint32_t failsafe_latency_us;      /* Fault sample -> full duty applied, last episode */
+    uint32_t failsafe_latency_max_us;  /* Worst case since boot */
 } temperature_sensor_data_t;
 
 #endif /* __MAIN_APPLICATION_H */
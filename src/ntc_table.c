@@ -0,0 +1,31 @@
+/***********************************************************************************************************************
+ * File Name    : ntc_table.c
+ * Description  : NTC Linearization Table - GENERATED by tools/ntc_table_gen.py, do not edit
+ *
+ * Beta 3950, R0 10000 ohm at 25 °C, series resistor 10000 ohm
+ * Entry i = temperature (°C x 100) at 12-bit counts i << NTC_TABLE_STEP_LOG2
+ **********************************************************************************************************************/
+
+#include "ntc_thermistor.h"
+
+_Static_assert(NTC_TABLE_STEP_LOG2 == 5, "regenerate ntc_table.c for this table step");
+
+const int16_t g_ntc_table[NTC_TABLE_ENTRIES] = {
+     15000,  15000,  15000,  14182,  12932,  12006,  11274,  10671,
+     10160,   9717,   9326,   8977,   8661,   8372,   8107,   7862,
+      7633,   7419,   7218,   7028,   6849,   6678,   6515,   6360,
+      6211,   6068,   5930,   5797,   5669,   5545,   5425,   5309,
+      5196,   5086,   4979,   4874,   4772,   4673,   4575,   4480,
+      4387,   4295,   4205,   4117,   4030,   3944,   3860,   3777,
+      3696,   3615,   3536,   3457,   3379,   3302,   3226,   3151,
+      3077,   3003,   2929,   2857,   2784,   2713,   2641,   2570,
+      2500,   2430,   2360,   2290,   2221,   2152,   2083,   2014,
+      1945,   1876,   1807,   1739,   1670,   1601,   1532,   1463,
+      1393,   1323,   1253,   1183,   1113,   1041,    970,    898,
+       825,    752,    678,    604,    528,    452,    375,    296,
+       217,    136,     54,    -29,   -114,   -200,   -288,   -379,
+      -471,   -566,   -663,   -763,   -867,   -973,  -1084,  -1199,
+     -1318,  -1443,  -1575,  -1713,  -1859,  -2015,  -2182,  -2363,
+     -2560,  -2778,  -3023,  -3304,  -3637,  -4050,  -4603,  -5483,
+     -5500,
+};
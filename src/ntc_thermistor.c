@@ -0,0 +1,225 @@
+/***********************************************************************************************************************
+ * File Name    : ntc_thermistor.c
+ * Description  : NTC Thermistor Linearization - table lookup with linear interpolation (no log() at runtime),
+ *                per-probe offset/gain calibration stored in data flash
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stddef.h>
+#include "common_utils.h"
+#include "ntc_thermistor.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+_Static_assert(sizeof(ntc_cal_t) <= NTC_CAL_FLASH_BLOCK_SIZE, "ntc_cal_t must fit one data flash block");
+
+/* Flash Instance */
+extern flash_ctrl_t g_flash0_ctrl;
+extern const flash_cfg_t g_flash0_cfg;
+
+/* Static variables */
+static ntc_cal_t gs_cal;
+static bool gs_flash_open = false;
+
+/**
+ * @brief CRC-32 (IEEE, bitwise - only runs on calibration load/store)
+ */
+static uint32_t ntc_cal_crc(ntc_cal_t const *p_cal)
+{
+    uint8_t const *p_byte = (uint8_t const *)p_cal;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0; i < offsetof(ntc_cal_t, crc); i++)
+    {
+        crc ^= p_byte[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Check one probe's calibration is within what a healthy unit needs
+ */
+static bool ntc_cal_valid(float gain, float offset)
+{
+    return (gain >= NTC_CAL_MIN_GAIN) && (gain <= NTC_CAL_MAX_GAIN) &&
+           (offset >= -NTC_CAL_MAX_OFFSET) && (offset <= NTC_CAL_MAX_OFFSET);
+}
+
+/**
+ * @brief Linearize ADC counts
+ * @param[in] counts     ADC result with extra_bits of oversampling (full scale 4095 << extra_bits)
+ * @param[in] extra_bits Oversampling bits beyond 12
+ * @return Temperature in °C x 100 (uncalibrated)
+ */
+int32_t ntc_counts_to_centi_celsius(uint32_t counts, uint8_t extra_bits)
+{
+    uint32_t shift = NTC_TABLE_STEP_LOG2 + extra_bits;
+    uint32_t index = counts >> shift;
+    int32_t frac = (int32_t)(counts & ((1UL << shift) - 1U));
+    int32_t span;
+
+    if (index >= (NTC_TABLE_ENTRIES - 1U))
+    {
+        return g_ntc_table[NTC_TABLE_ENTRIES - 1U];
+    }
+
+    span = (int32_t)g_ntc_table[index + 1U] - (int32_t)g_ntc_table[index];
+    return (int32_t)g_ntc_table[index] + ((span * frac) / (int32_t)(1UL << shift));
+}
+
+/**
+ * @brief Inverse linearization (table search, no log())
+ * @param[in] centi_celsius Temperature in °C x 100 (uncalibrated)
+ * @return 12-bit ADC counts the probe produces at that temperature, clamped to the table range
+ */
+uint16_t ntc_centi_celsius_to_counts(int32_t centi_celsius)
+{
+    uint32_t low = 0;
+    uint32_t high = NTC_TABLE_ENTRIES - 1U;
+    uint32_t mid;
+    int32_t span;
+
+    /* Table falls with counts */
+    if (centi_celsius >= g_ntc_table[0])
+    {
+        return 0;
+    }
+    if (centi_celsius <= g_ntc_table[NTC_TABLE_ENTRIES - 1U])
+    {
+        return 4095U;
+    }
+
+    /* Invariant: table[low] > centi_celsius >= table[high] */
+    while ((high - low) > 1U)
+    {
+        mid = (low + high) / 2U;
+        if (g_ntc_table[mid] > centi_celsius)
+        {
+            low = mid;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    span = (int32_t)g_ntc_table[low] - (int32_t)g_ntc_table[high];
+    mid = (low << NTC_TABLE_STEP_LOG2) +
+          (uint32_t)((((int32_t)g_ntc_table[low] - centi_celsius) << NTC_TABLE_STEP_LOG2) / span);
+
+    return (mid > 4095U) ? 4095U : (uint16_t)mid;
+}
+
+/**
+ * @brief Load per-unit calibration from data flash (identity if none is stored)
+ */
+void ntc_cal_init(void)
+{
+    ntc_cal_t const *p_stored = (ntc_cal_t const *)NTC_CAL_FLASH_ADDR;
+    fsp_err_t err;
+    bool valid;
+
+    err = R_FLASH_HP_Open(&g_flash0_ctrl, &g_flash0_cfg);
+    gs_flash_open = (FSP_SUCCESS == err) || (FSP_ERR_ALREADY_OPEN == err);
+
+    valid = gs_flash_open && (NTC_CAL_MAGIC == p_stored->magic) && (ntc_cal_crc(p_stored) == p_stored->crc);
+    for (uint8_t probe = 0; valid && (probe < NTC_CAL_MAX_PROBES); probe++)
+    {
+        valid = ntc_cal_valid(p_stored->gain[probe], p_stored->offset[probe]);
+    }
+
+    if (valid)
+    {
+        gs_cal = *p_stored;
+        log_info("NTC calibration: loaded from data flash\r\n");
+    }
+    else
+    {
+        memset(&gs_cal, 0, sizeof(gs_cal));
+        gs_cal.magic = NTC_CAL_MAGIC;
+        for (uint8_t probe = 0; probe < NTC_CAL_MAX_PROBES; probe++)
+        {
+            gs_cal.gain[probe] = 1.0f;
+            gs_cal.offset[probe] = 0.0f;
+        }
+        gs_cal.crc = ntc_cal_crc(&gs_cal);
+        log_info("NTC calibration: none stored, using nominal curve\r\n");
+    }
+}
+
+/**
+ * @brief Apply a probe's calibration to a table temperature
+ */
+float ntc_cal_apply(uint8_t probe, float temperature)
+{
+    if (probe >= NTC_CAL_MAX_PROBES)
+    {
+        return temperature;
+    }
+    return (gs_cal.gain[probe] * temperature) + gs_cal.offset[probe];
+}
+
+/**
+ * @brief Map a calibrated temperature back to the table temperature (for thresholds in counts)
+ */
+float ntc_cal_remove(uint8_t probe, float temperature)
+{
+    if (probe >= NTC_CAL_MAX_PROBES)
+    {
+        return temperature;
+    }
+    return (temperature - gs_cal.offset[probe]) / gs_cal.gain[probe];
+}
+
+/**
+ * @brief Set a probe's calibration (end-of-line test); takes effect immediately, persist separately
+ * @param[in] probe  Probe index
+ * @param[in] gain   Slope correction
+ * @param[in] offset Offset correction (°C)
+ * @return FSP_ERR_INVALID_ARGUMENT if outside the accepted range
+ */
+fsp_err_t ntc_cal_set(uint8_t probe, float gain, float offset)
+{
+    if ((probe >= NTC_CAL_MAX_PROBES) || !ntc_cal_valid(gain, offset))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    gs_cal.gain[probe] = gain;
+    gs_cal.offset[probe] = offset;
+    gs_cal.crc = ntc_cal_crc(&gs_cal);
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Write the calibration to data flash
+ * @note  Blocking erase+write of one data flash block; call outside the control step
+ */
+fsp_err_t ntc_cal_persist(void)
+{
+    fsp_err_t err;
+    uint32_t block[NTC_CAL_FLASH_BLOCK_SIZE / sizeof(uint32_t)];
+
+    if (!gs_flash_open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+
+    memset(block, 0xFF, sizeof(block));
+    memcpy(block, &gs_cal, sizeof(gs_cal));
+
+    err = R_FLASH_HP_Erase(&g_flash0_ctrl, NTC_CAL_FLASH_ADDR, 1);
+    if (FSP_SUCCESS == err)
+    {
+        err = R_FLASH_HP_Write(&g_flash0_ctrl, (uint32_t)block, NTC_CAL_FLASH_ADDR, sizeof(block));
+    }
+    if (FSP_SUCCESS != err)
+    {
+        log_error("NTC calibration: flash write FAILED\r\n");
+    }
+    return err;
+}
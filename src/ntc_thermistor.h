@@ -0,0 +1,46 @@
+/***********************************************************************************************************************
+ * File Name    : ntc_thermistor.h
+ * Description  : NTC Thermistor Linearization - table lookup with linear interpolation (no log() at runtime),
+ *                per-probe offset/gain calibration stored in data flash
+ **********************************************************************************************************************/
+
+#ifndef NTC_THERMISTOR_H_
+#define NTC_THERMISTOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+/* Linearization Table (ntc_table.c, generated by tools/ntc_table_gen.py)
+ * Entry i holds °C x 100 at 12-bit counts i << NTC_TABLE_STEP_LOG2; the last entry is at full scale. */
+#define NTC_TABLE_STEP_LOG2             (5U)
+#define NTC_TABLE_ENTRIES               ((4096U >> NTC_TABLE_STEP_LOG2) + 1U)
+
+extern const int16_t g_ntc_table[NTC_TABLE_ENTRIES];
+
+/* Per-Unit Calibration: T = gain * T_table + offset */
+#define NTC_CAL_MAX_PROBES              (2U)
+#define NTC_CAL_FLASH_ADDR              (0x08000080UL)      /* Data flash block after the OTA boot record */
+#define NTC_CAL_FLASH_BLOCK_SIZE        (64U)
+#define NTC_CAL_MAGIC                   (0x4E43414CUL)      /* "NCAL" */
+#define NTC_CAL_MIN_GAIN                (0.90f)
+#define NTC_CAL_MAX_GAIN                (1.10f)
+#define NTC_CAL_MAX_OFFSET              (5.0f)              /* °C */
+
+typedef struct {
+    uint32_t magic;
+    float gain[NTC_CAL_MAX_PROBES];
+    float offset[NTC_CAL_MAX_PROBES];
+    uint32_t crc;
+} ntc_cal_t;
+
+/* Function Declarations */
+int32_t ntc_counts_to_centi_celsius(uint32_t counts, uint8_t extra_bits);
+uint16_t ntc_centi_celsius_to_counts(int32_t centi_celsius);
+void ntc_cal_init(void);
+float ntc_cal_apply(uint8_t probe, float temperature);
+float ntc_cal_remove(uint8_t probe, float temperature);
+fsp_err_t ntc_cal_set(uint8_t probe, float gain, float offset);
+fsp_err_t ntc_cal_persist(void);
+
+#endif /* NTC_THERMISTOR_H_ */
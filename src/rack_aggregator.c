@@ -0,0 +1,186 @@
+/***********************************************************************************************************************
+ * File Name    : rack_aggregator.c
+ * Description  : Row Aggregator - per-rack status table built from neighbouring racks' advertisements,
+ *                summarised into one row-level record (hottest rack, alert count, mean duty)
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include "rack_aggregator.h"
+
+/* Static variables - fixed footprint: AGGREGATOR_MAX_RACKS entries + a presence bitmap */
+static rack_entry_t gs_racks[AGGREGATOR_MAX_RACKS];
+static uint64_t gs_present;
+
+/**
+ * @brief Clear the rack table
+ */
+void rack_aggregator_init(void)
+{
+    memset(gs_racks, 0, sizeof(gs_racks));
+    gs_present = 0;
+}
+
+/**
+ * @brief Encode this rack's status as a manufacturer specific AD structure
+ * @param[out] p_buf At least RACK_ADV_AD_LEN bytes
+ * @return Bytes written (RACK_ADV_AD_LEN)
+ */
+uint8_t rack_aggregator_encode_adv(uint8_t *p_buf, uint8_t rack_id, int16_t temperature,
+                                   uint8_t cooling_level, uint8_t duty, uint8_t alert)
+{
+    p_buf[0] = RACK_ADV_AD_LEN - 1U;
+    p_buf[1] = RACK_ADV_AD_TYPE_MANUFACTURER;
+    p_buf[2] = (uint8_t)(RACK_ADV_COMPANY_ID & 0xFF);
+    p_buf[3] = (uint8_t)(RACK_ADV_COMPANY_ID >> 8);
+    p_buf[4] = rack_id;
+    p_buf[5] = (uint8_t)((uint16_t)temperature & 0xFF);
+    p_buf[6] = (uint8_t)((uint16_t)temperature >> 8);
+    p_buf[7] = cooling_level;
+    p_buf[8] = duty;
+    p_buf[9] = alert;
+
+    return RACK_ADV_AD_LEN;
+}
+
+/**
+ * @brief Scan an advertising/scan-response payload for a rack status AD structure and record it
+ * @param[in] p_data AD structures as received
+ * @param[in] len    Payload length
+ * @param[in] rssi   Report RSSI (dBm)
+ * @param[in] now_ms Current time (ms)
+ * @return FSP_SUCCESS if a rack status was recorded, FSP_ERR_NOT_FOUND otherwise
+ */
+fsp_err_t rack_aggregator_parse_adv(uint8_t const *p_data, uint8_t len, int8_t rssi, uint32_t now_ms)
+{
+    uint8_t pos = 0;
+    rack_entry_t entry;
+
+    while ((pos + 1U) < len)
+    {
+        uint8_t ad_len = p_data[pos];
+
+        if ((0U == ad_len) || ((uint16_t)pos + 1U + ad_len > len))
+        {
+            break;
+        }
+
+        if ((RACK_ADV_AD_LEN - 1U == ad_len) &&
+            (RACK_ADV_AD_TYPE_MANUFACTURER == p_data[pos + 1U]) &&
+            (RACK_ADV_COMPANY_ID == (uint16_t)(p_data[pos + 2U] | (p_data[pos + 3U] << 8))) &&
+            (p_data[pos + 4U] < AGGREGATOR_MAX_RACKS))
+        {
+            entry.temperature    = (int16_t)(p_data[pos + 5U] | (p_data[pos + 6U] << 8));
+            entry.cooling_level  = p_data[pos + 7U];
+            entry.pwm_duty_cycle = p_data[pos + 8U];
+            entry.system_alert   = p_data[pos + 9U];
+            entry.rssi           = rssi;
+            entry.last_seen_ms   = now_ms;
+            rack_aggregator_update(p_data[pos + 4U], &entry);
+            return FSP_SUCCESS;
+        }
+
+        pos = (uint8_t)(pos + 1U + ad_len);
+    }
+
+    return FSP_ERR_NOT_FOUND;
+}
+
+/**
+ * @brief Record a rack's latest status - O(1)
+ * @param[in] rack_id Rack ID (< AGGREGATOR_MAX_RACKS, others ignored)
+ */
+void rack_aggregator_update(uint8_t rack_id, rack_entry_t const *p_entry)
+{
+    if (rack_id >= AGGREGATOR_MAX_RACKS)
+    {
+        return;
+    }
+
+    gs_racks[rack_id] = *p_entry;
+    gs_present |= (1ULL << rack_id);
+}
+
+/**
+ * @brief Latest status of one rack
+ * @return Entry, or NULL if never heard from or stale
+ */
+rack_entry_t const *rack_aggregator_get(uint8_t rack_id, uint32_t now_ms)
+{
+    if ((rack_id >= AGGREGATOR_MAX_RACKS) ||
+        (0U == (gs_present & (1ULL << rack_id))) ||
+        ((now_ms - gs_racks[rack_id].last_seen_ms) > AGGREGATOR_STALE_MS))
+    {
+        return NULL;
+    }
+
+    return &gs_racks[rack_id];
+}
+
+/**
+ * @brief Row summary over the racks heard from recently - O(AGGREGATOR_MAX_RACKS), call at publish rate only
+ * @param[in]  now_ms    Current time (ms)
+ * @param[out] p_summary Summary
+ */
+void rack_aggregator_summarize(uint32_t now_ms, row_summary_t *p_summary)
+{
+    uint32_t duty_sum = 0;
+    uint64_t present = gs_present;
+
+    memset(p_summary, 0, sizeof(*p_summary));
+    p_summary->hottest_temperature = INT16_MIN;
+
+    while (0U != present)
+    {
+        uint8_t rack_id = (uint8_t)__builtin_ctzll(present);
+        rack_entry_t const *p_rack = &gs_racks[rack_id];
+
+        present &= present - 1U;
+
+        if ((now_ms - p_rack->last_seen_ms) > AGGREGATOR_STALE_MS)
+        {
+            /* Aged out - forget it so the bitmap only holds live racks */
+            gs_present &= ~(1ULL << rack_id);
+            continue;
+        }
+
+        p_summary->racks_reporting++;
+        duty_sum += p_rack->pwm_duty_cycle;
+        if (0U != p_rack->system_alert)
+        {
+            p_summary->alert_count++;
+        }
+        if (p_rack->temperature > p_summary->hottest_temperature)
+        {
+            p_summary->hottest_temperature = p_rack->temperature;
+            p_summary->hottest_rack = rack_id;
+        }
+    }
+
+    if (p_summary->racks_reporting > 0U)
+    {
+        p_summary->mean_duty = (uint8_t)((duty_sum + (p_summary->racks_reporting / 2U)) / p_summary->racks_reporting);
+    }
+    else
+    {
+        p_summary->hottest_temperature = 0;
+    }
+}
+
+/**
+ * @brief Row summary wire format:
+ *        racks_reporting, hottest_rack, hottest_temperature (int16 LE, °C × 100), alert_count, mean_duty, reserved
+ * @param[out] p_buf At least ROW_SUMMARY_WIRE_SIZE bytes
+ * @return Bytes written
+ */
+uint8_t rack_aggregator_serialize_summary(row_summary_t const *p_summary, uint8_t *p_buf)
+{
+    p_buf[0] = p_summary->racks_reporting;
+    p_buf[1] = p_summary->hottest_rack;
+    p_buf[2] = (uint8_t)((uint16_t)p_summary->hottest_temperature & 0xFF);
+    p_buf[3] = (uint8_t)((uint16_t)p_summary->hottest_temperature >> 8);
+    p_buf[4] = p_summary->alert_count;
+    p_buf[5] = p_summary->mean_duty;
+    p_buf[6] = 0;
+
+    return ROW_SUMMARY_WIRE_SIZE;
+}
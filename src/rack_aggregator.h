@@ -0,0 +1,57 @@
+/***********************************************************************************************************************
+ * File Name    : rack_aggregator.h
+ * Description  : Row Aggregator - per-rack status table built from neighbouring racks' advertisements,
+ *                summarised into one row-level record (hottest rack, alert count, mean duty)
+ **********************************************************************************************************************/
+
+#ifndef RACK_AGGREGATOR_H_
+#define RACK_AGGREGATOR_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+/* Table - indexed directly by rack ID, so an update is a single store */
+#define AGGREGATOR_MAX_RACKS            (64U)
+#define AGGREGATOR_STALE_MS             (10000U)    /* Racks not heard from for this long drop out of the summary */
+
+/* Rack status advertisement - manufacturer specific AD structure in the scan response
+ *   [0] length (RACK_ADV_AD_LEN - 1)   [1] 0xFF   [2..3] company ID (LE)
+ *   [4] rack ID   [5..6] temperature °C × 100 (LE)   [7] cooling level   [8] duty   [9] alert bits */
+#define RACK_ADV_COMPANY_ID             (0xFFFFU)   /* Bluetooth SIG "no company" ID - internal use */
+#define RACK_ADV_AD_TYPE_MANUFACTURER   (0xFFU)
+#define RACK_ADV_AD_LEN                 (10U)
+
+/* Row summary characteristic layout */
+#define ROW_SUMMARY_WIRE_SIZE           (7U)
+
+/* Latest status of one rack */
+typedef struct {
+    int16_t temperature;        /* °C × 100 */
+    uint8_t cooling_level;
+    uint8_t pwm_duty_cycle;
+    uint8_t system_alert;       /* SYSTEM_ALERT_* bits */
+    int8_t rssi;                /* dBm at the aggregator */
+    uint32_t last_seen_ms;
+} rack_entry_t;
+
+/* Row-level summary */
+typedef struct {
+    uint8_t racks_reporting;    /* Racks heard from within AGGREGATOR_STALE_MS */
+    uint8_t hottest_rack;       /* Rack ID of the hottest rack (valid if racks_reporting > 0) */
+    int16_t hottest_temperature;/* °C × 100 */
+    uint8_t alert_count;        /* Racks with any alert bit set */
+    uint8_t mean_duty;          /* Mean fan duty (%) */
+} row_summary_t;
+
+/* Function Declarations */
+void rack_aggregator_init(void);
+uint8_t rack_aggregator_encode_adv(uint8_t *p_buf, uint8_t rack_id, int16_t temperature,
+                                   uint8_t cooling_level, uint8_t duty, uint8_t alert);
+fsp_err_t rack_aggregator_parse_adv(uint8_t const *p_data, uint8_t len, int8_t rssi, uint32_t now_ms);
+void rack_aggregator_update(uint8_t rack_id, rack_entry_t const *p_entry);
+rack_entry_t const *rack_aggregator_get(uint8_t rack_id, uint32_t now_ms);
+void rack_aggregator_summarize(uint32_t now_ms, row_summary_t *p_summary);
+uint8_t rack_aggregator_serialize_summary(row_summary_t const *p_summary, uint8_t *p_buf);
+
+#endif /* RACK_AGGREGATOR_H_ */
@@ -0,0 +1,89 @@
+/***********************************************************************************************************************
+ * File Name    : sample_ring.c
+ * Description  : Lock-free SPSC ring buffer for ADC samples (ISR producer -> main loop consumer)
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include "sample_ring.h"
+
+/**
+ * @brief Reset ring to empty and clear counters
+ * @param[in] p_ring Ring instance
+ */
+void sample_ring_init(sample_ring_t *p_ring)
+{
+    memset(p_ring->buf, 0, sizeof(p_ring->buf));
+    atomic_store_explicit(&p_ring->head, 0U, memory_order_relaxed);
+    atomic_store_explicit(&p_ring->tail, 0U, memory_order_relaxed);
+    p_ring->overruns = 0U;
+    p_ring->high_water = 0U;
+}
+
+/**
+ * @brief Push one sample (producer side - call from ISR only)
+ * @param[in] p_ring   Ring instance
+ * @param[in] p_sample Sample to store
+ * @return true if stored, false if the ring was full and the sample was dropped
+ */
+bool sample_ring_push(sample_ring_t *p_ring, temp_sample_t const *p_sample)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&p_ring->head, memory_order_relaxed);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&p_ring->tail, memory_order_acquire);
+
+    if ((head - tail) >= SAMPLE_RING_SIZE)
+    {
+        /* Consumer fell behind - drop newest, never touch tail from this side */
+        p_ring->overruns++;
+        return false;
+    }
+
+    p_ring->buf[head & SAMPLE_RING_MASK] = *p_sample;
+
+    /* Publish slot contents before the new head becomes visible */
+    atomic_store_explicit(&p_ring->head, head + 1U, memory_order_release);
+    return true;
+}
+
+/**
+ * @brief Drain up to max_samples in one pass (consumer side - main loop only)
+ * @param[in]  p_ring      Ring instance
+ * @param[out] p_out       Destination array
+ * @param[in]  max_samples Capacity of p_out
+ * @return Number of samples copied out
+ */
+uint32_t sample_ring_pop_batch(sample_ring_t *p_ring, temp_sample_t *p_out, uint32_t max_samples)
+{
+    uint32_t tail = (uint32_t)atomic_load_explicit(&p_ring->tail, memory_order_relaxed);
+    uint32_t head = (uint32_t)atomic_load_explicit(&p_ring->head, memory_order_acquire);
+    uint32_t available = head - tail;
+    uint32_t count;
+
+    if (available > p_ring->high_water)
+    {
+        p_ring->high_water = available;
+    }
+
+    count = (available < max_samples) ? available : max_samples;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        p_out[i] = p_ring->buf[(tail + i) & SAMPLE_RING_MASK];
+    }
+
+    /* Release the slots only after they have been copied out */
+    atomic_store_explicit(&p_ring->tail, tail + count, memory_order_release);
+    return count;
+}
+
+/**
+ * @brief Current fill level
+ * @param[in] p_ring Ring instance
+ * @return Number of samples waiting to be drained
+ */
+uint32_t sample_ring_count(sample_ring_t *p_ring)
+{
+    uint32_t head = (uint32_t)atomic_load_explicit(&p_ring->head, memory_order_acquire);
+    uint32_t tail = (uint32_t)atomic_load_explicit(&p_ring->tail, memory_order_acquire);
+
+    return head - tail;
+}
@@ -0,0 +1,42 @@
+/***********************************************************************************************************************
+ * File Name    : sample_ring.h
+ * Description  : Lock-free SPSC ring buffer for ADC samples (ISR producer -> main loop consumer)
+ **********************************************************************************************************************/
+
+#ifndef SAMPLE_RING_H_
+#define SAMPLE_RING_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+/* Ring capacity in samples - must be a power of two */
+#define SAMPLE_RING_SIZE            (64U)
+#define SAMPLE_RING_MASK            (SAMPLE_RING_SIZE - 1U)
+
+_Static_assert((SAMPLE_RING_SIZE & SAMPLE_RING_MASK) == 0U, "SAMPLE_RING_SIZE must be a power of two");
+
+/* Single timestamped ADC sample */
+typedef struct {
+    uint32_t timestamp;         /* CPU cycle count at scan complete */
+    uint16_t raw;               /* Raw ADC counts */
+    uint16_t channel;           /* ADC channel the sample was taken on */
+} temp_sample_t;
+
+/* Ring state. head/tail are free-running and only masked on access, so
+ * (head - tail) is always the fill level even across 32-bit wrap. */
+typedef struct {
+    temp_sample_t buf[SAMPLE_RING_SIZE];
+    atomic_uint_fast32_t head;  /* Written by producer only */
+    atomic_uint_fast32_t tail;  /* Written by consumer only */
+    volatile uint32_t overruns; /* Samples dropped because the ring was full */
+    uint32_t high_water;        /* Highest fill level seen by the consumer */
+} sample_ring_t;
+
+/* Function Declarations */
+void sample_ring_init(sample_ring_t *p_ring);
+bool sample_ring_push(sample_ring_t *p_ring, temp_sample_t const *p_sample);
+uint32_t sample_ring_pop_batch(sample_ring_t *p_ring, temp_sample_t *p_out, uint32_t max_samples);
+uint32_t sample_ring_count(sample_ring_t *p_ring);
+
+#endif /* SAMPLE_RING_H_ */
@@ -0,0 +1,194 @@
+/***********************************************************************************************************************
+ * File Name    : sensor_fault.c
+ * Description  : Rack Temperature Sensor Plausibility Checks (open/short, slew, stuck, stale, cross-check)
+ *                Pure logic - no HAL access, all time comes in through timestamps.
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stdint.h>
+#include "system_config.h"
+#include "sensor_fault.h"
+
+/**
+ * @brief Latch fault bits and open a new fault episode if none is active
+ */
+static void sensor_fault_raise(sensor_fault_ctx_t *p_ctx, uint32_t bits, uint32_t timestamp)
+{
+    if (SENSOR_FAULT_NONE == p_ctx->active)
+    {
+        p_ctx->fault_timestamp = timestamp;
+        p_ctx->fault_events++;
+    }
+
+    p_ctx->active |= bits;
+    p_ctx->last_fault_timestamp = timestamp;
+}
+
+/**
+ * @brief Reset plausibility state
+ * @param[in] p_ctx         Context
+ * @param[in] cycles_per_ms Timestamp ticks per millisecond
+ * @param[in] hw_add_count  ADC conversions summed into each raw value
+ * @param[in] now           Current timestamp (starts the stale timers)
+ */
+void sensor_fault_init(sensor_fault_ctx_t *p_ctx, uint32_t cycles_per_ms, uint32_t hw_add_count, uint32_t now)
+{
+    memset(p_ctx, 0, sizeof(*p_ctx));
+    p_ctx->cycles_per_ms = cycles_per_ms;
+    p_ctx->hw_add_count = (0U == hw_add_count) ? 1U : hw_add_count;
+
+    for (uint8_t i = 0; i < SENSOR_FAULT_MAX_PROBES; i++)
+    {
+        p_ctx->last_sample_timestamp[i] = now;
+        p_ctx->stuck_since[i] = now;
+    }
+}
+
+/**
+ * @brief Per-scan checks on raw counts: rail-stuck (open/short) and stuck-value
+ * @param[in] p_ctx     Context
+ * @param[in] probe     Probe index (0 = primary)
+ * @param[in] raw       Scan result
+ * @param[in] timestamp Sample timestamp
+ */
+void sensor_fault_check_raw(sensor_fault_ctx_t *p_ctx, uint8_t probe, uint16_t raw, uint32_t timestamp)
+{
+    uint32_t stuck_limit = TEMP_SENSOR_TIMEOUT_MS * p_ctx->cycles_per_ms;
+
+    if (probe >= SENSOR_FAULT_MAX_PROBES)
+    {
+        return;
+    }
+
+    p_ctx->last_sample_timestamp[probe] = timestamp;
+
+    /* Open/short: value pinned against either rail */
+    if ((uint32_t)raw <= (SENSOR_RAIL_LOW_COUNTS * p_ctx->hw_add_count))
+    {
+        sensor_fault_raise(p_ctx, SENSOR_FAULT_RAIL_LOW, timestamp);
+    }
+    else if ((uint32_t)raw >= (SENSOR_RAIL_HIGH_COUNTS * p_ctx->hw_add_count))
+    {
+        sensor_fault_raise(p_ctx, SENSOR_FAULT_RAIL_HIGH, timestamp);
+    }
+
+    /* Stuck: a live ADC input always shows some LSB noise */
+    if (raw != p_ctx->stuck_raw[probe])
+    {
+        p_ctx->stuck_raw[probe] = raw;
+        p_ctx->stuck_since[probe] = timestamp;
+    }
+    else if ((timestamp - p_ctx->stuck_since[probe]) >= stuck_limit)
+    {
+        sensor_fault_raise(p_ctx, SENSOR_FAULT_STUCK, timestamp);
+    }
+}
+
+/**
+ * @brief Per-reading checks on converted temperature: rate-of-change and redundant-probe cross-check
+ * @param[in] p_ctx       Context
+ * @param[in] probe       Probe index (0 = primary)
+ * @param[in] temperature Converted reading in Celsius
+ * @param[in] timestamp   Timestamp of the last sample folded into the reading
+ */
+void sensor_fault_check_reading(sensor_fault_ctx_t *p_ctx, uint8_t probe, float temperature, uint32_t timestamp)
+{
+    float delta;
+    float elapsed_ms;
+    float window_ms;
+
+    if (probe >= SENSOR_FAULT_MAX_PROBES)
+    {
+        return;
+    }
+
+    /* Rate of change against the reading that opened the current window. A window shorter than
+     * SENSOR_SLEW_WINDOW_MS is judged as if it were that long, so LSB jitter between readings a few ms apart
+     * never adds up to a slew, while a jump bigger than a whole window's allowance still trips at once. */
+    if (p_ctx->have_temp[probe])
+    {
+        delta = temperature - p_ctx->slew_ref_temp[probe];
+        delta = (delta < 0.0f) ? -delta : delta;
+        elapsed_ms = (float)(timestamp - p_ctx->slew_ref_timestamp[probe]) / (float)p_ctx->cycles_per_ms;
+        window_ms = (elapsed_ms < (float)SENSOR_SLEW_WINDOW_MS) ? (float)SENSOR_SLEW_WINDOW_MS : elapsed_ms;
+
+        if ((delta * 1000.0f) > ((SENSOR_MAX_SLEW_C_PER_S * window_ms) + (SENSOR_SLEW_NOISE_C * 1000.0f)))
+        {
+            sensor_fault_raise(p_ctx, SENSOR_FAULT_SLEW, timestamp);
+        }
+        if (elapsed_ms >= (float)SENSOR_SLEW_WINDOW_MS)
+        {
+            p_ctx->slew_ref_temp[probe] = temperature;
+            p_ctx->slew_ref_timestamp[probe] = timestamp;
+        }
+    }
+    else
+    {
+        p_ctx->slew_ref_temp[probe] = temperature;
+        p_ctx->slew_ref_timestamp[probe] = timestamp;
+    }
+
+    p_ctx->last_temp[probe] = temperature;
+    p_ctx->have_temp[probe] = true;
+
+    /* Cross-check on every primary reading once the redundant probe has reported */
+    if ((0U == probe) && p_ctx->have_temp[1])
+    {
+        delta = p_ctx->last_temp[0] - p_ctx->last_temp[1];
+        delta = (delta < 0.0f) ? -delta : delta;
+
+        if (delta > SENSOR_CROSSCHECK_MAX_DELTA_C)
+        {
+            if (p_ctx->crosscheck_count < SENSOR_CROSSCHECK_PERSIST)
+            {
+                p_ctx->crosscheck_count++;
+            }
+            if (p_ctx->crosscheck_count >= SENSOR_CROSSCHECK_PERSIST)
+            {
+                sensor_fault_raise(p_ctx, SENSOR_FAULT_CROSSCHECK, timestamp);
+            }
+        }
+        else
+        {
+            p_ctx->crosscheck_count = 0;
+        }
+    }
+}
+
+/**
+ * @brief Time-driven checks: stale input and fault auto-clear. Call every loop iteration.
+ * @param[in] p_ctx      Context
+ * @param[in] num_probes Number of probes expected to deliver samples
+ * @param[in] now        Current timestamp
+ */
+void sensor_fault_check_timeout(sensor_fault_ctx_t *p_ctx, uint8_t num_probes, uint32_t now)
+{
+    uint32_t stale_limit = TEMP_SENSOR_TIMEOUT_MS * p_ctx->cycles_per_ms;
+    uint32_t clear_limit = SENSOR_FAULT_CLEAR_MS * p_ctx->cycles_per_ms;
+
+    for (uint8_t i = 0; (i < num_probes) && (i < SENSOR_FAULT_MAX_PROBES); i++)
+    {
+        if ((now - p_ctx->last_sample_timestamp[i]) >= stale_limit)
+        {
+            sensor_fault_raise(p_ctx, SENSOR_FAULT_STALE, now);
+
+            /* Re-arm so the episode stays confirmed without the difference wrapping */
+            p_ctx->last_sample_timestamp[i] = now - stale_limit;
+        }
+    }
+
+    /* Faults stay latched until the inputs have been plausible for a full clear period */
+    if ((SENSOR_FAULT_NONE != p_ctx->active) && ((now - p_ctx->last_fault_timestamp) >= clear_limit))
+    {
+        p_ctx->active = SENSOR_FAULT_NONE;
+        p_ctx->crosscheck_count = 0;
+    }
+}
+
+/**
+ * @brief Get latched fault bits
+ */
+uint32_t sensor_fault_active(sensor_fault_ctx_t const *p_ctx)
+{
+    return p_ctx->active;
+}
@@ -0,0 +1,57 @@
+/***********************************************************************************************************************
+ * File Name    : sensor_fault.h
+ * Description  : Rack Temperature Sensor Plausibility Checks (open/short, slew, stuck, stale, cross-check)
+ **********************************************************************************************************************/
+
+#ifndef SENSOR_FAULT_H_
+#define SENSOR_FAULT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Plausibility Limits */
+#define SENSOR_RAIL_LOW_COUNTS          (16U)       /* 12-bit counts at/below: input shorted to GND or open */
+#define SENSOR_RAIL_HIGH_COUNTS         (4079U)     /* 12-bit counts at/above: input shorted to VREF or open */
+#define SENSOR_MAX_SLEW_C_PER_S         (5.0f)      /* Rack air cannot physically change faster */
+#define SENSOR_SLEW_WINDOW_MS           (100U)      /* Slew measured over at least this long, not reading to reading */
+#define SENSOR_SLEW_NOISE_C             (0.25f)     /* Allowance for conversion noise on top of the slew limit */
+#define SENSOR_CROSSCHECK_MAX_DELTA_C   (3.0f)      /* Max disagreement between redundant probes */
+#define SENSOR_CROSSCHECK_PERSIST       (3U)        /* Consecutive disagreeing readings before fault */
+#define SENSOR_FAULT_CLEAR_MS           (10000U)    /* Fault-free time required before auto-clear */
+#define SENSOR_FAULT_MAX_PROBES         (2U)
+
+/* Fault Bits */
+#define SENSOR_FAULT_NONE               (0x00U)
+#define SENSOR_FAULT_RAIL_LOW           (0x01U)     /* Reading pinned at 0V */
+#define SENSOR_FAULT_RAIL_HIGH          (0x02U)     /* Reading pinned at VREF */
+#define SENSOR_FAULT_SLEW               (0x04U)     /* Implausible rate of change */
+#define SENSOR_FAULT_STUCK              (0x08U)     /* Identical raw value for TEMP_SENSOR_TIMEOUT_MS */
+#define SENSOR_FAULT_STALE              (0x10U)     /* No samples for TEMP_SENSOR_TIMEOUT_MS */
+#define SENSOR_FAULT_CROSSCHECK         (0x20U)     /* Redundant probes disagree */
+
+/* Plausibility State - timestamps are in sample_ring cycle units */
+typedef struct {
+    uint32_t cycles_per_ms;
+    uint32_t hw_add_count;                          /* Conversions summed per raw value */
+    uint32_t active;                                /* Latched SENSOR_FAULT_* bits */
+    uint32_t fault_timestamp;                       /* Sample that raised the current fault episode */
+    uint32_t last_fault_timestamp;                  /* Most recent confirmation of any fault */
+    uint32_t fault_events;                          /* Number of fault episodes since init */
+    uint32_t last_sample_timestamp[SENSOR_FAULT_MAX_PROBES];
+    uint32_t stuck_since[SENSOR_FAULT_MAX_PROBES];
+    uint16_t stuck_raw[SENSOR_FAULT_MAX_PROBES];
+    float last_temp[SENSOR_FAULT_MAX_PROBES];
+    float slew_ref_temp[SENSOR_FAULT_MAX_PROBES];   /* Reading the slew window started at */
+    uint32_t slew_ref_timestamp[SENSOR_FAULT_MAX_PROBES];
+    bool have_temp[SENSOR_FAULT_MAX_PROBES];
+    uint8_t crosscheck_count;
+} sensor_fault_ctx_t;
+
+/* Function Declarations */
+void sensor_fault_init(sensor_fault_ctx_t *p_ctx, uint32_t cycles_per_ms, uint32_t hw_add_count, uint32_t now);
+void sensor_fault_check_raw(sensor_fault_ctx_t *p_ctx, uint8_t probe, uint16_t raw, uint32_t timestamp);
+void sensor_fault_check_reading(sensor_fault_ctx_t *p_ctx, uint8_t probe, float temperature, uint32_t timestamp);
+void sensor_fault_check_timeout(sensor_fault_ctx_t *p_ctx, uint8_t num_probes, uint32_t now);
+uint32_t sensor_fault_active(sensor_fault_ctx_t const *p_ctx);
+
+#endif /* SENSOR_FAULT_H_ */
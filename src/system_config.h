@@ -62,14 +62,23 @@
    BLE DATA PACKET STRUCTURE
    ======================================== */
 
-#define BLE_TEMP_DATA_SIZE          7
-typedef struct {
-    int16_t temperature;                /* Temperature * 100 (Celsius) */
-    uint8_t cooling_level;              /* 0=OFF, 1=LOW, 2=MED, 3=HIGH, 4=EMERGENCY */
-    uint8_t pwm_duty_cycle;             /* PWM duty cycle 0-100% */
-    uint8_t system_alert;               /* Alert flag */
-    uint16_t sample_count;              /* Packet sequence number */
-} ble_rack_status_t;
+#define BLE_TEMP_DATA_SIZE          17         /* Field layout: ble_rack_status_t in ble_app.h */
+
+/* Telemetry Transport - where ble_send_temperature_data() frames go (values in telemetry_transport.h):
+   0 = BLE notifications (field), 1 = debug UART via DTC (lab), 2 = UDP socket (host builds) */
+#ifndef TELEMETRY_TRANSPORT
+#define TELEMETRY_TRANSPORT         0          /* Host builds pass -DTELEMETRY_TRANSPORT=2 */
+#endif
+#define TELEMETRY_DIAG_ENABLE       (TELEMETRY_TRANSPORT != 0)  /* Per-sample diagnostics need a wired link */
+
+/* Timebase - 64-bit µs clock: 0 = free-running GPT counter (target), 1 = virtual clock (host builds) */
+#ifndef TIMEBASE_VIRTUAL
+#define TIMEBASE_VIRTUAL            0          /* Host builds pass -DTIMEBASE_VIRTUAL=1 */
+#endif
+
+/* BLE Event Pump - stack servicing per main loop iteration, after the control work */
+#define BLE_PUMP_BUDGET_US          300        /* Upper bound per iteration */
+#define BLE_PUMP_LOOP_PERIOD_US     1000       /* Control loop period the budget is carved from */
 
 /* ========================================
    SYSTEM SAFETY LIMITS
@@ -99,4 +108,9 @@ typedef struct {
 #define INTAKE_FAN_ENABLE           1          /* Incoming cool air */
 #define EXHAUST_FAN_ENABLE          1          /* Outgoing hot air */
 
+/* Exhaust runs slightly slower than intake to keep positive rack pressure
+   (keeps dust out of unsealed gaps); both run full at EMERGENCY */
+#define FAN_EXHAUST_RATIO_PCT       90         /* Exhaust duty = intake duty x ratio */
+#define FAN_PHASE_OFFSET_PCT        50         /* Exhaust PWM lags intake by half a period */
+
 #endif /* SYSTEM_CONFIG_H_ */
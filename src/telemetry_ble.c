@@ -0,0 +1,65 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_ble.c
+ * Description  : Telemetry Transport Backend - BLE GATT notifications (field deployments)
+ **********************************************************************************************************************/
+
+#include "telemetry_transport.h"
+
+#if TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_BLE
+
+#include "ble_app.h"
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/**
+ * @brief Nothing to open - the BLE stack is brought up by ble_app_init()
+ */
+fsp_err_t telemetry_backend_open(void)
+{
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Stack events are pumped by ble_app_run(); nothing queued here
+ */
+void telemetry_backend_poll(void)
+{
+}
+
+/**
+ * @brief Per-link failures are tracked in the connection table instead
+ */
+uint32_t telemetry_backend_tx_errors(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Send a frame as a notification on the channel's characteristic
+ * @param[in] channel Frame channel
+ * @param[in] p_data  Encoded frame
+ * @param[in] len     Frame length
+ * @return true if every subscribed central accepted it
+ */
+bool telemetry_transport_send(telemetry_channel_t channel, uint8_t const *p_data, uint16_t len)
+{
+    if (TELEMETRY_CH_RACK_STATUS != channel)
+    {
+        /* Diagnostics stay off the radio - they would crowd out status and OTA traffic */
+        telemetry_account_dropped(len);
+        return false;
+    }
+
+    if (0U != ble_send_notification((uint8_t *)p_data, len))
+    {
+        telemetry_account_dropped(len);
+        return false;
+    }
+
+    telemetry_account_sent(len);
+    return true;
+}
+
+#endif /* TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_BLE */
@@ -0,0 +1,93 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_report.c
+ * Description  : Report-by-Exception for the rack status frame - send on change, deadband, heartbeat
+ *
+ * Consumers act on the cooling state and on meaningful temperature moves, not on a fixed cadence. A state
+ * change is reported at once; a temperature move only once it leaves the deadband, and no closer than the
+ * minimum gap so a noisy probe cannot flood the radio; a heartbeat covers quiet periods.
+ **********************************************************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "telemetry_report.h"
+
+/**
+ * @brief Reset the reporter - the first check always reports
+ * @param[in] p_report Reporter state
+ */
+void telemetry_report_init(telemetry_report_t *p_report)
+{
+    memset(p_report, 0, sizeof(*p_report));
+}
+
+/**
+ * @brief Report on the next check whatever changed (e.g. a central just subscribed)
+ * @param[in] p_report Reporter state
+ */
+void telemetry_report_force(telemetry_report_t *p_report)
+{
+    p_report->forced = true;
+}
+
+/**
+ * @brief Decide whether the current state is worth a frame
+ * @param[in] p_report       Reporter state
+ * @param[in] temperature    Current temperature (°C)
+ * @param[in] cooling_level  Current cooling level
+ * @param[in] pwm_duty_cycle Current duty (%)
+ * @param[in] system_alert   Current SYSTEM_ALERT_* bits
+ * @param[in] now_ms         Current time (timebase_now_ms())
+ * @param[in] deadband       Temperature move (°C) worth reporting
+ * @param[in] min_gap_ms     Minimum spacing of deadband reports
+ * @param[in] heartbeat_ms   Longest silence
+ * @return Reason to send now, or REPORT_NONE
+ */
+report_reason_t telemetry_report_check(telemetry_report_t *p_report, float temperature, uint8_t cooling_level,
+                                       uint8_t pwm_duty_cycle, uint8_t system_alert, uint32_t now_ms,
+                                       float deadband, uint32_t min_gap_ms, uint32_t heartbeat_ms)
+{
+    report_reason_t reason = REPORT_NONE;
+    uint32_t since_ms = now_ms - p_report->last_ms;     /* Unsigned difference - correct across the ms wrap */
+
+    if (!p_report->valid || p_report->forced)
+    {
+        reason = REPORT_FORCED;
+    }
+    else if ((cooling_level != p_report->cooling_level) || (pwm_duty_cycle != p_report->pwm_duty_cycle) ||
+             (system_alert != p_report->system_alert))
+    {
+        reason = REPORT_STATE;
+    }
+    else if ((fabsf(temperature - p_report->temperature) >= deadband) && (since_ms >= min_gap_ms))
+    {
+        reason = REPORT_DEADBAND;
+    }
+    else if (since_ms >= heartbeat_ms)
+    {
+        reason = REPORT_HEARTBEAT;
+    }
+
+    return reason;
+}
+
+/**
+ * @brief Record a frame that went out
+ * @param[in] p_report Reporter state
+ * @param[in] reason   Reason from telemetry_report_check()
+ * @param[in] now_ms   Time the frame went out
+ * @return Sequence number to put in the frame
+ */
+uint16_t telemetry_report_sent(telemetry_report_t *p_report, report_reason_t reason, float temperature,
+                               uint8_t cooling_level, uint8_t pwm_duty_cycle, uint8_t system_alert, uint32_t now_ms)
+{
+    p_report->temperature = temperature;
+    p_report->cooling_level = cooling_level;
+    p_report->pwm_duty_cycle = pwm_duty_cycle;
+    p_report->system_alert = system_alert;
+    p_report->valid = true;
+    p_report->forced = false;
+    p_report->last_ms = now_ms;
+    p_report->reports[reason]++;
+
+    return p_report->seq++;
+}
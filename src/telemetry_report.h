@@ -0,0 +1,43 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_report.h
+ * Description  : Report-by-Exception for the rack status frame - send on change, deadband, heartbeat
+ **********************************************************************************************************************/
+
+#ifndef TELEMETRY_REPORT_H_
+#define TELEMETRY_REPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Why a frame goes out */
+typedef enum {
+    REPORT_NONE = 0,            /* Nothing a consumer would act on - suppressed */
+    REPORT_STATE,               /* Cooling level, duty or alert changed - sent at once */
+    REPORT_DEADBAND,            /* Temperature left the deadband around the last reported value */
+    REPORT_HEARTBEAT,           /* Quiet for the heartbeat period - proves the rack is alive */
+    REPORT_FORCED,              /* First frame, or a new subscriber needs the current state */
+} report_reason_t;
+
+/* Reporter State - the last reported values and when */
+typedef struct {
+    float temperature;
+    uint8_t cooling_level;
+    uint8_t pwm_duty_cycle;
+    uint8_t system_alert;
+    bool valid;                 /* Something has been reported */
+    bool forced;                /* Report on the next check regardless */
+    uint32_t last_ms;           /* Timebase time of the last report (ms, wrapping) */
+    uint16_t seq;               /* Reports sent - carried in the frame so receivers can count losses */
+    uint32_t reports[REPORT_FORCED + 1];    /* Frames sent per report_reason_t */
+} telemetry_report_t;
+
+/* Function Declarations */
+void telemetry_report_init(telemetry_report_t *p_report);
+void telemetry_report_force(telemetry_report_t *p_report);
+report_reason_t telemetry_report_check(telemetry_report_t *p_report, float temperature, uint8_t cooling_level,
+                                       uint8_t pwm_duty_cycle, uint8_t system_alert, uint32_t now_ms,
+                                       float deadband, uint32_t min_gap_ms, uint32_t heartbeat_ms);
+uint16_t telemetry_report_sent(telemetry_report_t *p_report, report_reason_t reason, float temperature,
+                               uint8_t cooling_level, uint8_t pwm_duty_cycle, uint8_t system_alert, uint32_t now_ms);
+
+#endif /* TELEMETRY_REPORT_H_ */
@@ -0,0 +1,124 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_socket.c
+ * Description  : Telemetry Transport Backend - UDP datagrams for host builds (simulation / CI)
+ *
+ * Each frame goes out as one datagram in the tools/gateway envelope (rack_frame.h), so a host build of the
+ * control loop feeds rack_ingestd directly:
+ *   [0..1] rack ID   [2..3] channel   [4..11] CLOCK_MONOTONIC ns   [12..] frame
+ **********************************************************************************************************************/
+
+#include "telemetry_transport.h"
+
+#if TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_SOCKET
+
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "ble_app.h"
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+#define TELEMETRY_SOCKET_HEADER_SIZE    (12U)
+
+/* Static variables */
+static int g_socket_fd = -1;
+
+/**
+ * @brief Store a little-endian value
+ */
+static void socket_put_le(uint8_t *p_buf, uint64_t value, uint8_t bytes)
+{
+    for (uint8_t i = 0; i < bytes; i++)
+    {
+        p_buf[i] = (uint8_t)(value >> (8U * i));
+    }
+}
+
+/**
+ * @brief Create a non-blocking UDP socket connected to the gateway
+ */
+fsp_err_t telemetry_backend_open(void)
+{
+    struct sockaddr_in addr;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(TELEMETRY_SOCKET_PORT);
+    if (1 != inet_pton(AF_INET, TELEMETRY_SOCKET_HOST, &addr.sin_addr))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    g_socket_fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (g_socket_fd < 0)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+
+    if (0 != connect(g_socket_fd, (struct sockaddr *)&addr, sizeof(addr)))
+    {
+        close(g_socket_fd);
+        g_socket_fd = -1;
+        return FSP_ERR_NOT_OPEN;
+    }
+
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Datagrams are sent synchronously; nothing to drain
+ */
+void telemetry_backend_poll(void)
+{
+}
+
+/**
+ * @brief Every failed send is already counted as a drop
+ */
+uint32_t telemetry_backend_tx_errors(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Send a frame as one enveloped datagram
+ * @param[in] channel Frame channel
+ * @param[in] p_data  Encoded frame
+ * @param[in] len     Frame length
+ * @return true if the kernel accepted it
+ */
+bool telemetry_transport_send(telemetry_channel_t channel, uint8_t const *p_data, uint16_t len)
+{
+    uint8_t datagram[TELEMETRY_SOCKET_HEADER_SIZE + TELEMETRY_FRAME_MAX_PAYLOAD];
+    uint16_t datagram_len = (uint16_t)(TELEMETRY_SOCKET_HEADER_SIZE + len);
+    struct timespec ts;
+
+    if ((g_socket_fd < 0) || (len > TELEMETRY_FRAME_MAX_PAYLOAD))
+    {
+        telemetry_account_dropped(datagram_len);
+        return false;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    socket_put_le(&datagram[0], BLE_RACK_ID, 2U);
+    socket_put_le(&datagram[2], (uint64_t)channel, 2U);
+    socket_put_le(&datagram[4], ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec, 8U);
+    memcpy(&datagram[TELEMETRY_SOCKET_HEADER_SIZE], p_data, len);
+
+    if (send(g_socket_fd, datagram, datagram_len, MSG_DONTWAIT) != (ssize_t)datagram_len)
+    {
+        /* No listener (ECONNREFUSED) or a full buffer both mean the frame is gone */
+        telemetry_account_dropped(datagram_len);
+        return false;
+    }
+
+    telemetry_account_sent(datagram_len);
+    return true;
+}
+
+#endif /* TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_SOCKET */
@@ -0,0 +1,136 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_transport.c
+ * Description  : Telemetry Transport - backend-independent accounting, rate window and framing CRC
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include "telemetry_transport.h"
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+#if (TELEMETRY_TRANSPORT != TELEMETRY_TRANSPORT_BLE) && (TELEMETRY_TRANSPORT != TELEMETRY_TRANSPORT_UART) && \
+    (TELEMETRY_TRANSPORT != TELEMETRY_TRANSPORT_SOCKET)
+#error "TELEMETRY_TRANSPORT must name one backend"
+#endif
+
+/* Static variables */
+static telemetry_stats_t g_stats;
+static uint32_t g_cycles_per_ms;
+static uint32_t g_window_start;
+static uint32_t g_window_frames;        /* frames_sent at window start */
+static uint32_t g_window_bytes;         /* bytes_sent at window start */
+
+/**
+ * @brief Reset statistics and open the selected backend
+ * @param[in] cycles_per_ms Timestamp ticks per millisecond
+ * @param[in] now           Current timestamp
+ * @return FSP_SUCCESS or backend error
+ */
+fsp_err_t telemetry_transport_open(uint32_t cycles_per_ms, uint32_t now)
+{
+    fsp_err_t err;
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_cycles_per_ms = cycles_per_ms;
+    g_window_start = now;
+    g_window_frames = 0;
+    g_window_bytes = 0;
+
+    err = telemetry_backend_open();
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Telemetry transport %s open failed: %d\r\n", telemetry_transport_name(), err);
+        return err;
+    }
+
+    log_info("Telemetry transport: %s\r\n", telemetry_transport_name());
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Per-iteration housekeeping: let the backend make progress, roll the rate window
+ * @note  Call at least once per timestamp wrap period (DWT: ~20s at 200MHz)
+ * @param[in] now Current timestamp
+ */
+void telemetry_transport_service(uint32_t now)
+{
+    uint32_t elapsed_ms;
+
+    telemetry_backend_poll();
+
+    elapsed_ms = (now - g_window_start) / g_cycles_per_ms;
+    if (elapsed_ms >= TELEMETRY_RATE_WINDOW_MS)
+    {
+        g_stats.frames_per_s = (uint32_t)(((uint64_t)(g_stats.frames_sent - g_window_frames) * 1000U) / elapsed_ms);
+        g_stats.bytes_per_s = (uint32_t)(((uint64_t)(g_stats.bytes_sent - g_window_bytes) * 1000U) / elapsed_ms);
+        g_window_frames = g_stats.frames_sent;
+        g_window_bytes = g_stats.bytes_sent;
+        g_window_start = now;
+    }
+}
+
+/**
+ * @brief Snapshot transport statistics
+ */
+void telemetry_transport_get_stats(telemetry_stats_t *p_stats)
+{
+    *p_stats = g_stats;
+    p_stats->tx_errors = telemetry_backend_tx_errors();
+}
+
+/**
+ * @brief Name of the backend this image was built with
+ */
+char const *telemetry_transport_name(void)
+{
+#if TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_UART
+    return "uart";
+#elif TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_SOCKET
+    return "socket";
+#else
+    return "ble";
+#endif
+}
+
+/**
+ * @brief Record a frame accepted by the backend (main-loop context only)
+ * @param[in] bytes Bytes it occupies on the link, framing included
+ */
+void telemetry_account_sent(uint16_t bytes)
+{
+    g_stats.frames_sent++;
+    g_stats.bytes_sent += bytes;
+}
+
+/**
+ * @brief Record a frame the backend could not take (main-loop context only)
+ * @param[in] bytes Bytes it would have occupied
+ */
+void telemetry_account_dropped(uint16_t bytes)
+{
+    g_stats.frames_dropped++;
+    g_stats.bytes_dropped += bytes;
+}
+
+/**
+ * @brief CRC-8 (poly 0x07, no reflection) for stream framing
+ * @param[in] crc    Running value (0 to start)
+ * @param[in] p_data Bytes
+ * @param[in] len    Length
+ * @return Updated CRC
+ */
+uint8_t telemetry_crc8(uint8_t crc, uint8_t const *p_data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        crc ^= p_data[i];
+        for (uint8_t bit = 0; bit < 8U; bit++)
+        {
+            crc = (crc & 0x80U) ? (uint8_t)((crc << 1) ^ 0x07U) : (uint8_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
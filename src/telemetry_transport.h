@@ -0,0 +1,70 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_transport.h
+ * Description  : Telemetry Transport - encoded status/diagnostic frames out over the backend chosen at build time
+ *                (BLE notification, DMA-driven UART, or host socket)
+ **********************************************************************************************************************/
+
+#ifndef TELEMETRY_TRANSPORT_H_
+#define TELEMETRY_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+#include "system_config.h"
+
+/* Backends - TELEMETRY_TRANSPORT in system_config.h picks exactly one; only its translation unit defines
+ * telemetry_transport_send(), so the hot path is a direct call */
+#define TELEMETRY_TRANSPORT_BLE         (0)
+#define TELEMETRY_TRANSPORT_UART        (1)
+#define TELEMETRY_TRANSPORT_SOCKET      (2)         /* Host builds only (POSIX UDP) */
+
+/* Channels - what the frame is; each backend maps them onto its own addressing */
+typedef enum {
+    TELEMETRY_CH_RACK_STATUS = 0,   /* ble_rack_status_t frame */
+    TELEMETRY_CH_DIAGNOSTIC  = 1,   /* High-rate diagnostics - wired backends only */
+} telemetry_channel_t;
+
+/* Stream Framing (UART) - [sync][channel][len][payload...][crc8 over channel..payload] */
+#define TELEMETRY_FRAME_SYNC            (0x7EU)
+#define TELEMETRY_FRAME_OVERHEAD        (4U)
+#define TELEMETRY_FRAME_MAX_PAYLOAD     (255U)
+
+/* UART Backend */
+#define TELEMETRY_UART_TX_BUFFER        (1024U)     /* Power of two - frames queued behind the active transfer */
+
+/* Socket Backend - datagrams in the tools/gateway envelope, straight into rack_ingestd */
+#define TELEMETRY_SOCKET_HOST           "127.0.0.1"
+#define TELEMETRY_SOCKET_PORT           (47000U)
+
+/* Rate Window */
+#define TELEMETRY_RATE_WINDOW_MS        (1000U)
+
+/* Statistics */
+typedef struct {
+    uint32_t frames_sent;       /* Accepted by the backend */
+    uint32_t bytes_sent;        /* Including framing */
+    uint32_t frames_dropped;    /* Queue full, link rejected, or channel not carried by this backend */
+    uint32_t bytes_dropped;
+    uint32_t tx_errors;         /* Driver-level failures after acceptance */
+    uint32_t frames_per_s;      /* Over the last complete window */
+    uint32_t bytes_per_s;
+} telemetry_stats_t;
+
+/* Function Declarations */
+fsp_err_t telemetry_transport_open(uint32_t cycles_per_ms, uint32_t now);
+bool telemetry_transport_send(telemetry_channel_t channel, uint8_t const *p_data, uint16_t len);
+void telemetry_transport_service(uint32_t now);
+void telemetry_transport_get_stats(telemetry_stats_t *p_stats);
+char const *telemetry_transport_name(void);
+
+/* Backend Interface - implemented by the selected backend, used by telemetry_transport.c only */
+fsp_err_t telemetry_backend_open(void);
+void telemetry_backend_poll(void);
+uint32_t telemetry_backend_tx_errors(void);
+
+/* Shared Helpers - for backends */
+void telemetry_account_sent(uint16_t bytes);
+void telemetry_account_dropped(uint16_t bytes);
+uint8_t telemetry_crc8(uint8_t crc, uint8_t const *p_data, uint32_t len);
+
+#endif /* TELEMETRY_TRANSPORT_H_ */
@@ -0,0 +1,166 @@
+/***********************************************************************************************************************
+ * File Name    : telemetry_uart.c
+ * Description  : Telemetry Transport Backend - framed stream on the debug SCI UART, transmitted by DTC
+ *
+ * Frames are appended to a byte ring by the main loop and handed to R_SCI_UART_Write() in contiguous chunks;
+ * with a DTC transfer instance on the UART the write returns immediately and the next chunk is started from
+ * the TX-complete callback. The main loop only starts a transfer when none is in flight, so the ring has one
+ * producer (head, main loop) and one consumer (tail, UART ISR).
+ *
+ * g_uart0 in configuration.xml: SCI9 on P109/P110 (the debug probe's virtual COM port), 115200 8N1, TX by DTC
+ * instance g_transfer0.
+ **********************************************************************************************************************/
+
+#include "telemetry_transport.h"
+
+#if TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_UART
+
+#include <stdatomic.h>
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+#define TELEMETRY_UART_MASK     (TELEMETRY_UART_TX_BUFFER - 1U)
+
+_Static_assert((TELEMETRY_UART_TX_BUFFER & TELEMETRY_UART_MASK) == 0U, "TELEMETRY_UART_TX_BUFFER must be a power of two");
+
+/* SCI channel configured as DEBUG_SERIAL_PORT in the FSP configurator */
+extern uart_ctrl_t g_uart0_ctrl;
+extern const uart_cfg_t g_uart0_cfg;
+
+/* Static variables */
+static uint8_t g_tx_buf[TELEMETRY_UART_TX_BUFFER];
+static atomic_uint g_head;              /* Next byte to write (main loop) */
+static atomic_uint g_tail;              /* Next byte to transmit (ISR) */
+static atomic_bool g_busy;              /* Transfer in flight */
+static uint32_t g_inflight;             /* Bytes in the active transfer */
+static volatile uint32_t g_tx_errors;
+
+/**
+ * @brief Start a transfer of the next contiguous chunk, or go idle
+ * @note  Caller owns the transfer: either the TX-complete ISR, or the main loop after claiming g_busy
+ */
+static void uart_tx_start(void)
+{
+    uint32_t tail = atomic_load(&g_tail);
+    uint32_t pending = atomic_load(&g_head) - tail;
+    uint32_t offset = tail & TELEMETRY_UART_MASK;
+
+    if (0U == pending)
+    {
+        atomic_store(&g_busy, false);
+        return;
+    }
+
+    g_inflight = (pending < (TELEMETRY_UART_TX_BUFFER - offset)) ? pending : (TELEMETRY_UART_TX_BUFFER - offset);
+    if (FSP_SUCCESS != R_SCI_UART_Write(&g_uart0_ctrl, &g_tx_buf[offset], g_inflight))
+    {
+        /* Discard the chunk rather than retrying forever; the receiver resyncs on the next sync byte */
+        g_tx_errors++;
+        atomic_store(&g_tail, tail + g_inflight);
+        atomic_store(&g_busy, false);
+    }
+}
+
+/**
+ * @brief UART callback - chain the next chunk when a transfer finishes
+ * @note  Runs in ISR context
+ */
+static void uart_callback(uart_callback_args_t *p_args)
+{
+    if (UART_EVENT_TX_COMPLETE == p_args->event)
+    {
+        atomic_store(&g_tail, atomic_load(&g_tail) + g_inflight);
+        uart_tx_start();
+    }
+}
+
+/**
+ * @brief Open the debug UART and hook the TX-complete callback
+ */
+fsp_err_t telemetry_backend_open(void)
+{
+    fsp_err_t err;
+
+    atomic_store(&g_head, 0U);
+    atomic_store(&g_tail, 0U);
+    atomic_store(&g_busy, false);
+    g_inflight = 0;
+    g_tx_errors = 0;
+
+    err = R_SCI_UART_Open(&g_uart0_ctrl, &g_uart0_cfg);
+    if ((FSP_SUCCESS != err) && (FSP_ERR_ALREADY_OPEN != err))
+    {
+        return err;
+    }
+
+    return R_SCI_UART_CallbackSet(&g_uart0_ctrl, uart_callback, NULL, NULL);
+}
+
+/**
+ * @brief Start a transfer if data is queued and the UART is idle
+ */
+void telemetry_backend_poll(void)
+{
+    /* Claim the idle UART; if the ISR is mid-chain it sees our head update and keeps going */
+    if ((atomic_load(&g_head) != atomic_load(&g_tail)) && !atomic_exchange(&g_busy, true))
+    {
+        uart_tx_start();
+    }
+}
+
+/**
+ * @brief Write failures reported by the driver
+ */
+uint32_t telemetry_backend_tx_errors(void)
+{
+    return g_tx_errors;
+}
+
+/**
+ * @brief Queue a frame for the UART
+ * @param[in] channel Frame channel
+ * @param[in] p_data  Encoded frame
+ * @param[in] len     Frame length (up to TELEMETRY_FRAME_MAX_PAYLOAD)
+ * @return true if queued; false (counted as a drop) if the ring cannot hold the whole frame
+ */
+bool telemetry_transport_send(telemetry_channel_t channel, uint8_t const *p_data, uint16_t len)
+{
+    uint8_t header[3];
+    uint8_t crc;
+    uint32_t head = atomic_load(&g_head);
+    uint32_t space = TELEMETRY_UART_TX_BUFFER - (head - atomic_load(&g_tail));
+    uint32_t frame_len = (uint32_t)len + TELEMETRY_FRAME_OVERHEAD;
+
+    if ((len > TELEMETRY_FRAME_MAX_PAYLOAD) || (frame_len > space))
+    {
+        telemetry_account_dropped((uint16_t)frame_len);
+        return false;
+    }
+
+    header[0] = TELEMETRY_FRAME_SYNC;
+    header[1] = (uint8_t)channel;
+    header[2] = (uint8_t)len;
+    crc = telemetry_crc8(0U, &header[1], 2U);
+    crc = telemetry_crc8(crc, p_data, len);
+
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        g_tx_buf[(head++) & TELEMETRY_UART_MASK] = header[i];
+    }
+    for (uint32_t i = 0; i < len; i++)
+    {
+        g_tx_buf[(head++) & TELEMETRY_UART_MASK] = p_data[i];
+    }
+    g_tx_buf[(head++) & TELEMETRY_UART_MASK] = crc;
+
+    /* Publish the whole frame at once - the ISR never sees a partial one */
+    atomic_store(&g_head, head);
+    telemetry_account_sent((uint16_t)frame_len);
+
+    telemetry_backend_poll();
+    return true;
+}
+
+#endif /* TELEMETRY_TRANSPORT == TELEMETRY_TRANSPORT_UART */
@@ -0,0 +1,48 @@
+/***********************************************************************************************************************
+ * File Name    : temp_oversample.h
+ * Description  : Oversample-and-Decimate Accumulator - sums scan results until 4^n conversions, then decimates
+ *                to 12+n bits (HAL-free, shared with the host benchmark tools/host/adc_oversample_bench.c)
+ **********************************************************************************************************************/
+
+#ifndef TEMP_OVERSAMPLE_H_
+#define TEMP_OVERSAMPLE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Oversampling accumulator (consumer side) */
+typedef struct {
+    uint32_t sum;               /* Sum of scan results since last decimation */
+    uint32_t conversions;       /* Conversions represented by sum */
+    uint32_t counts;            /* Last decimated result, full scale = ADC_MAX_VALUE << extra_bits */
+    bool valid;                 /* At least one decimated result available */
+} temp_oversample_t;
+
+/**
+ * @brief Feed one scan result into an oversampling accumulator
+ * @param[in] p_os         Accumulator of the probe the sample belongs to
+ * @param[in] raw          Scan result (sum of hw_add_count conversions)
+ * @param[in] hw_add_count Conversions the ADC hardware summed into raw (1 when addition is off)
+ * @param[in] extra_bits   Bits gained over the 12-bit converter (0-4, ratio 4^extra_bits)
+ * @return true when a new decimated result was produced
+ */
+static inline bool temp_oversample_feed(temp_oversample_t *p_os, uint16_t raw, uint32_t hw_add_count,
+                                        uint8_t extra_bits)
+{
+    p_os->sum += raw;
+    p_os->conversions += hw_add_count;
+
+    if (p_os->conversions < (1UL << (2U * extra_bits)))
+    {
+        return false;
+    }
+
+    /* Decimate: mean scaled by 2^n. With exactly 4^n conversions this is sum >> n. */
+    p_os->counts = (p_os->sum << extra_bits) / p_os->conversions;
+    p_os->valid = true;
+    p_os->sum = 0;
+    p_os->conversions = 0;
+    return true;
+}
+
+#endif /* TEMP_OVERSAMPLE_H_ */
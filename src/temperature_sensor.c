@@ -3,9 +3,16 @@
  * Description  : Server Rack Temperature Monitoring ADC Driver
  **********************************************************************************************************************/
 
+#include <string.h>
 #include "hal_data.h"
 #include "temperature_sensor.h"
-#include "log_disabled.h"
+#include "sample_ring.h"
+#include "temp_oversample.h"
+#include "sensor_fault.h"
+#include "thermal_shutdown.h"
+#include "ntc_thermistor.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
 
 /* ADC Configuration */
 #define ADC_RESOLUTION          12          /* 12-bit ADC */
@@ -22,18 +29,142 @@ extern adc_ctrl_t g_adc0_ctrl;
 extern const adc_cfg_t g_adc0_cfg;
 
 /* Static variables */
-static volatile uint16_t g_adc_result = 0;
-static uint32_t g_sample_count = 0;
+static sample_ring_t g_sample_ring;
+static volatile uint32_t g_sample_count = 0;
+static temp_oversample_t g_oversample[TEMP_SENSOR_NUM_PROBES];
+static uint32_t g_hw_add_count = 1;
+static sensor_fault_ctx_t g_sensor_fault;
+static float g_probe_temp[TEMP_SENSOR_NUM_PROBES];
+static adc_channel_cfg_t g_scan_cfg;
+static adc_window_cfg_t g_window_cfg;
+
+/**
+ * @brief Number of conversions the ADC hardware sums into one scan result
+ * @return 1 when hardware addition is off (averaging modes also count as 1 - they do not add bits)
+ */
+static uint32_t adc_hw_add_count(void)
+{
+    adc_extended_cfg_t const *p_extend = (adc_extended_cfg_t const *)g_adc0_cfg.p_extend;
+
+    if (NULL == p_extend)
+    {
+        return 1;
+    }
+
+    switch (p_extend->add_average_count)
+    {
+        case ADC_ADD_TWO:     return 2;
+        case ADC_ADD_THREE:   return 3;
+        case ADC_ADD_FOUR:    return 4;
+        case ADC_ADD_SIXTEEN: return 16;
+        default:              return 1;
+    }
+}
+
+/**
+ * @brief Convert ADC counts to rack temperature
+ * @param[in] probe  Probe index (selects the per-unit calibration)
+ * @param[in] counts Decimated ADC result, full scale TEMP_OVERSAMPLE_FULL_SCALE
+ * @return Temperature in Celsius
+ */
+static float temp_sensor_counts_to_celsius(uint8_t probe, uint32_t counts)
+{
+#if TEMP_SENSOR_TYPE_NTC
+    /* Table lookup + interpolation, then this unit's offset/gain */
+    return ntc_cal_apply(probe, (float)ntc_counts_to_centi_celsius(counts, TEMP_OVERSAMPLE_EXTRA_BITS) / 100.0f);
+#else
+    FSP_PARAMETER_NOT_USED(probe);
+
+    /* Convert ADC value to voltage */
+    float voltage = ((float)counts / (float)TEMP_OVERSAMPLE_FULL_SCALE) * ADC_REFERENCE_VOLTAGE;
+
+    /* Convert voltage to temperature */
+    /* Formula: Temp = 25 + (V_ref - V_adc) / TC */
+    return 25.0f + ((TEMP_SENSOR_V_25 - voltage) / TEMP_SENSOR_TC);
+#endif
+}
+
+/**
+ * @brief Convert a rack temperature to the 12-bit ADC counts a probe would produce
+ * @param[in] channel     ADC channel of the probe
+ * @param[in] temperature Temperature in Celsius
+ * @return ADC counts, clamped to 0..ADC_MAX_VALUE
+ */
+uint16_t temp_sensor_celsius_to_counts(uint16_t channel, float temperature)
+{
+#if TEMP_SENSOR_TYPE_NTC
+    uint8_t probe = (TEMP_SENSOR_CHANNEL == channel) ? 0U : 1U;
+
+    return ntc_centi_celsius_to_counts((int32_t)(ntc_cal_remove(probe, temperature) * 100.0f));
+#else
+    FSP_PARAMETER_NOT_USED(channel);
+
+    float voltage = TEMP_SENSOR_V_25 + ((temperature - 25.0f) * TEMP_SENSOR_TC);
+    float counts = (voltage / ADC_REFERENCE_VOLTAGE) * (float)ADC_MAX_VALUE;
+
+    if (counts <= 0.0f)
+    {
+        return 0;
+    }
+    if (counts >= (float)ADC_MAX_VALUE)
+    {
+        return ADC_MAX_VALUE;
+    }
+    return (uint16_t)(counts + 0.5f);
+#endif
+}
 
 /**
  * @brief ADC Callback for Rack Temperature Reading
+ * @note  Runs in ISR context - sole producer of g_sample_ring
  */
 static void adc_callback(adc_callback_args_t *p_args)
 {
+    temp_sample_t sample;
+
     if (ADC_EVENT_SCAN_COMPLETE == p_args->event)
     {
-        g_adc_result = p_args->result;
+        sample.timestamp = TEMP_TIMESTAMP_NOW();
+        sample.channel = TEMP_SENSOR_CHANNEL;
+        sample.raw = 0;
+        R_ADC_Read(&g_adc0_ctrl, TEMP_SENSOR_CHANNEL, &sample.raw);
+        sample_ring_push(&g_sample_ring, &sample);
+
+#if TEMP_SENSOR_REDUNDANT_ENABLE
+        sample.channel = TEMP_SENSOR_REDUNDANT_CHANNEL;
+        sample.raw = 0;
+        R_ADC_Read(&g_adc0_ctrl, TEMP_SENSOR_REDUNDANT_CHANNEL, &sample.raw);
+        sample_ring_push(&g_sample_ring, &sample);
+#endif
+
         g_sample_count++;
+        thermal_shutdown_scan_end_isr();
+    }
+    else if (ADC_EVENT_WINDOW_COMPARE_A == p_args->event)
+    {
+        thermal_shutdown_isr();
+    }
+}
+
+/**
+ * @brief Run one drained sample through plausibility checks and decimation
+ * @param[in] p_sample Sample from the ring
+ */
+static void temp_sensor_process_sample(temp_sample_t const *p_sample)
+{
+    uint8_t probe = (TEMP_SENSOR_CHANNEL == p_sample->channel) ? 0U : 1U;
+
+    if (probe >= TEMP_SENSOR_NUM_PROBES)
+    {
+        return;
+    }
+
+    sensor_fault_check_raw(&g_sensor_fault, probe, p_sample->raw, p_sample->timestamp);
+
+    if (temp_oversample_feed(&g_oversample[probe], p_sample->raw, g_hw_add_count, TEMP_OVERSAMPLE_EXTRA_BITS))
+    {
+        g_probe_temp[probe] = temp_sensor_counts_to_celsius(probe, g_oversample[probe].counts);
+        sensor_fault_check_reading(&g_sensor_fault, probe, g_probe_temp[probe], p_sample->timestamp);
     }
 }
 
@@ -47,6 +178,13 @@ fsp_err_t temp_sensor_adc_init(void)
     
     log_info("Initializing Rack Temperature Sensor...\r\n");
     
+    /* Enable DWT cycle counter for sample timestamps */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    
+    sample_ring_init(&g_sample_ring);
+    memset(g_oversample, 0, sizeof(g_oversample));
+    
     /* Open ADC */
     err = R_ADC_Open(&g_adc0_ctrl, &g_adc0_cfg);
     if (FSP_SUCCESS != err)
@@ -55,8 +193,25 @@ fsp_err_t temp_sensor_adc_init(void)
         return err;
     }
     
-    /* Configure scan */
-    err = R_ADC_ScanCfg(&g_adc0_ctrl, &g_adc0_cfg.scan_cfg);
+    /* Route scan-complete events into the sample ring */
+    err = R_ADC_CallbackSet(&g_adc0_ctrl, adc_callback, NULL, NULL);
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Rack Temperature Sensor: CALLBACK FAILED\r\n");
+        R_ADC_Close(&g_adc0_ctrl);
+        return err;
+    }
+    
+#if TEMP_SENSOR_TYPE_NTC
+    /* Per-unit calibration first - the shutdown threshold below is converted through it */
+    ntc_cal_init();
+#endif
+    
+    /* Configure scan, with the shutdown window comparator attached */
+    g_scan_cfg = g_adc0_cfg.scan_cfg;
+    thermal_shutdown_window_cfg(&g_window_cfg);
+    g_scan_cfg.p_window_cfg = &g_window_cfg;
+    err = R_ADC_ScanCfg(&g_adc0_ctrl, &g_scan_cfg);
     if (FSP_SUCCESS != err)
     {
         log_error("Rack Temperature Sensor: CONFIG FAILED\r\n");
@@ -73,47 +228,70 @@ fsp_err_t temp_sensor_adc_init(void)
         return err;
     }
     
+    g_hw_add_count = adc_hw_add_count();
+    sensor_fault_init(&g_sensor_fault, TEMP_TIMESTAMP_CYCLES_PER_MS, g_hw_add_count, TEMP_TIMESTAMP_NOW());
+    
     log_info("Rack Temperature Sensor: ONLINE\r\n");
     log_info("Monitoring Range: 0-65°C\r\n");
+    log_info("Resolution: %d bit (%lu scans/reading)\r\n",
+             temp_sensor_get_effective_bits(), temp_sensor_get_scans_per_reading());
     return FSP_SUCCESS;
 }
 
+/**
+ * @brief Drain the sample ring and run plausibility checks
+ * @note  Call every main-loop iteration - fault detection latency is bounded by the loop period
+ */
+void temp_sensor_service(void)
+{
+    temp_sample_t batch[TEMP_DRAIN_BATCH_SIZE];
+    uint32_t count;
+    
+    do
+    {
+        count = sample_ring_pop_batch(&g_sample_ring, batch, TEMP_DRAIN_BATCH_SIZE);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            temp_sensor_process_sample(&batch[i]);
+        }
+    } while (TEMP_DRAIN_BATCH_SIZE == count);
+    
+    sensor_fault_check_timeout(&g_sensor_fault, TEMP_SENSOR_NUM_PROBES, TEMP_TIMESTAMP_NOW());
+}
+
 /**
  * @brief Read Rack Temperature from ADC
  * @param[out] p_temperature Pointer to store temperature in Celsius
  * @return FSP_SUCCESS if successful
+ * @return FSP_ERR_UNDERFLOW if no decimated reading is available yet
+ * @return FSP_ERR_INVALID_DATA if the plausibility layer has latched a sensor fault
  */
 fsp_err_t temp_sensor_read_adc(float *p_temperature)
 {
-    fsp_err_t err = FSP_SUCCESS;
-    uint16_t adc_result = 0;
-    float voltage = 0.0f;
-    float temperature = 0.0f;
-    
     if (NULL == p_temperature)
     {
         return FSP_ERR_INVALID_ARGUMENT;
     }
     
-    /* Read ADC value */
-    err = R_ADC_Read(&g_adc0_ctrl, TEMP_SENSOR_CHANNEL, &adc_result);
-    if (FSP_SUCCESS != err)
+    /* Fold everything the ISR has buffered so far */
+    temp_sensor_service();
+    
+    if (!g_oversample[0].valid)
     {
-        log_error("ADC Read FAILED\r\n");
-        return err;
+        /* Not enough conversions yet for the first decimated result */
+        return FSP_ERR_UNDERFLOW;
     }
     
-    /* Convert ADC value to voltage */
-    voltage = ((float)adc_result / (float)ADC_MAX_VALUE) * ADC_REFERENCE_VOLTAGE;
+    *p_temperature = g_probe_temp[0];
     
-    /* Convert voltage to temperature */
-    /* Formula: Temp = 25 + (V_ref - V_adc) / TC */
-    temperature = 25.0f + ((TEMP_SENSOR_V_25 - voltage) / TEMP_SENSOR_TC);
+    log_debug("Rack Temp: ADC=0x%05lx (%d bit), T=%.2f°C\r\n", 
+             g_oversample[0].counts, temp_sensor_get_effective_bits(), g_probe_temp[0]);
     
-    *p_temperature = temperature;
-    
-    log_debug("Rack Temp: ADC=0x%04x, V=%.3fV, T=%.1f°C\r\n", 
-             adc_result, voltage, temperature);
+    if (SENSOR_FAULT_NONE != sensor_fault_active(&g_sensor_fault))
+    {
+        log_error("Rack Temp: implausible reading, faults=0x%02lx\r\n", sensor_fault_active(&g_sensor_fault));
+        return FSP_ERR_INVALID_DATA;
+    }
     
     return FSP_SUCCESS;
 }
@@ -134,3 +312,68 @@ uint32_t temp_sensor_get_sample_count(void)
 {
     return g_sample_count;
 }
+
+/**
+ * @brief Drain buffered ADC samples in one batch
+ * @param[out] p_samples   Destination array
+ * @param[in]  max_samples Capacity of p_samples
+ * @return Number of samples copied (oldest first)
+ */
+uint32_t temp_sensor_drain_samples(temp_sample_t *p_samples, uint32_t max_samples)
+{
+    if (NULL == p_samples)
+    {
+        return 0;
+    }
+
+    return sample_ring_pop_batch(&g_sample_ring, p_samples, max_samples);
+}
+
+/**
+ * @brief Get number of samples dropped because the consumer fell behind
+ */
+uint32_t temp_sensor_get_overrun_count(void)
+{
+    return g_sample_ring.overruns;
+}
+
+/**
+ * @brief Get highest ring fill level observed at drain time
+ */
+uint32_t temp_sensor_get_ring_high_water(void)
+{
+    return g_sample_ring.high_water;
+}
+
+/**
+ * @brief Get effective resolution of temp_sensor_read_adc() results
+ */
+uint8_t temp_sensor_get_effective_bits(void)
+{
+    return (uint8_t)(ADC_RESOLUTION + TEMP_OVERSAMPLE_EXTRA_BITS);
+}
+
+/**
+ * @brief Get ADC scan interrupts needed per decimated reading
+ * @note  Cost proxy: CPU time and ADC energy both scale with this figure
+ */
+uint32_t temp_sensor_get_scans_per_reading(void)
+{
+    return (TEMP_OVERSAMPLE_RATIO + g_hw_add_count - 1U) / g_hw_add_count;
+}
+
+/**
+ * @brief Get latched sensor fault bits (SENSOR_FAULT_*)
+ */
+uint32_t temp_sensor_get_faults(void)
+{
+    return sensor_fault_active(&g_sensor_fault);
+}
+
+/**
+ * @brief Get timestamp of the sample that opened the current fault episode
+ */
+uint32_t temp_sensor_get_fault_timestamp(void)
+{
+    return g_sensor_fault.fault_timestamp;
+}
@@ -7,6 +7,7 @@
 #define TEMPERATURE_SENSOR_H_
 
 #include "hal_data.h"
+#include "sample_ring.h"
 
 /* Temperature Sensor Configuration for Rack Monitoring */
 #define TEMP_MIN_CELSIUS        0.0f
@@ -20,12 +21,44 @@
 #define ADC_MAX_VALUE           4095          /* 2^12 - 1 */
 #define ADC_REFERENCE_VOLTAGE   3.3f          /* 3.3V reference */
 #define TEMP_SENSOR_CHANNEL     0             /* ADC channel for rack temperature */
+#define TEMP_DRAIN_BATCH_SIZE   16            /* Samples consumed per main-loop drain */
+
+/* Redundant Probe for Plausibility Cross-Check */
+#define TEMP_SENSOR_REDUNDANT_ENABLE    1
+#define TEMP_SENSOR_REDUNDANT_CHANNEL   1     /* AN001 - second probe in the same air stream */
+#define TEMP_SENSOR_NUM_PROBES          (1U + TEMP_SENSOR_REDUNDANT_ENABLE)
+
+/* Sensor Type - 1: NTC thermistor divider (table linearization + per-unit calibration, ntc_thermistor.h)
+ *               0: linear analog sensor (TEMP_SENSOR_V_25 / TEMP_SENSOR_TC) */
+#define TEMP_SENSOR_TYPE_NTC            1
+
+/* Sample Timestamps (DWT cycle counter) */
+#define TEMP_TIMESTAMP_NOW()            (DWT->CYCCNT)
+#define TEMP_TIMESTAMP_CYCLES_PER_MS    (SystemCoreClock / 1000U)
+#define TEMP_TIMESTAMP_CYCLES_PER_US    (SystemCoreClock / 1000000U)
+
+/* Oversampling & Decimation
+ * Each extra bit of resolution costs 4x conversions (OSR = 4^n). When the ADC unit is configured for
+ * hardware addition (Add/Average Count in the FSP configurator, channel in the addition mask) each
+ * scan result already holds that many conversions and the software accumulator needs fewer of them. */
+#define TEMP_OVERSAMPLE_EXTRA_BITS  2                                    /* 0 = off, 1-4 = 13-16 bit */
+#define TEMP_OVERSAMPLE_RATIO       (1UL << (2U * TEMP_OVERSAMPLE_EXTRA_BITS))
+#define TEMP_OVERSAMPLE_FULL_SCALE  ((uint32_t)ADC_MAX_VALUE << TEMP_OVERSAMPLE_EXTRA_BITS)
 
 /* Function Declarations */
 fsp_err_t temp_sensor_adc_init(void);
 fsp_err_t temp_sensor_read_adc(float *p_temperature);
 void temp_sensor_adc_deinit(void);
 uint32_t temp_sensor_get_sample_count(void);
+uint32_t temp_sensor_drain_samples(temp_sample_t *p_samples, uint32_t max_samples);
+uint32_t temp_sensor_get_overrun_count(void);
+uint32_t temp_sensor_get_ring_high_water(void);
+uint8_t temp_sensor_get_effective_bits(void);
+uint32_t temp_sensor_get_scans_per_reading(void);
+void temp_sensor_service(void);
+uint16_t temp_sensor_celsius_to_counts(uint16_t channel, float temperature);
+uint32_t temp_sensor_get_faults(void);
+uint32_t temp_sensor_get_fault_timestamp(void);
 
 /* Temperature Data Structure for Rack Monitoring */
 typedef struct {
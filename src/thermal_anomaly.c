@@ -0,0 +1,156 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_anomaly.c
+ * Description  : Thermal Anomaly Detector - EWMA z-score (sudden excursions) and CUSUM on the
+ *                temperature-versus-duty residual (slow degradation: clogging filter, weakening fan)
+ *
+ * For a given fan duty a healthy rack settles at a repeatable temperature. Each duty band keeps a slow
+ * EWMA of that temperature and of its variance; the residual against it, in units of the band's spread,
+ * feeds a one-sided CUSUM. Small persistent excesses accumulate where a threshold would never fire.
+ **********************************************************************************************************************/
+
+#include <math.h>
+#include <string.h>
+#include "thermal_anomaly.h"
+
+/**
+ * @brief Exponentially weighted mean/variance update (West's incremental form)
+ * @param[in] p_ewma Metric state
+ * @param[in] x      New value
+ * @param[in] alpha  Weight of the new value
+ * @return Deviation of x from the mean before the update
+ */
+static float anomaly_ewma_update(anomaly_ewma_t *p_ewma, float x, float alpha)
+{
+    float diff;
+
+    if (0U == p_ewma->n)
+    {
+        p_ewma->mean = x;
+        p_ewma->var = 0.0f;
+        p_ewma->n = 1;
+        return 0.0f;
+    }
+
+    diff = x - p_ewma->mean;
+    p_ewma->mean += alpha * diff;
+    p_ewma->var = (1.0f - alpha) * (p_ewma->var + (alpha * diff * diff));
+    if (p_ewma->n < UINT32_MAX)
+    {
+        p_ewma->n++;
+    }
+    return diff;
+}
+
+/**
+ * @brief Standard deviation with a floor
+ */
+static float anomaly_stddev(anomaly_ewma_t const *p_ewma)
+{
+    float sd = sqrtf(p_ewma->var);
+
+    return (sd < ANOMALY_MIN_STDDEV) ? ANOMALY_MIN_STDDEV : sd;
+}
+
+/**
+ * @brief Reset the detector (baselines are relearned)
+ */
+void thermal_anomaly_init(thermal_anomaly_t *p_detector)
+{
+    memset(p_detector, 0, sizeof(*p_detector));
+}
+
+/**
+ * @brief Fold a completed block mean into the CUSUM and the band baseline
+ * @param[in] p_detector Detector state
+ * @param[in] p_band     Band the block was recorded in
+ * @param[in] block_mean Block mean (°C)
+ */
+static void anomaly_block_update(thermal_anomaly_t *p_detector, anomaly_band_t *p_band, float block_mean)
+{
+    float alpha;
+
+    if (p_band->blocks >= ANOMALY_WARMUP_BLOCKS)
+    {
+        p_detector->residual = block_mean - p_band->baseline;
+        p_detector->cusum += p_detector->residual - ANOMALY_CUSUM_K;
+        if (p_detector->cusum < 0.0f)
+        {
+            p_detector->cusum = 0.0f;
+        }
+        else if (p_detector->cusum > (2.0f * ANOMALY_CUSUM_H))
+        {
+            /* Bounded so a long episode still clears promptly once it ends */
+            p_detector->cusum = 2.0f * ANOMALY_CUSUM_H;
+        }
+
+        /* Raise above H, clear once the accumulated excess has drained below H/2 */
+        if (p_detector->cusum > ANOMALY_CUSUM_H)
+        {
+            p_detector->flags |= ANOMALY_DRIFT;
+        }
+        else if (p_detector->cusum < (ANOMALY_CUSUM_H / 2.0f))
+        {
+            p_detector->flags &= (uint8_t)~ANOMALY_DRIFT;
+        }
+    }
+
+    /* Cumulative average while learning, then a fixed long time constant */
+    p_band->blocks++;
+    alpha = (p_band->blocks < ANOMALY_BASELINE_BLOCKS) ? (1.0f / (float)p_band->blocks)
+                                                        : (1.0f / (float)ANOMALY_BASELINE_BLOCKS);
+    p_band->baseline += alpha * (block_mean - p_band->baseline);
+}
+
+/**
+ * @brief Feed one filtered sample
+ * @param[in] p_detector  Detector state
+ * @param[in] temperature Filtered temperature (°C)
+ * @param[in] duty_band   Duty band the fans ran in (cooling level)
+ * @param[in] dt_ms       Time the sample stands for (ms) - the sample rate may vary
+ * @return ANOMALY_* flags currently raised
+ */
+uint8_t thermal_anomaly_update(thermal_anomaly_t *p_detector, float temperature, uint8_t duty_band, uint32_t dt_ms)
+{
+    anomaly_band_t *p_band;
+    float sd;
+    float diff;
+
+    /* Excursion: deviation from the recent mean, scored against the spread before this sample */
+    sd = anomaly_stddev(&p_detector->temp);
+    diff = anomaly_ewma_update(&p_detector->temp, temperature, ANOMALY_FAST_ALPHA);
+    p_detector->z = diff / sd;
+    if ((p_detector->temp.n > (uint32_t)(2.0f / ANOMALY_FAST_ALPHA)) && (fabsf(p_detector->z) > ANOMALY_Z_THRESHOLD))
+    {
+        p_detector->flags |= ANOMALY_EXCURSION;
+    }
+    else
+    {
+        p_detector->flags &= (uint8_t)~ANOMALY_EXCURSION;
+    }
+
+    if (duty_band >= ANOMALY_NUM_BANDS)
+    {
+        return p_detector->flags;
+    }
+
+    /* A band change restarts the block - the temperature is still settling to the new duty */
+    p_band = &p_detector->band[duty_band];
+    if (duty_band != p_detector->last_band)
+    {
+        p_detector->band[p_detector->last_band].block_sum = 0.0f;
+        p_detector->band[p_detector->last_band].block_ms = 0;
+        p_detector->last_band = duty_band;
+    }
+
+    /* Degradation: block residual against this band's baseline, accumulated while positive */
+    p_band->block_sum += temperature * (float)dt_ms;
+    p_band->block_ms += dt_ms;
+    if (p_band->block_ms >= ANOMALY_BLOCK_MS)
+    {
+        anomaly_block_update(p_detector, p_band, p_band->block_sum / (float)p_band->block_ms);
+        p_band->block_sum = 0.0f;
+        p_band->block_ms = 0;
+    }
+
+    return p_detector->flags;
+}
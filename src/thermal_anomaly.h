@@ -0,0 +1,65 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_anomaly.h
+ * Description  : Thermal Anomaly Detector - EWMA z-score (sudden excursions) and CUSUM on the
+ *                temperature-versus-duty residual (slow degradation: clogging filter, weakening fan)
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_ANOMALY_H_
+#define THERMAL_ANOMALY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Excursion detector - fast EWMA mean/variance of temperature */
+#define ANOMALY_FAST_ALPHA              (0.05f)     /* ~20 sample memory */
+#define ANOMALY_Z_THRESHOLD             (4.0f)      /* |z| above this is an excursion */
+#define ANOMALY_MIN_STDDEV              (0.05f)     /* °C - floor so a flat signal does not give huge z */
+
+/* Degradation detector - per duty band, the temperature this rack normally runs at.
+ * Samples are averaged into time-weighted block means first: the baseline then moves in steps float can
+ * resolve, ordinary noise is gone before the CUSUM sees it, and a block spans the same time at any sample rate. */
+#define ANOMALY_NUM_BANDS               (5U)        /* One per cooling level */
+#define ANOMALY_BLOCK_MS                (60000U)    /* Time per block mean (1 min) */
+#define ANOMALY_BASELINE_BLOCKS         (4320U)     /* Baseline time constant in blocks (3 days) - much longer
+                                                       than the drift it has to expose */
+#define ANOMALY_WARMUP_BLOCKS           (720U)      /* Blocks per band before its residual is trusted (12 h) */
+#define ANOMALY_CUSUM_K                 (0.75f)     /* Allowance (°C) - covers a ±0.75 °C day/night swing in
+                                                       the baseline; raise it on sites with a wider one */
+#define ANOMALY_CUSUM_H                 (60.0f)     /* Decision threshold (°C x blocks): 1 °C excess for an hour */
+
+/* Findings */
+#define ANOMALY_NONE                    (0x00U)
+#define ANOMALY_EXCURSION               (0x01U)     /* Temperature far outside its recent spread */
+#define ANOMALY_DRIFT                   (0x02U)     /* Running hotter than usual for the same duty */
+
+/* Fast statistics - three words */
+typedef struct {
+    float mean;
+    float var;
+    uint32_t n;
+} anomaly_ewma_t;
+
+/* Slow baseline of one duty band - four words */
+typedef struct {
+    float baseline;             /* Usual temperature in this band (°C) */
+    float block_sum;            /* Sum of temperature x dt (°C x ms) */
+    uint32_t block_ms;
+    uint32_t blocks;            /* Block means folded into the baseline */
+} anomaly_band_t;
+
+/* Detector State */
+typedef struct {
+    anomaly_ewma_t temp;
+    anomaly_band_t band[ANOMALY_NUM_BANDS];
+    uint8_t last_band;
+    float cusum;                /* One-sided (upward) CUSUM of block residuals (°C x blocks) */
+    float z;                    /* Last excursion score */
+    float residual;             /* Last block residual (°C) */
+    uint8_t flags;              /* ANOMALY_* currently raised */
+} thermal_anomaly_t;
+
+/* Function Declarations */
+void thermal_anomaly_init(thermal_anomaly_t *p_detector);
+uint8_t thermal_anomaly_update(thermal_anomaly_t *p_detector, float temperature, uint8_t duty_band, uint32_t dt_ms);
+
+#endif /* THERMAL_ANOMALY_H_ */
@@ -0,0 +1,300 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_config.c
+ * Description  : Runtime Thermal Configuration - validated staging, atomic double-buffered apply, data flash storage
+ *
+ * Two banks: one is active (read by the control loop through thermal_config_get()), the other is staging.
+ * A writer claims staging (EMPTY -> WRITING), fills and validates it, then publishes it (-> READY).
+ * Between control iterations the loop swaps the active pointer to a READY bank and frees the old one.
+ * Readers never see a partially written bank, and the loop never waits on a writer.
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "common_utils.h"
+#include "main_application.h"
+#include "temperature_sensor.h"
+#include "thermal_config.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/* Staging bank states */
+#define STAGING_EMPTY       (0U)
+#define STAGING_WRITING     (1U)
+#define STAGING_READY       (2U)
+
+_Static_assert(sizeof(thermal_config_t) <= THERMAL_CONFIG_FLASH_BLOCK_SIZE, "thermal_config_t must fit one data flash block");
+
+/* Flash Instance */
+extern flash_ctrl_t g_flash0_ctrl;
+extern const flash_cfg_t g_flash0_cfg;
+
+/* Static variables */
+static thermal_config_t g_config_bank[2];
+static thermal_config_t * volatile gp_active = &g_config_bank[0];
+static atomic_uint g_staging_state = STAGING_EMPTY;
+static bool g_flash_open = false;
+
+/* Build-time defaults */
+static const thermal_config_t g_config_default = {
+    .magic              = THERMAL_CONFIG_MAGIC,
+    .version            = THERMAL_CONFIG_VERSION,
+    .sample_interval_ms = TEMP_SAMPLE_INTERVAL_MS,
+    .level_threshold    = { TEMP_LEVEL_OFF, TEMP_LEVEL_LOW, TEMP_LEVEL_MEDIUM, TEMP_LEVEL_HIGH },
+    .critical_temp      = SYSTEM_CRITICAL_TEMP,
+    .hysteresis         = TEMP_HYSTERESIS,
+    .ble_tx_interval_ms = BLE_TX_INTERVAL_MS,
+    .duty               = { PWM_DUTY_CYCLE_OFF, PWM_DUTY_CYCLE_LOW, PWM_DUTY_CYCLE_MEDIUM,
+                            PWM_DUTY_CYCLE_HIGH, PWM_DUTY_CYCLE_EMERGENCY },
+    .reserved           = 0,
+    .crc                = 0
+};
+
+/**
+ * @brief CRC-32 (IEEE, bitwise - only runs on config writes)
+ */
+static uint32_t thermal_config_crc(thermal_config_t const *p_config)
+{
+    uint8_t const *p_byte = (uint8_t const *)p_config;
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0; i < offsetof(thermal_config_t, crc); i++)
+    {
+        crc ^= p_byte[i];
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ (0xEDB88320UL & (0UL - (crc & 1UL)));
+        }
+    }
+    return ~crc;
+}
+
+/**
+ * @brief Check a configuration for internal consistency
+ * @return FSP_SUCCESS if it is safe to control with
+ */
+static fsp_err_t thermal_config_validate(thermal_config_t const *p_config)
+{
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        if ((p_config->level_threshold[i] < TEMP_MIN_CELSIUS) || (p_config->level_threshold[i] > SYSTEM_SHUTDOWN_TEMP))
+        {
+            return FSP_ERR_INVALID_ARGUMENT;
+        }
+        if ((i > 0) && (p_config->level_threshold[i] <= p_config->level_threshold[i - 1]))
+        {
+            return FSP_ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    for (uint8_t i = 0; i < 5; i++)
+    {
+        if ((p_config->duty[i] > 100U) || ((i > 0) && (p_config->duty[i] < p_config->duty[i - 1])))
+        {
+            return FSP_ERR_INVALID_ARGUMENT;
+        }
+    }
+
+    /* Full cooling is a safety invariant, not a tunable */
+    if (PWM_DUTY_CYCLE_EMERGENCY != p_config->duty[4])
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((p_config->critical_temp <= p_config->level_threshold[0]) || (p_config->critical_temp >= SYSTEM_SHUTDOWN_TEMP) ||
+        (p_config->hysteresis < 0.0f) || (p_config->hysteresis > THERMAL_CONFIG_MAX_HYSTERESIS))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    if ((p_config->sample_interval_ms < THERMAL_CONFIG_MIN_INTERVAL_MS) ||
+        (p_config->sample_interval_ms > THERMAL_CONFIG_MAX_INTERVAL_MS) ||
+        (p_config->ble_tx_interval_ms < THERMAL_CONFIG_MIN_INTERVAL_MS) ||
+        (p_config->ble_tx_interval_ms > THERMAL_CONFIG_MAX_INTERVAL_MS))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Load configuration from data flash, falling back to build-time defaults
+ */
+void thermal_config_init(void)
+{
+    thermal_config_t const *p_stored = (thermal_config_t const *)THERMAL_CONFIG_FLASH_ADDR;
+    fsp_err_t err;
+
+    err = R_FLASH_HP_Open(&g_flash0_ctrl, &g_flash0_cfg);
+    g_flash_open = (FSP_SUCCESS == err);
+
+    g_config_bank[0] = g_config_default;
+
+    if (g_flash_open &&
+        (THERMAL_CONFIG_MAGIC == p_stored->magic) &&
+        (THERMAL_CONFIG_VERSION == p_stored->version) &&
+        (thermal_config_crc(p_stored) == p_stored->crc) &&
+        (FSP_SUCCESS == thermal_config_validate(p_stored)))
+    {
+        g_config_bank[0] = *p_stored;
+        log_info("Thermal config: loaded from data flash\r\n");
+    }
+    else
+    {
+        log_info("Thermal config: using build defaults\r\n");
+    }
+
+    g_config_bank[0].crc = thermal_config_crc(&g_config_bank[0]);
+    gp_active = &g_config_bank[0];
+    atomic_store(&g_staging_state, STAGING_EMPTY);
+}
+
+/**
+ * @brief Get the active configuration
+ * @note  Take the pointer once per control iteration; it stays valid until the next apply
+ */
+thermal_config_t const * thermal_config_get(void)
+{
+    return gp_active;
+}
+
+/**
+ * @brief Decode, validate and stage a configuration written by a GATT client
+ * @param[in] p_data Wire-format payload
+ * @param[in] len    Payload length
+ * @return FSP_SUCCESS if staged for the next apply
+ * @return FSP_ERR_IN_USE if a previous write has not been applied yet
+ * @return FSP_ERR_INVALID_SIZE / FSP_ERR_INVALID_ARGUMENT on malformed or unsafe values
+ */
+fsp_err_t thermal_config_stage(uint8_t const *p_data, uint16_t len)
+{
+    unsigned int expected = STAGING_EMPTY;
+    thermal_config_t *p_staging;
+    fsp_err_t err;
+
+    if ((NULL == p_data) || (THERMAL_CONFIG_WIRE_SIZE != len))
+    {
+        return FSP_ERR_INVALID_SIZE;
+    }
+
+    /* Claim the staging bank; only one writer at a time, never the active bank */
+    if (!atomic_compare_exchange_strong(&g_staging_state, &expected, STAGING_WRITING))
+    {
+        return FSP_ERR_IN_USE;
+    }
+
+    p_staging = (gp_active == &g_config_bank[0]) ? &g_config_bank[1] : &g_config_bank[0];
+
+    p_staging->magic = THERMAL_CONFIG_MAGIC;
+    p_staging->version = (uint16_t)(p_data[0] | (p_data[1] << 8));
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        p_staging->level_threshold[i] = (float)(int16_t)(p_data[2 + (2 * i)] | (p_data[3 + (2 * i)] << 8)) / 100.0f;
+    }
+    p_staging->critical_temp = (float)(int16_t)(p_data[10] | (p_data[11] << 8)) / 100.0f;
+    p_staging->hysteresis = (float)p_data[12] / 10.0f;
+    memcpy(p_staging->duty, &p_data[13], sizeof(p_staging->duty));
+    p_staging->sample_interval_ms = (uint16_t)(p_data[18] | (p_data[19] << 8));
+    p_staging->ble_tx_interval_ms = (uint16_t)(p_data[20] | (p_data[21] << 8));
+    p_staging->reserved = 0;
+
+    err = (THERMAL_CONFIG_VERSION == p_staging->version) ? thermal_config_validate(p_staging) : FSP_ERR_INVALID_ARGUMENT;
+    if (FSP_SUCCESS != err)
+    {
+        atomic_store(&g_staging_state, STAGING_EMPTY);
+        log_error("Thermal config: write rejected\r\n");
+        return err;
+    }
+
+    p_staging->crc = thermal_config_crc(p_staging);
+
+    /* Publish - contents are complete before the state changes */
+    atomic_store(&g_staging_state, STAGING_READY);
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Swap in a staged configuration (call between control iterations)
+ * @return true if a new configuration became active
+ */
+bool thermal_config_apply_pending(void)
+{
+    if (STAGING_READY != atomic_load(&g_staging_state))
+    {
+        return false;
+    }
+
+    gp_active = (gp_active == &g_config_bank[0]) ? &g_config_bank[1] : &g_config_bank[0];
+
+    /* Old active bank becomes the next staging bank */
+    atomic_store(&g_staging_state, STAGING_EMPTY);
+    log_info("Thermal config: applied\r\n");
+    return true;
+}
+
+/**
+ * @brief Write the active configuration to data flash
+ * @note  Blocking erase+write of one data flash block; call outside the control step
+ */
+fsp_err_t thermal_config_persist(void)
+{
+    fsp_err_t err;
+    uint32_t block[THERMAL_CONFIG_FLASH_BLOCK_SIZE / sizeof(uint32_t)];
+
+    if (!g_flash_open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+
+    memset(block, 0xFF, sizeof(block));
+    memcpy(block, gp_active, sizeof(thermal_config_t));
+
+    err = R_FLASH_HP_Erase(&g_flash0_ctrl, THERMAL_CONFIG_FLASH_ADDR, 1);
+    if (FSP_SUCCESS == err)
+    {
+        err = R_FLASH_HP_Write(&g_flash0_ctrl, (uint32_t)block, THERMAL_CONFIG_FLASH_ADDR, sizeof(block));
+    }
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Thermal config: flash write FAILED\r\n");
+    }
+    return err;
+}
+
+/**
+ * @brief Encode a configuration in GATT wire format
+ * @param[in]  p_config Configuration
+ * @param[out] p_buf    Destination
+ * @param[in]  buf_len  Destination size
+ * @return Bytes written, 0 if the buffer is too small
+ */
+uint16_t thermal_config_serialize(thermal_config_t const *p_config, uint8_t *p_buf, uint16_t buf_len)
+{
+    int16_t value;
+
+    if (buf_len < THERMAL_CONFIG_WIRE_SIZE)
+    {
+        return 0;
+    }
+
+    p_buf[0] = (uint8_t)(p_config->version & 0xFF);
+    p_buf[1] = (uint8_t)((p_config->version >> 8) & 0xFF);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        value = (int16_t)(p_config->level_threshold[i] * 100.0f);
+        p_buf[2 + (2 * i)] = (uint8_t)(value & 0xFF);
+        p_buf[3 + (2 * i)] = (uint8_t)((value >> 8) & 0xFF);
+    }
+    value = (int16_t)(p_config->critical_temp * 100.0f);
+    p_buf[10] = (uint8_t)(value & 0xFF);
+    p_buf[11] = (uint8_t)((value >> 8) & 0xFF);
+    p_buf[12] = (uint8_t)(p_config->hysteresis * 10.0f);
+    memcpy(&p_buf[13], p_config->duty, sizeof(p_config->duty));
+    p_buf[18] = (uint8_t)(p_config->sample_interval_ms & 0xFF);
+    p_buf[19] = (uint8_t)((p_config->sample_interval_ms >> 8) & 0xFF);
+    p_buf[20] = (uint8_t)(p_config->ble_tx_interval_ms & 0xFF);
+    p_buf[21] = (uint8_t)((p_config->ble_tx_interval_ms >> 8) & 0xFF);
+
+    return THERMAL_CONFIG_WIRE_SIZE;
+}
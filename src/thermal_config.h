@@ -0,0 +1,54 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_config.h
+ * Description  : Runtime Thermal Configuration - validated staging, atomic double-buffered apply, data flash storage
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_CONFIG_H_
+#define THERMAL_CONFIG_H_
+
+#include "hal_data.h"
+
+/* Storage */
+#define THERMAL_CONFIG_MAGIC            (0x54434647UL)      /* "TCFG" */
+#define THERMAL_CONFIG_VERSION          (1U)
+#define THERMAL_CONFIG_FLASH_ADDR       (0x08000000UL)      /* First data flash block */
+#define THERMAL_CONFIG_FLASH_BLOCK_SIZE (64U)
+
+/* GATT Wire Format (little-endian, 22 bytes)
+ *   [0..1]   version
+ *   [2..9]   level thresholds OFF/LOW/MEDIUM/HIGH, int16 °C x 100
+ *   [10..11] critical alert temperature, int16 °C x 100
+ *   [12]     hysteresis, °C x 10
+ *   [13..17] duty OFF/LOW/MEDIUM/HIGH/EMERGENCY (%)
+ *   [18..19] sample interval (ms)
+ *   [20..21] BLE TX interval (ms) */
+#define THERMAL_CONFIG_WIRE_SIZE        (22U)
+
+/* Validation Limits */
+#define THERMAL_CONFIG_MIN_INTERVAL_MS  (100U)
+#define THERMAL_CONFIG_MAX_INTERVAL_MS  (60000U)
+#define THERMAL_CONFIG_MAX_HYSTERESIS   (5.0f)
+
+/* Active Configuration */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sample_interval_ms;
+    float level_threshold[4];       /* Upper threshold of OFF, LOW, MEDIUM, HIGH */
+    float critical_temp;
+    float hysteresis;
+    uint16_t ble_tx_interval_ms;
+    uint8_t duty[5];                /* Duty per cooling level (%) */
+    uint8_t reserved;
+    uint32_t crc;                   /* CRC-32 over everything above */
+} thermal_config_t;
+
+/* Function Declarations */
+void thermal_config_init(void);
+thermal_config_t const * thermal_config_get(void);
+fsp_err_t thermal_config_stage(uint8_t const *p_data, uint16_t len);
+bool thermal_config_apply_pending(void);
+fsp_err_t thermal_config_persist(void);
+uint16_t thermal_config_serialize(thermal_config_t const *p_config, uint8_t *p_buf, uint16_t buf_len);
+
+#endif /* THERMAL_CONFIG_H_ */
@@ -0,0 +1,168 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_policy.c
+ * Description  : Thermal Policy Kernel - cooling level, duty table and critical/shutdown alert rules, HAL-free, with a
+ *                batch form that scores a policy over a recorded temperature trace
+ **********************************************************************************************************************/
+
+#include <float.h>
+#include <string.h>
+#include "thermal_policy.h"
+
+_Static_assert(THERMAL_POLICY_BLOCK <= UINT16_MAX, "per-block counters are 16-bit");
+
+/**
+ * @brief Highest sample in a stretch (a NaN never is)
+ * @note  Compared as integer keys - the float bits with the magnitude flipped for negatives, so integer order is
+ *        float order. An integer max reduction vectorizes; a float compare-select one does not, the compiler may
+ *        not reorder it around NaN.
+ * @return Peak (°C), -FLT_MAX if there is no number in the stretch
+ */
+static float thermal_policy_peak(float const *p_temp, uint32_t count)
+{
+    int32_t top = INT32_MIN;
+    float peak;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        int32_t bits;
+        int32_t key;
+        int32_t nan;
+
+        memcpy(&bits, &p_temp[i], sizeof(bits));
+        key = bits ^ (int32_t)((uint32_t)(bits >> 31) >> 1);
+        nan = -(int32_t)((bits & 0x7FFFFFFF) > 0x7F800000);
+        key = (key & ~nan) | (INT32_MIN & nan);
+        top = (key > top) ? key : top;
+    }
+
+    if (INT32_MIN == top)
+    {
+        return -FLT_MAX;
+    }
+    top ^= (int32_t)((uint32_t)(top >> 31) >> 1);
+    memcpy(&peak, &top, sizeof(peak));
+    return peak;
+}
+
+/**
+ * @brief Start a trace: no level yet, no alerts, empty metrics
+ * @param[out] p_state   Batch state
+ * @param[out] p_metrics Metrics
+ */
+void thermal_policy_batch_init(thermal_policy_state_t *p_state, thermal_policy_metrics_t *p_metrics)
+{
+    memset(p_state, 0, sizeof(*p_state));
+    memset(p_metrics, 0, sizeof(*p_metrics));
+    p_metrics->shutdown_sample = UINT64_MAX;
+    p_metrics->peak_temp = -FLT_MAX;
+}
+
+/**
+ * @brief Run a policy over a stretch of samples, as pwm_control_update() would decide them
+ * @note  Three passes per block: levels (independent per sample - vectorizes) and the peak, the alert latch (the only
+ *        sample-to-sample dependency, scalar), then time per level and transitions (vectorizes). Once the shutdown
+ *        latches the fans stay at EMERGENCY, as they do behind the tripped POEG. Feed-forward and energy trim are not
+ *        modelled - this is the table policy a configuration defines.
+ * @param[in]     p_policy  Policy
+ * @param[in]     p_temp    Samples (°C), evenly spaced
+ * @param[in]     count     Number of samples
+ * @param[in,out] p_state   Batch state (thermal_policy_batch_init() before the first stretch of a trace)
+ * @param[in,out] p_metrics Metrics, accumulated
+ */
+void thermal_policy_batch(thermal_policy_t const *p_policy, float const *p_temp, uint32_t count,
+                          thermal_policy_state_t *p_state, thermal_policy_metrics_t *p_metrics)
+{
+    uint8_t level[THERMAL_POLICY_BLOCK];
+    float const th0 = p_policy->level_threshold[0];
+    float const th1 = p_policy->level_threshold[1];
+    float const th2 = p_policy->level_threshold[2];
+    float const th3 = p_policy->level_threshold[3];
+    float const critical_temp = p_policy->critical_temp;
+    float const hysteresis = p_policy->hysteresis;
+    float const shutdown_temp = p_policy->shutdown_temp;
+    float peak = p_metrics->peak_temp;
+
+    for (uint32_t base = 0; base < count; base += THERMAL_POLICY_BLOCK)
+    {
+        float const *p_block = &p_temp[base];
+        uint32_t n = ((count - base) < THERMAL_POLICY_BLOCK) ? (count - base) : THERMAL_POLICY_BLOCK;
+        uint32_t trip = n;
+        uint16_t changes = 0;       /* Block counters are 16-bit: a block fits, and narrow lanes vectorize wider */
+        uint32_t raised = 0;
+        uint32_t critical = 0;
+        uint16_t time_at[THERMAL_POLICY_LEVELS] = { 0 };
+        uint8_t alert = p_state->alert;
+        uint8_t prev;
+        float block_peak;
+
+        /* Pass 1: level per sample, then the peak */
+        for (uint32_t i = 0; i < n; i++)
+        {
+            float t = p_block[i];
+
+            level[i] = (uint8_t)(!(t < th0) + !(t < th1) + !(t < th2) + !(t < th3));
+        }
+        block_peak = thermal_policy_peak(p_block, n);
+        peak = (block_peak > peak) ? block_peak : peak;
+
+        /* Pass 2: critical alert with hysteresis, shutdown latch - the firmware's own rule, sample by sample.
+         * Most of a trace sits well below critical: with no alert active and the whole block under the clear
+         * level nothing can change (a NaN neither raises nor clears), so only blocks near critical pay for it. */
+        if (alert & THERMAL_POLICY_ALERT_SHUTDOWN)
+        {
+            trip = 0;
+        }
+        if ((alert & THERMAL_POLICY_ALERT_CRITICAL) || !(block_peak < (critical_temp - hysteresis)))
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                uint8_t was = alert;
+
+                alert = thermal_policy_alert(alert, p_block[i], critical_temp, hysteresis, shutdown_temp);
+                raised += (uint32_t)((alert & ~was) & THERMAL_POLICY_ALERT_CRITICAL);
+                critical += (uint32_t)(alert & THERMAL_POLICY_ALERT_CRITICAL);
+                trip = ((alert & ~was) & THERMAL_POLICY_ALERT_SHUTDOWN) ? i : trip;
+            }
+            if ((trip < n) && (UINT64_MAX == p_metrics->shutdown_sample))
+            {
+                p_metrics->shutdown_sample = p_metrics->samples + trip;
+            }
+        }
+        if (trip < n)
+        {
+            memset(&level[trip], 4, n - trip);
+        }
+        p_state->alert = alert;
+
+        /* Pass 3: time per level and transitions */
+        prev = p_state->started ? p_state->level : level[0];
+        changes = (uint16_t)(level[0] != prev);
+        for (uint32_t i = 1; i < n; i++)
+        {
+            changes = (uint16_t)(changes + (level[i] != level[i - 1]));
+        }
+        for (uint32_t i = 0; i < n; i++)
+        {
+            uint8_t l = level[i];
+
+            time_at[0] = (uint16_t)(time_at[0] + (0 == l));
+            time_at[1] = (uint16_t)(time_at[1] + (1 == l));
+            time_at[2] = (uint16_t)(time_at[2] + (2 == l));
+            time_at[3] = (uint16_t)(time_at[3] + (3 == l));
+            time_at[4] = (uint16_t)(time_at[4] + (4 == l));
+        }
+
+        for (uint8_t k = 0; k < THERMAL_POLICY_LEVELS; k++)
+        {
+            p_metrics->level_samples[k] += time_at[k];
+        }
+        p_metrics->level_changes += changes;
+        p_metrics->critical_alerts += raised;
+        p_metrics->critical_samples += critical;
+        p_metrics->samples += n;
+        p_state->level = level[n - 1];
+        p_state->started = true;
+    }
+
+    p_metrics->peak_temp = peak;
+}
@@ -0,0 +1,122 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_policy.h
+ * Description  : Thermal Policy Kernel - cooling level, duty table and critical/shutdown alert rules, HAL-free, with a
+ *                batch form that scores a policy over a recorded temperature trace
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_POLICY_H_
+#define THERMAL_POLICY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Cooling Levels - OFF, LOW, MEDIUM, HIGH, EMERGENCY */
+#define THERMAL_POLICY_LEVELS           (5U)
+
+/* Alert bits - same values as SYSTEM_ALERT_CRITICAL_TEMP / SYSTEM_ALERT_THERMAL_SHUTDOWN (src/main_application.h) */
+#define THERMAL_POLICY_ALERT_CRITICAL   (0x01U)
+#define THERMAL_POLICY_ALERT_SHUTDOWN   (0x04U)
+
+/* Batch Block - samples classified per pass; the level scratch stays in L1 */
+#define THERMAL_POLICY_BLOCK            (1024U)
+
+/* Policy - the thermal_config_t fields the control decision depends on */
+typedef struct {
+    float level_threshold[4];   /* Upper threshold of OFF, LOW, MEDIUM, HIGH (ascending) */
+    float critical_temp;
+    float hysteresis;           /* Critical alert clears this far below critical_temp */
+    float shutdown_temp;        /* Latched hardware shutdown (SYSTEM_SHUTDOWN_TEMP) */
+    uint8_t duty[THERMAL_POLICY_LEVELS];
+} thermal_policy_t;
+
+/* Batch State - carried between calls so a trace can be fed in pieces */
+typedef struct {
+    uint8_t level;
+    uint8_t alert;              /* THERMAL_POLICY_ALERT_* */
+    bool started;               /* A sample has been classified (the first sets the level, no transition) */
+} thermal_policy_state_t;
+
+/* Batch Metrics - what one policy did over a trace */
+typedef struct {
+    uint64_t samples;
+    uint64_t level_samples[THERMAL_POLICY_LEVELS];  /* Time at each level (samples) - energy follows from the duty */
+    uint32_t level_changes;     /* Fan speed changes */
+    uint32_t critical_alerts;   /* Critical alert raised (edges) */
+    uint64_t critical_samples;  /* Time with the critical alert active */
+    uint64_t shutdown_sample;   /* Sample the shutdown latched at, UINT64_MAX if it never did */
+    float peak_temp;
+} thermal_policy_metrics_t;
+
+/**
+ * @brief Cooling level for a temperature
+ * @note  Counts the thresholds reached rather than branching - same result as the if-chain for ascending
+ *        thresholds, and a NaN lands on EMERGENCY as it does there
+ * @param[in] p_threshold Upper thresholds of OFF, LOW, MEDIUM, HIGH
+ * @param[in] temperature Rack temperature (°C)
+ * @return Cooling level (0=OFF ... 4=EMERGENCY)
+ */
+static inline uint8_t thermal_policy_level(float const *p_threshold, float temperature)
+{
+    return (uint8_t)(!(temperature < p_threshold[0]) + !(temperature < p_threshold[1]) +
+                     !(temperature < p_threshold[2]) + !(temperature < p_threshold[3]));
+}
+
+/**
+ * @brief Duty for a cooling level
+ * @param[in] p_duty        Duty table OFF ... EMERGENCY (%)
+ * @param[in] cooling_level Cooling level (0-4)
+ * @return Duty (%), 0 for an out-of-range level
+ */
+static inline uint8_t thermal_policy_duty(uint8_t const *p_duty, uint8_t cooling_level)
+{
+    return (cooling_level < THERMAL_POLICY_LEVELS) ? p_duty[cooling_level] : 0U;
+}
+
+/**
+ * @brief Feed-forward duty ahead of a predicted level crossing
+ * @note  Linear ramp: nothing at the horizon, the full step to the next level's duty at the predicted crossing
+ * @param[in] p_duty        Duty table OFF ... EMERGENCY (%)
+ * @param[in] cooling_level Reactive cooling level (0-4, EMERGENCY gets nothing)
+ * @param[in] time_to_cross Predicted seconds until the level's upper threshold, negative if not approaching it
+ * @param[in] horizon_s     Ramp starts this long before the crossing (s, > 0)
+ * @return Extra duty (%) on top of the table duty
+ */
+static inline uint8_t thermal_policy_feedforward(uint8_t const *p_duty, uint8_t cooling_level, float time_to_cross,
+                                                 float horizon_s)
+{
+    if ((cooling_level >= (THERMAL_POLICY_LEVELS - 1U)) || (time_to_cross < 0.0f) || (time_to_cross >= horizon_s))
+    {
+        return 0U;
+    }
+    return (uint8_t)((1.0f - (time_to_cross / horizon_s)) *
+                     (float)(p_duty[cooling_level + 1U] - p_duty[cooling_level]));
+}
+
+/**
+ * @brief Critical and shutdown alerts after a sample - shutdown latches, critical clears with hysteresis
+ * @note  Shutdown is the superset (it raises critical too). Written as set/clear masks rather than an if-chain:
+ *        same result, no data-dependent branches when a trace sits around the critical temperature.
+ * @param[in] alert         Alert bits before the sample (other bits pass through)
+ * @param[in] temperature   Rack temperature (°C)
+ * @param[in] critical_temp Critical alert temperature (°C)
+ * @param[in] hysteresis    Clear margin below critical_temp (°C, >= 0)
+ * @param[in] shutdown_temp Shutdown temperature (°C)
+ * @return Alert bits after the sample
+ */
+static inline uint8_t thermal_policy_alert(uint8_t alert, float temperature, float critical_temp, float hysteresis,
+                                           float shutdown_temp)
+{
+    uint8_t set = (uint8_t)(((temperature >= shutdown_temp) ? (THERMAL_POLICY_ALERT_CRITICAL |
+                                                               THERMAL_POLICY_ALERT_SHUTDOWN) : 0U) |
+                            ((temperature >= critical_temp) ? THERMAL_POLICY_ALERT_CRITICAL : 0U));
+    uint8_t clear = (temperature < (critical_temp - hysteresis)) ? THERMAL_POLICY_ALERT_CRITICAL : 0U;
+
+    return (uint8_t)(set | (alert & ~clear));
+}
+
+/* Function Declarations */
+void thermal_policy_batch_init(thermal_policy_state_t *p_state, thermal_policy_metrics_t *p_metrics);
+void thermal_policy_batch(thermal_policy_t const *p_policy, float const *p_temp, uint32_t count,
+                          thermal_policy_state_t *p_state, thermal_policy_metrics_t *p_metrics);
+
+#endif /* THERMAL_POLICY_H_ */
@@ -0,0 +1,208 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_shutdown.c
+ * Description  : Hardware Thermal Shutdown - confirmed ADC window compare -> shutdown GPIO (ELC) + POEG fan forcing
+ *
+ * Reaction chain:
+ *   ADC0 window A, band mode on the shutdown channel:
+ *     rail floor (SENSOR_RAIL_LOW_COUNTS + THERMAL_SHUTDOWN_RAIL_MARGIN_COUNTS) < counts < shutdown counts
+ *     NTC counts fall as temperature rises; a shorted or grounded probe sits below the band and is left to
+ *     sensor_fault (emergency cooling), an open probe sits above it.
+ *   Every in-band scan raises a compare event; THERMAL_SHUTDOWN_CONFIRM_SCANS of them in consecutive scans
+ *   are needed, so one noisy conversion never latches.
+ *     -> after CONFIRM_SCANS - 1 events the ISR links ADC0_WINDOW_A to IOPORT1 through the ELC: the
+ *        confirming conversion itself sets the shutdown GPIO via the port event output (P106, EOSR), without
+ *        waiting for the CPU. A broken run unlinks it again.
+ *     -> the confirming compare interrupt calls R_POEG_OutputDisable(): both fan GTIOCB pins are forced to
+ *        their disable level (HIGH = 100% duty, see gtiocb_disable_setting in configuration.xml).
+ *        The RA6E2 POEG has no ELC input (its triggers are the GTETRG pin, GPT output level, oscillation stop
+ *        and software), so this step is software, from interrupt context - not the main loop.
+ * The condition is latched until reset; POEG is never released from software.
+ **********************************************************************************************************************/
+
+#include "common_utils.h"
+#include "main_application.h"
+#include "thermal_shutdown.h"
+#include "sensor_fault.h"
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/* HAL Instances */
+extern poeg_ctrl_t g_poeg0_ctrl;
+extern const poeg_cfg_t g_poeg0_cfg;
+extern elc_ctrl_t g_elc_ctrl;
+extern const elc_cfg_t g_elc_cfg;
+extern const adc_cfg_t g_adc0_cfg;
+
+#if THERMAL_SHUTDOWN_CONFIRM_SCANS < 2U
+#error "THERMAL_SHUTDOWN_CONFIRM_SCANS < 2 - the ELC link is armed one event before confirmation"
+#endif
+
+/* Static variables */
+static thermal_shutdown_confirm_t g_confirm;
+static volatile bool g_elc_armed = false;
+static volatile bool g_shutdown_tripped = false;
+static volatile uint32_t g_trip_count = 0;
+static volatile uint32_t g_trip_timestamp = 0;
+
+#if THERMAL_SHUTDOWN_HW_ENABLE
+/**
+ * @brief Check that window A preempts scan end, so each scan's compare event is counted before its scan-complete
+ * @note  Runs before R_ADC_Open(), which programs these priorities into the NVIC - so the configuration is checked,
+ *        not NVIC_GetPriority() (lower value = higher priority on Cortex-M)
+ */
+static bool thermal_shutdown_irq_order_ok(void)
+{
+    adc_extended_cfg_t const *p_extend = (adc_extended_cfg_t const *)g_adc0_cfg.p_extend;
+
+    return (FSP_INVALID_VECTOR != p_extend->window_a_irq) && (FSP_INVALID_VECTOR != g_adc0_cfg.scan_end_irq) &&
+           (p_extend->window_a_ipl < g_adc0_cfg.scan_end_ipl);
+}
+#endif
+
+/**
+ * @brief Open POEG and the ELC, and preset the shutdown GPIO event output
+ * @return FSP_SUCCESS if POEG is open (the ELC path is best effort),
+ *         FSP_ERR_INVALID_ARGUMENT if window A is not above scan end (POEG is open, the window path is not armed)
+ */
+fsp_err_t thermal_shutdown_init(void)
+{
+    fsp_err_t err = FSP_SUCCESS;
+    
+    memset(&g_confirm, 0, sizeof(g_confirm));
+    g_elc_armed = false;
+    
+    R_IOPORT_PinWrite(&g_ioport_ctrl, THERMAL_SHUTDOWN_PIN,
+                      (BSP_IO_LEVEL_HIGH == THERMAL_SHUTDOWN_PIN_ACTIVE) ? BSP_IO_LEVEL_LOW : BSP_IO_LEVEL_HIGH);
+    
+    err = R_POEG_Open(&g_poeg0_ctrl, &g_poeg0_cfg);
+    if (FSP_SUCCESS != err)
+    {
+        log_error("Thermal shutdown: POEG open FAILED\r\n");
+        return err;
+    }
+    
+#if THERMAL_SHUTDOWN_HW_ENABLE
+    if (!thermal_shutdown_irq_order_ok())
+    {
+        /* Every scan-complete would break the run before its compare event counts - the path never confirms */
+        log_error("Thermal shutdown: ADC window A interrupt not above scan end - window path NOT armed\r\n");
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+
+    /* Port 1 event output: an IOPORT1 event drives the shutdown pin to its active level. The link itself is
+     * only made once a run of compare events is one short of confirmation (thermal_shutdown_isr). */
+    err = R_IOPORT_PinEventOutputWrite(&g_ioport_ctrl, THERMAL_SHUTDOWN_PIN, THERMAL_SHUTDOWN_PIN_ACTIVE);
+    if (FSP_SUCCESS == err)
+    {
+        err = R_ELC_Open(&g_elc_ctrl, &g_elc_cfg);
+    }
+    if (FSP_SUCCESS == err)
+    {
+        err = R_ELC_Enable(&g_elc_ctrl);
+    }
+    if (FSP_SUCCESS != err)
+    {
+        /* ISR path still forces the outputs and drives the pin */
+        log_error("Thermal shutdown: ELC/event output setup FAILED\r\n");
+    }
+#endif
+    
+    log_info("Thermal shutdown: ARMED at %.1f°C (%d-%d counts, %u scans)\r\n", SYSTEM_SHUTDOWN_TEMP,
+             SENSOR_RAIL_LOW_COUNTS + THERMAL_SHUTDOWN_RAIL_MARGIN_COUNTS,
+             temp_sensor_celsius_to_counts(THERMAL_SHUTDOWN_CHANNEL, SYSTEM_SHUTDOWN_TEMP),
+             THERMAL_SHUTDOWN_CONFIRM_SCANS);
+    return FSP_SUCCESS;
+}
+
+/**
+ * @brief Fill ADC window A settings for the shutdown comparator
+ * @param[out] p_window_cfg Window configuration passed to R_ADC_ScanCfg()
+ */
+void thermal_shutdown_window_cfg(adc_window_cfg_t *p_window_cfg)
+{
+    memset(p_window_cfg, 0, sizeof(*p_window_cfg));
+    
+#if THERMAL_SHUTDOWN_HW_ENABLE
+    /* Sensor voltage falls as temperature rises: fire inside the band between the rail floor and the shutdown
+     * counts (window mode, compare mode bit set = "ref_low < converted value < ref_high") */
+    p_window_cfg->compare_cfg       = ADC_COMPARE_CFG_A_ENABLE | ADC_COMPARE_CFG_WINDOW_ENABLE |
+                                      ADC_COMPARE_CFG_EVENT_OUTPUT_OR;
+    p_window_cfg->compare_mask      = (1UL << THERMAL_SHUTDOWN_CHANNEL);
+    p_window_cfg->compare_mode_mask = (1UL << THERMAL_SHUTDOWN_CHANNEL);
+    p_window_cfg->compare_ref_low   = (uint16_t)(SENSOR_RAIL_LOW_COUNTS + THERMAL_SHUTDOWN_RAIL_MARGIN_COUNTS);
+    p_window_cfg->compare_ref_high  = temp_sensor_celsius_to_counts(THERMAL_SHUTDOWN_CHANNEL, SYSTEM_SHUTDOWN_TEMP);
+#endif
+}
+
+/**
+ * @brief Window compare interrupt handler (called from the ADC callback)
+ * @note  Latches only on the THERMAL_SHUTDOWN_CONFIRM_SCANS-th consecutive event; the one before it arms the
+ *        ELC link so the confirming conversion asserts the shutdown GPIO in hardware.
+ */
+void thermal_shutdown_isr(void)
+{
+    if (thermal_shutdown_confirm_event(&g_confirm))
+    {
+        thermal_shutdown_trip();
+    }
+#if THERMAL_SHUTDOWN_HW_ENABLE
+    else if (!g_elc_armed && ((g_confirm.hits + 1U) >= THERMAL_SHUTDOWN_CONFIRM_SCANS))
+    {
+        g_elc_armed = (FSP_SUCCESS == R_ELC_LinkSet(&g_elc_ctrl, ELC_PERIPHERAL_IOPORT1, ELC_EVENT_ADC0_WINDOW_A));
+    }
+#endif
+}
+
+/**
+ * @brief Scan-complete hook (called from the ADC callback) - breaks the run when a scan had no compare event
+ */
+void thermal_shutdown_scan_end_isr(void)
+{
+    if (thermal_shutdown_confirm_scan_end(&g_confirm) && g_elc_armed && !g_shutdown_tripped)
+    {
+        R_ELC_LinkBreak(&g_elc_ctrl, ELC_PERIPHERAL_IOPORT1);
+        g_elc_armed = false;
+    }
+}
+
+/**
+ * @brief Force fans to full and assert the shutdown GPIO
+ * @note  Safe from ISR and thread context; idempotent
+ */
+void thermal_shutdown_trip(void)
+{
+    /* Outputs first - everything else is bookkeeping */
+    R_POEG_OutputDisable(&g_poeg0_ctrl);
+    R_IOPORT_PinWrite(&g_ioport_ctrl, THERMAL_SHUTDOWN_PIN, THERMAL_SHUTDOWN_PIN_ACTIVE);
+    
+    if (!g_shutdown_tripped)
+    {
+        g_trip_timestamp = TEMP_TIMESTAMP_NOW();
+        g_trip_count++;
+        g_shutdown_tripped = true;
+    }
+}
+
+/**
+ * @brief Check whether the emergency path has fired since reset
+ */
+bool thermal_shutdown_is_tripped(void)
+{
+    return g_shutdown_tripped;
+}
+
+/**
+ * @brief Get number of trips since reset
+ */
+uint32_t thermal_shutdown_get_trip_count(void)
+{
+    return g_trip_count;
+}
+
+/**
+ * @brief Get sample-clock timestamp of the first trip
+ */
+uint32_t thermal_shutdown_get_trip_timestamp(void)
+{
+    return g_trip_timestamp;
+}
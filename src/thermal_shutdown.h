@@ -0,0 +1,33 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_shutdown.h
+ * Description  : Hardware Thermal Shutdown - confirmed ADC window compare -> shutdown GPIO (ELC) + POEG fan forcing
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_SHUTDOWN_H_
+#define THERMAL_SHUTDOWN_H_
+
+#include "hal_data.h"
+#include "temperature_sensor.h"
+#include "thermal_shutdown_confirm.h"
+
+/* Emergency Path Configuration
+ * The window comparator runs on the redundant probe: it is independent of the control probe and is kept
+ * out of the ADC addition mask (compare and addition cannot share a channel). The window A interrupt must be
+ * configured at a higher priority than scan end, so each scan's compare event is counted before the scan-complete
+ * event that would otherwise break the run (thermal_shutdown_confirm.h). */
+#define THERMAL_SHUTDOWN_HW_ENABLE      1
+#define THERMAL_SHUTDOWN_CHANNEL        TEMP_SENSOR_REDUNDANT_CHANNEL
+#define THERMAL_SHUTDOWN_PIN            BSP_IO_PORT_01_PIN_06     /* PMOD1_GPIO1 - rack shutdown request */
+#define THERMAL_SHUTDOWN_PIN_ACTIVE     BSP_IO_LEVEL_HIGH
+
+/* Function Declarations */
+fsp_err_t thermal_shutdown_init(void);
+void thermal_shutdown_window_cfg(adc_window_cfg_t *p_window_cfg);
+void thermal_shutdown_isr(void);
+void thermal_shutdown_scan_end_isr(void);
+void thermal_shutdown_trip(void);
+bool thermal_shutdown_is_tripped(void);
+uint32_t thermal_shutdown_get_trip_count(void);
+uint32_t thermal_shutdown_get_trip_timestamp(void);
+
+#endif /* THERMAL_SHUTDOWN_H_ */
@@ -0,0 +1,70 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_shutdown_confirm.h
+ * Description  : Shutdown Window Confirmation - band-mode comparator model and consecutive-event counter
+ *                (HAL-free, shared with the host stand-in tools/host/shutdown_window_sim.c)
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_SHUTDOWN_CONFIRM_H_
+#define THERMAL_SHUTDOWN_CONFIRM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Confirmation Configuration */
+#define THERMAL_SHUTDOWN_CONFIRM_SCANS      (4U)    /* Consecutive in-band scans before the shutdown latches */
+#define THERMAL_SHUTDOWN_RAIL_MARGIN_COUNTS (48U)   /* Band floor above SENSOR_RAIL_LOW_COUNTS - a shorted probe
+                                                     * and its conversion noise stay below it */
+
+/* Consecutive compare-event counter */
+typedef struct {
+    uint32_t hits;              /* Compare events in consecutive scans */
+    uint32_t scans_since_hit;   /* Scan-complete events since the last compare event */
+} thermal_shutdown_confirm_t;
+
+/**
+ * @brief Model of ADC window A in band mode (compare mode bit set): ref_low < raw < ref_high
+ * @note  The hardware evaluates this per conversion; the firmware only ever sees its events. The host stand-in
+ *        drives the counter below through it.
+ */
+static inline bool thermal_shutdown_in_band(uint16_t raw, uint16_t ref_low, uint16_t ref_high)
+{
+    return (raw > ref_low) && (raw < ref_high);
+}
+
+/**
+ * @brief Count one window compare event
+ * @return true once THERMAL_SHUTDOWN_CONFIRM_SCANS consecutive scans have matched
+ * @note  Expects a scan's compare event ahead of its scan-complete event (window A interrupt priority above scan
+ *        end); an event more than one scan-complete after the previous one starts a new run.
+ */
+static inline bool thermal_shutdown_confirm_event(thermal_shutdown_confirm_t *p_confirm)
+{
+    if (p_confirm->scans_since_hit > 1U)
+    {
+        p_confirm->hits = 0;
+    }
+    p_confirm->scans_since_hit = 0;
+    p_confirm->hits++;
+
+    return p_confirm->hits >= THERMAL_SHUTDOWN_CONFIRM_SCANS;
+}
+
+/**
+ * @brief Count one scan-complete event
+ * @return true when the run of matching scans just broke (no compare event in the previous scan)
+ */
+static inline bool thermal_shutdown_confirm_scan_end(thermal_shutdown_confirm_t *p_confirm)
+{
+    if (p_confirm->scans_since_hit < UINT32_MAX)
+    {
+        p_confirm->scans_since_hit++;
+    }
+    if ((p_confirm->scans_since_hit > 1U) && (0U != p_confirm->hits))
+    {
+        p_confirm->hits = 0;
+        return true;
+    }
+    return false;
+}
+
+#endif /* THERMAL_SHUTDOWN_CONFIRM_H_ */
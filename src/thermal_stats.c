@@ -0,0 +1,246 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_stats.c
+ * Description  : Hierarchical Rolling Temperature Statistics (1 min / 1 h / 24 h) - fixed memory, O(1) per sample
+ *
+ * A sample only touches the 5 s bucket still filling. When a bucket's span is complete it is pushed into its
+ * level's ring and merged into the next level's filling bucket - a constant number of bucket operations,
+ * whatever the window length. Queries walk the rings (at most 96 buckets) and run at publish rate only.
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include "thermal_stats.h"
+
+/* Static variables - 96 buckets in total */
+static thermal_stats_bucket_t gs_ring_1min[THERMAL_STATS_1MIN_BUCKETS];
+static thermal_stats_bucket_t gs_ring_1h[THERMAL_STATS_1H_BUCKETS];
+static thermal_stats_bucket_t gs_ring_24h[THERMAL_STATS_24H_BUCKETS];
+static thermal_stats_level_t gs_levels[THERMAL_STATS_NUM_WINDOWS];
+
+/**
+ * @brief Empty a bucket
+ */
+static void stats_bucket_clear(thermal_stats_bucket_t *p_bucket)
+{
+    memset(p_bucket, 0, sizeof(*p_bucket));
+}
+
+/**
+ * @brief Merge one bucket into another
+ */
+static void stats_bucket_merge(thermal_stats_bucket_t *p_dst, thermal_stats_bucket_t const *p_src)
+{
+    if (0U == p_src->count)
+    {
+        return;
+    }
+    if ((0U == p_dst->count) || (p_src->min < p_dst->min))
+    {
+        p_dst->min = p_src->min;
+    }
+    if ((0U == p_dst->count) || (p_src->max > p_dst->max))
+    {
+        p_dst->max = p_src->max;
+    }
+    p_dst->sum += p_src->sum;
+    p_dst->count += p_src->count;
+    p_dst->above_ms += p_src->above_ms;
+}
+
+/**
+ * @brief Close a level's filling bucket: store it and hand it up the hierarchy
+ * @param[in] level Level index
+ */
+static void stats_level_roll(uint8_t level)
+{
+    thermal_stats_level_t *p_level = &gs_levels[level];
+
+    p_level->p_ring[p_level->head] = p_level->current;
+    p_level->head = (uint8_t)((p_level->head + 1U) % p_level->size);
+    if (p_level->filled < p_level->size)
+    {
+        p_level->filled++;
+    }
+
+    if ((level + 1U) < THERMAL_STATS_NUM_WINDOWS)
+    {
+        thermal_stats_level_t *p_next = &gs_levels[level + 1U];
+
+        stats_bucket_merge(&p_next->current, &p_level->current);
+        p_next->current_ms += p_level->bucket_ms;
+        if (p_next->current_ms >= p_next->bucket_ms)
+        {
+            p_next->current_ms -= p_next->bucket_ms;
+            stats_level_roll(level + 1U);
+        }
+    }
+
+    stats_bucket_clear(&p_level->current);
+}
+
+/**
+ * @brief Reset all windows
+ */
+void thermal_stats_init(void)
+{
+    static thermal_stats_bucket_t * const rings[THERMAL_STATS_NUM_WINDOWS] = { gs_ring_1min, gs_ring_1h, gs_ring_24h };
+    static const uint8_t sizes[THERMAL_STATS_NUM_WINDOWS] =
+        { THERMAL_STATS_1MIN_BUCKETS, THERMAL_STATS_1H_BUCKETS, THERMAL_STATS_24H_BUCKETS };
+    static const uint32_t spans[THERMAL_STATS_NUM_WINDOWS] =
+        { THERMAL_STATS_1MIN_BUCKET_MS, THERMAL_STATS_1H_BUCKET_MS, THERMAL_STATS_24H_BUCKET_MS };
+
+    for (uint8_t level = 0; level < THERMAL_STATS_NUM_WINDOWS; level++)
+    {
+        memset(&gs_levels[level], 0, sizeof(gs_levels[level]));
+        gs_levels[level].p_ring = rings[level];
+        gs_levels[level].size = sizes[level];
+        gs_levels[level].bucket_ms = spans[level];
+        memset(rings[level], 0, sizes[level] * sizeof(thermal_stats_bucket_t));
+    }
+}
+
+/**
+ * @brief Add one sample
+ * @param[in] temperature Sample (°C)
+ * @param[in] dt_ms       Time since the previous sample - the span this sample stands for
+ * @param[in] threshold   Time-above-threshold limit (°C)
+ */
+void thermal_stats_update(float temperature, uint32_t dt_ms, float threshold)
+{
+    thermal_stats_level_t *p_fine = &gs_levels[0];
+    thermal_stats_bucket_t sample = {
+        .min      = temperature,
+        .max      = temperature,
+        .sum      = temperature,
+        .count    = 1,
+        .above_ms = (temperature > threshold) ? dt_ms : 0U
+    };
+
+    stats_bucket_merge(&p_fine->current, &sample);
+    p_fine->current_ms += dt_ms;
+
+    /* A long gap closes several buckets; more than a ring's worth would only overwrite itself */
+    for (uint8_t i = 0; (p_fine->current_ms >= p_fine->bucket_ms) && (i < p_fine->size); i++)
+    {
+        p_fine->current_ms -= p_fine->bucket_ms;
+        stats_level_roll(0);
+    }
+    if (p_fine->current_ms >= p_fine->bucket_ms)
+    {
+        p_fine->current_ms %= p_fine->bucket_ms;
+    }
+}
+
+/**
+ * @brief Statistics over one window
+ * @param[in]  window   THERMAL_STATS_WINDOW_*
+ * @param[out] p_window Result
+ * @return false if the window holds no samples yet
+ */
+bool thermal_stats_get_window(uint8_t window, thermal_stats_window_t *p_window)
+{
+    thermal_stats_bucket_t total;
+    thermal_stats_level_t const *p_level;
+
+    if (window >= THERMAL_STATS_NUM_WINDOWS)
+    {
+        return false;
+    }
+
+    stats_bucket_clear(&total);
+    p_level = &gs_levels[window];
+    for (uint8_t i = 0; i < p_level->filled; i++)
+    {
+        stats_bucket_merge(&total, &p_level->p_ring[i]);
+    }
+
+    /* Data not yet rolled up to this level */
+    for (uint8_t level = 0; level <= window; level++)
+    {
+        stats_bucket_merge(&total, &gs_levels[level].current);
+    }
+
+    memset(p_window, 0, sizeof(*p_window));
+    if (0U == total.count)
+    {
+        return false;
+    }
+
+    p_window->min = total.min;
+    p_window->max = total.max;
+    p_window->mean = total.sum / (float)total.count;
+    p_window->above_s = total.above_ms / 1000U;
+    p_window->samples = total.count;
+    return true;
+}
+
+/**
+ * @brief Fill the sensor summary from the 1 min window
+ * @param[out] p_data        Summary
+ * @param[in]  temperature   Latest sample (°C)
+ * @param[in]  critical_temp Critical threshold in force (°C)
+ */
+void thermal_stats_fill(temp_sensor_data_t *p_data, float temperature, float critical_temp)
+{
+    thermal_stats_window_t w;
+
+    p_data->current_temp = temperature;
+    if (thermal_stats_get_window(THERMAL_STATS_WINDOW_1MIN, &w))
+    {
+        p_data->min_temp = w.min;
+        p_data->max_temp = w.max;
+        p_data->avg_temp = w.mean;
+    }
+    p_data->sample_count++;
+
+    if (temperature >= critical_temp)
+    {
+        p_data->temperature_status = TEMP_STATUS_CRITICAL;
+    }
+    else if (temperature >= TEMP_WARNING_CELSIUS)
+    {
+        p_data->temperature_status = TEMP_STATUS_WARNING;
+    }
+    else
+    {
+        p_data->temperature_status = TEMP_STATUS_SAFE;
+    }
+}
+
+/**
+ * @brief Encode all windows in GATT wire format
+ * @param[in]  status  Temperature status to report
+ * @param[out] p_buf   Destination
+ * @param[in]  buf_len Destination size
+ * @return Bytes written, 0 if the buffer is too small
+ */
+uint16_t thermal_stats_serialize(uint8_t status, uint8_t *p_buf, uint16_t buf_len)
+{
+    thermal_stats_window_t w;
+    uint8_t *p = p_buf;
+    int16_t values[3];
+
+    if (buf_len < THERMAL_STATS_WIRE_SIZE)
+    {
+        return 0;
+    }
+
+    *p++ = status;
+    for (uint8_t window = 0; window < THERMAL_STATS_NUM_WINDOWS; window++)
+    {
+        thermal_stats_get_window(window, &w);
+        values[0] = (int16_t)(w.min * 100.0f);
+        values[1] = (int16_t)(w.max * 100.0f);
+        values[2] = (int16_t)(w.mean * 100.0f);
+        for (uint8_t i = 0; i < 3U; i++)
+        {
+            *p++ = (uint8_t)((uint16_t)values[i] & 0xFF);
+            *p++ = (uint8_t)((uint16_t)values[i] >> 8);
+        }
+        *p++ = (uint8_t)(w.above_s & 0xFF);
+        *p++ = (uint8_t)((w.above_s >> 8) & 0xFF);
+        *p++ = (uint8_t)((w.above_s >> 16) & 0xFF);
+        *p++ = (uint8_t)((w.above_s >> 24) & 0xFF);
+    }
+
+    return THERMAL_STATS_WIRE_SIZE;
+}
@@ -0,0 +1,70 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_stats.h
+ * Description  : Hierarchical Rolling Temperature Statistics (1 min / 1 h / 24 h) - fixed memory, O(1) per sample
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_STATS_H_
+#define THERMAL_STATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "temperature_sensor.h"
+
+/* Windows - each level is a ring of completed buckets; a completed bucket is folded into the next level.
+ * A window covers its ring plus the buckets still filling below it. */
+#define THERMAL_STATS_WINDOW_1MIN       (0U)
+#define THERMAL_STATS_WINDOW_1H         (1U)
+#define THERMAL_STATS_WINDOW_24H        (2U)
+#define THERMAL_STATS_NUM_WINDOWS       (3U)
+
+#define THERMAL_STATS_1MIN_BUCKETS      (12U)       /* 12 x 5 s */
+#define THERMAL_STATS_1MIN_BUCKET_MS    (5000UL)
+#define THERMAL_STATS_1H_BUCKETS        (60U)       /* 60 x 1 min */
+#define THERMAL_STATS_1H_BUCKET_MS      (60000UL)
+#define THERMAL_STATS_24H_BUCKETS       (24U)       /* 24 x 1 h */
+#define THERMAL_STATS_24H_BUCKET_MS     (3600000UL)
+
+/* GATT Wire Format (little-endian, 31 bytes)
+ *   [0]      temperature status (TEMP_STATUS_*) over the 1 min window
+ *   then per window 1 min, 1 h, 24 h (10 bytes each):
+ *   [+0..1] min, [+2..3] max, [+4..5] mean - int16 °C x 100
+ *   [+6..9] time above threshold (s) */
+#define THERMAL_STATS_WIRE_SIZE         (1U + (THERMAL_STATS_NUM_WINDOWS * 10U))
+
+/* Aggregate of the samples in a time span */
+typedef struct {
+    float min;
+    float max;
+    float sum;
+    uint32_t count;
+    uint32_t above_ms;          /* Time spent above the threshold */
+} thermal_stats_bucket_t;
+
+/* One level of the hierarchy */
+typedef struct {
+    thermal_stats_bucket_t *p_ring;
+    uint8_t size;               /* Ring capacity */
+    uint8_t head;               /* Next slot to overwrite */
+    uint8_t filled;             /* Completed buckets held */
+    uint32_t bucket_ms;         /* Span of one bucket */
+    uint32_t current_ms;        /* Time accumulated in the bucket still filling */
+    thermal_stats_bucket_t current;
+} thermal_stats_level_t;
+
+/* Window result */
+typedef struct {
+    float min;
+    float max;
+    float mean;
+    uint32_t above_s;
+    uint32_t samples;
+} thermal_stats_window_t;
+
+/* Function Declarations */
+void thermal_stats_init(void);
+void thermal_stats_update(float temperature, uint32_t dt_ms, float threshold);
+bool thermal_stats_get_window(uint8_t window, thermal_stats_window_t *p_window);
+void thermal_stats_fill(temp_sensor_data_t *p_data, float temperature, float critical_temp);
+uint16_t thermal_stats_serialize(uint8_t status, uint8_t *p_buf, uint16_t buf_len);
+
+#endif /* THERMAL_STATS_H_ */
@@ -0,0 +1,78 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_trend.c
+ * Description  : Rack Temperature Trend Estimator (alpha-beta / steady-state Kalman, O(1) per sample)
+ **********************************************************************************************************************/
+
+#include "thermal_trend.h"
+
+/**
+ * @brief Reset estimator - next sample seeds the level with zero slope
+ * @param[in] p_trend Estimator state
+ */
+void thermal_trend_init(thermal_trend_t *p_trend)
+{
+    p_trend->level = 0.0f;
+    p_trend->slope = 0.0f;
+    p_trend->initialized = false;
+}
+
+/**
+ * @brief Fold one temperature sample into the estimate
+ * @param[in] p_trend     Estimator state
+ * @param[in] temperature Measured temperature (°C)
+ * @param[in] dt_s        Time since previous sample (s); sampling may be irregular
+ */
+void thermal_trend_update(thermal_trend_t *p_trend, float temperature, float dt_s)
+{
+    float predicted;
+    float residual;
+
+    if (!p_trend->initialized || (dt_s <= 0.0f) || (dt_s > THERMAL_TREND_MAX_DT_S))
+    {
+        p_trend->level = temperature;
+        p_trend->slope = 0.0f;
+        p_trend->initialized = true;
+        return;
+    }
+
+    /* Predict forward, then correct level and slope from the innovation */
+    predicted = p_trend->level + (p_trend->slope * dt_s);
+    residual = temperature - predicted;
+
+    p_trend->level = predicted + (THERMAL_TREND_ALPHA * residual);
+    p_trend->slope = p_trend->slope + ((THERMAL_TREND_BETA * residual) / dt_s);
+}
+
+/**
+ * @brief Extrapolate temperature
+ * @param[in] p_trend   Estimator state
+ * @param[in] horizon_s Look-ahead (s)
+ * @return Predicted temperature (°C)
+ */
+float thermal_trend_predict(thermal_trend_t const *p_trend, float horizon_s)
+{
+    return p_trend->level + (p_trend->slope * horizon_s);
+}
+
+/**
+ * @brief Time until the trend crosses a threshold from below
+ * @param[in] p_trend   Estimator state
+ * @param[in] threshold Temperature (°C)
+ * @return Seconds until crossing, 0 if already above, negative if not rising toward it
+ */
+float thermal_trend_time_to_reach(thermal_trend_t const *p_trend, float threshold)
+{
+    if (!p_trend->initialized)
+    {
+        return -1.0f;
+    }
+    if (p_trend->level >= threshold)
+    {
+        return 0.0f;
+    }
+    if (p_trend->slope <= 0.0f)
+    {
+        return -1.0f;
+    }
+    return (threshold - p_trend->level) / p_trend->slope;
+}
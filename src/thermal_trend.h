@@ -0,0 +1,31 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_trend.h
+ * Description  : Rack Temperature Trend Estimator (alpha-beta / steady-state Kalman, O(1) per sample)
+ **********************************************************************************************************************/
+
+#ifndef THERMAL_TREND_H_
+#define THERMAL_TREND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Filter Gains - constant-velocity model, tuned for ~1s sampling.
+ * alpha weights the level correction, beta the slope correction. */
+#define THERMAL_TREND_ALPHA             (0.30f)
+#define THERMAL_TREND_BETA              (0.02f)
+#define THERMAL_TREND_MAX_DT_S          (60.0f)     /* Gaps longer than this restart the estimate */
+
+/* Estimator State */
+typedef struct {
+    float level;                /* Filtered temperature (°C) */
+    float slope;                /* Temperature trend (°C/s) */
+    bool initialized;
+} thermal_trend_t;
+
+/* Function Declarations */
+void thermal_trend_init(thermal_trend_t *p_trend);
+void thermal_trend_update(thermal_trend_t *p_trend, float temperature, float dt_s);
+float thermal_trend_predict(thermal_trend_t const *p_trend, float horizon_s);
+float thermal_trend_time_to_reach(thermal_trend_t const *p_trend, float threshold);
+
+#endif /* THERMAL_TREND_H_ */
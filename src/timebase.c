@@ -0,0 +1,165 @@
+/***********************************************************************************************************************
+ * File Name    : timebase.c
+ * Description  : Monotonic 64-bit Microsecond Timebase - deadline helpers and the GPT counter backend
+ *
+ * The 32-bit GPT counter is extended in software: every read compares the counter with the previous read and
+ * adds one counter period when it went backwards. The overflow interrupt performs a read too, so the extension
+ * never misses a wrap even if nothing else asks for the time for longer than a period. The read-compare-update
+ * runs with interrupts masked for a few instructions, so the clock can be read from any context, ISRs included.
+ **********************************************************************************************************************/
+
+#include "timebase.h"
+
+/* Debug logging configuration */
+#include "log_tokenized.h"
+//#include "log_disabled.h"
+
+/**
+ * @brief Move a periodic deadline to its next slot
+ * @note  Deadlines advance by whole periods from where they were, not from now, so lateness in one iteration
+ *        does not shift every later one. Slots already in the past are skipped rather than run back to back.
+ * @param[in,out] p_deadline_us Deadline just reached (absolute µs)
+ * @param[in]     period_us     Period
+ * @param[in]     now_us        Current time
+ * @return Slots skipped (0 = on time)
+ */
+uint32_t timebase_deadline_advance(uint64_t *p_deadline_us, uint64_t period_us, uint64_t now_us)
+{
+    uint64_t missed;
+
+    *p_deadline_us += period_us;
+    if ((*p_deadline_us > now_us) || (0U == period_us))
+    {
+        return 0U;
+    }
+
+    missed = ((now_us - *p_deadline_us) / period_us) + 1U;
+    *p_deadline_us += missed * period_us;
+    return (missed > UINT32_MAX) ? UINT32_MAX : (uint32_t)missed;
+}
+
+/**
+ * @brief Time in milliseconds, truncated to 32 bits (wraps after ~49 days - use unsigned differences)
+ */
+uint32_t timebase_now_ms(void)
+{
+    return (uint32_t)(timebase_now_us() / 1000U);
+}
+
+#if !TIMEBASE_VIRTUAL
+
+/* Timer Instance (configured in HAL) */
+extern timer_ctrl_t g_timer_timebase_ctrl;
+extern timer_cfg_t g_timer_timebase_cfg;
+
+/* Static variables */
+static uint64_t g_base_counts;          /* Extended count at the start of the current counter period */
+static uint32_t g_last_counter;
+static uint32_t g_period_counts;
+static uint32_t g_counts_per_us;
+static bool g_timebase_open = false;
+
+/**
+ * @brief Extended counter value
+ * @return Counts since timebase_init()
+ */
+static uint64_t timebase_counts(void)
+{
+    timer_status_t status;
+    uint64_t counts;
+    FSP_CRITICAL_SECTION_DEFINE;
+
+    FSP_CRITICAL_SECTION_ENTER;
+    R_GPT_StatusGet(&g_timer_timebase_ctrl, &status);
+    if (status.counter < g_last_counter)
+    {
+        g_base_counts += g_period_counts;
+    }
+    g_last_counter = status.counter;
+    counts = g_base_counts + status.counter;
+    FSP_CRITICAL_SECTION_EXIT;
+
+    return counts;
+}
+
+/**
+ * @brief Open and start the free-running counter
+ * @note  First thing after the boot clock - every later timestamp depends on it
+ * @return FSP_SUCCESS, or an error if the timer cannot run or its clock is not a whole number of MHz
+ */
+fsp_err_t timebase_init(void)
+{
+    timer_info_t info;
+    fsp_err_t err;
+
+    if (g_timebase_open)
+    {
+        return FSP_SUCCESS;
+    }
+
+    err = R_GPT_Open(&g_timer_timebase_ctrl, &g_timer_timebase_cfg);
+    if (FSP_SUCCESS == err)
+    {
+        err = R_GPT_InfoGet(&g_timer_timebase_ctrl, &info);
+    }
+    if ((FSP_SUCCESS == err) &&
+        ((info.clock_frequency < TIMEBASE_MIN_COUNT_HZ) || (0U != (info.clock_frequency % 1000000U))))
+    {
+        log_error("Timebase: count clock %luHz is not a whole number of MHz\r\n", info.clock_frequency);
+        err = FSP_ERR_INVALID_ARGUMENT;
+    }
+    if (FSP_SUCCESS != err)
+    {
+        return err;
+    }
+
+    g_counts_per_us = info.clock_frequency / 1000000U;
+    g_period_counts = info.period_counts;
+    g_base_counts = 0;
+    g_last_counter = 0;
+
+    err = R_GPT_Start(&g_timer_timebase_ctrl);
+    g_timebase_open = (FSP_SUCCESS == err);
+    return err;
+}
+
+/**
+ * @brief Monotonic time since timebase_init()
+ * @note  Safe from ISRs and the main loop alike
+ * @return Time (µs), 0 if the timebase is not running
+ */
+uint64_t timebase_now_us(void)
+{
+    if (!g_timebase_open)
+    {
+        return 0U;
+    }
+    return timebase_counts() / g_counts_per_us;
+}
+
+/**
+ * @brief Wait until a deadline
+ * @param[in] deadline_us Absolute time (µs); returns at once if already past
+ */
+void timebase_delay_until(uint64_t deadline_us)
+{
+    uint64_t now_us = timebase_now_us();
+
+    if (deadline_us > now_us)
+    {
+        R_BSP_SoftwareDelay((uint32_t)(deadline_us - now_us), BSP_DELAY_UNITS_MICROSECONDS);
+    }
+}
+
+/**
+ * @brief Counter overflow - keeps the extension current when nobody reads the time for a whole period
+ */
+void timebase_overflow_callback(timer_callback_args_t *p_args)
+{
+    if (TIMER_EVENT_CYCLE_END == p_args->event)
+    {
+        (void)timebase_counts();
+    }
+}
+
+#endif /* !TIMEBASE_VIRTUAL */
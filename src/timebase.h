@@ -0,0 +1,39 @@
+/***********************************************************************************************************************
+ * File Name    : timebase.h
+ * Description  : Monotonic 64-bit Microsecond Timebase - free-running GPT counter with overflow extension
+ *                (target) or a virtual clock with the same API (host builds)
+ **********************************************************************************************************************/
+
+#ifndef TIMEBASE_H_
+#define TIMEBASE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "system_config.h"
+#if !TIMEBASE_VIRTUAL
+#include "hal_data.h"
+#endif
+
+/* GPT Counter - g_timer_timebase (GPT0, 32-bit) in periodic mode at its maximum period, overflow interrupt
+ * enabled with timebase_overflow_callback. The count clock must be a whole number of MHz; at 100 MHz (PCLKD)
+ * the counter wraps every ~43 s and the 64-bit extended count every ~5800 years. */
+#define TIMEBASE_MIN_COUNT_HZ           (1000000U)
+
+/* Function Declarations - the virtual clock needs no FSP: its init cannot fail and returns 0 (FSP_SUCCESS) */
+#if TIMEBASE_VIRTUAL
+int timebase_init(void);
+#else
+fsp_err_t timebase_init(void);
+#endif
+uint64_t timebase_now_us(void);
+uint32_t timebase_now_ms(void);
+uint32_t timebase_deadline_advance(uint64_t *p_deadline_us, uint64_t period_us, uint64_t now_us);
+void timebase_delay_until(uint64_t deadline_us);
+#if TIMEBASE_VIRTUAL
+void timebase_virtual_set(uint64_t now_us);
+void timebase_virtual_advance(uint64_t delta_us);
+#else
+void timebase_overflow_callback(timer_callback_args_t *p_args);
+#endif
+
+#endif /* TIMEBASE_H_ */
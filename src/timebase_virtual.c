@@ -0,0 +1,64 @@
+/***********************************************************************************************************************
+ * File Name    : timebase_virtual.c
+ * Description  : Monotonic 64-bit Microsecond Timebase - virtual clock for host builds
+ *
+ * Time only moves when the harness moves it or the control loop waits for a deadline, so a day of control
+ * runs in as long as its computation takes and every run with the same inputs is identical.
+ **********************************************************************************************************************/
+
+#include "timebase.h"
+
+#if TIMEBASE_VIRTUAL
+
+#include <stdatomic.h>
+
+/* Static variables */
+static _Atomic uint64_t g_virtual_us;
+
+/**
+ * @brief Nothing to start - the virtual clock reads 0 at program start and is never set back
+ * @note  Boot code reads the clock before it calls this, as it reads the DWT counter on target
+ * @return 0 (FSP_SUCCESS)
+ */
+int timebase_init(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Current virtual time (µs)
+ */
+uint64_t timebase_now_us(void)
+{
+    return atomic_load(&g_virtual_us);
+}
+
+/**
+ * @brief Waiting for a deadline jumps the clock to it
+ */
+void timebase_delay_until(uint64_t deadline_us)
+{
+    uint64_t now_us = atomic_load(&g_virtual_us);
+
+    while ((deadline_us > now_us) && !atomic_compare_exchange_weak(&g_virtual_us, &now_us, deadline_us))
+    {
+    }
+}
+
+/**
+ * @brief Set the virtual time (never backwards - the clock is monotonic)
+ */
+void timebase_virtual_set(uint64_t now_us)
+{
+    timebase_delay_until(now_us);
+}
+
+/**
+ * @brief Advance the virtual time
+ */
+void timebase_virtual_advance(uint64_t delta_us)
+{
+    atomic_fetch_add(&g_virtual_us, delta_us);
+}
+
+#endif /* TIMEBASE_VIRTUAL */
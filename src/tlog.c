@@ -0,0 +1,161 @@
+/***********************************************************************************************************************
+ * File Name    : tlog.c
+ * Description  : Tokenized Deferred Logger - format ID + raw 32-bit arguments into a lock-free RAM ring,
+ *                drained to RTT/UART at idle and decoded on the host (tools/tlog_decode.py)
+ *
+ * Producers (thread or ISR) reserve space with a CAS on g_reserve, fill their words, and write the header
+ * word last. The single consumer (tlog_flush, main loop idle) stops at the first header that is still zero,
+ * so a record is never emitted before it is complete. Consumed words are zeroed to re-arm the slots.
+ **********************************************************************************************************************/
+
+#include <string.h>
+#include <stdatomic.h>
+#include "hal_data.h"
+#include "tlog.h"
+#include "SEGGER_RTT.h"
+
+#define TLOG_RING_MASK          (TLOG_RING_WORDS - 1U)
+
+_Static_assert((TLOG_RING_WORDS & TLOG_RING_MASK) == 0U, "TLOG_RING_WORDS must be a power of two");
+
+/* Static variables */
+static volatile uint32_t g_ring[TLOG_RING_WORDS];
+static atomic_uint g_reserve;           /* Next free word (producers) */
+static atomic_uint g_consume;           /* Next word to drain (consumer) */
+static atomic_uint g_seq;
+
+/* Statistics - producers may be an ISR preempting another producer, so no plain read-modify-write */
+static atomic_uint g_records;
+static atomic_uint g_dropped;
+static atomic_uint g_call_cycles_max;
+static atomic_uint g_call_cycles_last;
+
+/**
+ * @brief Reset the ring and statistics
+ */
+void tlog_init(void)
+{
+    memset((void *)g_ring, 0, sizeof(g_ring));
+    atomic_store(&g_reserve, 0U);
+    atomic_store(&g_consume, 0U);
+    atomic_store(&g_seq, 0U);
+    atomic_store(&g_records, 0U);
+    atomic_store(&g_dropped, 0U);
+    atomic_store(&g_call_cycles_max, 0U);
+    atomic_store(&g_call_cycles_last, 0U);
+}
+
+/**
+ * @brief Append one record (called through the log_* macros)
+ * @param[in] level  TLOG_LEVEL_*
+ * @param[in] token  Format string token
+ * @param[in] nargs  Number of argument words
+ * @param[in] p_args Argument words
+ */
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    uint32_t start_cycles = DWT->CYCCNT;
+    uint32_t words = TLOG_RECORD_FIXED_WORDS + nargs;
+    unsigned int head;
+    unsigned int cycles_max;
+    uint32_t seq;
+    uint32_t elapsed;
+
+    /* Reserve words; fail rather than overwrite what the consumer has not drained */
+    head = atomic_load_explicit(&g_reserve, memory_order_relaxed);
+    do
+    {
+        if (((head + words) - atomic_load_explicit(&g_consume, memory_order_acquire)) > TLOG_RING_WORDS)
+        {
+            atomic_fetch_add_explicit(&g_dropped, 1U, memory_order_relaxed);
+            return;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&g_reserve, &head, head + words,
+                                                    memory_order_acq_rel, memory_order_relaxed));
+
+    seq = atomic_fetch_add_explicit(&g_seq, 1U, memory_order_relaxed);
+
+    g_ring[(head + 1U) & TLOG_RING_MASK] = token;
+    g_ring[(head + 2U) & TLOG_RING_MASK] = start_cycles;
+    for (uint32_t i = 0; i < nargs; i++)
+    {
+        g_ring[(head + TLOG_RECORD_FIXED_WORDS + i) & TLOG_RING_MASK] = p_args[i];
+    }
+
+    /* Commit: header last, after the body is visible */
+    atomic_thread_fence(memory_order_release);
+    g_ring[head & TLOG_RING_MASK] = TLOG_HEADER_MARK | ((level & 0xFU) << 8) | ((nargs & 0xFU) << 12) | (seq << 16);
+
+    atomic_fetch_add_explicit(&g_records, 1U, memory_order_relaxed);
+    elapsed = DWT->CYCCNT - start_cycles;
+    atomic_store_explicit(&g_call_cycles_last, elapsed, memory_order_relaxed);
+    cycles_max = atomic_load_explicit(&g_call_cycles_max, memory_order_relaxed);
+    while ((elapsed > cycles_max) &&
+           !atomic_compare_exchange_weak_explicit(&g_call_cycles_max, &cycles_max, elapsed,
+                                                  memory_order_relaxed, memory_order_relaxed))
+    {
+    }
+}
+
+/**
+ * @brief Drain committed records to the sink (main loop idle only)
+ * @return Number of words written
+ */
+uint32_t tlog_flush(void)
+{
+    uint32_t out[TLOG_FLUSH_MAX_WORDS];
+    uint32_t count = 0;
+    unsigned int tail = atomic_load_explicit(&g_consume, memory_order_relaxed);
+    uint32_t header;
+    uint32_t words;
+
+    for (;;)
+    {
+        header = g_ring[tail & TLOG_RING_MASK];
+        if (0U == header)
+        {
+            /* Next record not committed yet */
+            break;
+        }
+        atomic_thread_fence(memory_order_acquire);
+
+        words = TLOG_RECORD_FIXED_WORDS + ((header >> 12) & 0xFU);
+        if ((count + words) > TLOG_FLUSH_MAX_WORDS)
+        {
+            break;
+        }
+
+        for (uint32_t i = 0; i < words; i++)
+        {
+            out[count++] = g_ring[(tail + i) & TLOG_RING_MASK];
+            g_ring[(tail + i) & TLOG_RING_MASK] = 0U;
+        }
+        tail += words;
+    }
+
+    if (count > 0U)
+    {
+        atomic_store_explicit(&g_consume, tail, memory_order_release);
+        tlog_sink_write((uint8_t const *)out, count * sizeof(uint32_t));
+    }
+    return count;
+}
+
+/**
+ * @brief Snapshot logger statistics
+ */
+void tlog_get_stats(tlog_stats_t *p_stats)
+{
+    p_stats->records = atomic_load_explicit(&g_records, memory_order_relaxed);
+    p_stats->dropped = atomic_load_explicit(&g_dropped, memory_order_relaxed);
+    p_stats->call_cycles_max = atomic_load_explicit(&g_call_cycles_max, memory_order_relaxed);
+    p_stats->call_cycles_last = atomic_load_explicit(&g_call_cycles_last, memory_order_relaxed);
+}
+
+/**
+ * @brief Default sink: SEGGER RTT up-buffer 0 (override to drain elsewhere)
+ */
+__attribute__((weak)) void tlog_sink_write(uint8_t const *p_data, uint32_t len)
+{
+    SEGGER_RTT_Write(0, p_data, len);
+}
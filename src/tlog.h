@@ -0,0 +1,68 @@
+/***********************************************************************************************************************
+ * File Name    : tlog.h
+ * Description  : Tokenized Deferred Logger - format ID + raw 32-bit arguments into a lock-free RAM ring,
+ *                drained to RTT/UART at idle and decoded on the host (tools/tlog_decode.py)
+ **********************************************************************************************************************/
+
+#ifndef TLOG_H_
+#define TLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Ring capacity in 32-bit words - must be a power of two */
+#define TLOG_RING_WORDS         (512U)
+#define TLOG_MAX_ARGS           (6U)
+#define TLOG_FLUSH_MAX_WORDS    (64U)           /* Words drained per tlog_flush() call */
+
+/* Record layout (words):
+ *   [0] header   0xA5 | level << 8 | nargs << 12 | seq << 16  (never zero once committed)
+ *   [1] token    address of the format string in the .tlog_fmt section
+ *   [2] timestamp
+ *   [3..] args   integers as-is, floats as IEEE-754 single bits, strings as pointers */
+#define TLOG_HEADER_MARK        (0xA5U)
+#define TLOG_RECORD_FIXED_WORDS (3U)
+
+/* Levels */
+#define TLOG_LEVEL_ERROR        (1U)
+#define TLOG_LEVEL_WARNING      (2U)
+#define TLOG_LEVEL_INFO         (3U)
+#define TLOG_LEVEL_DEBUG        (4U)
+
+/* Statistics */
+typedef struct {
+    uint32_t records;           /* Records committed */
+    uint32_t dropped;           /* Records lost to a full ring */
+    uint32_t call_cycles_max;   /* Worst-case cycles spent in tlog_write() */
+    uint32_t call_cycles_last;
+} tlog_stats_t;
+
+/* Function Declarations */
+void tlog_init(void);
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args);
+uint32_t tlog_flush(void);
+void tlog_get_stats(tlog_stats_t *p_stats);
+void tlog_sink_write(uint8_t const *p_data, uint32_t len);
+
+/* Argument capture - the decoder knows each argument's type from the format string */
+static inline uint32_t tlog_arg_u32(uint32_t value)    { return value; }
+static inline uint32_t tlog_arg_ptr(void const *p)     { return (uint32_t)(uintptr_t)p; }
+static inline uint32_t tlog_arg_float(double value)
+{
+    union { float f; uint32_t u; } bits;
+    bits.f = (float)value;
+    return bits.u;
+}
+
+/* One word per argument: a 64-bit integer would be truncated, so it fails to build instead (cast it, or split it) */
+#define TLOG_ARG_FITS(x) sizeof(struct {                                                    \
+        _Static_assert(_Generic((x), long long: 0, unsigned long long: 0, default: 1),     \
+                       "tlog: 64-bit integer argument - log it as two 32-bit halves");      \
+        int fits; })
+
+#define TLOG_ARG(x) ((void)TLOG_ARG_FITS(x), _Generic((x),  \
+        float: tlog_arg_float, double: tlog_arg_float,      \
+        char *: tlog_arg_ptr, const char *: tlog_arg_ptr,   \
+        default: tlog_arg_u32)(x))
+
+#endif /* TLOG_H_ */
@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+"""
+File Name    : footprint_report.py
+Description  : Per-module RAM/flash footprint report from a GNU ld map file, checked against budgets.
+
+Attributes every input section in the map's memory map to a module - application sources by file name
+(ble_app, gpt_timer, temperature_sensor, main_application, ...), FSP drivers by their ra/fsp/src/<module>
+directory, libraries by archive name - and sums .text (code + rodata), .data (RAM, with a flash load copy)
+and .bss (RAM, including .noinit/COMMON). Fails when a module or the image total exceeds its budget.
+
+    footprint_report.py build.map [--budgets tools/footprint_budgets.json] [--history footprint.json]
+    footprint_report.py build.map --baseline old.json         # diff against a specific snapshot
+
+Run it as a post-build step (e2 studio: Properties > C/C++ Build > Settings > Build Steps):
+    python3 ${ProjDirPath}/tools/footprint_report.py ${ProjName}.map
+        --budgets ${ProjDirPath}/tools/footprint_budgets.json --history footprint.json
+
+With --history, the previous snapshot in that file is diffed against this build and then replaced.
+Exit status: 0 within budget, 1 over budget, 2 usage/parse error.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+KINDS = ("text", "data", "bss")
+
+# Input section name (or name prefix before a '.') -> kind
+SECTION_KINDS = (
+    (".text", "text"),
+    (".rodata", "text"),
+    (".ARM.extab", "text"),
+    (".ARM.exidx", "text"),
+    (".init_array", "text"),
+    (".fini_array", "text"),
+    (".tlog_fmt", None),        # Format strings live in the ELF only (not loaded), see tools/tlog_decode.py
+    (".data", "data"),
+    (".bss", "bss"),
+    (".noinit", "bss"),
+    ("COMMON", "bss"),
+)
+
+ENTRY_RE = re.compile(r"^\s(\S+)?\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+NAME_ONLY_RE = re.compile(r"^\s(\S+)\s*$")
+FSP_RE = re.compile(r"ra[/\\]fsp[/\\]src[/\\]([^/\\]+)")
+ARCHIVE_RE = re.compile(r"([^/\\]+)\.a\(([^)]+)\)$")
+
+
+def section_kind(name):
+    for prefix, kind in SECTION_KINDS:
+        if name == prefix or name.startswith(prefix + "."):
+            return kind
+    return None
+
+
+def module_of(path):
+    """Map an object path from the map file to a module name."""
+    path = path.strip()
+    archive = ARCHIVE_RE.search(path)
+    fsp = FSP_RE.search(path)
+    if fsp:
+        return fsp.group(1)
+    if archive:
+        return archive.group(1)
+    base = os.path.basename(path)
+    stem, ext = os.path.splitext(base)
+    return stem if ext in (".o", ".obj") else "other"
+
+
+def parse_map(path):
+    """Sum input-section sizes per module and kind."""
+    totals = {}
+    with open(path, "r", errors="replace") as f:
+        lines = f.read().splitlines()
+
+    try:
+        start = next(i for i, line in enumerate(lines) if line.startswith("Linker script and memory map"))
+    except StopIteration:
+        raise ValueError("no 'Linker script and memory map' section - is this a GNU ld map?")
+
+    pending = None      # Section name printed alone on a line; address/size/file follow on the next
+    for line in lines[start + 1:]:
+        if line.startswith("OUTPUT(") or line.startswith("LOAD "):
+            pending = None
+            continue
+
+        match = ENTRY_RE.match(line)
+        if match:
+            name = match.group(1) or pending
+            pending = None
+            if name is None or name.startswith("*"):
+                continue
+            size = int(match.group(3), 16)
+            origin = match.group(4)
+            # Symbol lines (address + symbol name, no size) never reach here; these carry a size and a file
+            if size == 0 or "(size before relaxing)" in origin:
+                continue
+            kind = section_kind(name)
+            if kind is None:
+                continue
+            module = module_of(origin)
+            entry = totals.setdefault(module, dict.fromkeys(KINDS, 0))
+            entry[kind] += size
+            continue
+
+        name_only = NAME_ONLY_RE.match(line)
+        pending = name_only.group(1) if name_only else None
+
+    return totals
+
+
+def image_totals(modules):
+    total = dict.fromkeys(KINDS, 0)
+    for sizes in modules.values():
+        for kind in KINDS:
+            total[kind] += sizes[kind]
+    return total
+
+
+def flash_of(sizes):
+    return sizes["text"] + sizes["data"]
+
+
+def ram_of(sizes):
+    return sizes["data"] + sizes["bss"]
+
+
+def check_budgets(modules, budgets):
+    """Return (module, metric, used, budget) for every exceeded limit."""
+    over = []
+    total = image_totals(modules)
+    for module, limits in budgets.items():
+        if module.startswith("_") and module != "_total":
+            continue
+        sizes = total if module == "_total" else modules.get(module, dict.fromkeys(KINDS, 0))
+        used = dict(sizes, flash=flash_of(sizes), ram=ram_of(sizes))
+        for metric, limit in limits.items():
+            if metric in used and used[metric] > limit:
+                over.append((module, metric, used[metric], limit))
+    return over
+
+
+def fmt_diff(sizes, old):
+    if old is None:
+        return "new"
+    parts = []
+    for label, metric in (("flash", flash_of), ("ram", ram_of)):
+        delta = metric(sizes) - metric(old)
+        if delta:
+            parts.append("%s %+d" % (label, delta))
+    return ", ".join(parts)
+
+
+def print_report(modules, baseline, budgets, top):
+    rows = sorted(modules.items(), key=lambda kv: ram_of(kv[1]) + flash_of(kv[1]), reverse=True)
+    budgeted = {m for m in budgets if not m.startswith("_")}
+    shown = [r for r in rows if r[0] in budgeted] + [r for r in rows if r[0] not in budgeted][:top]
+
+    print("%-28s %9s %7s %7s %9s %7s   %s" % ("module", "text", "data", "bss", "flash", "ram", "vs baseline"))
+    print("-" * 96)
+    for module, sizes in shown:
+        diff = fmt_diff(sizes, baseline.get(module)) if baseline is not None else ""
+        mark = "*" if module in budgeted else " "
+        print("%s%-27s %9d %7d %7d %9d %7d   %s" % (mark, module, sizes["text"], sizes["data"], sizes["bss"],
+                                                 flash_of(sizes), ram_of(sizes), diff))
+
+    if len(rows) > len(shown):
+        rest = dict.fromkeys(KINDS, 0)
+        for _module, sizes in (r for r in rows if r not in shown):
+            for kind in KINDS:
+                rest[kind] += sizes[kind]
+        print(" %-27s %9d %7d %7d %9d %7d" % ("(%d more)" % (len(rows) - len(shown)), rest["text"], rest["data"],
+                                              rest["bss"], flash_of(rest), ram_of(rest)))
+
+    total = image_totals(modules)
+    diff = fmt_diff(total, image_totals(baseline)) if baseline is not None else ""
+    print("-" * 96)
+    print(" %-27s %9d %7d %7d %9d %7d   %s" % ("TOTAL", total["text"], total["data"], total["bss"],
+                                             flash_of(total), ram_of(total), diff))
+
+    if baseline is not None:
+        gone = sorted(set(baseline) - set(modules))
+        if gone:
+            print("removed since baseline: " + ", ".join(gone))
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Per-module footprint report and budget check from a GNU ld map")
+    ap.add_argument("map", help="linker map file (-Wl,-Map=...)")
+    ap.add_argument("--budgets", help="JSON budgets: {module: {text|data|bss|flash|ram: bytes}}, '_total' for the image")
+    ap.add_argument("--history", help="snapshot file: diffed against, then overwritten with this build")
+    ap.add_argument("--baseline", help="snapshot to diff against (read only)")
+    ap.add_argument("--save", help="write this build's snapshot here")
+    ap.add_argument("--top", type=int, default=12, help="unbudgeted modules to list (default 12)")
+    args = ap.parse_args()
+
+    try:
+        modules = parse_map(args.map)
+    except (OSError, ValueError) as e:
+        print("footprint_report: %s" % e, file=sys.stderr)
+        return 2
+
+    budgets = {}
+    if args.budgets:
+        with open(args.budgets) as f:
+            budgets = json.load(f)
+
+    baseline = None
+    baseline_path = args.baseline or args.history
+    if baseline_path and os.path.exists(baseline_path):
+        with open(baseline_path) as f:
+            baseline = json.load(f).get("modules", {})
+
+    print_report(modules, baseline, budgets, args.top)
+
+    for path in filter(None, (args.save, args.history)):
+        with open(path, "w") as f:
+            json.dump({"map": os.path.basename(args.map), "modules": modules}, f, indent=1, sort_keys=True)
+
+    over = check_budgets(modules, budgets)
+    for module, metric, used, limit in over:
+        print("BUDGET EXCEEDED: %s %s = %d bytes (budget %d, over by %d)" % (module, metric, used, limit,
+                                                                              used - limit))
+    if budgets and not over:
+        print("all budgets met")
+    return 1 if over else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,277 @@
+/***********************************************************************************************************************
+ * File Name    : gw_transport.c
+ * Description  : Gateway Datagram Transports - UDP (SO_REUSEPORT fan-out) and Unix datagram sockets
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include "gw_transport.h"
+
+#include <errno.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/un.h>
+
+static int dgram_recv(gw_transport_t *p_self, gw_batch_t *p_batch);
+static int dgram_send(gw_transport_t *p_self, gw_batch_t *p_batch);
+static void dgram_close(gw_transport_t *p_self);
+static int udp_open(gw_transport_t *p_self, char const *p_address, uint32_t endpoint, bool listen);
+static int unix_open(gw_transport_t *p_self, char const *p_address, uint32_t endpoint, bool listen);
+
+/* Backend Table */
+static gw_transport_api_t const gs_transports[] = {
+    { "udp",  udp_open,  dgram_recv, dgram_send, dgram_close },
+    { "unix", unix_open, dgram_recv, dgram_send, dgram_close },
+};
+
+/**
+ * @brief Look up a transport backend by name
+ * @param[in] p_name Backend name ("udp", "unix")
+ * @return Backend, or NULL if unknown
+ */
+gw_transport_api_t const *gw_transport_find(char const *p_name)
+{
+    for (size_t i = 0; i < sizeof(gs_transports) / sizeof(gs_transports[0]); i++)
+    {
+        if (0 == strcmp(gs_transports[i].p_name, p_name))
+        {
+            return &gs_transports[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief List backend names for usage text
+ */
+char const *gw_transport_names(void)
+{
+    return "udp|unix";
+}
+
+/**
+ * @brief Point the batch's mmsghdr/iovec entries at its buffers
+ * @param[in] p_batch Batch
+ * @param[in] count   Entries to prepare
+ * @param[in] receive true to expose the full buffers, false to send len[] bytes
+ */
+static void batch_prepare(gw_batch_t *p_batch, uint32_t count, bool receive)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        p_batch->iov[i].iov_base = p_batch->data[i];
+        p_batch->iov[i].iov_len = receive ? sizeof(p_batch->data[i]) : p_batch->len[i];
+        memset(&p_batch->msgs[i].msg_hdr, 0, sizeof(p_batch->msgs[i].msg_hdr));
+        p_batch->msgs[i].msg_hdr.msg_iov = &p_batch->iov[i];
+        p_batch->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+}
+
+/**
+ * @brief Receive up to GW_BATCH_MAX datagrams
+ * @return Datagrams received (0 on timeout), -1 on error
+ */
+static int dgram_recv(gw_transport_t *p_self, gw_batch_t *p_batch)
+{
+    batch_prepare(p_batch, GW_BATCH_MAX, true);
+
+    /* Block for the first datagram only, then drain whatever is already queued */
+    int n = recvmmsg(p_self->fd, p_batch->msgs, GW_BATCH_MAX, MSG_WAITFORONE, NULL);
+    if (n < 0)
+    {
+        p_batch->count = 0;
+        return ((EAGAIN == errno) || (EWOULDBLOCK == errno) || (EINTR == errno)) ? 0 : -1;
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        /* Truncated datagrams keep a length the decoder rejects */
+        p_batch->len[i] = (p_batch->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ? 0U : (uint16_t)p_batch->msgs[i].msg_len;
+    }
+    p_batch->count = (uint32_t)n;
+
+    return n;
+}
+
+/**
+ * @brief Send p_batch->count datagrams to the connected peer
+ * @return Datagrams accepted by the kernel, -1 on error
+ */
+static int dgram_send(gw_transport_t *p_self, gw_batch_t *p_batch)
+{
+    uint32_t sent = 0;
+
+    batch_prepare(p_batch, p_batch->count, false);
+
+    while (sent < p_batch->count)
+    {
+        int n = sendmmsg(p_self->fd, &p_batch->msgs[sent], p_batch->count - sent, 0);
+        if (n < 0)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+            /* ENOBUFS / ECONNREFUSED / EAGAIN: receiver is behind or absent - report what made it */
+            return (0U == sent) ? -1 : (int)sent;
+        }
+        sent += (uint32_t)n;
+    }
+
+    return (int)sent;
+}
+
+/**
+ * @brief Close the socket; a listening Unix socket also removes its path
+ */
+static void dgram_close(gw_transport_t *p_self)
+{
+    if (p_self->fd >= 0)
+    {
+        close(p_self->fd);
+        p_self->fd = -1;
+    }
+    if (p_self->listen && ('\0' != p_self->path[0]))
+    {
+        unlink(p_self->path);
+    }
+}
+
+/**
+ * @brief Apply the receive timeout and a larger receive buffer to a listening socket
+ */
+static void dgram_listen_options(int fd)
+{
+    struct timeval tv = { .tv_sec = 0, .tv_usec = GW_RECV_TIMEOUT_MS * 1000 };
+    int rcvbuf = 8 * 1024 * 1024;
+
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    (void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+}
+
+/**
+ * @brief Open a UDP socket
+ * @param[in] p_address "host:port"
+ * @param[in] endpoint  Ignored - listeners share the port via SO_REUSEPORT and the kernel spreads
+ *                      senders across them by flow hash, so one rack always lands on one worker
+ * @param[in] listen    true to bind (daemon), false to connect (load generator)
+ * @return 0 on success, -1 on error
+ */
+static int udp_open(gw_transport_t *p_self, char const *p_address, uint32_t endpoint, bool listen)
+{
+    char host[256];
+    char const *p_port = strrchr(p_address, ':');
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_DGRAM };
+    struct addrinfo *p_res = NULL;
+    int one = 1;
+
+    (void)endpoint;
+    p_self->fd = -1;
+    p_self->listen = listen;
+    p_self->path[0] = '\0';
+
+    if ((NULL == p_port) || ((size_t)(p_port - p_address) >= sizeof(host)))
+    {
+        fprintf(stderr, "udp: address must be host:port (%s)\n", p_address);
+        return -1;
+    }
+    memcpy(host, p_address, (size_t)(p_port - p_address));
+    host[p_port - p_address] = '\0';
+
+    if (listen)
+    {
+        hints.ai_flags = AI_PASSIVE;
+    }
+    if (0 != getaddrinfo(host, p_port + 1, &hints, &p_res))
+    {
+        fprintf(stderr, "udp: cannot resolve %s\n", p_address);
+        return -1;
+    }
+
+    p_self->fd = socket(p_res->ai_family, SOCK_DGRAM, 0);
+    if (p_self->fd < 0)
+    {
+        freeaddrinfo(p_res);
+        return -1;
+    }
+
+    int rc;
+    if (listen)
+    {
+        (void)setsockopt(p_self->fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+        dgram_listen_options(p_self->fd);
+        rc = bind(p_self->fd, p_res->ai_addr, p_res->ai_addrlen);
+    }
+    else
+    {
+        rc = connect(p_self->fd, p_res->ai_addr, p_res->ai_addrlen);
+    }
+    freeaddrinfo(p_res);
+
+    if (0 != rc)
+    {
+        perror("udp");
+        dgram_close(p_self);
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Open a Unix datagram socket
+ * @param[in] p_address Socket path prefix
+ * @param[in] endpoint  Endpoint index - socket is "<prefix>.<endpoint>" (Unix sockets have no SO_REUSEPORT,
+ *                      so each daemon worker owns one path and generator threads pick one)
+ * @param[in] listen    true to bind (daemon), false to connect (load generator)
+ * @return 0 on success, -1 on error
+ */
+static int unix_open(gw_transport_t *p_self, char const *p_address, uint32_t endpoint, bool listen)
+{
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+
+    p_self->fd = -1;
+    p_self->listen = listen;
+    p_self->path[0] = '\0';
+
+    int len = snprintf(addr.sun_path, sizeof(addr.sun_path), "%s.%u", p_address, endpoint);
+    if ((len < 0) || ((size_t)len >= sizeof(addr.sun_path)))
+    {
+        fprintf(stderr, "unix: path too long (%s)\n", p_address);
+        return -1;
+    }
+
+    p_self->fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (p_self->fd < 0)
+    {
+        return -1;
+    }
+
+    int rc;
+    if (listen)
+    {
+        unlink(addr.sun_path);
+        dgram_listen_options(p_self->fd);
+        rc = bind(p_self->fd, (struct sockaddr *)&addr, sizeof(addr));
+        if (0 == rc)
+        {
+            memcpy(p_self->path, addr.sun_path, sizeof(p_self->path));
+        }
+    }
+    else
+    {
+        rc = connect(p_self->fd, (struct sockaddr *)&addr, sizeof(addr));
+    }
+
+    if (0 != rc)
+    {
+        fprintf(stderr, "unix: %s: %s\n", addr.sun_path, strerror(errno));
+        dgram_close(p_self);
+        return -1;
+    }
+
+    return 0;
+}
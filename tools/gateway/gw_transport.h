@@ -0,0 +1,53 @@
+/***********************************************************************************************************************
+ * File Name    : gw_transport.h
+ * Description  : Gateway Datagram Transport Interface (pluggable backends, batched send/receive)
+ **********************************************************************************************************************/
+
+#ifndef GW_TRANSPORT_H_
+#define GW_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "rack_frame.h"
+
+/* Batch Configuration */
+#define GW_BATCH_MAX                    (64U)       /* Datagrams per recvmmsg/sendmmsg call */
+#define GW_RECV_TIMEOUT_MS              (100U)      /* Receive wakeup so workers notice shutdown */
+#define GW_DATAGRAM_MAX                 (RACK_ENVELOPE_HEADER_SIZE + 255U)  /* Largest telemetry frame + envelope */
+
+/* Datagram Batch - caller fills data/len for send, transport fills them on receive */
+typedef struct {
+    uint32_t count;
+    uint16_t len[GW_BATCH_MAX];
+    uint8_t data[GW_BATCH_MAX][GW_DATAGRAM_MAX];
+    struct mmsghdr msgs[GW_BATCH_MAX];
+    struct iovec iov[GW_BATCH_MAX];
+} gw_batch_t;
+
+typedef struct gw_transport gw_transport_t;
+
+/* Backend Interface - one per transport; a BLE central backend would be another entry here */
+typedef struct {
+    char const *p_name;
+    int (*open)(gw_transport_t *p_self, char const *p_address, uint32_t endpoint, bool listen);
+    int (*recv)(gw_transport_t *p_self, gw_batch_t *p_batch);
+    int (*send)(gw_transport_t *p_self, gw_batch_t *p_batch);
+    void (*close)(gw_transport_t *p_self);
+} gw_transport_api_t;
+
+/* Transport Instance */
+struct gw_transport {
+    gw_transport_api_t const *p_api;
+    int fd;
+    bool listen;
+    char path[108];             /* Bound Unix socket path, unlinked on close */
+};
+
+/* Function Declarations */
+gw_transport_api_t const *gw_transport_find(char const *p_name);
+char const *gw_transport_names(void);
+
+#endif /* GW_TRANSPORT_H_ */
@@ -0,0 +1,170 @@
+/***********************************************************************************************************************
+ * File Name    : rack_frame.h
+ * Description  : Rack Status Frame Codec (host side of ble_rack_status_t, plus the gateway datagram envelope)
+ **********************************************************************************************************************/
+
+#ifndef RACK_FRAME_H_
+#define RACK_FRAME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/* Rack Status Frame - byte layout of ble_send_temperature_data() (src/main_application.c), little endian:
+ *   [0..1] temperature °C x100 (int16)   [2] cooling level   [3] PWM duty %   [4] SYSTEM_ALERT_* bits
+ *   [5..6] sample count (uint16)          [7..10] fan energy J (uint32, absent in pre-energy firmware)
+ *   [11..12] report sequence (uint16, absent before report-by-exception)
+ *   [13..16] sample time, ms since boot (uint32, wrapping; absent before the timebase) */
+#define RACK_FRAME_SIZE                 (17U)
+#define RACK_FRAME_SEQ_SIZE             (13U)       /* Report-by-exception, no sample timestamp */
+#define RACK_FRAME_ENERGY_SIZE          (11U)       /* Sent every interval - sample count doubled as sequence */
+#define RACK_FRAME_LEGACY_SIZE          (7U)
+
+/* Alert bits - mirror SYSTEM_ALERT_* in src/main_application.h */
+#define RACK_ALERT_CRITICAL_TEMP        (0x01U)
+#define RACK_ALERT_SENSOR_FAULT         (0x02U)
+#define RACK_ALERT_THERMAL_SHUTDOWN     (0x04U)
+#define RACK_ALERT_ANOMALY              (0x08U)
+
+/* Gateway Envelope - prepended by whatever bridges a rack's notifications onto the datagram transport.
+ * A BLE central knows the rack from the connection; the datagram stand-in has to carry it explicitly.
+ *   [0..1] rack ID   [2..3] channel   [4..11] bridge timestamp (CLOCK_MONOTONIC ns, 0 = unknown)
+ * Channels follow telemetry_channel_t (src/telemetry_transport.h); only status frames are decoded here. */
+#define RACK_ENVELOPE_HEADER_SIZE       (12U)
+#define RACK_CHANNEL_STATUS             (0U)
+#define RACK_CHANNEL_DIAGNOSTIC         (1U)
+#define RACK_DATAGRAM_MAX_SIZE          (RACK_ENVELOPE_HEADER_SIZE + RACK_FRAME_SIZE)
+
+/* Decoded Rack Status */
+typedef struct {
+    int16_t temperature;        /* °C x100 */
+    uint8_t cooling_level;
+    uint8_t pwm_duty_cycle;
+    uint8_t system_alert;
+    uint16_t sample_count;
+    uint32_t fan_energy_j;
+    uint16_t report_seq;        /* Frame sequence (sample count for older frames) */
+    uint32_t sample_time_ms;    /* Rack clock at the sample (0 for older frames) */
+} rack_frame_t;
+
+/* Decoded Datagram */
+typedef struct {
+    uint16_t rack_id;
+    uint16_t channel;
+    uint64_t sent_ns;
+    rack_frame_t frame;         /* Valid for RACK_CHANNEL_STATUS only */
+} rack_datagram_t;
+
+static inline uint16_t rack_get_u16(uint8_t const *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline uint32_t rack_get_u32(uint8_t const *p)
+{
+    return (uint32_t)rack_get_u16(p) | ((uint32_t)rack_get_u16(p + 2) << 16);
+}
+
+static inline void rack_put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void rack_put_u32(uint8_t *p, uint32_t v)
+{
+    rack_put_u16(p, (uint16_t)v);
+    rack_put_u16(p + 2, (uint16_t)(v >> 16));
+}
+
+/**
+ * @brief Decode a rack status frame
+ * @param[in]  p_data  Frame bytes
+ * @param[in]  len     Frame length (older 7/11/13-byte frames decode with zero energy / sample count as sequence /
+ *                     zero sample time)
+ * @param[out] p_frame Decoded fields
+ * @return true if the length is one the firmware produces
+ */
+static inline bool rack_frame_decode(uint8_t const *p_data, size_t len, rack_frame_t *p_frame)
+{
+    if ((RACK_FRAME_SIZE != len) && (RACK_FRAME_SEQ_SIZE != len) && (RACK_FRAME_ENERGY_SIZE != len) &&
+        (RACK_FRAME_LEGACY_SIZE != len))
+    {
+        return false;
+    }
+
+    p_frame->temperature = (int16_t)rack_get_u16(&p_data[0]);
+    p_frame->cooling_level = p_data[2];
+    p_frame->pwm_duty_cycle = p_data[3];
+    p_frame->system_alert = p_data[4];
+    p_frame->sample_count = rack_get_u16(&p_data[5]);
+    p_frame->fan_energy_j = (len >= RACK_FRAME_ENERGY_SIZE) ? rack_get_u32(&p_data[7]) : 0U;
+    p_frame->report_seq = (len >= RACK_FRAME_SEQ_SIZE) ? rack_get_u16(&p_data[11]) : p_frame->sample_count;
+    p_frame->sample_time_ms = (RACK_FRAME_SIZE == len) ? rack_get_u32(&p_data[13]) : 0U;
+
+    return true;
+}
+
+/**
+ * @brief Encode a rack status frame exactly as the firmware does
+ * @param[in]  p_frame Fields
+ * @param[out] p_data  RACK_FRAME_SIZE bytes
+ */
+static inline void rack_frame_encode(rack_frame_t const *p_frame, uint8_t *p_data)
+{
+    rack_put_u16(&p_data[0], (uint16_t)p_frame->temperature);
+    p_data[2] = p_frame->cooling_level;
+    p_data[3] = p_frame->pwm_duty_cycle;
+    p_data[4] = p_frame->system_alert;
+    rack_put_u16(&p_data[5], p_frame->sample_count);
+    rack_put_u32(&p_data[7], p_frame->fan_energy_j);
+    rack_put_u16(&p_data[11], p_frame->report_seq);
+    rack_put_u32(&p_data[13], p_frame->sample_time_ms);
+}
+
+/**
+ * @brief Decode an enveloped datagram
+ * @param[in]  p_data Datagram bytes
+ * @param[in]  len    Datagram length
+ * @param[out] p_dgram Decoded envelope and frame
+ * @return true if well formed (other channels: envelope only)
+ */
+static inline bool rack_datagram_decode(uint8_t const *p_data, size_t len, rack_datagram_t *p_dgram)
+{
+    if (len < RACK_ENVELOPE_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    p_dgram->rack_id = rack_get_u16(&p_data[0]);
+    p_dgram->channel = rack_get_u16(&p_data[2]);
+    p_dgram->sent_ns = (uint64_t)rack_get_u32(&p_data[4]) | ((uint64_t)rack_get_u32(&p_data[8]) << 32);
+    if (RACK_CHANNEL_STATUS != p_dgram->channel)
+    {
+        return true;
+    }
+
+    return rack_frame_decode(&p_data[RACK_ENVELOPE_HEADER_SIZE], len - RACK_ENVELOPE_HEADER_SIZE, &p_dgram->frame);
+}
+
+/**
+ * @brief Encode an enveloped datagram
+ * @param[in]  rack_id Rack ID
+ * @param[in]  sent_ns Bridge timestamp
+ * @param[in]  p_frame Fields
+ * @param[out] p_data  RACK_DATAGRAM_MAX_SIZE bytes
+ * @return Datagram length
+ */
+static inline size_t rack_datagram_encode(uint16_t rack_id, uint64_t sent_ns, rack_frame_t const *p_frame,
+                                          uint8_t *p_data)
+{
+    rack_put_u16(&p_data[0], rack_id);
+    rack_put_u16(&p_data[2], RACK_CHANNEL_STATUS);
+    rack_put_u32(&p_data[4], (uint32_t)sent_ns);
+    rack_put_u32(&p_data[8], (uint32_t)(sent_ns >> 32));
+    rack_frame_encode(p_frame, &p_data[RACK_ENVELOPE_HEADER_SIZE]);
+
+    return RACK_DATAGRAM_MAX_SIZE;
+}
+
+#endif /* RACK_FRAME_H_ */
@@ -0,0 +1,587 @@
+/***********************************************************************************************************************
+ * File Name    : rack_ingestd.c
+ * Description  : Rack Telemetry Ingest Daemon (decode, per-rack state, alerting, throughput/latency metrics)
+ *
+ * Receives enveloped rack status frames (rack_frame.h) on a datagram transport, keeps the latest state of every
+ * rack in a flat table indexed by rack ID, and raises/clears alerts on SYSTEM_ALERT_* edges, report-sequence gaps
+ * and racks going silent. Every report interval it prints frames/s and the ingest latency distribution
+ * (bridge timestamp to decoded-and-applied), both per worker and overall.
+ *
+ *   cc -O2 -pthread -o rack_ingestd rack_ingestd.c gw_transport.c
+ *   rack_ingestd [-t udp|unix] [-a address] [-w workers] [-c] [-i report_s] [-d duration_s] [-s stale_ms] [-q]
+ *
+ * Workers: each owns one socket (UDP: shared port via SO_REUSEPORT, Unix: "<path>.<n>") and, with -c, one core.
+ * A rack's datagrams always reach the same worker, so table entries have a single writer and need no locks.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gw_transport.h"
+#include "rack_frame.h"
+
+/* ==================================================================================================================
+ * DAEMON CONFIGURATION
+ * ================================================================================================================== */
+#define INGEST_MAX_RACKS                (65536U)    /* Whole rack ID space - table is 1 MiB */
+#define INGEST_MAX_WORKERS              (64U)
+#define INGEST_DEFAULT_UDP_ADDRESS      "127.0.0.1:47000"
+#define INGEST_DEFAULT_UNIX_ADDRESS     "/tmp/rack_ingest.sock"
+#define INGEST_DEFAULT_REPORT_S         (1U)
+#define INGEST_DEFAULT_STALE_MS         (10000U)    /* Matches AGGREGATOR_STALE_MS on the rack side */
+#define INGEST_CACHE_LINE               (64U)
+
+/* Latency Histogram - log-linear, 16 sub-buckets per power of two (<= 6.25% bucket width) */
+#define HIST_SUB_BITS                   (4U)
+#define HIST_SUB_COUNT                  (1U << HIST_SUB_BITS)
+#define HIST_BUCKETS                    ((65U - HIST_SUB_BITS) * HIST_SUB_COUNT)
+
+/* Rack Entry Flags */
+#define RACK_FLAG_SEEN                  (0x01U)
+#define RACK_FLAG_STALE                 (0x02U)
+
+/* Rack Entry - 16 bytes, four per cache line; hot fields only, ID is the index */
+typedef struct {
+    int16_t temperature;        /* °C x100 */
+    uint8_t cooling_level;
+    uint8_t pwm_duty_cycle;
+    uint8_t system_alert;       /* RACK_ALERT_* last reported */
+    uint8_t flags;              /* RACK_FLAG_* */
+    uint16_t report_seq;        /* Last frame sequence */
+    uint32_t fan_energy_j;
+    uint32_t last_seen_ms;      /* Daemon uptime at last frame (written by worker, read by reporter) */
+} rack_entry_t;
+
+_Static_assert(sizeof(rack_entry_t) == 16, "rack_entry_t must stay 16 bytes");
+
+/* Per-Worker Counters - single writer, reporter reads with relaxed loads */
+typedef struct {
+    uint64_t frames;            /* Frames applied */
+    uint64_t malformed;         /* Wrong length or truncated */
+    uint64_t diagnostic;        /* Non-status channels (counted, not decoded) */
+    uint64_t duplicates;        /* Same report sequence as last frame */
+    uint64_t lost;              /* Report-sequence gaps */
+    uint64_t alerts_raised;
+    uint64_t alerts_cleared;
+    uint64_t latency_hist[HIST_BUCKETS];
+} ingest_counters_t;
+
+/* Worker */
+typedef struct {
+    pthread_t thread;
+    uint32_t index;
+    gw_transport_t transport;
+    ingest_counters_t counters __attribute__((aligned(INGEST_CACHE_LINE)));
+    ingest_counters_t reported;                 /* Reporter's previous snapshot */
+} ingest_worker_t;
+
+/* Daemon Options */
+typedef struct {
+    gw_transport_api_t const *p_transport;
+    char const *p_address;
+    uint32_t workers;
+    bool pin;
+    uint32_t report_s;
+    uint32_t duration_s;
+    uint32_t stale_ms;
+    bool quiet;
+} ingest_options_t;
+
+/* Global Variables */
+static rack_entry_t gs_racks[INGEST_MAX_RACKS] __attribute__((aligned(INGEST_CACHE_LINE)));
+static ingest_worker_t *gs_workers;
+static ingest_options_t gs_opt;
+static uint64_t gs_start_ns;
+static volatile sig_atomic_t gs_stop;
+
+/* Local helpers */
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* Single-writer counter update: no lock prefix, but never torn for the reporter */
+static inline void counter_add(uint64_t *p_counter, uint64_t n)
+{
+    __atomic_store_n(p_counter, __atomic_load_n(p_counter, __ATOMIC_RELAXED) + n, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t counter_get(uint64_t const *p_counter)
+{
+    return __atomic_load_n(p_counter, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Histogram bucket for a latency
+ * @param[in] value_ns Latency (ns)
+ * @return Bucket index
+ */
+static inline uint32_t hist_index(uint64_t value_ns)
+{
+    if (value_ns < HIST_SUB_COUNT)
+    {
+        return (uint32_t)value_ns;
+    }
+
+    uint32_t msb = 63U - (uint32_t)__builtin_clzll(value_ns);
+    return ((msb - HIST_SUB_BITS + 1U) * HIST_SUB_COUNT) +
+           (uint32_t)((value_ns >> (msb - HIST_SUB_BITS)) & (HIST_SUB_COUNT - 1U));
+}
+
+/**
+ * @brief Upper edge of a histogram bucket (percentiles report the conservative side)
+ * @param[in] index Bucket index
+ * @return Latency (ns)
+ */
+static uint64_t hist_upper(uint32_t index)
+{
+    if (index < HIST_SUB_COUNT)
+    {
+        return index;
+    }
+
+    uint32_t shift = (index / HIST_SUB_COUNT) - 1U;
+    uint64_t lower = (uint64_t)(HIST_SUB_COUNT + (index % HIST_SUB_COUNT)) << shift;
+    return lower + (1ULL << shift) - 1U;
+}
+
+/**
+ * @brief Latency at a quantile of a histogram
+ * @param[in] p_hist  Bucket counts
+ * @param[in] total   Sum of counts
+ * @param[in] quantile 0..1
+ * @return Latency (ns)
+ */
+static uint64_t hist_quantile(uint64_t const *p_hist, uint64_t total, double quantile)
+{
+    uint64_t rank = (uint64_t)((double)total * quantile);
+    uint64_t seen = 0;
+
+    if (0U == total)
+    {
+        return 0;
+    }
+    if (rank >= total)
+    {
+        rank = total - 1U;
+    }
+
+    for (uint32_t i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += p_hist[i];
+        if (seen > rank)
+        {
+            return hist_upper(i);
+        }
+    }
+
+    return hist_upper(HIST_BUCKETS - 1U);
+}
+
+/**
+ * @brief Print alert bit names
+ */
+static void print_alert_bits(uint8_t bits)
+{
+    static char const *const names[] = { "CRITICAL_TEMP", "SENSOR_FAULT", "THERMAL_SHUTDOWN", "ANOMALY" };
+    char const *p_sep = "";
+
+    for (uint32_t i = 0; i < 8U; i++)
+    {
+        if (bits & (1U << i))
+        {
+            if (i < (sizeof(names) / sizeof(names[0])))
+            {
+                printf("%s%s", p_sep, names[i]);
+            }
+            else
+            {
+                printf("%sBIT%u", p_sep, i);
+            }
+            p_sep = "|";
+        }
+    }
+}
+
+/**
+ * @brief Apply one decoded frame to the rack table
+ * @param[in] p_counters Worker counters
+ * @param[in] p_dgram    Decoded datagram
+ * @param[in] uptime_ms  Daemon uptime
+ */
+static void ingest_apply(ingest_counters_t *p_counters, rack_datagram_t const *p_dgram, uint32_t uptime_ms)
+{
+    rack_entry_t *p_rack = &gs_racks[p_dgram->rack_id];
+    rack_frame_t const *p_frame = &p_dgram->frame;
+    uint8_t previous_alert = 0;
+
+    if (p_rack->flags & RACK_FLAG_SEEN)
+    {
+        uint16_t delta = (uint16_t)(p_frame->report_seq - p_rack->report_seq);
+
+        if (0U == delta)
+        {
+            counter_add(&p_counters->duplicates, 1);
+            return;
+        }
+        /* Forward gap = lost frames; a large backwards jump is a reboot (sequence restarts) */
+        if ((delta > 1U) && (delta < 0x8000U))
+        {
+            counter_add(&p_counters->lost, delta - 1U);
+        }
+        previous_alert = p_rack->system_alert;
+    }
+
+    uint8_t raised = (uint8_t)(p_frame->system_alert & ~previous_alert);
+    uint8_t cleared = (uint8_t)(previous_alert & ~p_frame->system_alert);
+
+    p_rack->temperature = p_frame->temperature;
+    p_rack->cooling_level = p_frame->cooling_level;
+    p_rack->pwm_duty_cycle = p_frame->pwm_duty_cycle;
+    p_rack->system_alert = p_frame->system_alert;
+    p_rack->report_seq = p_frame->report_seq;
+    p_rack->fan_energy_j = p_frame->fan_energy_j;
+    __atomic_store_n(&p_rack->last_seen_ms, uptime_ms, __ATOMIC_RELAXED);
+    __atomic_store_n(&p_rack->flags, RACK_FLAG_SEEN, __ATOMIC_RELAXED);
+
+    counter_add(&p_counters->frames, 1);
+
+    if (0U != (raised | cleared))
+    {
+        /* Edge-triggered, so this stays off the per-frame path in steady state */
+        if (0U != raised)
+        {
+            counter_add(&p_counters->alerts_raised, 1);
+        }
+        if (0U != cleared)
+        {
+            counter_add(&p_counters->alerts_cleared, 1);
+        }
+        if (!gs_opt.quiet)
+        {
+            flockfile(stdout);
+            printf("ALERT rack=%u temp=%.2f level=%u duty=%u", p_dgram->rack_id, p_frame->temperature / 100.0,
+                   p_frame->cooling_level, p_frame->pwm_duty_cycle);
+            if (0U != raised)
+            {
+                printf(" raised=");
+                print_alert_bits(raised);
+            }
+            if (0U != cleared)
+            {
+                printf(" cleared=");
+                print_alert_bits(cleared);
+            }
+            printf("\n");
+            funlockfile(stdout);
+        }
+    }
+}
+
+/**
+ * @brief Worker thread - receive, decode, apply, time
+ */
+static void *ingest_worker(void *p_arg)
+{
+    ingest_worker_t *p_worker = p_arg;
+    gw_batch_t *p_batch = malloc(sizeof(gw_batch_t));
+
+    if (NULL == p_batch)
+    {
+        return NULL;
+    }
+
+    if (gs_opt.pin)
+    {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(p_worker->index % (uint32_t)sysconf(_SC_NPROCESSORS_ONLN), &cpus);
+        (void)pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    }
+
+    while (!gs_stop)
+    {
+        int n = p_worker->transport.p_api->recv(&p_worker->transport, p_batch);
+        if (n <= 0)
+        {
+            if (n < 0)
+            {
+                perror("recv");
+                break;
+            }
+            continue;
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            rack_datagram_t dgram;
+
+            if (!rack_datagram_decode(p_batch->data[i], p_batch->len[i], &dgram))
+            {
+                counter_add(&p_worker->counters.malformed, 1);
+                continue;
+            }
+            if (RACK_CHANNEL_STATUS != dgram.channel)
+            {
+                counter_add(&p_worker->counters.diagnostic, 1);
+                continue;
+            }
+
+            uint64_t t = now_ns();
+            ingest_apply(&p_worker->counters, &dgram, (uint32_t)((t - gs_start_ns) / 1000000ULL));
+
+            if ((0U != dgram.sent_ns) && (t >= dgram.sent_ns))
+            {
+                /* Applied timestamp taken before the update, so this excludes the histogram bump itself */
+                counter_add(&p_worker->counters.latency_hist[hist_index(t - dgram.sent_ns)], 1);
+            }
+        }
+    }
+
+    free(p_batch);
+    return NULL;
+}
+
+/**
+ * @brief Sweep the table for racks that went silent and for racks that came back
+ * @param[in] uptime_ms Daemon uptime
+ * @return Racks currently reporting
+ */
+static uint32_t ingest_check_stale(uint32_t uptime_ms)
+{
+    uint32_t live = 0;
+
+    for (uint32_t id = 0; id < INGEST_MAX_RACKS; id++)
+    {
+        rack_entry_t *p_rack = &gs_racks[id];
+        uint8_t flags = __atomic_load_n(&p_rack->flags, __ATOMIC_RELAXED);
+
+        if (0U == (flags & RACK_FLAG_SEEN))
+        {
+            continue;
+        }
+
+        uint32_t silent_ms = uptime_ms - __atomic_load_n(&p_rack->last_seen_ms, __ATOMIC_RELAXED);
+        if (silent_ms < gs_opt.stale_ms)
+        {
+            live++;
+        }
+        else if (0U == (flags & RACK_FLAG_STALE))
+        {
+            /* The owning worker clears STALE on the next frame by rewriting flags */
+            __atomic_store_n(&p_rack->flags, (uint8_t)(flags | RACK_FLAG_STALE), __ATOMIC_RELAXED);
+            if (!gs_opt.quiet)
+            {
+                flockfile(stdout);
+                printf("ALERT rack=%u raised=STALE silent_ms=%u\n", id, silent_ms);
+                funlockfile(stdout);
+            }
+        }
+    }
+
+    return live;
+}
+
+/**
+ * @brief Print one interval (or the final summary) and advance the snapshots
+ * @param[in] elapsed_s Interval length
+ * @param[in] live      Racks currently reporting
+ * @param[in] final     true for the whole-run summary (cumulative instead of interval)
+ * @return Frames counted in the report
+ */
+static uint64_t ingest_report(double elapsed_s, uint32_t live, bool final)
+{
+    static uint64_t hist[HIST_BUCKETS];
+    uint64_t frames = 0, malformed = 0, diagnostic = 0, duplicates = 0, lost = 0, raised = 0, cleared = 0, samples = 0;
+
+    memset(hist, 0, sizeof(hist));
+
+    for (uint32_t w = 0; w < gs_opt.workers; w++)
+    {
+        ingest_counters_t *p_now = &gs_workers[w].counters;
+        ingest_counters_t *p_prev = &gs_workers[w].reported;
+        uint64_t worker_frames = counter_get(&p_now->frames);
+        uint64_t worker_samples = 0;
+
+        for (uint32_t i = 0; i < HIST_BUCKETS; i++)
+        {
+            uint64_t v = counter_get(&p_now->latency_hist[i]);
+            uint64_t d = final ? v : (v - p_prev->latency_hist[i]);
+            hist[i] += d;
+            worker_samples += d;
+            p_prev->latency_hist[i] = v;
+        }
+
+        frames += final ? worker_frames : (worker_frames - p_prev->frames);
+        if ((gs_opt.workers > 1U) && !final)
+        {
+            printf("  worker %2u: %10.0f frames/s\n", w, (double)(worker_frames - p_prev->frames) / elapsed_s);
+        }
+        p_prev->frames = worker_frames;
+
+        malformed += counter_get(&p_now->malformed);
+        diagnostic += counter_get(&p_now->diagnostic);
+        duplicates += counter_get(&p_now->duplicates);
+        lost += counter_get(&p_now->lost);
+        raised += counter_get(&p_now->alerts_raised);
+        cleared += counter_get(&p_now->alerts_cleared);
+        samples += worker_samples;
+    }
+
+    printf("%s %10.0f frames/s  racks=%u  latency us p50=%.1f p99=%.1f p99.9=%.1f max=%.1f  "
+           "lost=%llu dup=%llu bad=%llu diag=%llu alerts=%llu/%llu\n",
+           final ? "TOTAL" : "RATE ", (double)frames / elapsed_s, live,
+           (double)hist_quantile(hist, samples, 0.50) / 1000.0, (double)hist_quantile(hist, samples, 0.99) / 1000.0,
+           (double)hist_quantile(hist, samples, 0.999) / 1000.0, (double)hist_quantile(hist, samples, 1.0) / 1000.0,
+           (unsigned long long)lost, (unsigned long long)duplicates, (unsigned long long)malformed,
+           (unsigned long long)diagnostic, (unsigned long long)raised, (unsigned long long)cleared);
+    fflush(stdout);
+
+    return frames;
+}
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    gs_stop = 1;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr,
+            "usage: %s [-t %s] [-a address] [-w workers] [-c] [-i report_s] [-d duration_s] [-s stale_ms] [-q]\n"
+            "  -t  transport (default udp)\n"
+            "  -a  udp host:port (default " INGEST_DEFAULT_UDP_ADDRESS ") or unix path prefix (default "
+            INGEST_DEFAULT_UNIX_ADDRESS ")\n"
+            "  -w  receive workers, one socket each (default 1)\n"
+            "  -c  pin worker n to CPU n\n"
+            "  -i  report interval (default %u s)\n"
+            "  -d  stop after this many seconds (default: run until SIGINT)\n"
+            "  -s  rack silent this long raises STALE (default %u ms)\n"
+            "  -q  do not print individual alerts\n",
+            p_prog, gw_transport_names(), INGEST_DEFAULT_REPORT_S, INGEST_DEFAULT_STALE_MS);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    gs_opt.p_transport = gw_transport_find("udp");
+    gs_opt.workers = 1;
+    gs_opt.report_s = INGEST_DEFAULT_REPORT_S;
+    gs_opt.stale_ms = INGEST_DEFAULT_STALE_MS;
+
+    while (-1 != (opt = getopt(argc, argv, "t:a:w:ci:d:s:qh")))
+    {
+        switch (opt)
+        {
+            case 't':
+                gs_opt.p_transport = gw_transport_find(optarg);
+                if (NULL == gs_opt.p_transport)
+                {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'a': gs_opt.p_address = optarg; break;
+            case 'w': gs_opt.workers = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': gs_opt.pin = true; break;
+            case 'i': gs_opt.report_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': gs_opt.duration_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': gs_opt.stale_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'q': gs_opt.quiet = true; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if ((0U == gs_opt.workers) || (gs_opt.workers > INGEST_MAX_WORKERS) || (0U == gs_opt.report_s))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if (NULL == gs_opt.p_address)
+    {
+        gs_opt.p_address = (0 == strcmp(gs_opt.p_transport->p_name, "unix")) ? INGEST_DEFAULT_UNIX_ADDRESS
+                                                                              : INGEST_DEFAULT_UDP_ADDRESS;
+    }
+
+    gs_workers = aligned_alloc(INGEST_CACHE_LINE, sizeof(ingest_worker_t) * gs_opt.workers);
+    if (NULL == gs_workers)
+    {
+        return 1;
+    }
+    memset(gs_workers, 0, sizeof(ingest_worker_t) * gs_opt.workers);
+
+    for (uint32_t w = 0; w < gs_opt.workers; w++)
+    {
+        gs_workers[w].index = w;
+        gs_workers[w].transport.p_api = gs_opt.p_transport;
+        if (0 != gs_opt.p_transport->open(&gs_workers[w].transport, gs_opt.p_address, w, true))
+        {
+            return 1;
+        }
+    }
+
+    struct sigaction sa = { .sa_handler = on_signal };
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    printf("rack_ingestd: %s %s, %u worker(s)%s\n", gs_opt.p_transport->p_name, gs_opt.p_address, gs_opt.workers,
+           gs_opt.pin ? ", pinned" : "");
+    fflush(stdout);
+
+    gs_start_ns = now_ns();
+    for (uint32_t w = 0; w < gs_opt.workers; w++)
+    {
+        pthread_create(&gs_workers[w].thread, NULL, ingest_worker, &gs_workers[w]);
+    }
+
+    uint64_t last_report_ns = gs_start_ns;
+    double active_s = 0.0;
+    uint32_t live = 0;
+    while (!gs_stop)
+    {
+        struct timespec ts = { .tv_sec = gs_opt.report_s, .tv_nsec = 0 };
+        nanosleep(&ts, NULL);
+
+        uint64_t t = now_ns();
+        double interval_s = (double)(t - last_report_ns) / 1e9;
+        live = ingest_check_stale((uint32_t)((t - gs_start_ns) / 1000000ULL));
+
+        /* Summary throughput counts only intervals that saw traffic, so start-up and drain idle time
+         * do not dilute the sustained rate */
+        if (ingest_report(interval_s, live, false) > 0U)
+        {
+            active_s += interval_s;
+        }
+        last_report_ns = t;
+
+        if ((0U != gs_opt.duration_s) && ((t - gs_start_ns) >= (gs_opt.duration_s * 1000000000ULL)))
+        {
+            gs_stop = 1;
+        }
+    }
+
+    for (uint32_t w = 0; w < gs_opt.workers; w++)
+    {
+        pthread_join(gs_workers[w].thread, NULL);
+        gs_workers[w].transport.p_api->close(&gs_workers[w].transport);
+    }
+
+    (void)ingest_report((active_s > 0.0) ? active_s : ((double)(now_ns() - gs_start_ns) / 1e9), live, true);
+    free(gs_workers);
+
+    return 0;
+}
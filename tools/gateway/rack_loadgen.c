@@ -0,0 +1,358 @@
+/***********************************************************************************************************************
+ * File Name    : rack_loadgen.c
+ * Description  : Simulated N-Rack Load Generator for rack_ingestd (paced, batched, multi-threaded)
+ *
+ * Each simulated rack runs a small thermal model (ambient drift plus load, fan level from the firmware's
+ * default thresholds, cumulative fan energy) and emits the same frame ble_send_temperature_data() builds,
+ * wrapped in the gateway envelope with a send timestamp for latency measurement. A configurable fraction of
+ * racks overheat occasionally and set/clear the critical alert.
+ *
+ *   cc -O2 -pthread -o rack_loadgen rack_loadgen.c gw_transport.c -lm
+ *   rack_loadgen [-t udp|unix] [-a address] [-n racks] [-r hz] [-T threads] [-e endpoints] [-d duration_s]
+ *                [-x hot_permille] [-L loss_permille]
+ *
+ * Racks are split evenly across threads; each thread has its own socket, so with UDP the daemon's
+ * SO_REUSEPORT hash keeps every rack on one worker. With -r 0 threads send as fast as the socket accepts.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "gw_transport.h"
+#include "rack_frame.h"
+
+/* ==================================================================================================================
+ * GENERATOR CONFIGURATION
+ * ================================================================================================================== */
+#define LOADGEN_MAX_RACKS               (65536U)
+#define LOADGEN_MAX_THREADS             (64U)
+#define LOADGEN_DEFAULT_RACKS           (1000U)
+#define LOADGEN_DEFAULT_RATE_HZ         (1.0)       /* Firmware sends once per sample interval */
+#define LOADGEN_DEFAULT_DURATION_S      (10U)
+#define LOADGEN_DEFAULT_HOT_PERMILLE    (5U)
+
+/* Rack Model - defaults mirror thermal_config.c / system_config.h */
+#define SIM_AMBIENT_C                   (24.0)
+#define SIM_CRITICAL_C                  (40.0)
+#define SIM_FAN_RATED_W                 (12.0)
+static double const gs_level_thresholds[4] = { 25.0, 30.0, 35.0, 40.0 };
+static uint8_t const gs_level_duty[5] = { 0, 25, 50, 75, 100 };
+
+/* Simulated Rack */
+typedef struct {
+    uint16_t rack_id;
+    double temperature;         /* °C */
+    double load;                /* Heat load offset (°C above ambient at zero airflow) */
+    bool hot;                   /* Currently in an overheat episode */
+    uint16_t sample_count;
+    double fan_energy_j;
+    uint8_t system_alert;
+    double clock_ms;            /* Rack timebase */
+} sim_rack_t;
+
+/* Thread */
+typedef struct {
+    pthread_t thread;
+    uint32_t index;
+    uint32_t first_rack;
+    uint32_t rack_count;
+    gw_transport_t transport;
+    uint64_t sent;
+    uint64_t send_failed;
+    uint64_t skipped;           /* Frames deliberately dropped (-L) */
+} loadgen_thread_t;
+
+/* Generator Options */
+typedef struct {
+    gw_transport_api_t const *p_transport;
+    char const *p_address;
+    uint32_t racks;
+    double rate_hz;
+    uint32_t threads;
+    uint32_t endpoints;
+    uint32_t duration_s;
+    uint32_t hot_permille;
+    uint32_t loss_permille;
+} loadgen_options_t;
+
+/* Global Variables */
+static loadgen_options_t gs_opt;
+static uint64_t gs_stop_ns;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift64* - per-thread, deterministic per rack range */
+static inline uint64_t rng_next(uint64_t *p_state)
+{
+    *p_state ^= *p_state >> 12;
+    *p_state ^= *p_state << 25;
+    *p_state ^= *p_state >> 27;
+    return *p_state * 0x2545F4914F6CDD1DULL;
+}
+
+static inline double rng_unit(uint64_t *p_state)
+{
+    return (double)(rng_next(p_state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**
+ * @brief Advance one rack by one sample and produce its status frame
+ * @param[in]  p_rack  Rack model
+ * @param[in]  dt_s    Sample interval
+ * @param[in]  p_rng   Thread RNG
+ * @param[out] p_frame Frame fields
+ */
+static void sim_rack_step(sim_rack_t *p_rack, double dt_s, uint64_t *p_rng, rack_frame_t *p_frame)
+{
+    uint8_t level = 0;
+
+    while ((level < 4U) && (p_rack->temperature >= gs_level_thresholds[level]))
+    {
+        level++;
+    }
+
+    /* Overheat episodes start rarely and end once the fans have had a go at it */
+    if (!p_rack->hot && (rng_unit(p_rng) * 1000.0 * 600.0 < (double)gs_opt.hot_permille))
+    {
+        p_rack->hot = true;
+    }
+    else if (p_rack->hot && (rng_unit(p_rng) < 0.02))
+    {
+        p_rack->hot = false;
+    }
+
+    /* First-order approach to ambient + load, less whatever the fans remove, plus sensor noise */
+    double target = SIM_AMBIENT_C + p_rack->load + (p_rack->hot ? 25.0 : 0.0) - (gs_level_duty[level] * 0.08);
+    p_rack->temperature += (target - p_rack->temperature) * (1.0 - exp(-dt_s / 30.0));
+    p_rack->temperature += (rng_unit(p_rng) - 0.5) * 0.1;
+
+    double duty = gs_level_duty[level] / 100.0;
+    p_rack->fan_energy_j += SIM_FAN_RATED_W * duty * duty * duty * dt_s;
+
+    if (p_rack->temperature >= SIM_CRITICAL_C)
+    {
+        p_rack->system_alert |= RACK_ALERT_CRITICAL_TEMP;
+    }
+    else
+    {
+        p_rack->system_alert &= (uint8_t)~RACK_ALERT_CRITICAL_TEMP;
+    }
+
+    p_rack->sample_count++;
+    p_rack->clock_ms += dt_s * 1000.0;
+
+    p_frame->temperature = (int16_t)lround(p_rack->temperature * 100.0);
+    p_frame->cooling_level = level;
+    p_frame->pwm_duty_cycle = gs_level_duty[level];
+    p_frame->system_alert = p_rack->system_alert;
+    p_frame->sample_count = p_rack->sample_count;
+    p_frame->report_seq = p_rack->sample_count;     /* Simulated racks report every sample */
+    p_frame->fan_energy_j = (uint32_t)p_rack->fan_energy_j;
+    p_frame->sample_time_ms = (uint32_t)fmod(p_rack->clock_ms, 4294967296.0);
+}
+
+/**
+ * @brief Generator thread - round-robin over its racks, one batch at a time, paced to the target rate
+ */
+static void *loadgen_thread(void *p_arg)
+{
+    loadgen_thread_t *p_thread = p_arg;
+    gw_batch_t *p_batch = malloc(sizeof(gw_batch_t));
+    sim_rack_t *p_racks = calloc(p_thread->rack_count, sizeof(sim_rack_t));
+    uint64_t rng = 0x9E3779B97F4A7C15ULL ^ ((uint64_t)(p_thread->index + 1U) << 32);
+    double dt_s = (gs_opt.rate_hz > 0.0) ? (1.0 / gs_opt.rate_hz) : 1.0;
+    uint32_t next_rack = 0;
+
+    if ((NULL == p_batch) || (NULL == p_racks))
+    {
+        free(p_batch);
+        free(p_racks);
+        return NULL;
+    }
+
+    for (uint32_t i = 0; i < p_thread->rack_count; i++)
+    {
+        p_racks[i].rack_id = (uint16_t)(p_thread->first_rack + i);
+        p_racks[i].load = 2.0 + (rng_unit(&rng) * 8.0);
+        p_racks[i].temperature = SIM_AMBIENT_C + p_racks[i].load;
+        p_racks[i].sample_count = (uint16_t)rng_next(&rng);
+    }
+
+    /* Batch period at the thread's share of the aggregate rate */
+    double thread_rate = gs_opt.rate_hz * p_thread->rack_count;
+    uint64_t period_ns = (thread_rate > 0.0) ? (uint64_t)(1e9 * GW_BATCH_MAX / thread_rate) : 0U;
+    uint64_t next_ns = now_ns();
+
+    while (now_ns() < gs_stop_ns)
+    {
+        p_batch->count = 0;
+        while (p_batch->count < GW_BATCH_MAX)
+        {
+            sim_rack_t *p_rack = &p_racks[next_rack];
+            rack_frame_t frame;
+
+            next_rack = (next_rack + 1U) % p_thread->rack_count;
+            sim_rack_step(p_rack, dt_s, &rng, &frame);
+
+            if ((0U != gs_opt.loss_permille) && ((rng_next(&rng) % 1000U) < gs_opt.loss_permille))
+            {
+                p_thread->skipped++;
+                continue;
+            }
+
+            uint32_t i = p_batch->count++;
+            p_batch->len[i] = (uint16_t)rack_datagram_encode(p_rack->rack_id, 0U, &frame, p_batch->data[i]);
+        }
+
+        /* Stamp as late as possible so latency covers the transport and the daemon, not the model */
+        uint64_t t = now_ns();
+        for (uint32_t i = 0; i < p_batch->count; i++)
+        {
+            rack_put_u32(&p_batch->data[i][4], (uint32_t)t);
+            rack_put_u32(&p_batch->data[i][8], (uint32_t)(t >> 32));
+        }
+
+        int n = p_thread->transport.p_api->send(&p_thread->transport, p_batch);
+        uint32_t accepted = (n > 0) ? (uint32_t)n : 0U;
+        p_thread->sent += accepted;
+        p_thread->send_failed += p_batch->count - accepted;
+
+        if (0U != period_ns)
+        {
+            next_ns += period_ns;
+            struct timespec ts = { .tv_sec = (time_t)(next_ns / 1000000000ULL),
+                                   .tv_nsec = (long)(next_ns % 1000000000ULL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+
+    free(p_racks);
+    free(p_batch);
+    return NULL;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr,
+            "usage: %s [-t %s] [-a address] [-n racks] [-r hz] [-T threads] [-e endpoints] [-d duration_s]\n"
+            "          [-x hot_permille] [-L loss_permille]\n"
+            "  -n  simulated racks (default %u, max %u)\n"
+            "  -r  frames per second per rack (default %.0f, 0 = unpaced)\n"
+            "  -T  sender threads (default 1)\n"
+            "  -e  unix only: daemon worker sockets to spread threads over (default 1)\n"
+            "  -d  run time (default %u s)\n"
+            "  -x  racks per mille starting an overheat episode per 10 min (default %u)\n"
+            "  -L  frames per mille dropped at the source, to exercise gap accounting\n",
+            p_prog, gw_transport_names(), LOADGEN_DEFAULT_RACKS, LOADGEN_MAX_RACKS, LOADGEN_DEFAULT_RATE_HZ,
+            LOADGEN_DEFAULT_DURATION_S, LOADGEN_DEFAULT_HOT_PERMILLE);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+
+    gs_opt.p_transport = gw_transport_find("udp");
+    gs_opt.racks = LOADGEN_DEFAULT_RACKS;
+    gs_opt.rate_hz = LOADGEN_DEFAULT_RATE_HZ;
+    gs_opt.threads = 1;
+    gs_opt.endpoints = 1;
+    gs_opt.duration_s = LOADGEN_DEFAULT_DURATION_S;
+    gs_opt.hot_permille = LOADGEN_DEFAULT_HOT_PERMILLE;
+
+    while (-1 != (opt = getopt(argc, argv, "t:a:n:r:T:e:d:x:L:h")))
+    {
+        switch (opt)
+        {
+            case 't':
+                gs_opt.p_transport = gw_transport_find(optarg);
+                if (NULL == gs_opt.p_transport)
+                {
+                    usage(argv[0]);
+                    return 2;
+                }
+                break;
+            case 'a': gs_opt.p_address = optarg; break;
+            case 'n': gs_opt.racks = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': gs_opt.rate_hz = strtod(optarg, NULL); break;
+            case 'T': gs_opt.threads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'e': gs_opt.endpoints = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'd': gs_opt.duration_s = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'x': gs_opt.hot_permille = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'L': gs_opt.loss_permille = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    if ((0U == gs_opt.racks) || (gs_opt.racks > LOADGEN_MAX_RACKS) || (0U == gs_opt.threads) ||
+        (gs_opt.threads > LOADGEN_MAX_THREADS) || (gs_opt.threads > gs_opt.racks) || (0U == gs_opt.endpoints) ||
+        (gs_opt.rate_hz < 0.0))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if (NULL == gs_opt.p_address)
+    {
+        gs_opt.p_address = (0 == strcmp(gs_opt.p_transport->p_name, "unix")) ? "/tmp/rack_ingest.sock"
+                                                                              : "127.0.0.1:47000";
+    }
+
+    loadgen_thread_t *p_threads = calloc(gs_opt.threads, sizeof(loadgen_thread_t));
+    if (NULL == p_threads)
+    {
+        return 1;
+    }
+
+    uint32_t first = 0;
+    for (uint32_t t = 0; t < gs_opt.threads; t++)
+    {
+        p_threads[t].index = t;
+        p_threads[t].first_rack = first;
+        p_threads[t].rack_count = (gs_opt.racks / gs_opt.threads) + ((t < (gs_opt.racks % gs_opt.threads)) ? 1U : 0U);
+        first += p_threads[t].rack_count;
+
+        p_threads[t].transport.p_api = gs_opt.p_transport;
+        if (0 != gs_opt.p_transport->open(&p_threads[t].transport, gs_opt.p_address, t % gs_opt.endpoints, false))
+        {
+            return 1;
+        }
+    }
+
+    uint64_t start_ns = now_ns();
+    gs_stop_ns = start_ns + (gs_opt.duration_s * 1000000000ULL);
+    for (uint32_t t = 0; t < gs_opt.threads; t++)
+    {
+        pthread_create(&p_threads[t].thread, NULL, loadgen_thread, &p_threads[t]);
+    }
+
+    uint64_t sent = 0, failed = 0, skipped = 0;
+    for (uint32_t t = 0; t < gs_opt.threads; t++)
+    {
+        pthread_join(p_threads[t].thread, NULL);
+        p_threads[t].transport.p_api->close(&p_threads[t].transport);
+        sent += p_threads[t].sent;
+        failed += p_threads[t].send_failed;
+        skipped += p_threads[t].skipped;
+    }
+
+    double elapsed_s = (double)(now_ns() - start_ns) / 1e9;
+    printf("rack_loadgen: %u racks, %u thread(s), %.1f s: sent=%llu (%.0f frames/s) failed=%llu dropped=%llu\n",
+           gs_opt.racks, gs_opt.threads, elapsed_s, (unsigned long long)sent, (double)sent / elapsed_s,
+           (unsigned long long)failed, (unsigned long long)skipped);
+
+    free(p_threads);
+    return 0;
+}
@@ -0,0 +1,299 @@
+/***********************************************************************************************************************
+ * File Name    : adaptive_sampling_eval.c
+ * Description  : Host Evaluation - adaptive control sample rate (src/adaptive_sampling.c) versus the fixed 1 s rate
+ *
+ * Each scenario is a rack temperature profile plus Gaussian probe noise. Every sample runs the firmware's
+ * per-sample chain - thermal_trend_update(), thermal_anomaly_update() - and the next interval is either the fixed
+ * TEMP_SAMPLE_INTERVAL_MS or adaptive_sampling_next() on the trend, with the default level thresholds, the
+ * critical alert and the shutdown temperature as boundaries (sample_interval_next() in main_application.c).
+ * A sample is taken on the loop tick after its interval expires.
+ *
+ *   samples   control samples over the scenario - what the per-sample pipeline, logging and telemetry cost
+ *   cpu ms    host time in the per-sample chain (relative)
+ *   latency   mean/max time from a true upward boundary crossing to the first sample past it
+ *   over C    worst overshoot past a boundary when that sample is taken
+ *
+ *   cc -O2 -I../../src -o adaptive_sampling_eval adaptive_sampling_eval.c ../../src/adaptive_sampling.c \
+ *      ../../src/thermal_trend.c ../../src/thermal_anomaly.c -lm
+ *   adaptive_sampling_eval [-n noise_c] [-r seed]
+ *
+ * Exit status 1 if the adaptive rate misses a crossing, sees one later than three fixed-rate samples would, overshoots
+ * one by more than half the hysteresis, or saves less than EVAL_MIN_STEADY_SAVING on the steady rack.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "adaptive_sampling.h"
+#include "thermal_anomaly.h"
+#include "thermal_trend.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+/* Build Defaults - mirror src/main_application.h and src/system_config.h */
+#define EVAL_FIXED_MS                   (1000U)     /* TEMP_SAMPLE_INTERVAL_MS */
+#define EVAL_MIN_MS                     (250U)      /* ADAPTIVE_SAMPLE_MIN_MS */
+#define EVAL_MAX_MS                     (10000U)    /* ADAPTIVE_SAMPLE_MAX_MS */
+#define EVAL_HYSTERESIS_C               (1.0)       /* TEMP_HYSTERESIS */
+#define EVAL_NUM_BOUNDARIES             (6U)
+static float const gs_boundary[EVAL_NUM_BOUNDARIES] = {
+    30.0f, 40.0f, 50.0f, 55.0f,                     /* TEMP_*_THRESHOLD, OFF to HIGH */
+    58.0f,                                          /* SYSTEM_CRITICAL_TEMP */
+    65.0f                                           /* SYSTEM_SHUTDOWN_TEMP */
+};
+
+#define EVAL_LOOP_S                     (0.001)     /* BLE_PUMP_LOOP_PERIOD_US - the sample waits for the next tick */
+#define EVAL_DEFAULT_NOISE_C            (0.1)       /* Probe noise, 1 sigma */
+#define EVAL_DEFAULT_SEED               (1U)
+#define EVAL_CROSSING_SCAN_S            (0.01)      /* Crossing search step, refined by bisection */
+#define EVAL_MIN_STEADY_SAVING          (5.0)       /* Fixed / adaptive samples on the steady rack */
+#define EVAL_MAX_OVERSHOOT_C            (EVAL_HYSTERESIS_C / 2.0)
+#define EVAL_MAX_LATENCY_S              (3.0 * EVAL_FIXED_MS / 1000.0)     /* Three fixed-rate samples */
+
+/* Scenario */
+typedef double (*eval_profile_t)(double t);
+
+typedef struct {
+    char const *p_name;
+    eval_profile_t profile;
+    double duration_s;
+} eval_scenario_t;
+
+/* Result of one run */
+typedef struct {
+    uint32_t samples;
+    double cpu_ms;
+    uint32_t crossings;         /* Crossings seen */
+    uint32_t missed;
+    double latency_sum_s;
+    double latency_max_s;
+    double overshoot_max_c;
+} eval_result_t;
+
+/* Global Variables */
+static uint64_t gs_rng;
+static uint64_t gs_seed = EVAL_DEFAULT_SEED;
+static double gs_noise_c = EVAL_DEFAULT_NOISE_C;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+
+    return sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2);
+}
+
+/* Profiles */
+static double profile_steady(double t)
+{
+    (void)t;
+    return 28.0;
+}
+
+/* Intake fan fails an hour in: 0.05 °C/s until the rack settles hot */
+static double profile_fan_failure(double t)
+{
+    return (t < 3600.0) ? 25.0 : fmin(25.0 + (0.05 * (t - 3600.0)), 62.0);
+}
+
+/* Both fans stall at full load: 0.2 °C/s, the guard rate */
+static double profile_fan_stall(double t)
+{
+    return (t < 3600.0) ? 27.0 : fmin(27.0 + (0.2 * (t - 3600.0)), 62.0);
+}
+
+/* Day/night swing across four boundaries */
+static double profile_diurnal(double t)
+{
+    return 34.5 + (10.5 * sin(2.0 * M_PI * t / 86400.0));
+}
+
+static eval_scenario_t const gs_scenarios[] = {
+    { "steady 28 C, 24 h",         profile_steady,      86400.0 },
+    { "fan failure 0.05 C/s, 2 h", profile_fan_failure, 7200.0  },
+    { "fan stall 0.2 C/s, 2 h",    profile_fan_stall,   7200.0  },
+    { "diurnal 24-45 C, 24 h",     profile_diurnal,     86400.0 },
+};
+
+/**
+ * @brief First upward crossing of each boundary - a rise from below it, -1 for none
+ */
+static void eval_crossings(eval_scenario_t const *p_scenario, double *p_cross)
+{
+    for (uint32_t b = 0U; b < EVAL_NUM_BOUNDARIES; b++)
+    {
+        bool below = (p_scenario->profile(0.0) < gs_boundary[b]);
+
+        p_cross[b] = -1.0;
+        for (double t = EVAL_CROSSING_SCAN_S; (p_cross[b] < 0.0) && (t < p_scenario->duration_s);
+             t += EVAL_CROSSING_SCAN_S)
+        {
+            double low = t - EVAL_CROSSING_SCAN_S;
+            double high = t;
+
+            if (p_scenario->profile(t) < gs_boundary[b])
+            {
+                below = true;
+                continue;
+            }
+            if (!below)
+            {
+                continue;
+            }
+            for (uint32_t i = 0U; i < 30U; i++)
+            {
+                double mid = (low + high) / 2.0;
+
+                if (p_scenario->profile(mid) >= gs_boundary[b])
+                {
+                    high = mid;
+                }
+                else
+                {
+                    low = mid;
+                }
+            }
+            p_cross[b] = high;
+        }
+    }
+}
+
+/**
+ * @brief Run one scenario at the fixed or the adaptive rate
+ */
+static void eval_run(eval_scenario_t const *p_scenario, bool adaptive, eval_result_t *p_result)
+{
+    thermal_trend_t trend;
+    thermal_anomaly_t anomaly;
+    adaptive_sampling_t sched;
+    double cross[EVAL_NUM_BOUNDARIES];
+    bool seen[EVAL_NUM_BOUNDARIES] = { false };
+    uint32_t interval_ms = adaptive ? EVAL_MIN_MS : EVAL_FIXED_MS;
+    uint64_t cpu_ns = 0U;
+    double t = 0.0;
+
+    eval_crossings(p_scenario, cross);
+    thermal_trend_init(&trend);
+    thermal_anomaly_init(&anomaly);
+    adaptive_sampling_init(&sched, EVAL_MIN_MS, EVAL_MAX_MS);
+    *p_result = (eval_result_t){ 0 };
+    gs_rng = 0x9E3779B97F4A7C15ULL ^ gs_seed;        /* Same noise for both rates */
+
+    while (t < p_scenario->duration_s)
+    {
+        double truth = p_scenario->profile(t);
+        float measured = (float)(truth + (gs_noise_c * rng_gauss()));
+        uint64_t start_ns = now_ns();
+
+        thermal_trend_update(&trend, measured, (float)interval_ms / 1000.0f);
+        (void)thermal_anomaly_update(&anomaly, trend.level, 1U, interval_ms);
+        interval_ms = adaptive ? adaptive_sampling_next(&sched, trend.level, trend.slope, gs_boundary,
+                                                        EVAL_NUM_BOUNDARIES) : EVAL_FIXED_MS;
+        cpu_ns += now_ns() - start_ns;
+        p_result->samples++;
+
+        for (uint32_t b = 0U; b < EVAL_NUM_BOUNDARIES; b++)
+        {
+            if (!seen[b] && (cross[b] >= 0.0) && (t >= cross[b]) && (truth >= gs_boundary[b]))
+            {
+                double latency = t - cross[b];
+
+                seen[b] = true;
+                p_result->crossings++;
+                p_result->latency_sum_s += latency;
+                p_result->latency_max_s = fmax(p_result->latency_max_s, latency);
+                p_result->overshoot_max_c = fmax(p_result->overshoot_max_c, truth - gs_boundary[b]);
+            }
+        }
+        t += ((double)interval_ms / 1000.0) + (EVAL_LOOP_S / 2.0);
+    }
+
+    for (uint32_t b = 0U; b < EVAL_NUM_BOUNDARIES; b++)
+    {
+        p_result->missed += ((cross[b] >= 0.0) && !seen[b]) ? 1U : 0U;
+    }
+    p_result->cpu_ms = (double)cpu_ns / 1e6;
+}
+
+static void print_result(char const *p_rate, eval_result_t const *p_result)
+{
+    printf("  %-9s %7u samples %7.2f ms cpu | %u crossings, %u missed, latency %.2f/%.2f s, over %.3f C\n", p_rate,
+           p_result->samples, p_result->cpu_ms, p_result->crossings, p_result->missed,
+           (p_result->crossings > 0U) ? (p_result->latency_sum_s / p_result->crossings) : 0.0,
+           p_result->latency_max_s, p_result->overshoot_max_c);
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n noise_c] [-r seed]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:r:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                gs_noise_c = strtod(optarg, NULL);
+                break;
+            case 'r':
+                gs_seed = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (gs_noise_c < 0.0)
+    {
+        usage(argv[0]);
+    }
+
+    printf("fixed %u ms vs adaptive %u-%u ms, noise %.2f °C, seed %llu\n", EVAL_FIXED_MS, EVAL_MIN_MS, EVAL_MAX_MS,
+           gs_noise_c, (unsigned long long)gs_seed);
+    for (uint32_t s = 0U; s < (sizeof(gs_scenarios) / sizeof(gs_scenarios[0])); s++)
+    {
+        eval_result_t fixed;
+        eval_result_t adaptive;
+        double saving;
+        bool ok;
+
+        eval_run(&gs_scenarios[s], false, &fixed);
+        eval_run(&gs_scenarios[s], true, &adaptive);
+        saving = (double)fixed.samples / (double)adaptive.samples;
+        ok = (0U == adaptive.missed) && (adaptive.overshoot_max_c <= EVAL_MAX_OVERSHOOT_C) &&
+             (adaptive.latency_max_s <= EVAL_MAX_LATENCY_S) &&
+             ((0U != s) || (saving >= EVAL_MIN_STEADY_SAVING));
+        pass = pass && ok;
+
+        printf("%-27s %.1fx fewer samples  %s\n", gs_scenarios[s].p_name, saving, ok ? "PASS" : "FAIL");
+        print_result("fixed", &fixed);
+        print_result("adaptive", &adaptive);
+    }
+
+    return pass ? 0 : 1;
+}
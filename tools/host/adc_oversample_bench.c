@@ -0,0 +1,221 @@
+/***********************************************************************************************************************
+ * File Name    : adc_oversample_bench.c
+ * Description  : Host Benchmark - effective bits gained by oversample-and-decimate versus CPU and ADC cost
+ *
+ * Runs src/temp_oversample.h, the accumulator temp_sensor_service() feeds, over a modelled 12-bit converter:
+ * every conversion is the true level plus Gaussian input noise (the dither oversampling needs), rounded and
+ * clamped; with hardware addition the ADC sums that many conversions into one scan result. Each decimated
+ * reading is compared with the level it measured, fresh and random for every reading.
+ *
+ *   ENOB      12 + log2(ideal 12-bit quantization error / measured RMS error)
+ *   res mC    RMS error in m°C for the linear sensor (ADC_REFERENCE_VOLTAGE / 4095 / |TEMP_SENSOR_TC| per LSB)
+ *   scans     ADC interrupts (ring push + accumulator feed) per reading - CPU cost
+ *   conv      conversions per reading - ADC energy scales with it
+ *   ns        host time per reading in the accumulator (relative CPU cost; target time scales with scans)
+ *   rate Hz   readings per second at the scan rate given with -r
+ *
+ *   cc -O2 -I../../src -o adc_oversample_bench adc_oversample_bench.c -lm
+ *   adc_oversample_bench [-n readings] [-s noise_lsb] [-r scan_hz]
+ *
+ * Exit status 1 if oversampling with adequate dither fails to gain at least half a bit per extra bit.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "temp_oversample.h"
+
+/* ==================================================================================================================
+ * BENCHMARK CONFIGURATION
+ * ================================================================================================================== */
+#define BENCH_ADC_MAX                   (4095U)     /* ADC_MAX_VALUE */
+#define BENCH_LSB_C                     (3.3 / 4095.0 / 0.01)   /* ADC_REFERENCE_VOLTAGE, TEMP_SENSOR_TC */
+#define BENCH_MAX_EXTRA_BITS            (4U)
+#define BENCH_DEFAULT_READINGS          (5000U)
+#define BENCH_DEFAULT_NOISE_LSB         (0.5)       /* Typical divider + ADC input noise */
+#define BENCH_DEFAULT_SCAN_HZ           (1000.0)
+#define BENCH_TIMING_SCANS              (1U << 20)
+static uint32_t const gs_hw_add[] = { 1U, 4U, 16U };    /* ADC_ADD_* choices (2 and 3 behave like 1 and 4) */
+
+/* One configuration's result */
+typedef struct {
+    double enob;
+    double rms_lsb;
+    uint32_t scans;
+    uint32_t conversions;
+    double ns_per_reading;
+} bench_result_t;
+
+/* Global Variables */
+static uint64_t gs_rng = 0x9E3779B97F4A7C15ULL;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+
+    return sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2);
+}
+
+/**
+ * @brief One scan result - hw_add conversions of level + noise, summed as the ADC addition mode does
+ */
+static uint16_t adc_scan(double level, double noise_lsb, uint32_t hw_add)
+{
+    uint32_t sum = 0;
+
+    for (uint32_t k = 0; k < hw_add; k++)
+    {
+        double v = floor(level + (noise_lsb * rng_gauss()) + 0.5);
+
+        sum += (v < 0.0) ? 0U : ((v > (double)BENCH_ADC_MAX) ? BENCH_ADC_MAX : (uint32_t)v);
+    }
+    return (uint16_t)sum;
+}
+
+/**
+ * @brief Resolution and cost of one (extra bits, hardware addition) setting
+ */
+static void bench_run(uint8_t extra_bits, uint32_t hw_add, uint32_t readings, double noise_lsb,
+                      bench_result_t *p_result)
+{
+    temp_oversample_t os = { 0 };
+    double sq_err = 0.0;
+    uint16_t *p_raw;
+    uint64_t start_ns;
+    uint32_t scans = 0;
+    uint32_t decimated = 0;
+    volatile uint32_t sink = 0;
+
+    /* Resolution: every reading measures its own random level */
+    for (uint32_t r = 0; r < readings; r++)
+    {
+        double level = 500.0 + (3000.0 * rng_uniform());
+
+        do
+        {
+            scans++;
+        } while (!temp_oversample_feed(&os, adc_scan(level, noise_lsb, hw_add), hw_add, extra_bits));
+
+        double err = ((double)os.counts / (double)(1U << extra_bits)) - level;
+        sq_err += err * err;
+    }
+    p_result->rms_lsb = sqrt(sq_err / readings);
+    p_result->enob = 12.0 + log2((1.0 / sqrt(12.0)) / p_result->rms_lsb);
+    p_result->scans = scans / readings;
+    p_result->conversions = p_result->scans * hw_add;
+
+    /* CPU: the accumulator over pre-generated scan results */
+    p_raw = malloc(BENCH_TIMING_SCANS * sizeof(*p_raw));
+    if (NULL == p_raw)
+    {
+        perror("malloc");
+        exit(2);
+    }
+    for (uint32_t i = 0; i < BENCH_TIMING_SCANS; i++)
+    {
+        p_raw[i] = adc_scan(2000.0, noise_lsb, hw_add);
+    }
+    os = (temp_oversample_t){ 0 };
+    start_ns = now_ns();
+    for (uint32_t i = 0; i < BENCH_TIMING_SCANS; i++)
+    {
+        if (temp_oversample_feed(&os, p_raw[i], hw_add, extra_bits))
+        {
+            sink += os.counts;
+            decimated++;
+        }
+    }
+    p_result->ns_per_reading = (double)(now_ns() - start_ns) / (double)(decimated ? decimated : 1U);
+    (void)sink;
+    free(p_raw);
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n readings] [-s noise_lsb] [-r scan_hz]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t readings = BENCH_DEFAULT_READINGS;
+    double noise_lsb = BENCH_DEFAULT_NOISE_LSB;
+    double scan_hz = BENCH_DEFAULT_SCAN_HZ;
+    double enob_plain = 0.0;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:r:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                readings = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                noise_lsb = strtod(optarg, NULL);
+                break;
+            case 'r':
+                scan_hz = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == readings) || (noise_lsb < 0.0) || (scan_hz <= 0.0))
+    {
+        usage(argv[0]);
+    }
+
+    printf("input noise %.2f LSB, %u readings per setting, scan rate %.0f Hz\n", noise_lsb, readings, scan_hz);
+    printf("%5s %6s %8s %8s %8s %6s %6s %8s %9s\n", "bits", "hw add", "ENOB", "rms LSB", "res mC", "scans", "conv",
+           "ns", "rate Hz");
+    for (uint8_t n = 0; n <= BENCH_MAX_EXTRA_BITS; n++)
+    {
+        for (uint32_t h = 0; h < (sizeof(gs_hw_add) / sizeof(gs_hw_add[0])); h++)
+        {
+            bench_result_t result;
+
+            if (gs_hw_add[h] > (1UL << (2U * n)))
+            {
+                continue;   /* More conversions per scan than the ratio asks for - same as a higher ratio */
+            }
+            bench_run(n, gs_hw_add[h], readings, noise_lsb, &result);
+            printf("%5u %6u %8.2f %8.3f %8.1f %6u %6u %8.1f %9.1f\n", 12U + n, gs_hw_add[h], result.enob,
+                   result.rms_lsb, result.rms_lsb * BENCH_LSB_C * 1000.0, result.scans, result.conversions,
+                   result.ns_per_reading, scan_hz / (double)result.scans);
+
+            if ((0U == n) && (1U == gs_hw_add[h]))
+            {
+                enob_plain = result.enob;
+            }
+            else if ((noise_lsb >= 0.3) && (result.enob < (enob_plain + (0.5 * n))))
+            {
+                printf("      FAIL  %u extra bits gained only %.2f\n", n, result.enob - enob_plain);
+                pass = false;
+            }
+        }
+    }
+
+    return pass ? 0 : 1;
+}
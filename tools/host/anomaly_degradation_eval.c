@@ -0,0 +1,284 @@
+/***********************************************************************************************************************
+ * File Name    : anomaly_degradation_eval.c
+ * Description  : Host Evaluation - thermal anomaly detector (src/thermal_anomaly.c) on synthetic degradation traces
+ *
+ * Each trace is days of 1 Hz probe samples: the rack's running temperature for its cooling level, a day/night swing,
+ * Gaussian sensor noise and the fault under test. The samples go through the firmware's chain -
+ * thermal_trend_update() and thermal_anomaly_update() with the cooling level as the duty band - and the findings
+ * are recorded from the moment the fault starts (after the baselines have learned the healthy rack).
+ *
+ *   healthy     no fault: no drift finding, on one band and switching bands twice a day
+ *   drift       a clogging filter - the temperature for the same duty creeps up linearly from day 2; detected
+ *               within the time allowed per rate
+ *   recovery    the drift stops and the filter is replaced: the finding clears
+ *   excursion   a fan stops - a 3 °C rise over 10 s: excursion raised within a minute. The fast EWMA's spread
+ *               follows rises slower than about 20 s; those are left to the thresholds and the drift detector
+ *
+ * Band switches are steps too, so a switching trace shows a few excursion samples per switch.
+ *
+ *   cc -O2 -I../../src -o anomaly_degradation_eval anomaly_degradation_eval.c ../../src/thermal_anomaly.c \
+ *      ../../src/thermal_trend.c -lm
+ *   anomaly_degradation_eval [-d days] [-n noise_c] [-w swing_c] [-r seed]
+ *
+ * Exit status 1 if a healthy trace raises a drift finding, a drift is missed or detected late, a recovered rack
+ * keeps the finding, or the fan stop is not an excursion.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thermal_anomaly.h"
+#include "thermal_trend.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+#define EVAL_SAMPLE_MS                  (1000U)     /* TEMP_SAMPLE_INTERVAL_MS */
+#define EVAL_DAY_S                      (86400U)
+#define EVAL_DEFAULT_DAYS               (8U)
+#define EVAL_DEFAULT_NOISE_C            (0.1)       /* Probe noise, 1 sigma */
+#define EVAL_DEFAULT_SWING_C            (0.5)       /* Day/night amplitude */
+#define EVAL_DEFAULT_SEED               (1U)
+#define EVAL_RACK_C                     (30.0)      /* Running temperature at band 2 */
+#define EVAL_BAND_STEP_C                (3.0)       /* One cooling level cooler per band up */
+#define EVAL_FAULT_START_S              (EVAL_DAY_S + 3600U)    /* Learned a day before the fault */
+#define EVAL_STEP_C                     (3.0)       /* Fan stop */
+#define EVAL_STEP_RAMP_S                (10U)
+
+/* Trace */
+typedef enum {
+    TRACE_HEALTHY,
+    TRACE_DRIFT,
+    TRACE_RECOVERY,             /* Drift for a day and a half, then back to healthy */
+    TRACE_STEP
+} eval_trace_t;
+
+typedef struct {
+    char const *p_name;
+    eval_trace_t trace;
+    double drift_c_per_day;
+    bool switch_bands;
+    double limit_h;             /* Detection allowed within (drift, step), clear within (recovery) */
+} eval_case_t;
+
+/* Result */
+typedef struct {
+    int64_t drift_s;            /* First drift finding after the fault started, -1 for none */
+    int64_t excursion_s;        /* First excursion finding after the fault started */
+    int64_t cleared_s;          /* Last drift finding cleared, after the recovery */
+    uint32_t false_drift;       /* Drift findings before the fault */
+    uint32_t excursions;        /* Samples with an excursion finding over the trace */
+    bool raised_at_end;
+} eval_result_t;
+
+static eval_case_t const gs_cases[] = {
+    { "healthy, band 2",        TRACE_HEALTHY,  0.0,  false, 0.0  },
+    { "healthy, bands 2/3",     TRACE_HEALTHY,  0.0,  true,  0.0  },
+    { "drift 2.0 C/day",        TRACE_DRIFT,    2.0,  false, 24.0 },
+    { "drift 1.0 C/day",        TRACE_DRIFT,    1.0,  false, 36.0 },
+    { "drift 0.5 C/day",        TRACE_DRIFT,    0.5,  false, 72.0 },
+    { "drift 1.0 C/day, 2/3",   TRACE_DRIFT,    1.0,  true,  48.0 },
+    { "recovery",               TRACE_RECOVERY, 1.0,  false, 24.0 },
+    { "fan stop",               TRACE_STEP,     0.0,  false, 1.0 / 60.0 },
+};
+
+/* Global Variables */
+static uint64_t gs_rng;
+static uint32_t gs_days = EVAL_DEFAULT_DAYS;
+static double gs_noise_c = EVAL_DEFAULT_NOISE_C;
+static double gs_swing_c = EVAL_DEFAULT_SWING_C;
+
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+
+    return sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2);
+}
+
+/**
+ * @brief Probe temperature and cooling level at time t
+ */
+static double eval_sample(eval_case_t const *p_case, uint32_t t, uint8_t *p_band)
+{
+    double temp;
+    double fault_s = (t > EVAL_FAULT_START_S) ? (double)(t - EVAL_FAULT_START_S) : 0.0;
+
+    /* Two band changes a day, e.g. a load that runs through the working day */
+    *p_band = (p_case->switch_bands && (((t % EVAL_DAY_S) / (EVAL_DAY_S / 2U)) == 1U)) ? 3U : 2U;
+    temp = EVAL_RACK_C - (EVAL_BAND_STEP_C * (double)(*p_band - 2U)) +
+           (gs_swing_c * sin(2.0 * M_PI * (double)t / (double)EVAL_DAY_S)) + (gs_noise_c * rng_gauss());
+
+    switch (p_case->trace)
+    {
+        case TRACE_DRIFT:
+            temp += p_case->drift_c_per_day * fault_s / (double)EVAL_DAY_S;
+            break;
+
+        case TRACE_RECOVERY:
+            /* Filter replaced a day and a half in */
+            temp += (fault_s < (1.5 * EVAL_DAY_S)) ? (p_case->drift_c_per_day * fault_s / (double)EVAL_DAY_S) : 0.0;
+            break;
+
+        case TRACE_STEP:
+            temp += EVAL_STEP_C * ((fault_s < EVAL_STEP_RAMP_S) ? (fault_s / EVAL_STEP_RAMP_S) : 1.0);
+            break;
+
+        default:
+            break;
+    }
+    return temp;
+}
+
+/**
+ * @brief Run one trace through the trend filter and the detector
+ */
+static void eval_run(eval_case_t const *p_case, eval_result_t *p_result)
+{
+    thermal_anomaly_t detector;
+    thermal_trend_t trend;
+    uint32_t trace_s = gs_days * EVAL_DAY_S;
+    uint32_t recovered_s = EVAL_FAULT_START_S + (uint32_t)(1.5 * EVAL_DAY_S);
+    bool drift = false;
+
+    thermal_anomaly_init(&detector);
+    thermal_trend_init(&trend);
+    p_result->drift_s = -1;
+    p_result->excursion_s = -1;
+    p_result->cleared_s = -1;
+    p_result->false_drift = 0U;
+    p_result->excursions = 0U;
+
+    for (uint32_t t = 0U; t < trace_s; t++)
+    {
+        uint8_t band;
+        double temp = eval_sample(p_case, t, &band);
+        uint8_t flags;
+
+        thermal_trend_update(&trend, (float)temp, (float)EVAL_SAMPLE_MS / 1000.0f);
+        flags = thermal_anomaly_update(&detector, trend.level, band, EVAL_SAMPLE_MS);
+
+        p_result->excursions += (flags & ANOMALY_EXCURSION) ? 1U : 0U;
+        if ((flags & ANOMALY_EXCURSION) && (t >= EVAL_FAULT_START_S) && (p_result->excursion_s < 0))
+        {
+            p_result->excursion_s = (int64_t)(t - EVAL_FAULT_START_S);
+        }
+        if (flags & ANOMALY_DRIFT)
+        {
+            if (t < EVAL_FAULT_START_S)
+            {
+                p_result->false_drift++;
+            }
+            else if (p_result->drift_s < 0)
+            {
+                p_result->drift_s = (int64_t)(t - EVAL_FAULT_START_S);
+            }
+        }
+        else if (drift && (t >= recovered_s))
+        {
+            p_result->cleared_s = (int64_t)(t - recovered_s);
+        }
+        drift = (0U != (flags & ANOMALY_DRIFT));
+    }
+    p_result->raised_at_end = drift;
+}
+
+/**
+ * @brief Verdict for one case
+ */
+static bool eval_judge(eval_case_t const *p_case, eval_result_t const *p_result, char *p_note, size_t note_len)
+{
+    double limit_s = p_case->limit_h * 3600.0;
+
+    switch (p_case->trace)
+    {
+        case TRACE_HEALTHY:
+            snprintf(p_note, note_len, "drift findings: %s", (p_result->drift_s < 0) ? "none" : "RAISED");
+            return (p_result->drift_s < 0) && (0U == p_result->false_drift);
+
+        case TRACE_DRIFT:
+            snprintf(p_note, note_len, "detected after %.1f h (limit %.0f h)", (double)p_result->drift_s / 3600.0,
+                     p_case->limit_h);
+            return (0U == p_result->false_drift) && (p_result->drift_s >= 0) && ((double)p_result->drift_s <= limit_s);
+
+        case TRACE_RECOVERY:
+            snprintf(p_note, note_len, "detected after %.1f h, cleared %.1f h after the fix (limit %.0f h)",
+                     (double)p_result->drift_s / 3600.0, (double)p_result->cleared_s / 3600.0, p_case->limit_h);
+            return (p_result->drift_s >= 0) && !p_result->raised_at_end && (p_result->cleared_s >= 0) &&
+                   ((double)p_result->cleared_s <= limit_s);
+
+        case TRACE_STEP:
+            snprintf(p_note, note_len, "excursion after %lld s", (long long)p_result->excursion_s);
+            return (p_result->excursion_s >= 0) && ((double)p_result->excursion_s <= limit_s);
+
+        default:
+            return false;
+    }
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-d days] [-n noise_c] [-w swing_c] [-r seed]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint64_t seed = EVAL_DEFAULT_SEED;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "d:n:w:r:")))
+    {
+        switch (opt)
+        {
+            case 'd':
+                gs_days = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'n':
+                gs_noise_c = strtod(optarg, NULL);
+                break;
+            case 'w':
+                gs_swing_c = strtod(optarg, NULL);
+                break;
+            case 'r':
+                seed = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((gs_days < 5U) || (gs_noise_c < 0.0) || (gs_swing_c < 0.0))
+    {
+        usage(argv[0]);
+    }
+
+    printf("%u days at 1 Hz, noise %.2f °C, day/night swing ±%.2f °C, fault from %.1f h; detector state %zu words\n",
+           gs_days, gs_noise_c, gs_swing_c, (double)EVAL_FAULT_START_S / 3600.0, sizeof(thermal_anomaly_t) / 4U);
+    for (uint32_t c = 0U; c < (sizeof(gs_cases) / sizeof(gs_cases[0])); c++)
+    {
+        eval_result_t result;
+        char note[96];
+        bool ok;
+
+        gs_rng = 0x9E3779B97F4A7C15ULL ^ (seed * (c + 1U));
+        eval_run(&gs_cases[c], &result);
+        ok = eval_judge(&gs_cases[c], &result, note, sizeof(note));
+        pass = pass && ok;
+        printf("%-22s | %-64s | %6u excursion samples  %s\n", gs_cases[c].p_name, note, result.excursions,
+               ok ? "PASS" : "FAIL");
+    }
+
+    return pass ? 0 : 1;
+}
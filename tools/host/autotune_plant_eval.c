@@ -0,0 +1,402 @@
+/***********************************************************************************************************************
+ * File Name    : autotune_plant_eval.c
+ * Description  : Host Evaluation - step-response autotune (src/autotune.c) against simulated plants
+ *
+ * Each plant is sampled every AUTOTUNE_SAMPLE_MS and its reading fed to autotune_update(), whose duty goes back
+ * into the plant, as autotune_service() and pwm_control_update() do on the rack. The experiment runs from
+ * autotune_start() with the firmware's arguments until it is done or has failed. The plant's noise-free response
+ * from the step on is recorded alongside, so the identified model can be judged against what really happened.
+ *
+ *   grid        first order plus dead time: gain x time constant x dead time, with probe noise - each identified
+ *               within EVAL_GAIN_TOL, EVAL_TAU_TOL and EVAL_DEAD_TOL_S
+ *   final       the same plants noise-free: the extrapolated final value within EVAL_FINAL_TOL
+ *   second      two lags in series (chassis and air): the fitted model follows the response within EVAL_FIT_TOL
+ *   noise/drift heavier probe noise and a slow ambient drift still identify; a response below
+ *               AUTOTUNE_MIN_RESPONSE_C fails with NO_RESPONSE instead of giving a model
+ *   rack        rack_model.h (airflow-dependent conductance, fan and probe lags, its own probe noise) at a steady
+ *               load: fitted within EVAL_FIT_TOL; the load rising during the baseline aborts at the limit
+ *
+ * A load that drifts by several °C an hour during the experiment biases the fit; the row is shown but not judged -
+ * commissioning wants a steady load.
+ *
+ *   fit %       largest difference between the model's step response and the plant's, of the total change
+ *
+ *   cc -O2 -I include -I../../src -o autotune_plant_eval autotune_plant_eval.c ../../src/autotune.c \
+ *      ../../src/fan_energy.c -lm
+ *   autotune_plant_eval [-n noise_c] [-r seed] [-v]
+ *
+ * Exit status 1 if a plant is not identified within its tolerances or a failure case does not fail as expected.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "autotune.h"
+#include "rack_model.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+/* Build Defaults - mirror src/main_application.h */
+#define EVAL_SAMPLE_MS                  (1000U)     /* AUTOTUNE_SAMPLE_MS */
+#define EVAL_STEP_DUTY                  (25)        /* AUTOTUNE_STEP_DUTY */
+#define EVAL_LIMIT_C                    (56.0f)     /* SYSTEM_CRITICAL_TEMP - AUTOTUNE_LIMIT_MARGIN_C */
+#define EVAL_MARGIN_C                   (2.0f)      /* ENERGY_OPT_MARGIN_C */
+#define EVAL_RACK_BASE_DUTY             (50U)       /* PWM_DUTY_CYCLE_MEDIUM */
+
+#define EVAL_DEFAULT_NOISE_C            (0.05)      /* Probe noise after oversampling, 1 sigma */
+#define EVAL_DEFAULT_SEED               (7U)
+#define EVAL_BASE_DUTY                  (40U)
+#define EVAL_PLANT_BASE_C               (40.0)      /* Plant temperature at 0% duty */
+#define EVAL_MAX_DEAD_S                 (64U)
+#define EVAL_MAX_S                      ((AUTOTUNE_BASELINE_MAX_MS + AUTOTUNE_STEP_MAX_MS) / 1000U)
+#define EVAL_RECORD_S                   (AUTOTUNE_STEP_MAX_MS / 1000U)
+
+/* Tolerances */
+#define EVAL_GAIN_TOL                   (0.05)      /* Of the true gain */
+#define EVAL_TAU_TOL                    (0.15)      /* Of the true time constant */
+#define EVAL_DEAD_TOL_S                 (10.0)
+#define EVAL_FINAL_TOL                  (0.01)      /* Of the true change, noise-free */
+#define EVAL_FIT_TOL                    (0.10)      /* Of the total change */
+
+/* Plant */
+typedef enum {
+    PLANT_LAGS,                 /* One or two first-order lags after a dead time */
+    PLANT_RACK                  /* rack_model.h */
+} eval_plant_kind_t;
+
+typedef struct {
+    char const *p_name;
+    eval_plant_kind_t kind;
+    double gain;                /* °C per % duty */
+    double tau_s;
+    double tau2_s;              /* Second lag, 0 for none */
+    uint32_t dead_s;
+    double noise_c;             /* < 0: the -n default */
+    double drift_c_per_s;
+    float load_w;               /* Rack: steady load */
+    float load_rise_w;          /* Rack: added ramping in over the baseline's first 10 min */
+    autotune_error_t expect;    /* AUTOTUNE_ERR_NONE: identified and within the tolerances */
+    bool judged;
+} eval_case_t;
+
+typedef struct {
+    double x1;
+    double x2;
+    uint8_t delay[EVAL_MAX_DEAD_S];
+    rack_model_t rack;
+} eval_plant_t;
+
+/* Result */
+typedef struct {
+    autotune_t tune;
+    uint32_t duration_s;
+    double fit;                 /* Model against the recorded response, of the change */
+    double final_err;           /* Extrapolated final value against the true change */
+} eval_result_t;
+
+static eval_case_t const gs_cases[] = {
+    { "2nd order 240 s + 30 s", PLANT_LAGS, -0.15, 240.0, 30.0, 10U, -1.0, 0.0,  0.0f, 0.0f, AUTOTUNE_ERR_NONE, true },
+    { "2nd order 240 s + 80 s", PLANT_LAGS, -0.15, 240.0, 80.0, 10U, -1.0, 0.0,  0.0f, 0.0f, AUTOTUNE_ERR_NONE, true },
+    { "noise 0.2 C",            PLANT_LAGS, -0.10, 180.0, 0.0,  20U, 0.2,  0.0,  0.0f, 0.0f, AUTOTUNE_ERR_NONE, true },
+    { "drift 0.36 C/h",         PLANT_LAGS, -0.10, 180.0, 0.0,  20U, -1.0, 1e-4, 0.0f, 0.0f, AUTOTUNE_ERR_NONE, true },
+    { "gain -0.01 C/%",         PLANT_LAGS, -0.01, 180.0, 0.0,  20U, -1.0, 0.0,  0.0f, 0.0f,
+      AUTOTUNE_ERR_NO_RESPONSE, true },
+    { "drift 7.2 C/h",          PLANT_LAGS, -0.10, 180.0, 0.0,  20U, -1.0, 2e-3, 0.0f, 0.0f, AUTOTUNE_ERR_NONE, false },
+    { "rack 2 kW, 50->75%",     PLANT_RACK, 0.0,   0.0,   0.0,  0U,  -1.0, 0.0,  2000.0f, 0.0f, AUTOTUNE_ERR_NONE,
+      true },
+    { "rack, load rises",       PLANT_RACK, 0.0,   0.0,   0.0,  0U,  -1.0, 0.0,  2000.0f, 2500.0f,
+      AUTOTUNE_ERR_LIMIT, true },
+};
+
+/* Grid */
+static double const gs_grid_gain[] = { -0.05, -0.1, -0.2 };
+static double const gs_grid_tau_s[] = { 60.0, 180.0, 400.0 };
+static uint32_t const gs_grid_dead_s[] = { 0U, 15U, 45U };
+
+/* Global Variables */
+static uint64_t gs_rng;
+static uint64_t gs_seed = EVAL_DEFAULT_SEED;
+static double gs_noise_c = EVAL_DEFAULT_NOISE_C;
+static bool gs_verbose = false;
+static float gs_response[EVAL_RECORD_S];
+
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+
+    return sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2);
+}
+
+/**
+ * @brief Start a plant at rest at the base duty
+ */
+static void eval_plant_init(eval_case_t const *p_case, eval_plant_t *p_plant, uint8_t base_duty)
+{
+    p_plant->x1 = p_case->gain * base_duty;
+    p_plant->x2 = p_plant->x1;
+    memset(p_plant->delay, base_duty, sizeof(p_plant->delay));
+    rack_model_init(&p_plant->rack, p_case->load_w);
+}
+
+/**
+ * @brief One sample period with a commanded duty
+ * @param[out] p_clean Output without noise or drift
+ * @return Probe reading
+ */
+static float eval_plant_step(eval_case_t const *p_case, eval_plant_t *p_plant, uint32_t t_s, uint8_t duty,
+                             float *p_clean)
+{
+    double dt_s = (double)EVAL_SAMPLE_MS / 1000.0;
+
+    if (PLANT_RACK == p_case->kind)
+    {
+        float rise = p_case->load_rise_w * fminf((float)t_s / 600.0f, 1.0f);
+
+        for (uint32_t i = 0U; i < (uint32_t)lroundf((float)dt_s / RACK_MODEL_STEP_S); i++)
+        {
+            (void)rack_model_step(&p_plant->rack, p_case->load_w + rise, duty);
+        }
+        *p_clean = p_plant->rack.probe;
+        return rack_model_reading(&p_plant->rack);
+    }
+
+    /* Duty through the dead time, then the lags */
+    if (p_case->dead_s > 0U)
+    {
+        uint8_t delayed = p_plant->delay[t_s % p_case->dead_s];
+
+        p_plant->delay[t_s % p_case->dead_s] = duty;
+        duty = delayed;
+    }
+    p_plant->x1 += ((p_case->gain * duty) - p_plant->x1) * (1.0 - exp(-dt_s / p_case->tau_s));
+    p_plant->x2 = (p_case->tau2_s > 0.0) ? (p_plant->x2 + ((p_plant->x1 - p_plant->x2) *
+                                                           (1.0 - exp(-dt_s / p_case->tau2_s))))
+                                         : p_plant->x1;
+
+    *p_clean = (float)(EVAL_PLANT_BASE_C + p_plant->x2);
+    return (float)(EVAL_PLANT_BASE_C + p_plant->x2 +
+                   (((p_case->noise_c < 0.0) ? gs_noise_c : p_case->noise_c) * rng_gauss()) +
+                   (p_case->drift_c_per_s * (double)t_s));
+}
+
+/**
+ * @brief Largest difference between the model's step response and the recorded one, of the recorded change
+ */
+static double eval_fit(autotune_model_t const *p_model, int8_t step_duty, uint32_t samples)
+{
+    double change = (double)gs_response[samples - 1U] - (double)gs_response[0];
+    double worst = 0.0;
+
+    for (uint32_t k = 0U; k < samples; k++)
+    {
+        double t_s = (double)k * ((double)EVAL_SAMPLE_MS / 1000.0);
+        double lag_s = t_s - (double)p_model->dead_time_s;
+        double model = (lag_s <= 0.0) ? 0.0 :
+                       ((double)p_model->gain * step_duty * (1.0 - exp(-lag_s / (double)p_model->tau_s)));
+
+        worst = fmax(worst, fabs(model - ((double)gs_response[k] - (double)gs_response[0])));
+    }
+    return worst / fabs(change);
+}
+
+/**
+ * @brief Run one experiment on a plant
+ */
+static void eval_run(eval_case_t const *p_case, eval_result_t *p_result)
+{
+    eval_plant_t plant;
+    autotune_t *p_tune = &p_result->tune;
+    uint8_t base_duty = (PLANT_RACK == p_case->kind) ? EVAL_RACK_BASE_DUTY : EVAL_BASE_DUTY;
+    uint8_t duty = base_duty;
+    uint32_t recorded = 0U;
+    float clean = 0.0f;
+    float step_from = 0.0f;
+
+    eval_plant_init(p_case, &plant, base_duty);
+    autotune_init(p_tune);
+    (void)autotune_start(p_tune, base_duty, EVAL_STEP_DUTY, EVAL_LIMIT_C, EVAL_MARGIN_C, EVAL_SAMPLE_MS);
+
+    p_result->duration_s = 0U;
+    while (autotune_active(p_tune) && (p_result->duration_s < EVAL_MAX_S))
+    {
+        float reading = eval_plant_step(p_case, &plant, p_result->duration_s, duty, &clean);
+        bool stepped = (AUTOTUNE_STEP == p_tune->state);
+
+        /* The response from the sample the step was commanded at */
+        if (stepped && (recorded < EVAL_RECORD_S))
+        {
+            gs_response[recorded++] = clean;
+        }
+        step_from = stepped ? step_from : clean;
+        duty = autotune_update(p_tune, reading, EVAL_SAMPLE_MS);
+        p_result->duration_s++;
+    }
+
+    p_result->fit = ((AUTOTUNE_DONE == p_tune->state) && (recorded > 1U)) ?
+                    eval_fit(&p_tune->model, p_tune->step_duty, recorded) : 0.0;
+    p_result->final_err = (AUTOTUNE_DONE == p_tune->state) ?
+                          (((double)p_tune->final - (double)p_tune->baseline) /
+                           ((double)clean - (double)step_from)) - 1.0 : 0.0;
+}
+
+static void eval_print(char const *p_name, eval_result_t const *p_result, char const *p_verdict)
+{
+    autotune_t const *p_tune = &p_result->tune;
+
+    if (AUTOTUNE_DONE == p_tune->state)
+    {
+        printf("%-24s | %5u s | %7.3f %6.1f %6.1f | %5.1f %5.1f | %4.0f %4lu %3u | %s\n", p_name, p_result->duration_s,
+               (double)p_tune->model.gain, (double)p_tune->model.tau_s, (double)p_tune->model.dead_time_s,
+               p_result->fit * 100.0, p_result->final_err * 100.0, (double)p_tune->params.predict_horizon_s,
+               (unsigned long)(p_tune->params.settle_ms / 1000U), p_tune->params.trim_step, p_verdict);
+    }
+    else
+    {
+        printf("%-24s | %5u s | failed, error %d %39s | %s\n", p_name, p_result->duration_s, (int)p_tune->error, "",
+               p_verdict);
+    }
+}
+
+/**
+ * @brief First-order-plus-dead-time grid, with noise and noise-free
+ */
+static bool eval_grid(void)
+{
+    double worst[3] = { 0.0, 0.0, 0.0 };
+    double worst_final = 0.0;
+    uint32_t identified = 0U;
+    uint32_t plants = 0U;
+    bool pass = true;
+
+    for (uint32_t g = 0U; g < (sizeof(gs_grid_gain) / sizeof(gs_grid_gain[0])); g++)
+    {
+        for (uint32_t t = 0U; t < (sizeof(gs_grid_tau_s) / sizeof(gs_grid_tau_s[0])); t++)
+        {
+            for (uint32_t d = 0U; d < (sizeof(gs_grid_dead_s) / sizeof(gs_grid_dead_s[0])); d++)
+            {
+                eval_case_t plant = { "", PLANT_LAGS, gs_grid_gain[g], gs_grid_tau_s[t], 0.0, gs_grid_dead_s[d],
+                                      -1.0, 0.0, 0.0f, 0.0f, AUTOTUNE_ERR_NONE, true };
+                eval_result_t result;
+                autotune_model_t const *p_model = &result.tune.model;
+                double err[3];
+                char name[32];
+                bool ok;
+
+                eval_run(&plant, &result);
+                err[0] = fabs(((double)p_model->gain / plant.gain) - 1.0);
+                err[1] = fabs(((double)p_model->tau_s / plant.tau_s) - 1.0);
+                err[2] = fabs((double)p_model->dead_time_s - (double)plant.dead_s);
+                ok = (AUTOTUNE_DONE == result.tune.state) && (err[0] <= EVAL_GAIN_TOL) && (err[1] <= EVAL_TAU_TOL) &&
+                     (err[2] <= EVAL_DEAD_TOL_S);
+                for (uint32_t i = 0U; ok && (i < 3U); i++)
+                {
+                    worst[i] = fmax(worst[i], err[i]);
+                }
+                identified += ok ? 1U : 0U;
+
+                /* Noise-free, the extrapolated final value is what the plant settles to */
+                plant.noise_c = 0.0;
+                eval_run(&plant, &result);
+                ok = ok && (AUTOTUNE_DONE == result.tune.state) && (fabs(result.final_err) <= EVAL_FINAL_TOL);
+                worst_final = fmax(worst_final, fabs(result.final_err));
+
+                pass = pass && ok;
+                plants++;
+                if (gs_verbose || !ok)
+                {
+                    snprintf(name, sizeof(name), "K %.2f tau %.0f dt %lu", plant.gain, plant.tau_s,
+                             (unsigned long)plant.dead_s);
+                    eval_print(name, &result, ok ? "PASS" : "FAIL");
+                }
+            }
+        }
+    }
+
+    printf("%-24s | %u/%u identified, worst gain %.1f%%, tau %.1f%%, dead time %.1f s; noise-free final %.2f%%  %s\n",
+           "grid (FOPDT)", identified, plants, worst[0] * 100.0, worst[1] * 100.0, worst[2], worst_final * 100.0,
+           pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n noise_c] [-r seed] [-v]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:r:v")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                gs_noise_c = strtod(optarg, NULL);
+                break;
+            case 'r':
+                gs_seed = strtoull(optarg, NULL, 0);
+                break;
+            case 'v':
+                gs_verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (gs_noise_c < 0.0)
+    {
+        usage(argv[0]);
+    }
+
+    gs_rng = 0x9E3779B97F4A7C15ULL ^ gs_seed;
+    printf("noise %.2f °C, step +%d%% from %u%%, limit %.0f °C; autotune state %zu bytes (trace %u points)\n",
+           gs_noise_c, EVAL_STEP_DUTY, EVAL_BASE_DUTY, (double)EVAL_LIMIT_C, sizeof(autotune_t), AUTOTUNE_TRACE_LEN);
+    printf("%-24s | %7s | %7s %6s %6s | %5s %5s | %4s %4s %3s |\n", "plant", "time", "gain", "tau s", "dead s",
+           "fit %", "fin %", "hor", "set", "trm");
+    pass = eval_grid();
+
+    for (uint32_t c = 0U; c < (sizeof(gs_cases) / sizeof(gs_cases[0])); c++)
+    {
+        eval_case_t const *p_case = &gs_cases[c];
+        eval_result_t result;
+        bool ok;
+
+        eval_run(p_case, &result);
+        if (AUTOTUNE_ERR_NONE != p_case->expect)
+        {
+            ok = (AUTOTUNE_FAILED == result.tune.state) && (p_case->expect == result.tune.error);
+        }
+        else if (PLANT_LAGS == p_case->kind)
+        {
+            ok = (AUTOTUNE_DONE == result.tune.state) && (result.fit <= EVAL_FIT_TOL) &&
+                 ((p_case->tau2_s > 0.0) ||
+                  ((fabs(((double)result.tune.model.gain / p_case->gain) - 1.0) <= EVAL_GAIN_TOL) &&
+                   (fabs(((double)result.tune.model.tau_s / p_case->tau_s) - 1.0) <= EVAL_TAU_TOL)));
+        }
+        else
+        {
+            ok = (AUTOTUNE_DONE == result.tune.state) && (result.fit <= EVAL_FIT_TOL);
+        }
+        pass = pass && (ok || !p_case->judged);
+        eval_print(p_case->p_name, &result, p_case->judged ? (ok ? "PASS" : "FAIL") : "shown");
+    }
+
+    return pass ? 0 : 1;
+}
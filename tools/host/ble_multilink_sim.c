@@ -0,0 +1,787 @@
+/***********************************************************************************************************************
+ * File Name    : ble_multilink_sim.c
+ * Description  : Host Test - src/ble_app.c connection table with several centrals, against a BLE stack stand-in
+ *
+ * The real gap_cb()/gatts_cb()/vs_cb() are fed the events the stack raises for concurrent links; the R_BLE_* and
+ * RM_BLE_ABS_* calls they make land in a stand-in that records them and, like the stack, stops legacy advertising
+ * when a central connects. Nothing here needs the radio, so the scripted cases run the paths a bench with four
+ * phones rarely reaches: a link the table has no slot for, a slot reused after a disconnect, the update owner
+ * dropping out.
+ *
+ *   scripted   boot to advertising, table fill and the extra link refused, per-link CCCD and MTU on fan-out,
+ *              middle slot freed and reused clean, firmware update owner cleared on disconnect
+ *   soak       random connects, disconnects, subscriptions, MTU exchanges and notifications (with stack queue-full
+ *              rejections) checked after every event against a reference model of the links - count, slots,
+ *              who got each notification, per-link TX counters, and advertising on exactly while a slot is free
+ *
+ *   cc -O2 -Wno-unused-parameter -I include -I../../src -o ble_multilink_sim ble_multilink_sim.c ../../src/ble_app.c \
+ *      ../../src/rack_aggregator.c
+ *   ble_multilink_sim [-n events] [-s seed] [-q queue_full_pct]
+ *
+ * Exit status 0 if every check passed, 1 on any violation.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "r_ble_api.h"
+#include "rm_ble_abs.h"
+#include "gatt_db.h"
+#include "profile_cmn/r_ble_servs_if.h"
+#include "profile_cmn/r_ble_servc_if.h"
+#include "ble_app.h"
+#include "ble_ota.h"
+#include "thermal_config.h"
+#include "thermal_stats.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * TEST CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_DEFAULT_EVENTS              (200000U)
+#define SIM_DEFAULT_SEED                (1U)
+#define SIM_DEFAULT_QUEUE_FULL_PCT      (5U)
+#define SIM_HANDLE_SPACE                (12U)       /* Handles the stand-in hands out - small, so they get reused */
+#define SIM_MAX_LINKS                   (SIM_HANDLE_SPACE)
+#define SIM_TABLE_FULL_REASON           (0x13U)     /* Remote user terminated connection */
+#define SIM_MAX_MTU_REQUEST             (300U)
+#define SIM_ATT_MTU_MAX                 (247U)      /* BLE_OPTIMAL_MTU in ble_app.c */
+
+/* Reference model of one link, kept by connection handle */
+typedef struct {
+    bool live;
+    uint16_t mtu;
+    bool notify;
+    uint32_t tx_notifications;
+    uint32_t tx_bytes;
+    uint32_t tx_failures;
+} sim_link_t;
+
+/* BLE stack stand-in */
+typedef struct {
+    bool advertising;
+    uint32_t adv_starts;
+    uint32_t adv_restarts;      /* Started while already advertising */
+    uint32_t data_len_sets;
+    uint32_t disconnects;
+    uint16_t last_disconnect_hdl;
+    uint8_t last_disconnect_reason;
+    bool delivered[SIM_HANDLE_SPACE];   /* Notification accepted, per handle, since the last reset */
+    bool rejected[SIM_HANDLE_SPACE];    /* Notification refused as queue full */
+    uint32_t ntf_foreign;               /* Notifications to a handle the stack does not have */
+} sim_stack_t;
+
+/* Firmware update stand-in */
+typedef struct {
+    bool busy;
+    uint32_t controls;
+    uint32_t aborts;
+} sim_ota_t;
+
+/* Global Variables */
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+uint32_t SystemCoreClock = 200000000U;
+
+ble_abs_instance_ctrl_t g_ble_abs0_ctrl;
+ble_abs_cfg_t const g_ble_abs0_cfg = { .channel = 0U };
+st_ble_gatts_db_cfg_t g_gatt_db_table;
+
+static sim_stack_t gs_stack;
+static sim_ota_t gs_ota;
+static sim_link_t gs_link[SIM_MAX_LINKS];
+static uint32_t gs_queue_full_pct = SIM_DEFAULT_QUEUE_FULL_PCT;
+static uint32_t gs_failures = 0U;
+static thermal_config_t gs_config;
+
+/* ==================================================================================================================
+ * BLE STACK STAND-IN
+ * ================================================================================================================== */
+ble_status_t R_BLE_Execute(void)
+{
+    return BLE_SUCCESS;
+}
+
+uint32_t R_BLE_IsTaskFree(void)
+{
+    return 1U;
+}
+
+ble_status_t R_BLE_GAP_Disconnect(uint16_t conn_hdl, uint8_t reason)
+{
+    gs_stack.disconnects++;
+    gs_stack.last_disconnect_hdl = conn_hdl;
+    gs_stack.last_disconnect_reason = reason;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_SetDataLen(uint16_t conn_hdl, uint16_t tx_octets, uint16_t tx_time)
+{
+    (void)conn_hdl;
+    (void)tx_octets;
+    (void)tx_time;
+    gs_stack.data_len_sets++;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_UpdConn(uint16_t conn_hdl, uint8_t mode, uint16_t accept,
+                               st_ble_gap_conn_param_t * p_conn_updt_param)
+{
+    (void)conn_hdl;
+    (void)mode;
+    (void)accept;
+    (void)p_conn_updt_param;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_SetAdvSresData(st_ble_gap_adv_data_t * p_adv_srsp_data)
+{
+    (void)p_adv_srsp_data;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetDbInst(void * p_db_inst)
+{
+    (void)p_db_inst;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetPrepareQueue(st_ble_gatt_pre_queue_t * p_pre_queues, uint8_t queue_num)
+{
+    (void)p_pre_queues;
+    (void)queue_num;
+    return BLE_SUCCESS;
+}
+
+/* Queue-full rejections at the configured rate */
+ble_status_t R_BLE_GATTS_Notification(uint16_t conn_hdl, st_ble_gatt_hdl_value_pair_t * p_ntf_data)
+{
+    (void)p_ntf_data;
+    if ((conn_hdl >= SIM_HANDLE_SPACE) || !gs_link[conn_hdl].live)
+    {
+        gs_stack.ntf_foreign++;
+        return BLE_ERR_INVALID_HDL;
+    }
+    if ((uint32_t)(rand() % 100) < gs_queue_full_pct)
+    {
+        gs_stack.rejected[conn_hdl] = true;
+        return BLE_ERR_MEM_ALLOC_FAILED;
+    }
+    gs_stack.delivered[conn_hdl] = true;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetAttr(uint16_t conn_hdl, uint16_t attr_hdl, st_ble_gatt_value_t * p_value)
+{
+    (void)conn_hdl;
+    (void)attr_hdl;
+    (void)p_value;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_RspExMtu(uint16_t conn_hdl, uint16_t mtu)
+{
+    (void)conn_hdl;
+    (void)mtu;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_VS_GetBdAddr(uint8_t area, uint8_t addr_type)
+{
+    (void)area;
+    (void)addr_type;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_SERVS_Init(void)
+{
+    return BLE_SUCCESS;
+}
+
+void R_BLE_SERVS_VsCb(uint16_t type, ble_status_t result, st_ble_vs_evt_data_t * p_data)
+{
+    (void)type;
+    (void)result;
+    (void)p_data;
+}
+
+ble_status_t R_BLE_QC_SVCS_Init(ble_servs_app_cb_t cb)
+{
+    (void)cb;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_SERVC_Init(void)
+{
+    return BLE_SUCCESS;
+}
+
+void R_BLE_SERVC_GattcCb(uint16_t type, ble_status_t result, st_ble_gattc_evt_data_t * p_data)
+{
+    (void)type;
+    (void)result;
+    (void)p_data;
+}
+
+fsp_err_t RM_BLE_ABS_Open(ble_abs_instance_ctrl_t * const p_ctrl, ble_abs_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_Close(ble_abs_instance_ctrl_t * const p_ctrl)
+{
+    p_ctrl->open = 0U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_StartLegacyAdvertising(ble_abs_instance_ctrl_t * const p_ctrl,
+                                            ble_abs_legacy_advertising_parameter_t const * const p_parameter)
+{
+    (void)p_ctrl;
+    (void)p_parameter;
+    if (gs_stack.advertising)
+    {
+        gs_stack.adv_restarts++;
+        return FSP_ERR_IN_USE;
+    }
+    gs_stack.advertising = true;
+    gs_stack.adv_starts++;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_StartScanning(ble_abs_instance_ctrl_t * const p_ctrl,
+                                   ble_abs_scan_parameter_t const * const p_scan_parameter)
+{
+    (void)p_ctrl;
+    (void)p_scan_parameter;
+    return FSP_SUCCESS;
+}
+
+/* ==================================================================================================================
+ * APPLICATION STAND-INS (modules ble_app.c calls that this test does not exercise)
+ * ================================================================================================================== */
+fsp_err_t ble_ota_control(uint8_t const *p_data, uint16_t len)
+{
+    gs_ota.controls++;
+    if ((len > 0U) && (OTA_CMD_START == p_data[0]))
+    {
+        gs_ota.busy = true;
+    }
+    return FSP_SUCCESS;
+}
+
+fsp_err_t ble_ota_data(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return FSP_SUCCESS;
+}
+
+void ble_ota_abort(void)
+{
+    gs_ota.aborts++;
+    gs_ota.busy = false;
+}
+
+bool ble_ota_busy(void)
+{
+    return gs_ota.busy;
+}
+
+void ble_ota_service(void)
+{
+}
+
+uint16_t ble_ota_take_status(uint8_t *p_buf)
+{
+    (void)p_buf;
+    return 0U;
+}
+
+thermal_config_t const * thermal_config_get(void)
+{
+    return &gs_config;
+}
+
+fsp_err_t thermal_config_stage(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return FSP_SUCCESS;
+}
+
+uint16_t thermal_config_serialize(thermal_config_t const *p_config, uint8_t *p_buf, uint16_t buf_len)
+{
+    (void)p_config;
+    memset(p_buf, 0, buf_len);
+    return buf_len;
+}
+
+uint16_t thermal_stats_serialize(uint8_t status, uint8_t *p_buf, uint16_t buf_len)
+{
+    (void)status;
+    memset(p_buf, 0, buf_len);
+    return buf_len;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/* ==================================================================================================================
+ * EVENTS (what the stack raises for the links)
+ * ================================================================================================================== */
+static void sim_boot(void)
+{
+    st_ble_vs_get_bd_addr_comp_evt_t addr = { .addr = { .addr = { 1, 2, 3, 4, 5, 0xC6 } } };
+    st_ble_vs_evt_data_t vs = { .param_len = sizeof(addr), .p_param = &addr };
+
+    ble_app_init();
+    gap_cb(BLE_GAP_EVENT_STACK_ON, BLE_SUCCESS, NULL);
+    vs_cb(BLE_VS_EVENT_GET_ADDR_COMP, BLE_SUCCESS, &vs);
+}
+
+/* A central connects - the stack ends legacy advertising when it does */
+static void sim_connect(uint16_t conn_hdl)
+{
+    st_ble_gap_conn_evt_t conn = { .conn_hdl = conn_hdl };
+    st_ble_evt_data_t evt = { .conn_hdl = conn_hdl, .param_len = sizeof(conn), .p_param = &conn };
+
+    gs_stack.advertising = false;
+    gap_cb(BLE_GAP_EVENT_CONN_IND, BLE_SUCCESS, &evt);
+}
+
+static void sim_disconnect(uint16_t conn_hdl)
+{
+    st_ble_gap_disconn_evt_t disconn = { .conn_hdl = conn_hdl, .reason = SIM_TABLE_FULL_REASON };
+    st_ble_evt_data_t evt = { .conn_hdl = conn_hdl, .param_len = sizeof(disconn), .p_param = &disconn };
+
+    gap_cb(BLE_GAP_EVENT_DISCONN_IND, BLE_SUCCESS, &evt);
+}
+
+static void sim_write(uint16_t conn_hdl, uint16_t attr_hdl, uint8_t db_op, uint8_t *p_value, uint16_t len)
+{
+    st_ble_gatts_db_params_t params = { .db_op = db_op, .attr_hdl = attr_hdl, .value = { p_value, len } };
+    st_ble_gatts_db_access_evt_t access = { .p_handle = &params };
+    st_ble_gatts_evt_data_t evt = { .conn_hdl = conn_hdl, .param_len = sizeof(access), .p_param = &access };
+
+    gatts_cb(BLE_GATTS_EVENT_DB_ACCESS_IND, BLE_SUCCESS, &evt);
+}
+
+static void sim_subscribe(uint16_t conn_hdl, uint16_t cccd_hdl, uint16_t value)
+{
+    uint8_t cccd[2] = { (uint8_t)(value & 0xFFU), (uint8_t)(value >> 8) };
+
+    sim_write(conn_hdl, cccd_hdl, BLE_GATTS_OP_CHAR_PEER_CLI_CNFG_WRITE_REQ, cccd, sizeof(cccd));
+}
+
+static void sim_exchange_mtu(uint16_t conn_hdl, uint16_t mtu)
+{
+    st_ble_gatts_ex_mtu_req_evt_t req = { .mtu = mtu };
+    st_ble_gatts_evt_data_t evt = { .conn_hdl = conn_hdl, .param_len = sizeof(req), .p_param = &req };
+
+    gatts_cb(BLE_GATTS_EVENT_EX_MTU_REQ, BLE_SUCCESS, &evt);
+}
+
+static void sim_ota_start(uint16_t conn_hdl)
+{
+    uint8_t start[OTA_CMD_START_LEN] = { OTA_CMD_START, 0x00, 0x10, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12 };
+
+    sim_write(conn_hdl, BLE_OTA_CONTROL_VAL_HDL, BLE_GATTS_OP_CHAR_PEER_WRITE_REQ, start, sizeof(start));
+}
+
+/**
+ * @brief Send one rack status notification; the stack stand-in records which handles took it
+ */
+static uint8_t sim_notify(uint16_t len)
+{
+    static uint8_t payload[SIM_ATT_MTU_MAX];
+
+    memset(gs_stack.delivered, 0, sizeof(gs_stack.delivered));
+    memset(gs_stack.rejected, 0, sizeof(gs_stack.rejected));
+    return ble_send_notification(payload, len);
+}
+
+/* ==================================================================================================================
+ * CHECKS
+ * ================================================================================================================== */
+static void check(bool ok, char const *p_what)
+{
+    printf("%-68s %s\n", p_what, ok ? "PASS" : "FAIL");
+    gs_failures += ok ? 0U : 1U;
+}
+
+/**
+ * @brief Table slot holding a handle
+ * @return Slot index, or -1
+ */
+static int32_t sim_slot_of(uint16_t conn_hdl)
+{
+    for (uint8_t i = 0U; i < BLE_MAX_CONNECTIONS; i++)
+    {
+        if (ble_get_connection(i)->conn_hdl == conn_hdl)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static uint32_t sim_live_links(void)
+{
+    uint32_t live = 0U;
+
+    for (uint16_t h = 0U; h < SIM_MAX_LINKS; h++)
+    {
+        live += gs_link[h].live ? 1U : 0U;
+    }
+    return live;
+}
+
+/**
+ * @brief Table against the reference model: every live link in exactly one slot with its state, nothing else
+ * @return Description of the first mismatch, or NULL
+ */
+static char const *sim_table_mismatch(void)
+{
+    uint32_t used = 0U;
+
+    for (uint8_t i = 0U; i < BLE_MAX_CONNECTIONS; i++)
+    {
+        ble_conn_t const *p_conn = ble_get_connection(i);
+        sim_link_t const *p_link;
+
+        if (BLE_GAP_INVALID_CONN_HDL == p_conn->conn_hdl)
+        {
+            continue;
+        }
+        used++;
+        if ((p_conn->conn_hdl >= SIM_MAX_LINKS) || !gs_link[p_conn->conn_hdl].live)
+        {
+            return "slot holds a handle that is not connected";
+        }
+        if (sim_slot_of(p_conn->conn_hdl) != i)
+        {
+            return "handle in two slots";
+        }
+        p_link = &gs_link[p_conn->conn_hdl];
+        if ((p_conn->mtu != p_link->mtu) || (((p_conn->cccd_rack_status & BLE_CCCD_NOTIFY) != 0U) != p_link->notify))
+        {
+            return "slot MTU or subscription differs from the link";
+        }
+        if ((p_conn->tx_notifications != p_link->tx_notifications) || (p_conn->tx_bytes != p_link->tx_bytes) ||
+            (p_conn->tx_failures != p_link->tx_failures))
+        {
+            return "slot TX counters differ from the link";
+        }
+    }
+    if ((used != sim_live_links()) || (ble_get_connection_count() != used))
+    {
+        return "connection count differs from the links";
+    }
+    if (ble_is_connected() != (used > 0U))
+    {
+        return "ble_is_connected() disagrees with the count";
+    }
+    if (gs_stack.advertising != (used < BLE_MAX_CONNECTIONS))
+    {
+        return "advertising not on exactly while a slot is free";
+    }
+    if (gs_stack.adv_restarts > 0U)
+    {
+        return "advertising started while already running";
+    }
+    return NULL;
+}
+
+/**
+ * @brief Model one notification: who should get it, and what ble_send_notification() should return
+ * @return Description of the first mismatch, or NULL
+ */
+static char const *sim_notify_mismatch(uint16_t len, uint8_t missed)
+{
+    uint8_t expected_missed = 0U;
+
+    for (uint16_t h = 0U; h < SIM_MAX_LINKS; h++)
+    {
+        sim_link_t *p_link = &gs_link[h];
+        bool fits = ((uint32_t)len + BLE_ATT_NTF_OVERHEAD) <= p_link->mtu;
+
+        if (!p_link->live || !p_link->notify || !fits)
+        {
+            if (gs_stack.delivered[h] || gs_stack.rejected[h])
+            {
+                return "notification sent to a link not subscribed or with too small an MTU";
+            }
+            if (p_link->live && p_link->notify)
+            {
+                p_link->tx_failures++;
+                expected_missed++;
+            }
+            continue;
+        }
+        if (gs_stack.delivered[h] == gs_stack.rejected[h])
+        {
+            return "subscribed link not offered the notification exactly once";
+        }
+        if (gs_stack.delivered[h])
+        {
+            p_link->tx_notifications++;
+            p_link->tx_bytes += len;
+        }
+        else
+        {
+            p_link->tx_failures++;
+            expected_missed++;
+        }
+    }
+    if (gs_stack.ntf_foreign > 0U)
+    {
+        return "notification to a handle the stack does not have";
+    }
+    return (missed == expected_missed) ? NULL : "missed count differs from the links not reached";
+}
+
+/* ==================================================================================================================
+ * SCENARIOS
+ * ================================================================================================================== */
+static void sim_link_up(uint16_t conn_hdl)
+{
+    gs_link[conn_hdl] = (sim_link_t){ .live = true, .mtu = BLE_DEFAULT_MTU };
+    sim_connect(conn_hdl);
+}
+
+static void sim_link_down(uint16_t conn_hdl)
+{
+    gs_link[conn_hdl].live = false;
+    sim_disconnect(conn_hdl);
+}
+
+static void sim_scripted(void)
+{
+    uint32_t disconnects;
+    uint8_t missed;
+    bool ok;
+
+    sim_boot();
+    check(gs_stack.advertising && (1U == gs_stack.adv_starts) && (0U == ble_get_connection_count()),
+          "boot: advertising once the address is read, table empty");
+
+    /* Handles 0..3 fill the table */
+    for (uint16_t h = 0U; h < BLE_MAX_CONNECTIONS; h++)
+    {
+        sim_link_up(h);
+    }
+    check((NULL == sim_table_mismatch()) && !gs_stack.advertising && (BLE_MAX_CONNECTIONS == gs_stack.data_len_sets),
+          "4 centrals connect, one slot each, advertising off at a full table");
+
+    /* A stack configured for more links than the table lets a fifth through */
+    disconnects = gs_stack.disconnects;
+    sim_connect(4U);
+    ok = (disconnects + 1U == gs_stack.disconnects) && (4U == gs_stack.last_disconnect_hdl) &&
+         (SIM_TABLE_FULL_REASON == gs_stack.last_disconnect_reason) && (-1 == sim_slot_of(4U));
+    sim_disconnect(4U);
+    check(ok && (NULL == sim_table_mismatch()), "5th link refused with 0x13, its disconnect leaves the table alone");
+
+    /* Link 0 and 2 subscribe, 2 and 1 raise the MTU (2 asks above the maximum), 1 subscribes to something else */
+    sim_subscribe(0U, BLE_RACK_STATUS_CCCD_HDL, BLE_CCCD_NOTIFY);
+    sim_subscribe(2U, BLE_RACK_STATUS_CCCD_HDL, BLE_CCCD_NOTIFY);
+    sim_subscribe(1U, BLE_ROW_SUMMARY_CCCD_HDL, BLE_CCCD_NOTIFY);
+    gs_link[0].notify = true;
+    gs_link[2].notify = true;
+    sim_exchange_mtu(2U, 512U);
+    sim_exchange_mtu(1U, 100U);
+    gs_link[2].mtu = SIM_ATT_MTU_MAX;
+    gs_link[1].mtu = 100U;
+    ok = ble_take_status_subscriber() && !ble_take_status_subscriber();
+    check(ok && (NULL == sim_table_mismatch()), "CCCD and MTU kept per link, MTU capped at 247, one subscriber flag");
+
+    gs_queue_full_pct = 0U;
+    missed = sim_notify(20U);
+    ok = (0U == missed) && gs_stack.delivered[0] && gs_stack.delivered[2] && !gs_stack.delivered[1] &&
+         !gs_stack.delivered[3] && (NULL == sim_notify_mismatch(20U, missed));
+    check(ok && (NULL == sim_table_mismatch()), "20-byte status reaches the two subscribed links only");
+
+    missed = sim_notify(100U);
+    ok = (1U == missed) && !gs_stack.delivered[0] && gs_stack.delivered[2] &&
+         (NULL == sim_notify_mismatch(100U, missed));
+    check(ok && (NULL == sim_table_mismatch()), "100-byte status skips the 23-byte MTU link and counts it missed");
+
+    /* Slot 1 freed and reused by a new central: nothing of the old link carries over */
+    sim_subscribe(1U, BLE_RACK_STATUS_CCCD_HDL, BLE_CCCD_NOTIFY);
+    (void)ble_take_status_subscriber();
+    sim_link_down(1U);
+    ok = gs_stack.advertising && (NULL == sim_table_mismatch());
+    sim_link_up(5U);
+    ok = ok && (1 == sim_slot_of(5U)) && (0U == ble_get_connection(1U)->cccd_rack_status) &&
+         (0U == ble_get_connection(1U)->cccd_row_summary) && (BLE_DEFAULT_MTU == ble_get_connection(1U)->mtu);
+    missed = sim_notify(20U);
+    ok = ok && !gs_stack.delivered[5] && (NULL == sim_notify_mismatch(20U, missed));
+    check(ok && (NULL == sim_table_mismatch()), "middle slot freed, advertising resumed, reused with a clean state");
+
+    /* Firmware update: link 3 claims it, link 2 cannot take it over, only link 3 leaving aborts it */
+    sim_ota_start(3U);
+    ok = gs_ota.busy && (1U == gs_ota.controls);
+    sim_ota_start(2U);
+    ok = ok && (1U == gs_ota.controls);
+    sim_link_down(2U);
+    ok = ok && (0U == gs_ota.aborts) && gs_ota.busy;
+    sim_link_down(3U);
+    ok = ok && (1U == gs_ota.aborts) && !gs_ota.busy;
+    sim_link_up(3U);                /* The stack reuses the handle - the new link never owned the update */
+    sim_link_down(3U);
+    ok = ok && (1U == gs_ota.aborts);
+    sim_link_up(6U);
+    sim_ota_start(6U);
+    ok = ok && (2U == gs_ota.controls) && gs_ota.busy;
+    sim_link_down(6U);
+    check(ok && (2U == gs_ota.aborts) && (NULL == sim_table_mismatch()),
+          "update owned by one link, aborted only when that link leaves");
+
+    /* Leave the table empty for the soak */
+    for (uint16_t h = 0U; h < SIM_MAX_LINKS; h++)
+    {
+        if (gs_link[h].live)
+        {
+            sim_link_down(h);
+        }
+    }
+}
+
+static void sim_soak(uint32_t events)
+{
+    uint32_t counts[6] = { 0U };
+    char const *p_error = NULL;
+    uint32_t n;
+
+    for (n = 0U; (n < events) && (NULL == p_error); n++)
+    {
+        uint16_t h = (uint16_t)(rand() % (int)SIM_MAX_LINKS);
+        uint32_t kind = (uint32_t)(rand() % 6);
+
+        switch (kind)
+        {
+            case 0:     /* Connect - only while advertising, or forced past a full table now and then */
+                if (gs_link[h].live)
+                {
+                    break;
+                }
+                if (gs_stack.advertising)
+                {
+                    sim_link_up(h);
+                    counts[0]++;
+                }
+                else if (0 == (rand() % 8))
+                {
+                    sim_connect(h);
+                    if ((gs_stack.last_disconnect_hdl != h) || (-1 != sim_slot_of(h)))
+                    {
+                        p_error = "link past a full table not refused";
+                    }
+                    sim_disconnect(h);
+                    counts[5]++;
+                }
+                break;
+
+            case 1:     /* Disconnect */
+                if (gs_link[h].live)
+                {
+                    sim_link_down(h);
+                    counts[1]++;
+                }
+                break;
+
+            case 2:     /* Subscribe or unsubscribe */
+                if (gs_link[h].live)
+                {
+                    gs_link[h].notify = (0 != (rand() % 3));
+                    sim_subscribe(h, BLE_RACK_STATUS_CCCD_HDL, gs_link[h].notify ? BLE_CCCD_NOTIFY : 0U);
+                    counts[2]++;
+                }
+                break;
+
+            case 3:     /* MTU exchange */
+                if (gs_link[h].live)
+                {
+                    uint16_t mtu = (uint16_t)(BLE_DEFAULT_MTU + (rand() % (SIM_MAX_MTU_REQUEST - BLE_DEFAULT_MTU)));
+
+                    sim_exchange_mtu(h, mtu);
+                    gs_link[h].mtu = (mtu < SIM_ATT_MTU_MAX) ? mtu : SIM_ATT_MTU_MAX;
+                    counts[3]++;
+                }
+                break;
+
+            default:    /* Notification, mostly sizes around the MTUs in play */
+            {
+                uint16_t len = (uint16_t)(1 + (rand() % (SIM_ATT_MTU_MAX - 2)));
+                uint8_t missed = sim_notify(len);
+
+                p_error = sim_notify_mismatch(len, missed);
+                counts[4]++;
+            }
+            break;
+        }
+        p_error = (NULL != p_error) ? p_error : sim_table_mismatch();
+    }
+
+    printf("soak: %u events - %u connects, %u refused, %u disconnects, %u CCCD writes, %u MTU exchanges, "
+           "%u notifications\n", n, counts[0], counts[5], counts[1], counts[2], counts[3], counts[4]);
+    if (NULL != p_error)
+    {
+        printf("  event %u: %s\n", n, p_error);
+    }
+    check(NULL == p_error, "soak: table, fan-out and advertising match the model every event");
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n events] [-s seed] [-q queue_full_pct]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t events = SIM_DEFAULT_EVENTS;
+    uint32_t seed = SIM_DEFAULT_SEED;
+    uint32_t queue_full_pct = SIM_DEFAULT_QUEUE_FULL_PCT;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:q:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                events = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'q':
+                queue_full_pct = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (queue_full_pct > 100U)
+    {
+        usage(argv[0]);
+    }
+
+    srand(seed);
+    printf("%u slots, %u handles, seed %u, %u%% stack queue-full\n", BLE_MAX_CONNECTIONS, SIM_HANDLE_SPACE, seed,
+           queue_full_pct);
+    sim_scripted();
+    gs_queue_full_pct = queue_full_pct;
+    sim_soak(events);
+
+    return (0U == gs_failures) ? 0 : 1;
+}
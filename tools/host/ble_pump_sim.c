@@ -0,0 +1,553 @@
+/***********************************************************************************************************************
+ * File Name    : ble_pump_sim.c
+ * Description  : Host Test - src/ble_app.c event pump (ble_app_run) against a BLE stack stand-in with event bursts
+ *
+ * The stand-in keeps a queue of pending stack work: every R_BLE_Execute() takes one event off it and advances the
+ * cycle counter by that event's cost, and R_BLE_IsTaskFree() reports whether the queue is empty. Events arrive in
+ * bursts between calls, so the pump sees what a connection event storm or a firmware update stream puts on the
+ * stack, with the budget the control loop hands it.
+ *
+ *   scripted   idle stack, a zero budget (skipped, queue untouched), one burst larger than a budget - the pump stops
+ *              at the budget with the work still queued and drains it over the following calls
+ *   soak       random bursts and budgets (some zero) checked after every call against a model of the pump: a call
+ *              ends only idle or with the budget spent, overruns it by at most one pass, never leaves work pending
+ *              without counting a deferral, and calls/executes/deferrals/skipped match the model
+ *
+ *   cc -O2 -Wno-unused-parameter -I include -I../../src -o ble_pump_sim ble_pump_sim.c ../../src/ble_app.c \
+ *      ../../src/rack_aggregator.c
+ *   ble_pump_sim [-n calls] [-s seed] [-b budget_us]
+ *
+ * Exit status 0 if every check passed, 1 on any violation.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "r_ble_api.h"
+#include "rm_ble_abs.h"
+#include "gatt_db.h"
+#include "profile_cmn/r_ble_servs_if.h"
+#include "profile_cmn/r_ble_servc_if.h"
+#include "ble_app.h"
+#include "ble_ota.h"
+#include "system_config.h"
+#include "thermal_config.h"
+#include "thermal_stats.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * TEST CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_DEFAULT_CALLS               (200000U)
+#define SIM_DEFAULT_SEED                (1U)
+#define SIM_DEFAULT_BUDGET_US           (BLE_PUMP_BUDGET_US)    /* What the control loop hands the pump */
+#define SIM_CORE_CLOCK_HZ               (200000000U)
+#define SIM_PASS_MIN_CYCLES             (400U)      /* One R_BLE_Execute() pass: 2 us ... */
+#define SIM_PASS_MAX_CYCLES             (24000U)    /* ... to 120 us (long GATT write handling) */
+#define SIM_IDLE_PASS_CYCLES            (200U)      /* Pass that finds nothing to do */
+#define SIM_BURST_MAX                   (64U)       /* Events in one burst */
+#define SIM_BURST_PCT                   (20U)       /* Calls preceded by a burst */
+#define SIM_SKIP_PCT                    (5U)        /* Calls with no budget left */
+#define SIM_QUEUE_MAX                   (4096U)
+
+/* BLE stack stand-in: pending work as a queue of pass costs */
+typedef struct {
+    uint32_t cost[SIM_QUEUE_MAX];
+    uint32_t head;
+    uint32_t count;
+    uint32_t executes;          /* R_BLE_Execute() passes seen */
+    uint32_t pass_max;          /* Costliest pass since the last reset */
+} sim_stack_t;
+
+/* Model of the pump counters */
+typedef struct {
+    uint32_t calls;
+    uint32_t executes;
+    uint32_t deferrals;
+    uint32_t skipped;
+} sim_model_t;
+
+/* Global Variables */
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+uint32_t SystemCoreClock = SIM_CORE_CLOCK_HZ;
+
+ble_abs_instance_ctrl_t g_ble_abs0_ctrl;
+ble_abs_cfg_t const g_ble_abs0_cfg = { .channel = 0U };
+st_ble_gatts_db_cfg_t g_gatt_db_table;
+
+static sim_stack_t gs_stack;
+static sim_model_t gs_model;
+static uint64_t gs_rng;
+static uint32_t gs_failures = 0U;
+static thermal_config_t gs_config;
+
+static inline uint32_t rng_next(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (uint32_t)(gs_rng >> 32);
+}
+
+static inline uint32_t rng_range(uint32_t lo, uint32_t hi)
+{
+    return lo + (rng_next() % (hi - lo + 1U));
+}
+
+/* ==================================================================================================================
+ * BLE STACK STAND-IN
+ * ================================================================================================================== */
+/* One pass: the next queued event, or an idle pass if there is none */
+ble_status_t R_BLE_Execute(void)
+{
+    uint32_t cost = SIM_IDLE_PASS_CYCLES;
+
+    if (gs_stack.count > 0U)
+    {
+        cost = gs_stack.cost[gs_stack.head];
+        gs_stack.head = (gs_stack.head + 1U) % SIM_QUEUE_MAX;
+        gs_stack.count--;
+    }
+    gs_dwt.CYCCNT += cost;
+    gs_stack.executes++;
+    if (cost > gs_stack.pass_max)
+    {
+        gs_stack.pass_max = cost;
+    }
+    return BLE_SUCCESS;
+}
+
+uint32_t R_BLE_IsTaskFree(void)
+{
+    return (0U == gs_stack.count) ? 1U : 0U;
+}
+
+ble_status_t R_BLE_GAP_Disconnect(uint16_t conn_hdl, uint8_t reason)
+{
+    (void)conn_hdl;
+    (void)reason;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_SetDataLen(uint16_t conn_hdl, uint16_t tx_octets, uint16_t tx_time)
+{
+    (void)conn_hdl;
+    (void)tx_octets;
+    (void)tx_time;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_UpdConn(uint16_t conn_hdl, uint8_t mode, uint16_t accept,
+                               st_ble_gap_conn_param_t * p_conn_updt_param)
+{
+    (void)conn_hdl;
+    (void)mode;
+    (void)accept;
+    (void)p_conn_updt_param;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GAP_SetAdvSresData(st_ble_gap_adv_data_t * p_adv_srsp_data)
+{
+    (void)p_adv_srsp_data;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetDbInst(void * p_db_inst)
+{
+    (void)p_db_inst;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetPrepareQueue(st_ble_gatt_pre_queue_t * p_pre_queues, uint8_t queue_num)
+{
+    (void)p_pre_queues;
+    (void)queue_num;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_Notification(uint16_t conn_hdl, st_ble_gatt_hdl_value_pair_t * p_ntf_data)
+{
+    (void)conn_hdl;
+    (void)p_ntf_data;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_SetAttr(uint16_t conn_hdl, uint16_t attr_hdl, st_ble_gatt_value_t * p_value)
+{
+    (void)conn_hdl;
+    (void)attr_hdl;
+    (void)p_value;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_GATTS_RspExMtu(uint16_t conn_hdl, uint16_t mtu)
+{
+    (void)conn_hdl;
+    (void)mtu;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_VS_GetBdAddr(uint8_t area, uint8_t addr_type)
+{
+    (void)area;
+    (void)addr_type;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_SERVS_Init(void)
+{
+    return BLE_SUCCESS;
+}
+
+void R_BLE_SERVS_VsCb(uint16_t type, ble_status_t result, st_ble_vs_evt_data_t * p_data)
+{
+    (void)type;
+    (void)result;
+    (void)p_data;
+}
+
+ble_status_t R_BLE_QC_SVCS_Init(ble_servs_app_cb_t cb)
+{
+    (void)cb;
+    return BLE_SUCCESS;
+}
+
+ble_status_t R_BLE_SERVC_Init(void)
+{
+    return BLE_SUCCESS;
+}
+
+void R_BLE_SERVC_GattcCb(uint16_t type, ble_status_t result, st_ble_gattc_evt_data_t * p_data)
+{
+    (void)type;
+    (void)result;
+    (void)p_data;
+}
+
+fsp_err_t RM_BLE_ABS_Open(ble_abs_instance_ctrl_t * const p_ctrl, ble_abs_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_Close(ble_abs_instance_ctrl_t * const p_ctrl)
+{
+    p_ctrl->open = 0U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_StartLegacyAdvertising(ble_abs_instance_ctrl_t * const p_ctrl,
+                                            ble_abs_legacy_advertising_parameter_t const * const p_parameter)
+{
+    (void)p_ctrl;
+    (void)p_parameter;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t RM_BLE_ABS_StartScanning(ble_abs_instance_ctrl_t * const p_ctrl,
+                                   ble_abs_scan_parameter_t const * const p_scan_parameter)
+{
+    (void)p_ctrl;
+    (void)p_scan_parameter;
+    return FSP_SUCCESS;
+}
+
+/* ==================================================================================================================
+ * APPLICATION STAND-INS (modules ble_app.c calls that this test does not exercise)
+ * ================================================================================================================== */
+fsp_err_t ble_ota_control(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t ble_ota_data(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return FSP_SUCCESS;
+}
+
+void ble_ota_abort(void)
+{
+}
+
+bool ble_ota_busy(void)
+{
+    return false;
+}
+
+void ble_ota_service(void)
+{
+}
+
+uint16_t ble_ota_take_status(uint8_t *p_buf)
+{
+    (void)p_buf;
+    return 0U;
+}
+
+thermal_config_t const * thermal_config_get(void)
+{
+    return &gs_config;
+}
+
+fsp_err_t thermal_config_stage(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+    return FSP_SUCCESS;
+}
+
+uint16_t thermal_config_serialize(thermal_config_t const *p_config, uint8_t *p_buf, uint16_t buf_len)
+{
+    (void)p_config;
+    memset(p_buf, 0, buf_len);
+    return buf_len;
+}
+
+uint16_t thermal_stats_serialize(uint8_t status, uint8_t *p_buf, uint16_t buf_len)
+{
+    (void)status;
+    memset(p_buf, 0, buf_len);
+    return buf_len;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/* ==================================================================================================================
+ * PUMP
+ * ================================================================================================================== */
+/* Queue a burst of stack work, each event with its own pass cost */
+static uint32_t sim_burst(uint32_t events)
+{
+    uint32_t queued = 0U;
+
+    while ((queued < events) && (gs_stack.count < SIM_QUEUE_MAX))
+    {
+        gs_stack.cost[(gs_stack.head + gs_stack.count) % SIM_QUEUE_MAX] =
+            rng_range(SIM_PASS_MIN_CYCLES, SIM_PASS_MAX_CYCLES);
+        gs_stack.count++;
+        queued++;
+    }
+    return queued;
+}
+
+/**
+ * @brief One ble_app_run() call, checked against the pump rules and the counter model
+ * @return NULL if the call kept every rule, else what it broke
+ */
+static char const * sim_run(uint32_t budget_cycles)
+{
+    ble_pump_stats_t stats;
+    uint32_t pending_before = gs_stack.count;
+    uint32_t executes_before = gs_stack.executes;
+    uint32_t start = gs_dwt.CYCCNT;
+    uint32_t passes;
+    uint32_t busy;
+    bool pending;
+
+    gs_stack.pass_max = 0U;
+    pending = ble_app_run(budget_cycles);
+    busy = gs_dwt.CYCCNT - start;
+    passes = gs_stack.executes - executes_before;
+
+    gs_model.calls++;
+    gs_model.executes += passes;
+    if (0U == budget_cycles)
+    {
+        gs_model.skipped++;
+    }
+    else if (0U != gs_stack.count)
+    {
+        gs_model.deferrals++;
+    }
+
+    ble_get_pump_stats(&stats);
+    if (pending != (0U != gs_stack.count))
+    {
+        return "return value does not match the stack's pending work";
+    }
+    if (0U == budget_cycles)
+    {
+        if ((0U != passes) || (pending_before != gs_stack.count))
+        {
+            return "zero budget still ran the stack";
+        }
+    }
+    else
+    {
+        if (0U == passes)
+        {
+            return "budget given but the stack was not run";
+        }
+        /* Stopped with work queued: only because the budget ran out */
+        if (pending && (busy < budget_cycles))
+        {
+            return "stopped with work pending and budget left";
+        }
+        /* The pass that crossed the budget started inside it */
+        if (busy >= (budget_cycles + gs_stack.pass_max))
+        {
+            return "kept running past the budget";
+        }
+        if (stats.busy_cycles_last != busy)
+        {
+            return "busy_cycles_last does not match the call";
+        }
+    }
+    if ((stats.calls != gs_model.calls) || (stats.executes != gs_model.executes) ||
+        (stats.deferrals != gs_model.deferrals) || (stats.skipped != gs_model.skipped))
+    {
+        return "counters do not match the model";
+    }
+    return NULL;
+}
+
+/* ==================================================================================================================
+ * CHECKS
+ * ================================================================================================================== */
+static void check(bool ok, char const *p_what)
+{
+    printf("%-68s %s\n", p_what, ok ? "PASS" : "FAIL");
+    gs_failures += ok ? 0U : 1U;
+}
+
+static void sim_scripted(uint32_t budget_cycles)
+{
+    ble_pump_stats_t stats;
+    char const *p_error;
+    uint32_t queued;
+    uint32_t calls = 0U;
+
+    p_error = sim_run(budget_cycles);
+    ble_get_pump_stats(&stats);
+    check((NULL == p_error) && (1U == stats.executes) && (0U == stats.deferrals),
+          "idle stack: one pass, nothing deferred");
+
+    (void)sim_burst(4U);
+    p_error = sim_run(0U);
+    ble_get_pump_stats(&stats);
+    check((NULL == p_error) && (1U == stats.skipped) && (4U == gs_stack.count),
+          "zero budget: skipped, queued work left alone and reported");
+    while ((NULL == p_error) && (0U != gs_stack.count))
+    {
+        p_error = sim_run(budget_cycles);
+    }
+    check(NULL == p_error, "small burst: drained within the budget");
+
+    /* Several budgets' worth of work in one burst */
+    queued = sim_burst((4U * budget_cycles) / SIM_PASS_MIN_CYCLES);
+    p_error = sim_run(budget_cycles);
+    calls++;
+    ble_get_pump_stats(&stats);
+    check((NULL == p_error) && (0U != gs_stack.count) && (gs_stack.count < queued) && (1U == stats.deferrals),
+          "large burst: stops at the budget, rest deferred");
+    while ((NULL == p_error) && (0U != gs_stack.count))
+    {
+        p_error = sim_run(budget_cycles);
+        calls++;
+    }
+    ble_get_pump_stats(&stats);
+    printf("  %u events over %u calls, worst call %u cycles (budget %u)\n", queued, calls, stats.busy_cycles_max,
+           budget_cycles);
+    check((NULL == p_error) && (calls > 1U) && (stats.busy_cycles_max < (budget_cycles + SIM_PASS_MAX_CYCLES)),
+          "large burst: carried into later calls, none past budget + one pass");
+    p_error = sim_run(budget_cycles);
+    check(NULL == p_error, "large burst: idle again once drained");
+}
+
+static void sim_soak(uint32_t calls, uint32_t budget_cycles)
+{
+    char const *p_error = NULL;
+    uint32_t arrived = 0U;
+    uint32_t max_backlog = 0U;
+    uint32_t n;
+
+    for (n = 0U; (n < calls) && (NULL == p_error); n++)
+    {
+        uint32_t budget = budget_cycles;
+
+        if (rng_range(1U, 100U) <= SIM_BURST_PCT)
+        {
+            arrived += sim_burst(rng_range(1U, SIM_BURST_MAX));
+        }
+        if (rng_range(1U, 100U) <= SIM_SKIP_PCT)
+        {
+            budget = 0U;
+        }
+        else if (0U == (rng_next() % 4U))
+        {
+            budget = rng_range(1U, budget_cycles);     /* Loop ran long, less left over */
+        }
+        max_backlog = (gs_stack.count > max_backlog) ? gs_stack.count : max_backlog;
+        p_error = sim_run(budget);
+    }
+
+    printf("soak: %u calls, %u events, backlog peak %u - %u executes, %u deferrals, %u skipped\n", n, arrived,
+           max_backlog, gs_model.executes, gs_model.deferrals, gs_model.skipped);
+    if (NULL != p_error)
+    {
+        printf("  call %u: %s\n", n, p_error);
+    }
+    check(NULL == p_error, "soak: budget, carry-over and counters hold every call");
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n calls] [-s seed] [-b budget_us]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t calls = SIM_DEFAULT_CALLS;
+    uint32_t seed = SIM_DEFAULT_SEED;
+    uint32_t budget_us = SIM_DEFAULT_BUDGET_US;
+    uint32_t budget_cycles;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:b:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                calls = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                budget_us = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == budget_us) || (budget_us > BLE_PUMP_LOOP_PERIOD_US))
+    {
+        usage(argv[0]);
+    }
+
+    gs_rng = 0x9E3779B97F4A7C15ULL ^ seed;
+    budget_cycles = budget_us * (SystemCoreClock / 1000000U);
+    printf("budget %u us (%u cycles), passes %u..%u cycles, seed %u\n", budget_us, budget_cycles,
+           SIM_PASS_MIN_CYCLES, SIM_PASS_MAX_CYCLES, seed);
+    sim_scripted(budget_cycles);
+    sim_soak(calls, budget_cycles);
+
+    return (0U == gs_failures) ? 0 : 1;
+}
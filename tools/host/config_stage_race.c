@@ -0,0 +1,390 @@
+/***********************************************************************************************************************
+ * File Name    : config_stage_race.c
+ * Description  : Host Stress Test - src/thermal_config.c staging and apply with racing writers
+ *
+ * Writer threads stand in for GATT writes arriving from any context and call thermal_config_stage() with
+ * payloads that each encode one key in every field, so a bank mixing two writes fails the check. The main thread
+ * is the control loop: thermal_config_apply_pending(), then one control iteration on the thermal_config_get()
+ * pointer - check the bank is one complete write, hold it for a while, check nothing wrote into it meanwhile.
+ *
+ *   free run    writers stage continuously; every successful stage must be applied exactly once, and the loop
+ *               must never see a torn or changing active bank
+ *   CAS race    all writers released together at an empty staging bank, many rounds; exactly one wins each
+ *               round and the applied bank is the winner's payload
+ *
+ *   cc -O2 -pthread -Wno-pointer-to-int-cast -I include -I../../src -o config_stage_race config_stage_race.c \
+ *      ../../src/thermal_config.c
+ *   config_stage_race [-n iterations] [-w writers] [-r rounds]
+ *
+ * Exit status 0 if every phase passed, 1 on any violation.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "thermal_config.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * TEST CONFIGURATION
+ * ================================================================================================================== */
+#define RACE_DEFAULT_ITERATIONS         (200000U)
+#define RACE_DEFAULT_WRITERS            (3U)
+#define RACE_DEFAULT_ROUNDS             (2000U)
+#define RACE_MAX_WRITERS                (8U)
+#define RACE_KEYS                       (300U)      /* Keys that give a valid configuration */
+#define RACE_HOLD_SPINS                 (200U)      /* Length of one control iteration on the active bank */
+
+/* Writer Statistics */
+typedef struct {
+    uint32_t id;
+    uint64_t staged;
+    uint64_t busy;
+    uint64_t rejected;
+    uint32_t last_key;
+} race_writer_t;
+
+/* Global Variables */
+flash_ctrl_t g_flash0_ctrl;
+const flash_cfg_t g_flash0_cfg = { .data_flash_bgo = false };
+
+static uint32_t gs_writers = RACE_DEFAULT_WRITERS;
+static race_writer_t gs_writer[RACE_MAX_WRITERS];
+static atomic_bool gs_stop;
+static pthread_barrier_t gs_start;
+static pthread_barrier_t gs_done;
+
+/* Data flash reads as erased - thermal_config_init() falls back to the build defaults */
+fsp_err_t R_FLASH_HP_Open(flash_ctrl_t * const p_ctrl, flash_cfg_t const * const p_cfg)
+{
+    (void)p_ctrl;
+    (void)p_cfg;
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Write(flash_ctrl_t * const p_ctrl, uint32_t const src_address, uint32_t flash_address,
+                           uint32_t const num_bytes)
+{
+    (void)p_ctrl;
+    (void)src_address;
+    (void)flash_address;
+    (void)num_bytes;
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Erase(flash_ctrl_t * const p_ctrl, uint32_t const address, uint32_t const num_blocks)
+{
+    (void)p_ctrl;
+    (void)address;
+    (void)num_blocks;
+    return FSP_ERR_NOT_OPEN;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/**
+ * @brief GATT payload for a key - every field carries it
+ */
+static void race_payload(uint32_t key, uint8_t *p_buf)
+{
+    int16_t const centi[5] = { (int16_t)(3000 + key), (int16_t)(4000 + key), (int16_t)(5000 + key),
+                               (int16_t)(5500 + key), (int16_t)(5800 + key) };
+
+    p_buf[0] = (uint8_t)THERMAL_CONFIG_VERSION;
+    p_buf[1] = 0U;
+    for (uint32_t i = 0U; i < 5U; i++)
+    {
+        p_buf[2U + (2U * i)] = (uint8_t)((uint16_t)centi[i] & 0xFFU);
+        p_buf[3U + (2U * i)] = (uint8_t)((uint16_t)centi[i] >> 8);
+    }
+    p_buf[12] = (uint8_t)(10U + (key % 40U));
+    p_buf[13] = 0U;
+    p_buf[14] = (uint8_t)(20U + (key % 5U));
+    p_buf[15] = (uint8_t)(45U + (key % 5U));
+    p_buf[16] = (uint8_t)(70U + (key % 5U));
+    p_buf[17] = 100U;
+    p_buf[18] = (uint8_t)((1000U + key) & 0xFFU);
+    p_buf[19] = (uint8_t)((1000U + key) >> 8);
+    p_buf[20] = (uint8_t)((500U + key) & 0xFFU);
+    p_buf[21] = (uint8_t)((500U + key) >> 8);
+}
+
+/**
+ * @brief Is a bank exactly the staged form of one key's payload
+ * @return The key, or -1 for a bank that mixes writes
+ */
+static int32_t race_bank_key(thermal_config_t const *p_config)
+{
+    uint32_t key = (uint32_t)p_config->sample_interval_ms - 1000U;
+    uint8_t wire[THERMAL_CONFIG_WIRE_SIZE];
+
+    if (key >= RACE_KEYS)
+    {
+        return -1;
+    }
+    race_payload(key, wire);
+
+    /* Same decode as thermal_config_stage(), so the floats compare bit for bit */
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        if (p_config->level_threshold[i] != ((float)(int16_t)(wire[2U + (2U * i)] | (wire[3U + (2U * i)] << 8)) /
+                                              100.0f))
+        {
+            return -1;
+        }
+    }
+    if ((p_config->critical_temp != ((float)(int16_t)(wire[10] | (wire[11] << 8)) / 100.0f)) ||
+        (p_config->hysteresis != ((float)wire[12] / 10.0f)) || (0 != memcmp(p_config->duty, &wire[13], 5U)) ||
+        (p_config->ble_tx_interval_ms != (500U + key)) || (THERMAL_CONFIG_MAGIC != p_config->magic) ||
+        (THERMAL_CONFIG_VERSION != p_config->version))
+    {
+        return -1;
+    }
+    return (int32_t)key;
+}
+
+/**
+ * @brief Free-run writer - stages continuously until stopped
+ */
+static void *race_free_writer(void *p_arg)
+{
+    race_writer_t *p_writer = (race_writer_t *)p_arg;
+    uint8_t wire[THERMAL_CONFIG_WIRE_SIZE];
+
+    for (uint32_t n = 0U; !atomic_load(&gs_stop); n++)
+    {
+        uint32_t key = ((p_writer->id * 97U) + n) % RACE_KEYS;
+        fsp_err_t err;
+
+        race_payload(key, wire);
+        err = thermal_config_stage(wire, THERMAL_CONFIG_WIRE_SIZE);
+        if (FSP_SUCCESS == err)
+        {
+            p_writer->staged++;
+            p_writer->last_key = key;
+        }
+        else if (FSP_ERR_IN_USE == err)
+        {
+            p_writer->busy++;
+            sched_yield();
+        }
+        else
+        {
+            p_writer->rejected++;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief CAS-race writer - one stage per round, all writers released together
+ */
+static void *race_round_writer(void *p_arg)
+{
+    race_writer_t *p_writer = (race_writer_t *)p_arg;
+    uint8_t wire[THERMAL_CONFIG_WIRE_SIZE];
+
+    for (uint32_t round = 0U; ; round++)
+    {
+        uint32_t key = ((round * RACE_MAX_WRITERS) + p_writer->id) % RACE_KEYS;
+
+        race_payload(key, wire);
+        pthread_barrier_wait(&gs_start);
+        if (atomic_load(&gs_stop))
+        {
+            break;
+        }
+        if (FSP_SUCCESS == thermal_config_stage(wire, THERMAL_CONFIG_WIRE_SIZE))
+        {
+            p_writer->staged++;
+            p_writer->last_key = key;
+        }
+        pthread_barrier_wait(&gs_done);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Phase 1 - control loop against continuously racing writers
+ */
+static bool race_free_run(uint32_t iterations)
+{
+    pthread_t thread[RACE_MAX_WRITERS];
+    uint64_t applied = 0U;
+    uint64_t staged = 0U;
+    uint64_t busy = 0U;
+    uint64_t rejected = 0U;
+    uint64_t torn = 0U;
+    uint64_t changed = 0U;
+    bool pass;
+
+    thermal_config_init();
+    atomic_store(&gs_stop, false);
+    for (uint32_t i = 0U; i < gs_writers; i++)
+    {
+        gs_writer[i] = (race_writer_t){ .id = i };
+        pthread_create(&thread[i], NULL, race_free_writer, &gs_writer[i]);
+    }
+
+    for (uint32_t n = 0U; n < iterations; n++)
+    {
+        thermal_config_t const *p_active;
+        thermal_config_t snapshot;
+
+        applied += thermal_config_apply_pending() ? 1U : 0U;
+        p_active = thermal_config_get();
+        snapshot = *p_active;
+        if ((race_bank_key(&snapshot) < 0) && (0U != applied))
+        {
+            torn++;
+        }
+        for (volatile uint32_t spin = 0U; spin < RACE_HOLD_SPINS; spin++)
+        {
+        }
+        if (0U == (n % 64U))
+        {
+            sched_yield();
+        }
+        if (0 != memcmp(&snapshot, p_active, sizeof(snapshot)))
+        {
+            changed++;
+        }
+    }
+
+    atomic_store(&gs_stop, true);
+    for (uint32_t i = 0U; i < gs_writers; i++)
+    {
+        pthread_join(thread[i], NULL);
+        staged += gs_writer[i].staged;
+        busy += gs_writer[i].busy;
+        rejected += gs_writer[i].rejected;
+    }
+    applied += thermal_config_apply_pending() ? 1U : 0U;
+    pass = (applied == staged) && (0U == rejected) && (0U == torn) && (0U == changed) && (0U != staged);
+
+    printf("free run   %u iterations, %u writers: %llu staged, %llu busy, %llu rejected, %llu applied, "
+           "%llu torn, %llu changed under the loop  %s\n", iterations, gs_writers, (unsigned long long)staged,
+           (unsigned long long)busy, (unsigned long long)rejected, (unsigned long long)applied,
+           (unsigned long long)torn, (unsigned long long)changed, pass ? "PASS" : "FAIL");
+    return pass;
+}
+
+/**
+ * @brief Phase 2 - all writers hit an empty staging bank at once; exactly one claims it
+ */
+static bool race_cas_rounds(uint32_t rounds)
+{
+    pthread_t thread[RACE_MAX_WRITERS];
+    uint64_t staged_before[RACE_MAX_WRITERS] = { 0 };
+    uint32_t bad_rounds = 0U;
+    uint32_t wrong_winner = 0U;
+    uint32_t wins[RACE_MAX_WRITERS] = { 0 };
+
+    thermal_config_init();
+    atomic_store(&gs_stop, false);
+    pthread_barrier_init(&gs_start, NULL, gs_writers + 1U);
+    pthread_barrier_init(&gs_done, NULL, gs_writers + 1U);
+    for (uint32_t i = 0U; i < gs_writers; i++)
+    {
+        gs_writer[i] = (race_writer_t){ .id = i };
+        pthread_create(&thread[i], NULL, race_round_writer, &gs_writer[i]);
+    }
+
+    for (uint32_t round = 0U; round < rounds; round++)
+    {
+        uint32_t winners = 0U;
+        uint32_t winner = 0U;
+
+        pthread_barrier_wait(&gs_start);
+        pthread_barrier_wait(&gs_done);
+        for (uint32_t i = 0U; i < gs_writers; i++)
+        {
+            if (gs_writer[i].staged != staged_before[i])
+            {
+                winners++;
+                winner = i;
+                staged_before[i] = gs_writer[i].staged;
+            }
+        }
+        bad_rounds += (1U == winners) ? 0U : 1U;
+        if ((1U == winners) && thermal_config_apply_pending())
+        {
+            wins[winner]++;
+            wrong_winner += (race_bank_key(thermal_config_get()) == (int32_t)gs_writer[winner].last_key) ? 0U : 1U;
+        }
+        else
+        {
+            wrong_winner++;
+        }
+    }
+
+    atomic_store(&gs_stop, true);
+    pthread_barrier_wait(&gs_start);
+    for (uint32_t i = 0U; i < gs_writers; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+    pthread_barrier_destroy(&gs_start);
+    pthread_barrier_destroy(&gs_done);
+
+    printf("CAS race   %u rounds, %u writers: %u rounds without exactly one winner, %u applied banks not the "
+           "winner's, wins", rounds, gs_writers, bad_rounds, wrong_winner);
+    for (uint32_t i = 0U; i < gs_writers; i++)
+    {
+        printf(" %u", wins[i]);
+    }
+    printf("  %s\n", ((0U == bad_rounds) && (0U == wrong_winner)) ? "PASS" : "FAIL");
+    return (0U == bad_rounds) && (0U == wrong_winner);
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n iterations] [-w writers (1-%u)] [-r rounds]\n", p_prog, RACE_MAX_WRITERS);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t iterations = RACE_DEFAULT_ITERATIONS;
+    uint32_t rounds = RACE_DEFAULT_ROUNDS;
+    bool pass;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:w:r:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                iterations = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'w':
+                gs_writers = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                rounds = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == iterations) || (0U == gs_writers) || (gs_writers > RACE_MAX_WRITERS))
+    {
+        usage(argv[0]);
+    }
+
+    pass = race_free_run(iterations);
+    pass = race_cas_rounds(rounds) && pass;
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,198 @@
+/***********************************************************************************************************************
+ * File Name    : energy_trim_eval.c
+ * Description  : Host Evaluation - energy-optimal duty trim on load traces, closed loop
+ *
+ * The rack model in rack_model.h is driven through each heat-load trace with the firmware's control rules at the
+ * build defaults - level table, trend feed-forward - once as is and once with the energy trim of
+ * fan_energy_trim_update() taken off the duty, the margin and floor decided as pwm_control_update() does. Fan
+ * power comes from fan_energy.c (cube law), so a few percent of duty is worth noticeably more in energy.
+ *
+ *   energy kJ fan electrical energy, intake + exhaust
+ *   peak C    highest true rack temperature
+ *   >crit s   time above SYSTEM_CRITICAL_TEMP
+ *   trim %    mean duty taken off by the trim
+ *
+ *   cc -O2 -I../../src -o energy_trim_eval energy_trim_eval.c ../../src/fan_energy.c ../../src/thermal_trend.c -lm
+ *   energy_trim_eval [-S settle_ms] [-t trim_step] [-m margin_c]
+ *
+ * Exit status 1 if the trim costs energy, raises the peak beyond the limit-cycle tolerance or adds more than a
+ * control period above critical on any trace.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "fan_energy.h"
+#include "rack_model.h"
+#include "thermal_policy.h"
+#include "thermal_trend.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+/* Build Defaults - mirror src/main_application.h */
+#define EVAL_CRITICAL_C                 (58.0f)     /* SYSTEM_CRITICAL_TEMP */
+#define EVAL_HORIZON_S                  (60.0f)     /* PREDICT_HORIZON_S */
+#define EVAL_MIN_SLOPE_C_PER_S          (0.005f)    /* PREDICT_MIN_SLOPE_C_PER_S */
+#define EVAL_MARGIN_C                   (2.0f)      /* ENERGY_OPT_MARGIN_C */
+#define EVAL_STEP_DUTY                  (5U)        /* ENERGY_OPT_STEP_DUTY */
+#define EVAL_SETTLE_MS                  (30000U)    /* ENERGY_OPT_SETTLE_MS */
+#define EVAL_MIN_DUTY                   (15U)       /* ENERGY_OPT_MIN_DUTY */
+#define EVAL_CONTROL_MS                 (1000U)     /* TEMP_SAMPLE_INTERVAL_MS */
+#define EVAL_PEAK_TOLERANCE_C           (0.1f)      /* The table limit-cycles around a threshold by about this */
+#define EVAL_CRITICAL_TOLERANCE_S       (1.0f)      /* One control period: a trimmed rack meets a load step up to
+                                                     * the margin warmer, and gives the trim back a sample later */
+static float const gs_threshold[4] = { 30.0f, 40.0f, 50.0f, 55.0f };
+static uint8_t const gs_duty[THERMAL_POLICY_LEVELS] = { 0, 25, 50, 75, 100 };
+
+/* Run Result */
+typedef struct {
+    double energy_kj;
+    float peak_c;
+    float above_critical_s;
+    double trim_sum;
+    uint32_t decisions;
+} eval_result_t;
+
+/* Global Variables */
+static uint32_t gs_settle_ms = EVAL_SETTLE_MS;
+static uint8_t gs_trim_step = EVAL_STEP_DUTY;
+static float gs_margin_c = EVAL_MARGIN_C;
+
+/**
+ * @brief pwm_control_update() without the fail-safe and autotune branches
+ */
+static uint8_t control_duty(thermal_trend_t const *p_trend, fan_energy_trim_t *p_trim, float reading,
+                            uint32_t *p_trim_out)
+{
+    uint8_t level = thermal_policy_level(gs_threshold, reading);
+    uint8_t table = thermal_policy_duty(gs_duty, level);
+    uint8_t duty = table;
+    uint8_t floor_duty = table;
+    uint8_t trim = 0U;
+
+    if ((level < 4U) && (p_trend->slope >= EVAL_MIN_SLOPE_C_PER_S))
+    {
+        float time_to_cross = thermal_trend_time_to_reach(p_trend, gs_threshold[level]);
+
+        duty = (uint8_t)(duty + thermal_policy_feedforward(gs_duty, level, time_to_cross, EVAL_HORIZON_S));
+    }
+
+    if (NULL != p_trim)
+    {
+        if ((level > 0U) && (level < 4U))
+        {
+            floor_duty = thermal_policy_duty(gs_duty, (uint8_t)(level - 1U));
+            floor_duty = (floor_duty < EVAL_MIN_DUTY) ? EVAL_MIN_DUTY : floor_duty;
+        }
+        trim = fan_energy_trim_update(p_trim, level, table, floor_duty,
+                                      (reading <= (gs_threshold[(level > 3U) ? 3U : level] - gs_margin_c)) &&
+                                      (p_trend->slope < EVAL_MIN_SLOPE_C_PER_S),
+                                      EVAL_CONTROL_MS);
+    }
+    *p_trim_out = trim;
+    return (uint8_t)(duty - trim);
+}
+
+/**
+ * @brief One trace with or without the trim
+ */
+static void eval_run(rack_trace_t const *p_trace, bool trimmed, eval_result_t *p_result)
+{
+    rack_model_t model;
+    thermal_trend_t trend;
+    fan_energy_trim_t trim;
+    float next_control_s = 0.0f;
+    uint8_t duty = 50U;
+
+    rack_model_init(&model, rack_trace_load(p_trace, 0.0f));
+    thermal_trend_init(&trend);
+    fan_energy_trim_init(&trim, gs_settle_ms, gs_trim_step);
+    *p_result = (eval_result_t){ .peak_c = model.temp };
+
+    for (float t = 0.0f; t < RACK_TRACE_END_S; t += RACK_MODEL_STEP_S)
+    {
+        if (t >= next_control_s)
+        {
+            float reading = rack_model_reading(&model);
+            uint32_t trim_duty;
+
+            thermal_trend_update(&trend, reading, (float)EVAL_CONTROL_MS / 1000.0f);
+            duty = control_duty(&trend, trimmed ? &trim : NULL, reading, &trim_duty);
+            p_result->trim_sum += trim_duty;
+            p_result->decisions++;
+            next_control_s += (float)EVAL_CONTROL_MS / 1000.0f;
+        }
+
+        p_result->energy_kj += rack_model_step(&model, rack_trace_load(p_trace, t), duty) *
+                               RACK_MODEL_STEP_S / 1000.0;
+        p_result->peak_c = (model.temp > p_result->peak_c) ? model.temp : p_result->peak_c;
+        p_result->above_critical_s += (model.temp >= EVAL_CRITICAL_C) ? RACK_MODEL_STEP_S : 0.0f;
+    }
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-S settle_ms] [-t trim_step] [-m margin_c]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    double base_total = 0.0;
+    double trim_total = 0.0;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "S:t:m:")))
+    {
+        switch (opt)
+        {
+            case 'S':
+                gs_settle_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 't':
+                gs_trim_step = (uint8_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'm':
+                gs_margin_c = strtof(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == gs_settle_ms) || (0U == gs_trim_step) || (gs_trim_step > 50U) || !(gs_margin_c >= 0.0f))
+    {
+        usage(argv[0]);
+    }
+
+    printf("settle %u ms, step %u%%, margin %.1f C, floor max(lower level, %u%%)\n", gs_settle_ms, gs_trim_step,
+           (double)gs_margin_c, EVAL_MIN_DUTY);
+    printf("%-12s %-8s %10s %8s %8s %7s\n", "trace", "trim", "energy kJ", "peak C", ">crit s", "trim %");
+    for (uint32_t i = 0; i < RACK_TRACE_COUNT; i++)
+    {
+        eval_result_t base;
+        eval_result_t trimmed;
+        bool ok;
+
+        eval_run(&gs_rack_traces[i], false, &base);
+        eval_run(&gs_rack_traces[i], true, &trimmed);
+        ok = (trimmed.energy_kj <= base.energy_kj) && (trimmed.peak_c <= (base.peak_c + EVAL_PEAK_TOLERANCE_C)) &&
+             (trimmed.above_critical_s <= (base.above_critical_s + EVAL_CRITICAL_TOLERANCE_S));
+        pass = pass && ok;
+        base_total += base.energy_kj;
+        trim_total += trimmed.energy_kj;
+
+        printf("%-12s %-8s %10.1f %8.2f %8.1f %7.2f\n", gs_rack_traces[i].p_name, "off", base.energy_kj,
+               (double)base.peak_c, (double)base.above_critical_s, 0.0);
+        printf("%-12s %-8s %10.1f %8.2f %8.1f %7.2f  %s  energy %+.1f%%, peak %+.2f C\n", "", "on",
+               trimmed.energy_kj, (double)trimmed.peak_c, (double)trimmed.above_critical_s,
+               trimmed.trim_sum / (double)trimmed.decisions, ok ? "PASS" : "FAIL",
+               100.0 * ((trimmed.energy_kj / base.energy_kj) - 1.0), (double)(trimmed.peak_c - base.peak_c));
+    }
+    printf("all traces: energy %+.1f%%\n", 100.0 * ((trim_total / base_total) - 1.0));
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,323 @@
+/***********************************************************************************************************************
+ * File Name    : fan_phase_sim.c
+ * Description  : Host Stand-in - intake/exhaust PWM through src/gpt_timer.c on a model of two GPT saw-wave
+ *                counters, reporting combined supply current and airflow balance
+ *
+ * Both timers are opened, the exhaust counter preset with set_timer_phase_offset(), started back to back (with
+ * an optional start skew in counts) and given their duties with set_timer_duty_cycle(), as fan_control_init()
+ * and fan_apply_duty() do. The model then counts one PWM period: GTIOCB is high while the counter is below the
+ * duty compare. Each fan draws its rated current while its output is high (switched 2-wire drive,
+ * FAN_RATED_POWER_MW at SIM_SUPPLY_MV), so the supply sees the sum of the two pulse trains.
+ *
+ * For every commanded duty 0-100% the exhaust duty follows the firmware's ratio rule (FAN_EXHAUST_RATIO_PCT
+ * below EMERGENCY), and the period is run in phase and at FAN_PHASE_OFFSET_PCT:
+ *
+ *   peak mA   highest combined current over the period
+ *   rms mA    combined RMS current (what the supply's ripple and the wiring loss see)
+ *   overlap % part of the period both fans draw at the offset
+ *   floor %   least overlap any offset gets, max(0, intake + exhaust - 100)
+ *   in/out    intake over exhaust airflow (flow ~ fan speed ~ duty); above 1 is positive rack pressure
+ *
+ * A fixed offset only reaches the floor while intake <= offset and exhaust <= 100 - offset; above that the
+ * pulses overlap by the excess even when the duties would still fit side by side.
+ *
+ *   cc -O2 -I include -I../../src -o fan_phase_sim fan_phase_sim.c ../../src/gpt_timer.c -lm
+ *   fan_phase_sim [-k start_skew_counts] [-v]
+ *
+ * Exit status 1 if the offset raises the peak or RMS anywhere, the modelled overlap differs from the one the
+ * offset should give by more than the start skew, or the exhaust outruns the intake below EMERGENCY.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "common_utils.h"
+#include "fan_energy.h"
+#include "gpt_timer.h"
+#include "main_application.h"
+#include "system_config.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * SIMULATION CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_PERIOD_COUNTS               (100000U)   /* PCLKD 100 MHz / PWM_FREQUENCY_HZ */
+#define SIM_SUPPLY_MV                   (12000U)
+#define SIM_FAN_ON_MA                   ((FAN_RATED_POWER_MW * 1000U) / SIM_SUPPLY_MV)
+#define SIM_FAN_COUNT                   (2U)
+
+/* GPT model - one channel per fan */
+typedef struct {
+    bool open;
+    bool running;
+    uint32_t counter;
+    uint32_t duty_counts;
+} sim_gpt_t;
+
+/* Period Result */
+typedef struct {
+    uint32_t peak_ma;
+    double rms_ma;
+    double overlap_pct;
+} sim_result_t;
+
+/* FSP instances the firmware touches */
+timer_ctrl_t g_timer_pwm_led1_ctrl;
+const timer_cfg_t g_timer_pwm_led1_cfg = { .channel = 1U, .period_counts = SIM_PERIOD_COUNTS };
+timer_ctrl_t g_timer_pwm_led2_ctrl;
+const timer_cfg_t g_timer_pwm_led2_cfg = { .channel = 3U, .period_counts = SIM_PERIOD_COUNTS };
+
+static sim_gpt_t gs_gpt[SIM_FAN_COUNT];
+static timer_ctrl_t * const gs_fan_ctrl[SIM_FAN_COUNT] = { &g_timer_pwm_led1_ctrl, &g_timer_pwm_led2_ctrl };
+static timer_cfg_t const * const gs_fan_cfg[SIM_FAN_COUNT] = { &g_timer_pwm_led1_cfg, &g_timer_pwm_led2_cfg };
+static uint32_t gs_start_skew = 0U;
+static bool gs_verbose = false;
+
+static sim_gpt_t *sim_gpt(timer_ctrl_t const *p_ctrl)
+{
+    return (p_ctrl == &g_timer_pwm_led1_ctrl) ? &gs_gpt[0] : &gs_gpt[1];
+}
+
+fsp_err_t R_GPT_Open(timer_ctrl_t * const p_ctrl, timer_cfg_t const * const p_cfg)
+{
+    sim_gpt_t *p_gpt = sim_gpt(p_ctrl);
+
+    if (p_gpt->open || (SIM_PERIOD_COUNTS != p_cfg->period_counts))
+    {
+        return FSP_ERR_IN_USE;
+    }
+    *p_gpt = (sim_gpt_t){ .open = true };
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_Start(timer_ctrl_t * const p_ctrl)
+{
+    sim_gpt_t *p_gpt = sim_gpt(p_ctrl);
+
+    if (!p_gpt->open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+    p_gpt->running = true;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_InfoGet(timer_ctrl_t * const p_ctrl, timer_info_t * const p_info)
+{
+    if (!sim_gpt(p_ctrl)->open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+    *p_info = (timer_info_t){ TIMER_DIRECTION_UP, 100000000U, SIM_PERIOD_COUNTS };
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_DutyCycleSet(timer_ctrl_t * const p_ctrl, uint32_t const duty_cycle_counts, uint32_t const pin)
+{
+    sim_gpt_t *p_gpt = sim_gpt(p_ctrl);
+
+    if (!p_gpt->open || (GPT_IO_PIN_GTIOCB != pin) || (duty_cycle_counts > SIM_PERIOD_COUNTS))
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+    p_gpt->duty_counts = duty_cycle_counts;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_PeriodSet(timer_ctrl_t * const p_ctrl, uint32_t const period_counts)
+{
+    /* One fixed period in this model */
+    return (sim_gpt(p_ctrl)->open && (SIM_PERIOD_COUNTS == period_counts)) ? FSP_SUCCESS : FSP_ERR_INVALID_ARGUMENT;
+}
+
+fsp_err_t R_GPT_CounterSet(timer_ctrl_t * const p_ctrl, uint32_t counter)
+{
+    sim_gpt_t *p_gpt = sim_gpt(p_ctrl);
+
+    /* GTCNT is only writable while the count is stopped */
+    if (!p_gpt->open || p_gpt->running || (counter >= SIM_PERIOD_COUNTS))
+    {
+        return FSP_ERR_INVALID_STATE;
+    }
+    p_gpt->counter = counter;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_Close(timer_ctrl_t * const p_ctrl)
+{
+    sim_gpt(p_ctrl)->open = false;
+    return FSP_SUCCESS;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/**
+ * @brief fan_duty_for() - exhaust at the ratio below EMERGENCY
+ */
+static uint8_t sim_exhaust_duty(uint8_t duty)
+{
+    return (duty < PWM_DUTY_CYCLE_EMERGENCY) ? (uint8_t)(((uint16_t)duty * FAN_EXHAUST_RATIO_PCT) / 100U) : duty;
+}
+
+/**
+ * @brief Overlap (%) of [0, a) and [offset, offset + b) on a period of 100
+ */
+static uint32_t sim_expected_overlap(uint32_t a, uint32_t b, uint32_t offset)
+{
+    uint32_t end = offset + b;
+    uint32_t overlap = (a > offset) ? (((end < 100U) ? ((end < a) ? end : a) : a) - offset) : 0U;
+
+    /* Part of the exhaust pulse that wrapped to the next period start */
+    if (end > 100U)
+    {
+        overlap += ((end - 100U) < a) ? (end - 100U) : a;
+    }
+    return overlap;
+}
+
+/**
+ * @brief fan_control_init() + fan_apply_duty() with one phase offset, then one PWM period on the model
+ */
+static bool sim_run(uint8_t duty, uint8_t phase_pct, sim_result_t *p_result)
+{
+    uint8_t const fan_duty[SIM_FAN_COUNT] = { duty, sim_exhaust_duty(duty) };
+    double sum_sq = 0.0;
+    uint32_t overlap = 0U;
+    fsp_err_t err = FSP_SUCCESS;
+
+    memset(gs_gpt, 0, sizeof(gs_gpt));
+    for (uint32_t fan = 0U; (FSP_SUCCESS == err) && (fan < SIM_FAN_COUNT); fan++)
+    {
+        err = init_gpt_timer(gs_fan_ctrl[fan], gs_fan_cfg[fan]);
+        if ((FSP_SUCCESS == err) && (1U == fan))
+        {
+            err = set_timer_phase_offset(phase_pct, gs_fan_ctrl[fan]);
+        }
+    }
+    for (uint32_t fan = 0U; (FSP_SUCCESS == err) && (fan < SIM_FAN_COUNT); fan++)
+    {
+        err = start_gpt_timer(gs_fan_ctrl[fan]);
+    }
+    for (uint32_t fan = 0U; (FSP_SUCCESS == err) && (fan < SIM_FAN_COUNT); fan++)
+    {
+        err = set_timer_duty_cycle(fan_duty[fan], gs_fan_ctrl[fan]);
+    }
+    if (FSP_SUCCESS != err)
+    {
+        printf("duty %3u%%: gpt_timer.c returned %d\n", duty, (int)err);
+        return false;
+    }
+
+    /* The exhaust starts a few counts late - its counter lags by the skew */
+    gs_gpt[1].counter = (gs_gpt[1].counter + SIM_PERIOD_COUNTS - (gs_start_skew % SIM_PERIOD_COUNTS)) %
+                        SIM_PERIOD_COUNTS;
+
+    *p_result = (sim_result_t){ 0 };
+    for (uint32_t count = 0U; count < SIM_PERIOD_COUNTS; count++)
+    {
+        uint32_t on = 0U;
+
+        for (uint32_t fan = 0U; fan < SIM_FAN_COUNT; fan++)
+        {
+            on += (gs_gpt[fan].counter < gs_gpt[fan].duty_counts) ? 1U : 0U;
+            gs_gpt[fan].counter = (gs_gpt[fan].counter + 1U) % SIM_PERIOD_COUNTS;
+        }
+        p_result->peak_ma = ((on * SIM_FAN_ON_MA) > p_result->peak_ma) ? (on * SIM_FAN_ON_MA) : p_result->peak_ma;
+        sum_sq += (double)(on * SIM_FAN_ON_MA) * (double)(on * SIM_FAN_ON_MA);
+        overlap += (SIM_FAN_COUNT == on) ? 1U : 0U;
+    }
+    p_result->rms_ma = sqrt(sum_sq / SIM_PERIOD_COUNTS);
+    p_result->overlap_pct = (100.0 * overlap) / SIM_PERIOD_COUNTS;
+
+    for (uint32_t fan = 0U; fan < SIM_FAN_COUNT; fan++)
+    {
+        deinit_gpt_timer(gs_fan_ctrl[fan]);
+    }
+    return true;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-k start_skew_counts] [-v]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    double worst_excess = 0.0;
+    float min_balance = INFINITY;
+    uint32_t one_fan_peak_to = 0U;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "k:v")))
+    {
+        switch (opt)
+        {
+            case 'k':
+                gs_start_skew = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'v':
+                gs_verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (gs_start_skew >= SIM_PERIOD_COUNTS)
+    {
+        usage(argv[0]);
+    }
+
+    printf("fan on-current %u mA, exhaust ratio %u%%, offset %u%%, start skew %u counts of %u\n", SIM_FAN_ON_MA,
+           FAN_EXHAUST_RATIO_PCT, FAN_PHASE_OFFSET_PCT, gs_start_skew, SIM_PERIOD_COUNTS);
+    printf("%5s %5s | %-20s | %-20s | %7s %7s %s\n", "in %", "out %", "in phase  peak/rms", "offset  peak/rms",
+           "overlap", "floor", "in/out");
+    for (uint32_t duty = 0U; duty <= 100U; duty++)
+    {
+        uint8_t const exhaust = sim_exhaust_duty((uint8_t)duty);
+        uint32_t const floor_pct = ((duty + exhaust) > 100U) ? (duty + exhaust - 100U) : 0U;
+        uint32_t const expected_pct = sim_expected_overlap(duty, exhaust, FAN_PHASE_OFFSET_PCT);
+        float const balance = (0U != exhaust) ? ((float)duty / (float)exhaust) : INFINITY;
+        sim_result_t in_phase;
+        sim_result_t offset;
+        bool ok;
+
+        if (!sim_run((uint8_t)duty, 0U, &in_phase) || !sim_run((uint8_t)duty, FAN_PHASE_OFFSET_PCT, &offset))
+        {
+            return 1;
+        }
+
+        /* The offset can only move pulses apart; a start skew moves the exhaust pulse by the skew at most */
+        ok = (offset.peak_ma <= in_phase.peak_ma) && (offset.rms_ma <= (in_phase.rms_ma + 1e-9)) &&
+             (fabs(offset.overlap_pct - expected_pct) <= (((100.0 * gs_start_skew) / SIM_PERIOD_COUNTS) + 1e-9)) &&
+             ((duty >= PWM_DUTY_CYCLE_EMERGENCY) || (0U == exhaust) || (balance > 1.0f));
+        pass = pass && ok;
+        worst_excess = ((offset.overlap_pct - floor_pct) > worst_excess) ? (offset.overlap_pct - floor_pct) :
+                       worst_excess;
+        one_fan_peak_to = ((offset.peak_ma <= SIM_FAN_ON_MA) && (one_fan_peak_to + 1U == duty)) ? duty :
+                          one_fan_peak_to;
+        min_balance = ((0U != exhaust) && (duty < PWM_DUTY_CYCLE_EMERGENCY) && (balance < min_balance)) ? balance :
+                      min_balance;
+
+        if (gs_verbose || !ok || (0U == (duty % 25U)) || (0U == ((duty + exhaust) % 100U)))
+        {
+            printf("%5u %5u | %8u %10.0f  | %8u %10.0f  | %6.1f%% %6u%% %6.3f  %s\n", duty, exhaust,
+                   in_phase.peak_ma, in_phase.rms_ma, offset.peak_ma, offset.rms_ma, offset.overlap_pct, floor_pct,
+                   (double)balance, ok ? "PASS" : "FAIL");
+        }
+    }
+    printf("peak stays at one fan up to intake %u%%, most overlap above floor %.1f%%, min in/out airflow %.3f\n",
+           one_fan_peak_to, worst_excess, (double)min_balance);
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,562 @@
+/***********************************************************************************************************************
+ * File Name    : fast_boot_sim.c
+ * Description  : Host Simulation - the fast-boot path of src/main_application.c on the virtual timebase
+ *
+ * main_application() runs unmodified from reset, built with TIMEBASE_VIRTUAL: boot_state.c stamps its stages on
+ * the virtual clock, and the 1 ms loop moves it by waiting for its deadlines. The fan PWM goes through
+ * src/gpt_timer.c to a GPT model; everything slower is a stand-in that charges a nominal time (not the datasheet's)
+ * when it is called - data flash configuration, the OTA boot record, the shutdown comparator, ADC calibration,
+ * the oversampler filling at the scan rate, and the BLE stack bring-up, which blocks.
+ *
+ * Every scenario is a reset in a forked child. A warm one first plays the previous run through the firmware's own
+ * boot_state_restore()/boot_state_save(), so the record in retained RAM is what that run left behind; a power-on
+ * starts from an empty record. The child stops at the watchdog refresh once 2 x FAST_BOOT_BLE_DEFER_MAX_MS have
+ * passed and sends its stage times back.
+ *
+ *   PWM us        boot_state_begin() to the safe (or restored) duty on the fan pins, against FAST_BOOT_PWM_BUDGET_US
+ *   duty          the first duty the intake GPT was given
+ *   sample us     first decimated temperature
+ *   decision us   first control decision (or the fail-safe), against FAST_BOOT_DECISION_BUDGET_MS
+ *   BLE us        ble_app_init() - after the decision, or at FAST_BOOT_BLE_DEFER_MAX_MS without one
+ *
+ *   cc -O2 -DTIMEBASE_VIRTUAL=1 -Wno-pointer-to-int-cast -I include -I../../src \
+ *      -o fast_boot_sim fast_boot_sim.c ../../src/main_application.c ../../src/boot_state.c ../../src/timebase.c \
+ *      ../../src/timebase_virtual.c ../../src/gpt_timer.c ../../src/thermal_config.c ../../src/thermal_trend.c \
+ *      ../../src/thermal_policy.c ../../src/thermal_anomaly.c ../../src/thermal_stats.c ../../src/adaptive_sampling.c \
+ *      ../../src/telemetry_report.c ../../src/fan_energy.c ../../src/autotune.c -lm
+ *   fast_boot_sim [-b ble_init_ms] [-s scan_hz]
+ *
+ * Exit status 1 if the fans miss their budget or start at the wrong duty, the retained state is not (or wrongly)
+ * restored, the first decision is late, or BLE comes up ahead of it or misses its deadline.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "autotune_store.h"
+#include "boot_state.h"
+#include "common_utils.h"
+#include "main_application.h"
+#include "sensor_fault.h"
+#include "system_config.h"
+#include "telemetry_transport.h"
+#include "timebase.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * SIMULATION CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_PERIOD_COUNTS               (100000U)   /* PCLKD 100 MHz / PWM_FREQUENCY_HZ */
+#define SIM_LOOP_US                     (1000U)     /* BLE_PUMP_LOOP_PERIOD_US */
+#define SIM_RUN_US                      (2000U * FAST_BOOT_BLE_DEFER_MAX_MS)
+#define SIM_OVERSAMPLE_SCANS            (16U)       /* TEMP_OVERSAMPLE_RATIO */
+#define SIM_DEFAULT_BLE_INIT_MS         (300U)      /* Stack open, GATT database, advertising start */
+#define SIM_DEFAULT_SCAN_HZ             (1000U)
+
+/* Nominal stand-in times (µs) */
+#define SIM_IWDT_OPEN_US                (5U)
+#define SIM_GPT_OPEN_US                 (20U)
+#define SIM_GPT_CALL_US                 (2U)
+#define SIM_CONFIG_LOAD_US              (400U)      /* Data flash open and record scan */
+#define SIM_OTA_CHECK_US                (300U)      /* Boot record read */
+#define SIM_SHUTDOWN_INIT_US            (200U)      /* Comparator window, ELC link, POEG */
+#define SIM_ADC_INIT_US                 (1500U)     /* ADC open and calibration */
+
+/* Probe at boot */
+typedef enum {
+    SIM_PROBE_OK,
+    SIM_PROBE_SILENT,           /* Scan never completes - the oversampler stays empty */
+    SIM_PROBE_OPEN              /* Reads at VREF - the plausibility layer flags it on the first scan */
+} sim_probe_t;
+
+/* Scenario */
+typedef struct {
+    char const *p_name;
+    bool warm;                  /* Previous run left a record in retained RAM */
+    uint8_t level;              /* Its cooling level and duty */
+    uint8_t duty;
+    float rack_c;
+    sim_probe_t probe;
+    uint8_t expect_duty;        /* First duty on the fan pins */
+} sim_scenario_t;
+
+/* Result - sent from the child */
+typedef struct {
+    boot_timing_t timing;
+    int64_t first_duty_us;      /* First intake duty set, -1 for none */
+    uint8_t first_duty;
+    uint8_t final_duty;
+    int64_t ble_init_us;        /* ble_app_init() call, -1 for none */
+} sim_result_t;
+
+static sim_scenario_t const gs_scenarios[] = {
+    { "power-on, 35 C",             false, 0U, 0U,   35.0f, SIM_PROBE_OK,     FAST_BOOT_SAFE_DUTY     },
+    { "warm from 100%, 57 C",       true,  4U, 100U, 57.0f, SIM_PROBE_OK,     PWM_DUTY_CYCLE_EMERGENCY },
+    { "warm from off, 25 C",        true,  0U, 0U,   25.0f, SIM_PROBE_OK,     FAST_BOOT_SAFE_DUTY     },
+    { "power-on, ADC silent",       false, 0U, 0U,   35.0f, SIM_PROBE_SILENT, FAST_BOOT_SAFE_DUTY     },
+    { "warm, probe open",           true,  1U, 25U,  35.0f, SIM_PROBE_OPEN,   FAST_BOOT_SAFE_DUTY     },
+};
+
+/* FSP instances the firmware touches */
+timer_ctrl_t g_timer_pwm_led1_ctrl;
+timer_cfg_t g_timer_pwm_led1_cfg = { .channel = 1U, .period_counts = SIM_PERIOD_COUNTS };
+timer_ctrl_t g_timer_pwm_led2_ctrl;
+timer_cfg_t g_timer_pwm_led2_cfg = { .channel = 3U, .period_counts = SIM_PERIOD_COUNTS };
+wdt_ctrl_t g_wdt0_ctrl;
+const wdt_cfg_t g_wdt0_cfg = { .timeout = 4369066U };
+flash_ctrl_t g_flash0_ctrl;
+const flash_cfg_t g_flash0_cfg = { .data_flash_bgo = false };
+ioport_ctrl_t g_ioport_ctrl;
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+uint32_t SystemCoreClock = 200000000U;
+
+/* Global Variables */
+static sim_scenario_t const *gs_sc;
+static sim_result_t gs_result;
+static int gs_result_fd = -1;
+static uint64_t gs_adc_ready_us;        /* Oversampler's first decimated reading, UINT64_MAX for never */
+static uint32_t gs_ble_init_ms = SIM_DEFAULT_BLE_INIT_MS;
+static uint32_t gs_scan_hz = SIM_DEFAULT_SCAN_HZ;
+
+static void sim_spend(uint32_t us)
+{
+    timebase_virtual_advance(us);
+}
+
+/* General PWM Timer - only the intake duty is tracked */
+fsp_err_t R_GPT_Open(timer_ctrl_t * const p_ctrl, timer_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    sim_spend(SIM_GPT_OPEN_US);
+    if (p_ctrl->open)
+    {
+        return FSP_ERR_ALREADY_OPEN;
+    }
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_Start(timer_ctrl_t * const p_ctrl)
+{
+    sim_spend(SIM_GPT_CALL_US);
+    return p_ctrl->open ? FSP_SUCCESS : FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_GPT_InfoGet(timer_ctrl_t * const p_ctrl, timer_info_t * const p_info)
+{
+    *p_info = (timer_info_t){ TIMER_DIRECTION_UP, 100000000U, SIM_PERIOD_COUNTS };
+    return p_ctrl->open ? FSP_SUCCESS : FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_GPT_DutyCycleSet(timer_ctrl_t * const p_ctrl, uint32_t const duty_cycle_counts, uint32_t const pin)
+{
+    uint8_t duty = (uint8_t)((duty_cycle_counts * 100U) / SIM_PERIOD_COUNTS);
+
+    (void)pin;
+    sim_spend(SIM_GPT_CALL_US);
+    if (!p_ctrl->open)
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+    if (&g_timer_pwm_led1_ctrl == p_ctrl)
+    {
+        if (gs_result.first_duty_us < 0)
+        {
+            gs_result.first_duty_us = (int64_t)timebase_now_us();
+            gs_result.first_duty = duty;
+        }
+        gs_result.final_duty = duty;
+    }
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_GPT_PeriodSet(timer_ctrl_t * const p_ctrl, uint32_t const period_counts)
+{
+    (void)period_counts;
+    return p_ctrl->open ? FSP_SUCCESS : FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_GPT_CounterSet(timer_ctrl_t * const p_ctrl, uint32_t counter)
+{
+    (void)counter;
+    return p_ctrl->open ? FSP_SUCCESS : FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_GPT_Close(timer_ctrl_t * const p_ctrl)
+{
+    p_ctrl->open = 0U;
+    return FSP_SUCCESS;
+}
+
+/* Data flash reads as erased - thermal_config_init() falls back to the build defaults */
+fsp_err_t R_FLASH_HP_Open(flash_ctrl_t * const p_ctrl, flash_cfg_t const * const p_cfg)
+{
+    (void)p_ctrl;
+    (void)p_cfg;
+    sim_spend(SIM_CONFIG_LOAD_US);
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Write(flash_ctrl_t * const p_ctrl, uint32_t const src_address, uint32_t flash_address,
+                           uint32_t const num_bytes)
+{
+    (void)p_ctrl;
+    (void)src_address;
+    (void)flash_address;
+    (void)num_bytes;
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Erase(flash_ctrl_t * const p_ctrl, uint32_t const address, uint32_t const num_blocks)
+{
+    (void)p_ctrl;
+    (void)address;
+    (void)num_blocks;
+    return FSP_ERR_NOT_OPEN;
+}
+
+/* Commissioning button released (active low) */
+fsp_err_t R_IOPORT_PinCfg(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, uint32_t cfg)
+{
+    (void)p_ctrl;
+    (void)pin;
+    (void)cfg;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_IOPORT_PinRead(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, bsp_io_level_t * p_pin_value)
+{
+    (void)p_ctrl;
+    (void)pin;
+    *p_pin_value = BSP_IO_LEVEL_HIGH;
+    return FSP_SUCCESS;
+}
+
+/* Watchdog - the refresh ends the run once the boot window has passed */
+fsp_err_t R_IWDT_Open(wdt_ctrl_t * const p_ctrl, wdt_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    sim_spend(SIM_IWDT_OPEN_US);
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_IWDT_Refresh(wdt_ctrl_t * const p_ctrl)
+{
+    (void)p_ctrl;
+    if (timebase_now_us() >= SIM_RUN_US)
+    {
+        gs_result.timing = *boot_state_get_timing();
+        _exit((sizeof(gs_result) == write(gs_result_fd, &gs_result, sizeof(gs_result))) ? 0 : 1);
+    }
+    return FSP_SUCCESS;
+}
+
+/* Temperature sensor (ADC, oversampler, plausibility) */
+fsp_err_t temp_sensor_adc_init(void)
+{
+    uint64_t fill_us = (1000000ULL * SIM_OVERSAMPLE_SCANS) / gs_scan_hz;
+
+    sim_spend(SIM_ADC_INIT_US);
+    gs_adc_ready_us = (SIM_PROBE_SILENT == gs_sc->probe) ? UINT64_MAX : (timebase_now_us() + fill_us);
+    return FSP_SUCCESS;
+}
+
+fsp_err_t temp_sensor_read_adc(float *p_temperature)
+{
+    if (timebase_now_us() < gs_adc_ready_us)
+    {
+        return FSP_ERR_UNDERFLOW;
+    }
+    *p_temperature = gs_sc->rack_c;
+    return (SIM_PROBE_OPEN == gs_sc->probe) ? FSP_ERR_INVALID_DATA : FSP_SUCCESS;
+}
+
+void temp_sensor_service(void)
+{
+}
+
+uint32_t temp_sensor_get_faults(void)
+{
+    bool scanned = (0U != gs_adc_ready_us) && (timebase_now_us() >= (gs_adc_ready_us - (1000000U / gs_scan_hz)));
+
+    return ((SIM_PROBE_OPEN == gs_sc->probe) && scanned) ? SENSOR_FAULT_RAIL_HIGH : SENSOR_FAULT_NONE;
+}
+
+uint32_t temp_sensor_get_fault_timestamp(void)
+{
+    return 0U;
+}
+
+/* Hardware shutdown path */
+fsp_err_t thermal_shutdown_init(void)
+{
+    sim_spend(SIM_SHUTDOWN_INIT_US);
+    return FSP_SUCCESS;
+}
+
+void thermal_shutdown_trip(void)
+{
+}
+
+bool thermal_shutdown_is_tripped(void)
+{
+    return false;
+}
+
+/* OTA - no image on trial */
+void ble_ota_init(void)
+{
+}
+
+void ble_ota_boot_check(void)
+{
+    sim_spend(SIM_OTA_CHECK_US);
+}
+
+void ble_ota_confirm(void)
+{
+}
+
+/* BLE - the stack bring-up blocks; nothing connects during the boot window */
+void ble_app_init(void)
+{
+    gs_result.ble_init_us = (int64_t)timebase_now_us();
+    sim_spend(gs_ble_init_ms * 1000U);
+}
+
+bool ble_app_run(uint32_t budget_cycles)
+{
+    (void)budget_cycles;
+    return false;
+}
+
+bool ble_take_status_subscriber(void)
+{
+    return false;
+}
+
+bool ble_take_autotune_command(uint8_t *p_cmd)
+{
+    (void)p_cmd;
+    return false;
+}
+
+void ble_publish_thermal_stats(uint8_t status)
+{
+    (void)status;
+}
+
+void ble_publish_autotune(uint8_t const *p_data, uint16_t len)
+{
+    (void)p_data;
+    (void)len;
+}
+
+void ble_update_adv_status(int16_t temperature, uint8_t cooling_level, uint8_t duty, uint8_t alert)
+{
+    (void)temperature;
+    (void)cooling_level;
+    (void)duty;
+    (void)alert;
+}
+
+fsp_err_t telemetry_transport_open(uint32_t cycles_per_ms, uint32_t now)
+{
+    (void)cycles_per_ms;
+    (void)now;
+    return FSP_SUCCESS;
+}
+
+bool telemetry_transport_send(telemetry_channel_t channel, uint8_t const *p_data, uint16_t len)
+{
+    (void)channel;
+    (void)p_data;
+    (void)len;
+    return true;
+}
+
+void telemetry_transport_service(uint32_t now)
+{
+    (void)now;
+}
+
+/* No stored autotune result */
+bool autotune_store_load(autotune_record_t *p_record)
+{
+    (void)p_record;
+    return false;
+}
+
+fsp_err_t autotune_store_save(autotune_t const *p_tune)
+{
+    (void)p_tune;
+    return FSP_SUCCESS;
+}
+
+/* Logging */
+void tlog_init(void)
+{
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+uint32_t tlog_flush(void)
+{
+    return 0U;
+}
+
+/**
+ * @brief Boot one scenario from reset in a child process
+ */
+static void sim_run(sim_scenario_t const *p_sc, sim_result_t *p_result)
+{
+    int fds[2];
+    pid_t pid;
+    int status = 0;
+
+    if (0 != pipe(fds))
+    {
+        perror("pipe");
+        exit(2);
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        exit(2);
+    }
+    if (0 == pid)
+    {
+        close(fds[0]);
+        gs_sc = p_sc;
+        gs_result_fd = fds[1];
+        gs_result = (sim_result_t){ .first_duty_us = -1, .ble_init_us = -1 };
+
+        /* The previous run: a power-on record, then its cooling state saved every iteration */
+        if (p_sc->warm)
+        {
+            boot_retained_t previous;
+
+            (void)boot_state_restore(&previous);
+            boot_state_save(p_sc->level, p_sc->duty, 0U);
+        }
+
+        alarm(10U);
+        main_application();
+        _exit(1);
+    }
+    close(fds[1]);
+    if (sizeof(*p_result) != read(fds[0], p_result, sizeof(*p_result)))
+    {
+        fprintf(stderr, "%s: child failed\n", p_sc->p_name);
+        exit(2);
+    }
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+}
+
+/**
+ * @brief Verdict for one scenario
+ */
+static bool sim_judge(sim_scenario_t const *p_sc, sim_result_t const *p_result)
+{
+    boot_timing_t const *p_t = &p_result->timing;
+    uint32_t decision_us = p_t->stage_us[BOOT_STAGE_FIRST_DECISION];
+    bool decided = (0U != (p_t->reached & (1U << BOOT_STAGE_FIRST_DECISION)));
+    bool ok;
+
+    /* Fans first, at the safe duty or the restored one above it */
+    ok = (0U != (p_t->reached & (1U << BOOT_STAGE_PWM))) &&
+         (p_t->stage_us[BOOT_STAGE_PWM] <= FAST_BOOT_PWM_BUDGET_US) && (p_result->first_duty_us >= 0) &&
+         (p_result->first_duty_us <= (int64_t)FAST_BOOT_PWM_BUDGET_US) && (p_result->first_duty == p_sc->expect_duty);
+
+    /* The record from the previous run, and only from one */
+    ok = ok && (p_t->restored == p_sc->warm) && (p_t->boot_count == (p_sc->warm ? 1U : 0U));
+
+    /* BLE must have come up - after the decision, or at the deadline when none is possible */
+    ok = ok && (0U != (p_t->reached & (1U << BOOT_STAGE_BLE_UP))) && (p_result->ble_init_us >= 0);
+    if (SIM_PROBE_SILENT == p_sc->probe)
+    {
+        ok = ok && !decided && (p_result->ble_init_us >= (int64_t)(FAST_BOOT_BLE_DEFER_MAX_MS * 1000U)) &&
+             (p_result->ble_init_us <= (int64_t)((FAST_BOOT_BLE_DEFER_MAX_MS * 1000U) + SIM_LOOP_US));
+    }
+    else
+    {
+        ok = ok && decided && (decision_us <= (FAST_BOOT_DECISION_BUDGET_MS * 1000U)) &&
+             (p_result->ble_init_us >= (int64_t)decision_us);
+    }
+
+    /* A probe that reads open leaves the fail-safe in charge */
+    if (SIM_PROBE_OPEN == p_sc->probe)
+    {
+        ok = ok && (PWM_DUTY_CYCLE_EMERGENCY == p_result->final_duty);
+    }
+    return ok;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-b ble_init_ms] [-s scan_hz]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "b:s:")))
+    {
+        switch (opt)
+        {
+            case 'b':
+                gs_ble_init_ms = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                gs_scan_hz = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((gs_scan_hz < 100U) || (gs_scan_hz > 1000000U) || (gs_ble_init_ms > FAST_BOOT_BLE_DEFER_MAX_MS))
+    {
+        usage(argv[0]);
+    }
+
+    printf("budgets: PWM %u us, decision %u ms, BLE by %u ms; BLE init %u ms, ADC %u Hz x %u scans\n",
+           FAST_BOOT_PWM_BUDGET_US, FAST_BOOT_DECISION_BUDGET_MS, FAST_BOOT_BLE_DEFER_MAX_MS, gs_ble_init_ms,
+           gs_scan_hz, SIM_OVERSAMPLE_SCANS);
+    printf("%-22s | %-8s | %6s %4s | %9s %11s %8s | %4s\n", "scenario", "boot", "PWM us", "duty", "sample us",
+           "decision us", "BLE us", "end");
+    for (uint32_t s = 0U; s < (sizeof(gs_scenarios) / sizeof(gs_scenarios[0])); s++)
+    {
+        sim_scenario_t const *p_sc = &gs_scenarios[s];
+        sim_result_t result;
+        bool ok;
+
+        sim_run(p_sc, &result);
+        ok = sim_judge(p_sc, &result);
+        pass = pass && ok;
+
+        printf("%-22s | %-4s #%-2lu | %6lu %3u%% | %9lu %11lu %8lld | %3u%%  %s\n", p_sc->p_name,
+               result.timing.restored ? "warm" : "cold", (unsigned long)result.timing.boot_count,
+               (unsigned long)result.timing.stage_us[BOOT_STAGE_PWM], result.first_duty,
+               (unsigned long)result.timing.stage_us[BOOT_STAGE_FIRST_SAMPLE],
+               (unsigned long)result.timing.stage_us[BOOT_STAGE_FIRST_DECISION], (long long)result.ble_init_us,
+               result.final_duty, ok ? "PASS" : "FAIL");
+    }
+
+    return pass ? 0 : 1;
+}
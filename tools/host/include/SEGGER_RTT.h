@@ -0,0 +1,11 @@
+/***********************************************************************************************************************
+ * File Name    : SEGGER_RTT.h
+ * Description  : Host Stand-in - the RTT calls the firmware makes; the harness defines them
+ **********************************************************************************************************************/
+
+#ifndef SEGGER_RTT_H_
+#define SEGGER_RTT_H_
+
+unsigned SEGGER_RTT_Write(unsigned BufferIndex, const void * pBuffer, unsigned NumBytes);
+
+#endif /* SEGGER_RTT_H_ */
@@ -0,0 +1,17 @@
+/***********************************************************************************************************************
+ * File Name    : common_utils.h
+ * Description  : Host Stand-in - common_utils.h without the RTT/APP_PRINT plumbing
+ **********************************************************************************************************************/
+
+#ifndef COMMON_UTILS_H_
+#define COMMON_UTILS_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+#define RESET_VALUE             (0x00)
+
+#endif /* COMMON_UTILS_H_ */
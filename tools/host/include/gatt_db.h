@@ -0,0 +1,18 @@
+/***********************************************************************************************************************
+ * File Name    : gatt_db.h
+ * Description  : Host Stand-in - the GATT database the QE for BLE tool generates (handles are in ble_app.h)
+ **********************************************************************************************************************/
+
+#ifndef GATT_DB_H_
+#define GATT_DB_H_
+
+#include "r_ble_api.h"
+
+typedef struct
+{
+    uint16_t attr_count;
+} st_ble_gatts_db_cfg_t;
+
+extern st_ble_gatts_db_cfg_t g_gatt_db_table;
+
+#endif /* GATT_DB_H_ */
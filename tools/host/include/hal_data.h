@@ -0,0 +1,255 @@
+/***********************************************************************************************************************
+ * File Name    : hal_data.h
+ * Description  : Host Stand-in - the slice of the FSP-generated hal_data.h the host harnesses compile against
+ *
+ * Types, constants and prototypes only, with FSP names and shapes; each harness defines the driver functions
+ * and instances the module under test calls, modelling the hardware it needs. Grow it by what a new harness
+ * links, not by the FSP API.
+ **********************************************************************************************************************/
+
+#ifndef HAL_DATA_H_
+#define HAL_DATA_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+/* Common */
+typedef enum e_fsp_err
+{
+    FSP_SUCCESS                 = 0,
+    FSP_ERR_ASSERTION           = 1,
+    FSP_ERR_INVALID_POINTER     = 2,
+    FSP_ERR_INVALID_ARGUMENT    = 3,
+    FSP_ERR_NOT_OPEN            = 6,
+    FSP_ERR_ALREADY_OPEN        = 7,
+    FSP_ERR_UNSUPPORTED         = 8,
+    FSP_ERR_INVALID_SIZE        = 11,
+    FSP_ERR_INVALID_ADDRESS     = 12,
+    FSP_ERR_IN_USE              = 16,
+    FSP_ERR_UNDERFLOW           = 17,
+    FSP_ERR_INVALID_STATE       = 20,
+    FSP_ERR_NOT_FOUND           = 23,
+    FSP_ERR_INVALID_DATA        = 33,
+    FSP_ERR_ABORTED             = 34,
+    FSP_ERR_WRITE_FAILED        = 40,
+    FSP_ERR_ERASE_FAILED        = 41,
+    FSP_ERR_TIMEOUT             = 46,
+} fsp_err_t;
+
+#define FSP_PARAMETER_NOT_USED(p)       (void)(p)
+#define FSP_CRITICAL_SECTION_DEFINE
+#define FSP_CRITICAL_SECTION_ENTER
+#define FSP_CRITICAL_SECTION_EXIT
+#define BSP_PLACE_IN_SECTION(x)         __attribute__((section(x)))
+
+/* Core (DWT cycle counter, advanced by the harness) */
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type * DWT;
+extern uint32_t SystemCoreClock;
+
+void NVIC_SystemReset(void) __attribute__((noreturn));
+
+/* Interrupt vectors (ICU event links) */
+typedef int32_t IRQn_Type;
+
+#define FSP_INVALID_VECTOR              ((IRQn_Type)-33)
+
+/* BSP I/O */
+typedef enum e_bsp_io_level
+{
+    BSP_IO_LEVEL_LOW = 0,
+    BSP_IO_LEVEL_HIGH
+} bsp_io_level_t;
+
+typedef uint16_t bsp_io_port_pin_t;
+
+#define BSP_IO_PORT_01_PIN_06           ((bsp_io_port_pin_t)0x0106)
+#define BSP_IO_PORT_01_PIN_07           ((bsp_io_port_pin_t)0x0107)
+
+/* I/O Port */
+typedef struct st_ioport_ctrl
+{
+    uint32_t open;
+} ioport_ctrl_t;
+
+extern ioport_ctrl_t g_ioport_ctrl;
+
+fsp_err_t R_IOPORT_PinWrite(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, bsp_io_level_t level);
+fsp_err_t R_IOPORT_PinRead(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, bsp_io_level_t * p_pin_value);
+fsp_err_t R_IOPORT_PinEventOutputWrite(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin,
+                                       bsp_io_level_t pin_value);
+
+typedef enum e_ioport_cfg_options
+{
+    IOPORT_CFG_PORT_DIRECTION_INPUT = 0x00000000,
+    IOPORT_CFG_PULLUP_ENABLE        = 0x00000010,
+} ioport_cfg_options_t;
+
+fsp_err_t R_IOPORT_PinCfg(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, uint32_t cfg);
+
+/* Independent Watchdog */
+typedef struct st_wdt_ctrl
+{
+    uint32_t open;
+} wdt_ctrl_t;
+
+typedef struct st_wdt_cfg
+{
+    uint32_t timeout;
+} wdt_cfg_t;
+
+extern wdt_ctrl_t g_wdt0_ctrl;
+extern wdt_cfg_t const g_wdt0_cfg;
+
+fsp_err_t R_IWDT_Open(wdt_ctrl_t * const p_ctrl, wdt_cfg_t const * const p_cfg);
+fsp_err_t R_IWDT_Refresh(wdt_ctrl_t * const p_ctrl);
+
+/* ADC */
+typedef enum e_adc_compare_cfg
+{
+    ADC_COMPARE_CFG_EVENT_OUTPUT_OR  = 0,
+    ADC_COMPARE_CFG_A_ENABLE         = 0x10,
+    ADC_COMPARE_CFG_B_ENABLE         = 0x20,
+    ADC_COMPARE_CFG_WINDOW_ENABLE    = 0x40,
+    ADC_COMPARE_CFG_EVENT_OUTPUT_XOR = 0x01,
+    ADC_COMPARE_CFG_EVENT_OUTPUT_AND = 0x02,
+} adc_compare_cfg_t;
+
+typedef struct st_adc_window_cfg
+{
+    uint32_t compare_cfg;
+    uint32_t compare_mask;
+    uint32_t compare_mode_mask;
+    uint32_t compare_b_channel;
+    uint32_t compare_b_mode;
+    uint16_t compare_ref_low;
+    uint16_t compare_ref_high;
+    uint16_t compare_b_ref_low;
+    uint16_t compare_b_ref_high;
+} adc_window_cfg_t;
+
+typedef struct st_adc_extended_cfg
+{
+    IRQn_Type window_a_irq;
+    uint8_t window_a_ipl;
+} adc_extended_cfg_t;
+
+typedef struct st_adc_cfg
+{
+    IRQn_Type scan_end_irq;
+    uint8_t scan_end_ipl;
+    void const * p_extend;
+} adc_cfg_t;
+
+/* Event Link Controller */
+typedef enum e_elc_peripheral
+{
+    ELC_PERIPHERAL_GPT_A   = 0,
+    ELC_PERIPHERAL_ADC0    = 8,
+    ELC_PERIPHERAL_IOPORT1 = 14,
+    ELC_PERIPHERAL_IOPORT2 = 15,
+} elc_peripheral_t;
+
+typedef enum e_elc_event
+{
+    ELC_EVENT_NONE           = 0,
+    ELC_EVENT_ADC0_SCAN_END  = 0x4B,
+    ELC_EVENT_ADC0_WINDOW_A  = 0x4D,
+} elc_event_t;
+
+typedef struct st_elc_ctrl
+{
+    uint32_t open;
+} elc_ctrl_t;
+
+typedef struct st_elc_cfg
+{
+    elc_event_t const * link;
+} elc_cfg_t;
+
+fsp_err_t R_ELC_Open(elc_ctrl_t * const p_ctrl, elc_cfg_t const * const p_cfg);
+fsp_err_t R_ELC_Enable(elc_ctrl_t * const p_ctrl);
+fsp_err_t R_ELC_LinkSet(elc_ctrl_t * const p_ctrl, elc_peripheral_t peripheral, elc_event_t signal);
+fsp_err_t R_ELC_LinkBreak(elc_ctrl_t * const p_ctrl, elc_peripheral_t peripheral);
+
+/* Port Output Enable for GPT */
+typedef struct st_poeg_ctrl
+{
+    uint32_t open;
+} poeg_ctrl_t;
+
+typedef struct st_poeg_cfg
+{
+    uint32_t channel;
+} poeg_cfg_t;
+
+fsp_err_t R_POEG_Open(poeg_ctrl_t * const p_ctrl, poeg_cfg_t const * const p_cfg);
+fsp_err_t R_POEG_OutputDisable(poeg_ctrl_t * const p_ctrl);
+
+/* Flash (r_flash_hp) */
+typedef struct st_flash_ctrl
+{
+    uint32_t open;
+} flash_ctrl_t;
+
+typedef struct st_flash_cfg
+{
+    bool data_flash_bgo;
+} flash_cfg_t;
+
+fsp_err_t R_FLASH_HP_Open(flash_ctrl_t * const p_ctrl, flash_cfg_t const * const p_cfg);
+fsp_err_t R_FLASH_HP_Write(flash_ctrl_t * const p_ctrl, uint32_t const src_address, uint32_t flash_address,
+                           uint32_t const num_bytes);
+fsp_err_t R_FLASH_HP_Erase(flash_ctrl_t * const p_ctrl, uint32_t const address, uint32_t const num_blocks);
+fsp_err_t R_FLASH_HP_BankSwap(flash_ctrl_t * const p_ctrl);
+
+/* General PWM Timer */
+typedef enum e_timer_direction
+{
+    TIMER_DIRECTION_DOWN = 0,
+    TIMER_DIRECTION_UP   = 1
+} timer_direction_t;
+
+typedef enum e_gpt_io_pin
+{
+    GPT_IO_PIN_GTIOCA            = 0,
+    GPT_IO_PIN_GTIOCB            = 1,
+    GPT_IO_PIN_GTIOCA_AND_GTIOCB = 2,
+} gpt_io_pin_t;
+
+typedef struct st_timer_info
+{
+    timer_direction_t count_direction;
+    uint32_t clock_frequency;
+    uint32_t period_counts;
+} timer_info_t;
+
+typedef struct st_timer_ctrl
+{
+    uint32_t open;
+} timer_ctrl_t;
+
+typedef struct st_timer_cfg
+{
+    uint32_t channel;
+    uint32_t period_counts;
+} timer_cfg_t;
+
+typedef timer_ctrl_t gpt_instance_ctrl_t;
+
+fsp_err_t R_GPT_Open(timer_ctrl_t * const p_ctrl, timer_cfg_t const * const p_cfg);
+fsp_err_t R_GPT_Start(timer_ctrl_t * const p_ctrl);
+fsp_err_t R_GPT_InfoGet(timer_ctrl_t * const p_ctrl, timer_info_t * const p_info);
+fsp_err_t R_GPT_DutyCycleSet(timer_ctrl_t * const p_ctrl, uint32_t const duty_cycle_counts, uint32_t const pin);
+fsp_err_t R_GPT_PeriodSet(timer_ctrl_t * const p_ctrl, uint32_t const period_counts);
+fsp_err_t R_GPT_CounterSet(timer_ctrl_t * const p_ctrl, uint32_t counter);
+fsp_err_t R_GPT_Close(timer_ctrl_t * const p_ctrl);
+
+#endif /* HAL_DATA_H_ */
@@ -0,0 +1,14 @@
+/***********************************************************************************************************************
+ * File Name    : r_ble_servc_if.h
+ * Description  : Host Stand-in - GATT client profile framework calls the application makes
+ **********************************************************************************************************************/
+
+#ifndef R_BLE_SERVC_IF_H_
+#define R_BLE_SERVC_IF_H_
+
+#include "r_ble_api.h"
+
+ble_status_t R_BLE_SERVC_Init(void);
+void R_BLE_SERVC_GattcCb(uint16_t type, ble_status_t result, st_ble_gattc_evt_data_t * p_data);
+
+#endif /* R_BLE_SERVC_IF_H_ */
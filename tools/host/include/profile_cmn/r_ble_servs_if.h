@@ -0,0 +1,24 @@
+/***********************************************************************************************************************
+ * File Name    : r_ble_servs_if.h
+ * Description  : Host Stand-in - GATT server profile framework calls the application makes
+ **********************************************************************************************************************/
+
+#ifndef R_BLE_SERVS_IF_H_
+#define R_BLE_SERVS_IF_H_
+
+#include "r_ble_api.h"
+
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint16_t param_len;
+    void   * p_param;
+} st_ble_servs_evt_data_t;
+
+typedef void (* ble_servs_app_cb_t)(uint16_t type, ble_status_t result, st_ble_servs_evt_data_t * p_data);
+
+ble_status_t R_BLE_SERVS_Init(void);
+void R_BLE_SERVS_VsCb(uint16_t type, ble_status_t result, st_ble_vs_evt_data_t * p_data);
+ble_status_t R_BLE_QC_SVCS_Init(ble_servs_app_cb_t cb);
+
+#endif /* R_BLE_SERVS_IF_H_ */
@@ -0,0 +1,239 @@
+/***********************************************************************************************************************
+ * File Name    : r_ble_api.h
+ * Description  : Host Stand-in - the slice of the FSP BLE host stack API src/ble_app.c compiles against
+ *
+ * Event codes, event parameter structures and the R_BLE_* calls the application makes, with FSP names and
+ * shapes. Values are not the stack's; the harness defines the calls and raises the events.
+ **********************************************************************************************************************/
+
+#ifndef R_BLE_API_H_
+#define R_BLE_API_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "hal_data.h"
+
+/* Status */
+typedef uint16_t ble_status_t;
+
+#define BLE_SUCCESS                                 (0x0000)
+#define BLE_ERR_INVALID_ARG                         (0x0003)
+#define BLE_ERR_INVALID_STATE                       (0x0008)
+#define BLE_ERR_INVALID_OPERATION                   (0x0009)
+#define BLE_ERR_MEM_ALLOC_FAILED                    (0x000C)
+#define BLE_ERR_INVALID_HDL                         (0x000E)
+
+/* GAP */
+#define BLE_GAP_INVALID_CONN_HDL                    (0xFFFF)
+#define BLE_BD_ADDR_LEN                             (6)
+#define BLE_GAP_ADDR_PUBLIC                         (0x00)
+#define BLE_GAP_ADDR_RAND                           (0x01)
+#define BLE_GAP_ADV_CH_37                           (0x01)
+#define BLE_GAP_ADV_CH_38                           (0x02)
+#define BLE_GAP_ADV_CH_39                           (0x04)
+#define BLE_GAP_ADV_DATA_MODE                       (0x00)
+#define BLE_GAP_SCAN_RSP_DATA_MODE                  (0x01)
+#define BLE_GAP_SCAN_ACTIVE                         (0x01)
+#define BLE_GAP_SCAN_FILT_DUPLIC_DISABLE            (0x00)
+#define BLE_GAP_ADV_RPT_TYPE_LEGACY                 (0x00)
+#define BLE_GAP_CONN_UPD_MODE_RSP                   (0x02)
+#define BLE_GAP_CONN_UPD_ACCEPT                     (0x0000)
+#define BLE_VS_ADDR_AREA_REG                        (0x01)
+
+/* GATT Server database operations */
+#define BLE_GATTS_OP_CHAR_PEER_READ_REQ             (0x01)
+#define BLE_GATTS_OP_CHAR_PEER_WRITE_REQ            (0x02)
+#define BLE_GATTS_OP_CHAR_PEER_WRITE_CMD            (0x03)
+#define BLE_GATTS_OP_CHAR_PEER_CLI_CNFG_WRITE_REQ   (0x13)
+
+/* Events */
+enum
+{
+    BLE_GAP_EVENT_STACK_ON = 0x0001,
+    BLE_GAP_EVENT_ADV_OFF,
+    BLE_GAP_EVENT_ADV_REPT_IND,
+    BLE_GAP_EVENT_CONN_IND,
+    BLE_GAP_EVENT_DISCONN_IND,
+    BLE_GAP_EVENT_CONN_PARAM_UPD_REQ,
+};
+
+enum
+{
+    BLE_GATTS_EVENT_DB_ACCESS_IND = 0x3042,
+    BLE_GATTS_EVENT_HDL_VAL_CNF,
+    BLE_GATTS_EVENT_EX_MTU_REQ,
+};
+
+enum
+{
+    BLE_VS_EVENT_GET_ADDR_COMP = 0x8008,
+};
+
+/* Common structures */
+typedef struct
+{
+    uint8_t addr[BLE_BD_ADDR_LEN];
+    uint8_t type;
+} st_ble_dev_addr_t;
+
+typedef struct
+{
+    uint8_t * p_value;
+    uint16_t  value_len;
+} st_ble_gatt_value_t;
+
+typedef struct
+{
+    uint16_t            attr_hdl;
+    st_ble_gatt_value_t value;
+} st_ble_gatt_hdl_value_pair_t;
+
+typedef struct
+{
+    uint8_t * p_buf_start;
+    uint16_t  buffer_len;
+    void    * p_queue;
+    uint8_t   queue_size;
+} st_ble_gatt_pre_queue_t;
+
+typedef struct
+{
+    uint16_t attr_hdl;
+    uint16_t offset;
+} st_ble_gatt_queue_elm_t;
+
+/* GAP event data */
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint16_t param_len;
+    void   * p_param;
+} st_ble_evt_data_t;
+
+typedef struct
+{
+    uint16_t          conn_hdl;
+    uint8_t           role;
+    st_ble_dev_addr_t remote_addr;
+} st_ble_gap_conn_evt_t;
+
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint8_t  reason;
+} st_ble_gap_disconn_evt_t;
+
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint16_t conn_intv_min;
+    uint16_t conn_intv_max;
+    uint16_t conn_latency;
+    uint16_t sup_to;
+} st_ble_gap_conn_upd_req_evt_t;
+
+typedef struct
+{
+    uint16_t conn_intv_min;
+    uint16_t conn_intv_max;
+    uint16_t conn_latency;
+    uint16_t sup_to;
+    uint16_t min_ce_length;
+    uint16_t max_ce_length;
+} st_ble_gap_conn_param_t;
+
+typedef struct
+{
+    uint8_t   adv_type;
+    uint8_t   addr_type;
+    uint8_t * p_addr;
+    uint8_t   len;
+    int8_t    rssi;
+    uint8_t * p_data;
+} st_ble_gap_adv_rpt_t;
+
+typedef struct
+{
+    uint8_t adv_rpt_type;
+    union
+    {
+        st_ble_gap_adv_rpt_t * p_adv_rpt;
+    } param;
+} st_ble_gap_adv_rept_evt_t;
+
+typedef struct
+{
+    uint8_t   adv_hdl;
+    uint8_t   data_type;
+    uint16_t  data_length;
+    uint8_t * p_data;
+    uint8_t   zero_length_flag;
+} st_ble_gap_adv_data_t;
+
+/* GATT Server event data */
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint16_t param_len;
+    void   * p_param;
+} st_ble_gatts_evt_data_t;
+
+typedef struct
+{
+    uint8_t             db_op;
+    uint16_t            attr_hdl;
+    st_ble_gatt_value_t value;
+} st_ble_gatts_db_params_t;
+
+typedef struct
+{
+    st_ble_gatts_db_params_t * p_handle;
+} st_ble_gatts_db_access_evt_t;
+
+typedef struct
+{
+    uint16_t mtu;
+} st_ble_gatts_ex_mtu_req_evt_t;
+
+/* GATT Client / vendor specific event data */
+typedef struct
+{
+    uint16_t conn_hdl;
+    uint16_t param_len;
+    void   * p_param;
+} st_ble_gattc_evt_data_t;
+
+typedef struct
+{
+    uint16_t param_len;
+    void   * p_param;
+} st_ble_vs_evt_data_t;
+
+typedef struct
+{
+    uint8_t           area;
+    st_ble_dev_addr_t addr;
+} st_ble_vs_get_bd_addr_comp_evt_t;
+
+/* Stack */
+ble_status_t R_BLE_Execute(void);
+uint32_t R_BLE_IsTaskFree(void);
+
+/* GAP */
+ble_status_t R_BLE_GAP_Disconnect(uint16_t conn_hdl, uint8_t reason);
+ble_status_t R_BLE_GAP_SetDataLen(uint16_t conn_hdl, uint16_t tx_octets, uint16_t tx_time);
+ble_status_t R_BLE_GAP_UpdConn(uint16_t conn_hdl, uint8_t mode, uint16_t accept,
+                               st_ble_gap_conn_param_t * p_conn_updt_param);
+ble_status_t R_BLE_GAP_SetAdvSresData(st_ble_gap_adv_data_t * p_adv_srsp_data);
+
+/* GATT Server */
+ble_status_t R_BLE_GATTS_SetDbInst(void * p_db_inst);
+ble_status_t R_BLE_GATTS_SetPrepareQueue(st_ble_gatt_pre_queue_t * p_pre_queues, uint8_t queue_num);
+ble_status_t R_BLE_GATTS_Notification(uint16_t conn_hdl, st_ble_gatt_hdl_value_pair_t * p_ntf_data);
+ble_status_t R_BLE_GATTS_SetAttr(uint16_t conn_hdl, uint16_t attr_hdl, st_ble_gatt_value_t * p_value);
+ble_status_t R_BLE_GATTS_RspExMtu(uint16_t conn_hdl, uint16_t mtu);
+
+/* Vendor Specific */
+ble_status_t R_BLE_VS_GetBdAddr(uint8_t area, uint8_t addr_type);
+
+#endif /* R_BLE_API_H_ */
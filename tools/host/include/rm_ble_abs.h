@@ -0,0 +1,14 @@
+/***********************************************************************************************************************
+ * File Name    : rm_ble_abs.h
+ * Description  : Host Stand-in - the BLE abstraction instance the configuration generates
+ **********************************************************************************************************************/
+
+#ifndef RM_BLE_ABS_H_
+#define RM_BLE_ABS_H_
+
+#include "rm_ble_abs_api.h"
+
+extern ble_abs_instance_ctrl_t g_ble_abs0_ctrl;
+extern ble_abs_cfg_t const g_ble_abs0_cfg;
+
+#endif /* RM_BLE_ABS_H_ */
@@ -0,0 +1,79 @@
+/***********************************************************************************************************************
+ * File Name    : rm_ble_abs_api.h
+ * Description  : Host Stand-in - BLE abstraction API types the application fills in; the harness defines the calls
+ **********************************************************************************************************************/
+
+#ifndef RM_BLE_ABS_API_H_
+#define RM_BLE_ABS_API_H_
+
+#include "r_ble_api.h"
+
+#define BLE_ABS_ADVERTISING_FILTER_ALLOW_ANY        (0x00)
+
+typedef struct
+{
+    st_ble_dev_addr_t * p_peer_address;
+    uint32_t            slow_advertising_interval;
+    uint16_t            slow_advertising_period;
+    uint8_t           * p_advertising_data;
+    uint16_t            advertising_data_length;
+    uint8_t           * p_scan_response_data;
+    uint16_t            scan_response_data_length;
+    uint8_t             advertising_filter_policy;
+    uint8_t             advertising_channel_map;
+    uint8_t             own_bluetooth_address_type;
+    uint8_t             own_bluetooth_address[BLE_BD_ADDR_LEN];
+} ble_abs_legacy_advertising_parameter_t;
+
+typedef struct
+{
+    uint16_t fast_scan_interval;
+    uint16_t fast_scan_window;
+    uint16_t slow_scan_interval;
+    uint16_t slow_scan_window;
+    uint8_t  active_scan_enable;
+} ble_abs_scan_phy_parameter_t;
+
+typedef struct
+{
+    ble_abs_scan_phy_parameter_t * p_phy_parameter_1M;
+    ble_abs_scan_phy_parameter_t * p_phy_parameter_coded;
+    uint16_t                       fast_scan_period;
+    uint16_t                       slow_scan_period;
+    uint8_t                      * p_filter_data;
+    uint16_t                       filter_data_length;
+    uint8_t                        filter_ad_type;
+    uint8_t                        device_scan_filter_policy;
+    uint8_t                        filter_duplicate;
+} ble_abs_scan_parameter_t;
+
+typedef struct
+{
+    void (* gatt_server_callback_function)(uint16_t type, ble_status_t result, st_ble_gatts_evt_data_t * p_data);
+    uint8_t gatt_server_callback_priority;
+} ble_abs_gatt_server_callback_set_t;
+
+typedef struct
+{
+    void (* gatt_client_callback_function)(uint16_t type, ble_status_t result, st_ble_gattc_evt_data_t * p_data);
+    uint8_t gatt_client_callback_priority;
+} ble_abs_gatt_client_callback_set_t;
+
+typedef struct
+{
+    uint32_t open;
+} ble_abs_instance_ctrl_t;
+
+typedef struct
+{
+    uint32_t channel;
+} ble_abs_cfg_t;
+
+fsp_err_t RM_BLE_ABS_Open(ble_abs_instance_ctrl_t * const p_ctrl, ble_abs_cfg_t const * const p_cfg);
+fsp_err_t RM_BLE_ABS_Close(ble_abs_instance_ctrl_t * const p_ctrl);
+fsp_err_t RM_BLE_ABS_StartLegacyAdvertising(ble_abs_instance_ctrl_t * const p_ctrl,
+                                            ble_abs_legacy_advertising_parameter_t const * const p_parameter);
+fsp_err_t RM_BLE_ABS_StartScanning(ble_abs_instance_ctrl_t * const p_ctrl,
+                                   ble_abs_scan_parameter_t const * const p_scan_parameter);
+
+#endif /* RM_BLE_ABS_API_H_ */
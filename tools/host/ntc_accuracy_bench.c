@@ -0,0 +1,379 @@
+/***********************************************************************************************************************
+ * File Name    : ntc_accuracy_bench.c
+ * Description  : Host Benchmark - NTC table linearization (src/ntc_thermistor.c, src/ntc_table.c) versus the
+ *                closed-form Beta equation it replaces
+ *
+ * The reference is the equation tools/ntc_table_gen.py builds the table from, in double precision, for the divider
+ * VREF -- R_series -- ADC -- NTC -- GND:
+ *
+ *   R = R_series * x / (1 - x),  x = counts / full scale      1/T = 1/T0 + ln(R/R0) / B
+ *
+ *   accuracy  every 12-bit count, and every 16-bit count with 4 bits of oversampling, inside the rack range
+ *             (0..65 °C) and the whole table range: max and RMS error of ntc_counts_to_centi_celsius()
+ *   inverse   ntc_centi_celsius_to_counts() round trip across the rack range, in counts
+ *   cal       ntc_cal_set()/ntc_cal_apply()/ntc_cal_remove(): limits enforced, apply and remove inverse
+ *   speed     ns per conversion: table, closed form in float (logf, what the firmware would run) and double
+ *
+ * Host times are relative; on a Cortex-M without a log instruction the closed form costs far more than here.
+ *
+ *   cc -O2 -I include -I../../src -o ntc_accuracy_bench ntc_accuracy_bench.c ../../src/ntc_thermistor.c \
+ *      ../../src/ntc_table.c -lm
+ *   ntc_accuracy_bench [-n conversions] [-e max_error_c]
+ *
+ * Exit status 1 if the table error exceeds the limit in the rack range, a round trip is off by more than one
+ * count, a calibration check fails, or the table is not faster than the float closed form.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ntc_thermistor.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * BENCHMARK CONFIGURATION
+ * ================================================================================================================== */
+/* Probe and divider - the header of src/ntc_table.c */
+#define BENCH_BETA                      (3950.0)
+#define BENCH_R0                        (10000.0)
+#define BENCH_T0_C                      (25.0)
+#define BENCH_R_SERIES                  (10000.0)
+#define BENCH_KELVIN                    (273.15)
+#define BENCH_TABLE_MIN_C               (-55.0)
+#define BENCH_TABLE_MAX_C               (150.0)
+
+#define BENCH_RACK_MIN_C                (0.0)
+#define BENCH_RACK_MAX_C                (65.0)
+#define BENCH_DEFAULT_MAX_ERROR_C       (0.05)      /* Rack range; a tenth of the probe's own ±0.5 °C tolerance */
+#define BENCH_OVERSAMPLE_BITS           (4U)        /* TEMP_OVERSAMPLE_MAX_BITS */
+#define BENCH_DEFAULT_CONVERSIONS       (1000000U)
+#define BENCH_SAMPLES                   (4096U)     /* Random counts cycled through by the speed runs */
+
+/* Error over one range */
+typedef struct {
+    double max;
+    double sum_sq;
+    uint32_t n;
+    uint32_t worst_counts;
+} bench_error_t;
+
+/* Global Variables */
+flash_ctrl_t g_flash0_ctrl;
+const flash_cfg_t g_flash0_cfg = { .data_flash_bgo = false };
+
+static uint16_t gs_samples[BENCH_SAMPLES];
+static volatile float gs_sink;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* No data flash on the host: the open fails, so ntc_cal_init() uses the nominal curve without reading it */
+fsp_err_t R_FLASH_HP_Open(flash_ctrl_t * const p_ctrl, flash_cfg_t const * const p_cfg)
+{
+    (void)p_ctrl;
+    (void)p_cfg;
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Write(flash_ctrl_t * const p_ctrl, uint32_t const src_address, uint32_t flash_address,
+                           uint32_t const num_bytes)
+{
+    (void)p_ctrl;
+    (void)src_address;
+    (void)flash_address;
+    (void)num_bytes;
+    return FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_FLASH_HP_Erase(flash_ctrl_t * const p_ctrl, uint32_t const address, uint32_t const num_blocks)
+{
+    (void)p_ctrl;
+    (void)address;
+    (void)num_blocks;
+    return FSP_ERR_NOT_OPEN;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/* ==================================================================================================================
+ * REFERENCE
+ * ================================================================================================================== */
+/**
+ * @brief Closed-form temperature (°C) for fractional 12-bit counts, clamped to the table range
+ */
+static double closed_form(double counts)
+{
+    double x = counts / 4096.0;
+    double t;
+
+    if (x <= 0.0)
+    {
+        return BENCH_TABLE_MAX_C;
+    }
+    if (x >= 1.0)
+    {
+        return BENCH_TABLE_MIN_C;
+    }
+    t = 1.0 / ((1.0 / (BENCH_T0_C + BENCH_KELVIN)) + (log((BENCH_R_SERIES * x / (1.0 - x)) / BENCH_R0) / BENCH_BETA));
+    t -= BENCH_KELVIN;
+    return (t < BENCH_TABLE_MIN_C) ? BENCH_TABLE_MIN_C : ((t > BENCH_TABLE_MAX_C) ? BENCH_TABLE_MAX_C : t);
+}
+
+/* The same equation in float, as the firmware would evaluate it per sample */
+static float closed_form_float(uint32_t counts)
+{
+    float x = (float)counts * (1.0f / 4096.0f);
+    float r = (float)BENCH_R_SERIES * x / (1.0f - x);
+
+    return (1.0f / ((1.0f / (float)(BENCH_T0_C + BENCH_KELVIN)) + (logf(r / (float)BENCH_R0) / (float)BENCH_BETA))) -
+           (float)BENCH_KELVIN;
+}
+
+/* ==================================================================================================================
+ * CHECKS
+ * ================================================================================================================== */
+static void error_add(bench_error_t *p_err, double err, uint32_t counts)
+{
+    err = fabs(err);
+    if (err > p_err->max)
+    {
+        p_err->max = err;
+        p_err->worst_counts = counts;
+    }
+    p_err->sum_sq += err * err;
+    p_err->n++;
+}
+
+/**
+ * @brief Table error for every count at one resolution
+ */
+static void bench_accuracy(uint8_t extra_bits, bench_error_t *p_rack, bench_error_t *p_full)
+{
+    uint32_t full_scale = 4096U << extra_bits;
+
+    for (uint32_t counts = 1U; counts < full_scale; counts++)
+    {
+        double exact = closed_form((double)counts / (double)(1U << extra_bits));
+        double err = ((double)ntc_counts_to_centi_celsius(counts, extra_bits) / 100.0) - exact;
+
+        if ((exact > BENCH_TABLE_MIN_C) && (exact < BENCH_TABLE_MAX_C))
+        {
+            error_add(p_full, err, counts);
+        }
+        if ((exact >= BENCH_RACK_MIN_C) && (exact <= BENCH_RACK_MAX_C))
+        {
+            error_add(p_rack, err, counts);
+        }
+    }
+}
+
+static bool report_accuracy(char const *p_name, bench_error_t const *p_rack, bench_error_t const *p_full,
+                            double max_error_c)
+{
+    bool ok = (p_rack->n > 0U) && (p_rack->max <= max_error_c);
+
+    printf("%-22s | rack max %.4f rms %.4f °C (%6u counts, worst at %u) | table max %.4f °C  %s\n", p_name,
+           p_rack->max, sqrt(p_rack->sum_sq / p_rack->n), p_rack->n, p_rack->worst_counts, p_full->max,
+           ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+/**
+ * @brief Round trip through the inverse across the rack range, in counts
+ */
+static bool bench_inverse(void)
+{
+    uint32_t worst = 0U;
+    int32_t worst_centi = 0;
+
+    for (int32_t centi = (int32_t)(BENCH_RACK_MIN_C * 100.0); centi <= (int32_t)(BENCH_RACK_MAX_C * 100.0); centi++)
+    {
+        double exact = 4096.0;
+        double low = 0.0;
+        double high = 4096.0;
+        uint32_t diff;
+
+        /* Exact counts for the temperature - bisect the closed form, which falls with counts */
+        for (uint32_t i = 0U; i < 60U; i++)
+        {
+            exact = (low + high) / 2.0;
+            if (closed_form(exact) > ((double)centi / 100.0))
+            {
+                low = exact;
+            }
+            else
+            {
+                high = exact;
+            }
+        }
+        diff = (uint32_t)fabs((double)ntc_centi_celsius_to_counts(centi) - exact);
+        if (diff > worst)
+        {
+            worst = diff;
+            worst_centi = centi;
+        }
+    }
+
+    printf("%-22s | max %u counts off the exact inverse (at %.2f °C)  %s\n", "inverse round trip", worst,
+           (double)worst_centi / 100.0, (worst <= 1U) ? "PASS" : "FAIL");
+    return (worst <= 1U);
+}
+
+/**
+ * @brief Calibration limits and the apply/remove pair
+ */
+static bool bench_cal(void)
+{
+    bool ok;
+    float worst = 0.0f;
+
+    ntc_cal_init();
+    ok = (ntc_cal_apply(0U, 42.0f) == 42.0f) && (ntc_cal_remove(1U, 42.0f) == 42.0f);
+    ok = ok && (FSP_ERR_INVALID_ARGUMENT == ntc_cal_set(0U, NTC_CAL_MAX_GAIN + 0.01f, 0.0f)) &&
+         (FSP_ERR_INVALID_ARGUMENT == ntc_cal_set(0U, 1.0f, -NTC_CAL_MAX_OFFSET - 0.1f)) &&
+         (FSP_ERR_INVALID_ARGUMENT == ntc_cal_set(NTC_CAL_MAX_PROBES, 1.0f, 0.0f));
+    ok = ok && (FSP_SUCCESS == ntc_cal_set(0U, 1.03f, -1.2f)) && (FSP_SUCCESS == ntc_cal_set(1U, 0.97f, 0.8f));
+
+    for (float t = (float)BENCH_RACK_MIN_C; t <= (float)BENCH_RACK_MAX_C; t += 0.25f)
+    {
+        for (uint8_t probe = 0U; probe < NTC_CAL_MAX_PROBES; probe++)
+        {
+            float err = fabsf(ntc_cal_remove(probe, ntc_cal_apply(probe, t)) - t);
+
+            worst = (err > worst) ? err : worst;
+        }
+    }
+    ok = ok && (fabsf(ntc_cal_apply(0U, 40.0f) - ((1.03f * 40.0f) - 1.2f)) < 1e-4f) && (worst < 1e-4f);
+    ok = ok && (FSP_ERR_NOT_OPEN == ntc_cal_persist());
+
+    printf("%-22s | limits enforced, apply/remove inverse to %.1e °C, persist needs flash  %s\n", "calibration",
+           (double)worst, ok ? "PASS" : "FAIL");
+    return ok;
+}
+
+/* ==================================================================================================================
+ * SPEED
+ * ================================================================================================================== */
+static double time_table(uint32_t conversions)
+{
+    uint64_t start_ns = now_ns();
+    int32_t acc = 0;
+
+    for (uint32_t i = 0U; i < conversions; i++)
+    {
+        acc += ntc_counts_to_centi_celsius(gs_samples[i % BENCH_SAMPLES], BENCH_OVERSAMPLE_BITS);
+    }
+    gs_sink = (float)acc;
+    return (double)(now_ns() - start_ns) / conversions;
+}
+
+static double time_closed_float(uint32_t conversions)
+{
+    uint64_t start_ns = now_ns();
+    float acc = 0.0f;
+
+    for (uint32_t i = 0U; i < conversions; i++)
+    {
+        acc += closed_form_float(gs_samples[i % BENCH_SAMPLES] >> BENCH_OVERSAMPLE_BITS);
+    }
+    gs_sink = acc;
+    return (double)(now_ns() - start_ns) / conversions;
+}
+
+static double time_closed_double(uint32_t conversions)
+{
+    uint64_t start_ns = now_ns();
+    double acc = 0.0;
+
+    for (uint32_t i = 0U; i < conversions; i++)
+    {
+        acc += closed_form((double)gs_samples[i % BENCH_SAMPLES] / (double)(1U << BENCH_OVERSAMPLE_BITS));
+    }
+    gs_sink = (float)acc;
+    return (double)(now_ns() - start_ns) / conversions;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n conversions] [-e max_error_c]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t conversions = BENCH_DEFAULT_CONVERSIONS;
+    double max_error_c = BENCH_DEFAULT_MAX_ERROR_C;
+    double table_ns;
+    double float_ns;
+    double double_ns;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:e:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                conversions = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'e':
+                max_error_c = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == conversions) || (max_error_c <= 0.0))
+    {
+        usage(argv[0]);
+    }
+
+    printf("Beta %.0f, R0 %.0f ohm, series %.0f ohm; %u-entry table (%zu bytes); rack range %.0f..%.0f °C, "
+           "limit %.3f °C\n", BENCH_BETA, BENCH_R0, BENCH_R_SERIES, NTC_TABLE_ENTRIES, sizeof(g_ntc_table),
+           BENCH_RACK_MIN_C, BENCH_RACK_MAX_C, max_error_c);
+    for (uint8_t extra_bits = 0U; extra_bits <= BENCH_OVERSAMPLE_BITS; extra_bits += BENCH_OVERSAMPLE_BITS)
+    {
+        bench_error_t rack = { 0 };
+        bench_error_t full = { 0 };
+        char name[32];
+
+        bench_accuracy(extra_bits, &rack, &full);
+        snprintf(name, sizeof(name), "table, %u-bit counts", 12U + extra_bits);
+        pass = report_accuracy(name, &rack, &full, max_error_c) && pass;
+    }
+    pass = bench_inverse() && pass;
+    pass = bench_cal() && pass;
+
+    /* Counts across the rack range, 16-bit as the oversampled readings arrive */
+    srand(1U);
+    for (uint32_t i = 0U; i < BENCH_SAMPLES; i++)
+    {
+        uint32_t low = (uint32_t)ntc_centi_celsius_to_counts((int32_t)(BENCH_RACK_MAX_C * 100.0));
+        uint32_t high = (uint32_t)ntc_centi_celsius_to_counts((int32_t)(BENCH_RACK_MIN_C * 100.0));
+
+        gs_samples[i] = (uint16_t)((low + ((uint32_t)rand() % (high - low))) << BENCH_OVERSAMPLE_BITS);
+    }
+    table_ns = time_table(conversions);
+    float_ns = time_closed_float(conversions);
+    double_ns = time_closed_double(conversions);
+    printf("%-22s | table %.1f ns, closed form float %.1f ns (%.1fx), double %.1f ns (%.1fx)  %s\n", "speed",
+           table_ns, float_ns, float_ns / table_ns, double_ns, double_ns / table_ns,
+           (table_ns < float_ns) ? "PASS" : "FAIL");
+    pass = pass && (table_ns < float_ns);
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,813 @@
+/***********************************************************************************************************************
+ * File Name    : ota_flash_sim.c
+ * Description  : Host Simulation - src/ble_ota.c end to end on file-backed dual-bank code flash and data flash
+ *
+ * The flash stand-in keeps both code flash banks, the data flash and the bank select in one file, mapped at the
+ * target addresses: the inactive bank at OTA_BANK_INACTIVE_ADDR and the data flash at 0x08000000, so the module's
+ * direct reads (CRC re-read, boot record) see what its R_FLASH_HP_* calls wrote. Programming unerased bytes,
+ * misaligned or out-of-bank operations count as violations. NVIC_SystemReset() and the watchdog re-enter the boot
+ * path - init, ble_ota_boot_check() - with the banks re-mapped from the file, like a reset does.
+ *
+ * A central streams the image at the MTU: a burst of packets every connection interval, some dropped, resuming
+ * from the sequence the status reports. Each main loop iteration takes the status and calls ble_ota_service()
+ * once, as ble_app_run() does. Every flash operation is charged a nominal time (not the datasheet's), which gives
+ * the longest stall a single call puts on the control loop.
+ *
+ *   update     v2 over v1: erased block by block, streamed, verified, swapped on reset, boots as a trial and
+ *              confirms - no flash work in the callbacks, at most one code flash erase or program per service
+ *              call (the boot record and bank swap, once at the end of the verify, are data flash)
+ *   abort      abort during the erase: no flash work after it
+ *   fault      a programmed unit flips a bit: the running CRC passes, the bank re-read fails, no swap
+ *   torn       power lost while the trial record is programmed: no swap, the torn record fails its CRC and reads
+ *              as no pending update - no trial boot counted, no rollback
+ *   rollback   v3 installed, then hangs before confirming: the watchdog resets it until ble_ota_boot_check()
+ *              swaps back to v2 after OTA_MAX_TRIAL_BOOTS
+ *
+ * The firmware passes buffer addresses as 32-bit integers (R_FLASH_HP_Write), so the harness is built non-PIE
+ * and runs the firmware on a thread whose stack is mapped below 4 GB.
+ *
+ *   cc -O2 -pthread -no-pie -Wno-pointer-to-int-cast -I include -I../../src -o ota_flash_sim ota_flash_sim.c \
+ *      ../../src/ble_ota.c
+ *   ota_flash_sim [-f flash_file] [-s image_size] [-b burst] [-i interval_loops] [-d drop_pct] [-r seed]
+ *
+ * The flash file is left behind for inspection. Exit status 0 if every check passed, 1 on any violation.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "ble_ota.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * SIMULATION CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_DEFAULT_IMAGE_SIZE          (90000U)    /* Padded tail unit; the last 32 KB block is not covered */
+#define SIM_DEFAULT_BURST               (4U)        /* Packets per connection event */
+#define SIM_DEFAULT_INTERVAL_LOOPS      (8U)        /* Connection interval in loop iterations (7.5 ms minimum) */
+#define SIM_DEFAULT_DROP_PCT            (2U)
+#define SIM_DEFAULT_SEED                (1U)
+#define SIM_PACKET_DATA                 (242U)      /* MTU 247 - ATT header 3 - sequence 2 */
+#define SIM_RESEND_EVENTS               (4U)        /* Connection events without completion before resending */
+#define SIM_LOOP_US                     (1000U)     /* BLE_PUMP_LOOP_PERIOD_US */
+#define SIM_MAX_LOOPS                   (100000U)
+#define SIM_HANG_LOOPS                  (50U)       /* A hung image's iterations before the watchdog fires */
+#define SIM_MAX_BOOTS                   (10U)
+#define SIM_IWDT_TIMEOUT_US             (4369066U)  /* 2048 cycles x 32 / 15 kHz - OFS0 in configuration.xml */
+
+/* Flash layout - file offsets and target addresses */
+#define SIM_DATA_FLASH_ADDR             (0x08000000UL)
+#define SIM_DATA_FLASH_SIZE             (4096U)
+#define SIM_DATA_FLASH_BLOCK            (64U)
+#define SIM_DATA_FLASH_UNIT             (4U)
+#define SIM_FILE_DATA_OFFSET            (2U * OTA_BANK_SIZE)
+#define SIM_FILE_OPTION_OFFSET          (SIM_FILE_DATA_OFFSET + SIM_DATA_FLASH_SIZE)
+#define SIM_FILE_SIZE                   (SIM_FILE_OPTION_OFFSET + 4096U)
+#define SIM_SMALL_BLOCKS_END            (OTA_SMALL_BLOCK_COUNT * OTA_SMALL_BLOCK_SIZE)
+#define SIM_STACK_ADDR                  (0x10000000UL)
+#define SIM_STACK_SIZE                  (1024U * 1024U)
+
+/* Nominal operation times (us) - the model's, for the stall comparison only */
+#define SIM_SMALL_ERASE_US              (80000U)
+#define SIM_LARGE_ERASE_US              (300000U)
+#define SIM_PROGRAM_US                  (500U)      /* One 128-byte code flash unit */
+#define SIM_DATA_ERASE_US               (10000U)
+#define SIM_DATA_PROGRAM_US             (500U)
+#define SIM_BANK_SWAP_US                (20000U)
+
+#define SIM_TEAR_BYTES                  (8U)        /* Programmed before the power is cut: magic and state */
+
+/* Boot record - mirrors ota_boot_record_t in ble_ota.c */
+typedef struct {
+    uint32_t magic;
+    uint32_t state;
+    uint32_t boot_attempts;
+    uint32_t image_size;
+    uint32_t image_crc;
+    uint32_t crc;
+} sim_boot_record_t;
+
+/* Flash stand-in */
+typedef struct {
+    int fd;
+    uint32_t active_bank;
+    uint32_t erases;            /* Code flash blocks erased */
+    uint32_t programs;          /* Code flash units programmed */
+    uint32_t swaps;
+    uint32_t violations;
+    uint32_t fault_program;     /* Program operation to corrupt, 0 for none */
+    uint32_t data_programs;     /* Data flash program operations */
+    uint32_t tear_program;      /* Data flash program the power is cut in, 0 for none */
+    uint32_t call_ops;          /* Code flash erases and programs in the current call */
+    uint32_t call_other_ops;    /* Data flash operations and bank swaps in the current call */
+    uint32_t call_us;           /* Nominal time of the current call's flash operations */
+} sim_flash_t;
+
+/* One transfer, as the central and the main loop see it */
+typedef struct {
+    uint8_t const *p_image;
+    uint32_t size;
+    uint32_t crc;
+    uint32_t loops;
+    uint32_t service_calls;
+    uint32_t erase_calls;
+    uint32_t multi_op_calls;    /* Service calls with more than one code flash operation */
+    uint32_t callback_ops;      /* Flash operations inside ble_ota_control()/ble_ota_data() */
+    uint32_t max_call_us;
+    uint32_t dropped;
+    uint32_t busy;
+    uint32_t rewinds;
+    uint32_t resends;
+    uint8_t state;
+    uint8_t error;
+    uint32_t bps;
+} sim_transfer_t;
+
+/* Global Variables */
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+uint32_t SystemCoreClock = 200000000U;
+
+flash_ctrl_t g_flash0_ctrl;
+const flash_cfg_t g_flash0_cfg = { .data_flash_bgo = false };
+
+static sim_flash_t gs_flash;
+static sim_transfer_t gs_xfer;
+static jmp_buf gs_reset;
+static uint32_t gs_resets;
+static uint32_t gs_failures;
+static char const *gs_file = NULL;
+static uint32_t gs_image_size = SIM_DEFAULT_IMAGE_SIZE;
+static uint32_t gs_burst = SIM_DEFAULT_BURST;
+static uint32_t gs_interval = SIM_DEFAULT_INTERVAL_LOOPS;
+static uint32_t gs_drop_pct = SIM_DEFAULT_DROP_PCT;
+
+/* ==================================================================================================================
+ * FLASH STAND-IN
+ * ================================================================================================================== */
+/**
+ * @brief Map the banks as a reset leaves them: the bank not selected appears at OTA_BANK_INACTIVE_ADDR
+ */
+static void sim_power_on(void)
+{
+    void *p_bank;
+
+    if ((ssize_t)sizeof(gs_flash.active_bank) != pread(gs_flash.fd, &gs_flash.active_bank, sizeof(gs_flash.active_bank),
+                                              SIM_FILE_OPTION_OFFSET))
+    {
+        perror("flash file");
+        exit(2);
+    }
+    munmap((void *)OTA_BANK_INACTIVE_ADDR, OTA_BANK_SIZE);
+    p_bank = mmap((void *)OTA_BANK_INACTIVE_ADDR, OTA_BANK_SIZE, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_FIXED_NOREPLACE, gs_flash.fd, (off_t)((1U - gs_flash.active_bank) * OTA_BANK_SIZE));
+    if ((void *)OTA_BANK_INACTIVE_ADDR != p_bank)
+    {
+        perror("map inactive bank");
+        exit(2);
+    }
+}
+
+/**
+ * @brief Host pointer for a flash range (mapped at its target address), checking it lies in one region
+ * @return Pointer, or NULL outside the inactive bank and the data flash
+ */
+static uint8_t *sim_flash_range(uint32_t address, uint32_t len, bool *p_code)
+{
+    *p_code = (address >= OTA_BANK_INACTIVE_ADDR) && ((address + len) <= (OTA_BANK_INACTIVE_ADDR + OTA_BANK_SIZE));
+    if (!*p_code &&
+        ((address < SIM_DATA_FLASH_ADDR) || ((address + len) > (SIM_DATA_FLASH_ADDR + SIM_DATA_FLASH_SIZE))))
+    {
+        return NULL;
+    }
+    return (uint8_t *)(uintptr_t)address;
+}
+
+static fsp_err_t sim_violation(char const *p_what, uint32_t address)
+{
+    printf("  flash violation: %s at 0x%08x\n", p_what, address);
+    gs_flash.violations++;
+    return FSP_ERR_INVALID_ARGUMENT;
+}
+
+fsp_err_t R_FLASH_HP_Open(flash_ctrl_t * const p_ctrl, flash_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+/* Programs only erased bytes, in whole units; one program operation of the fault case flips a bit */
+fsp_err_t R_FLASH_HP_Write(flash_ctrl_t * const p_ctrl, uint32_t const src_address, uint32_t flash_address,
+                           uint32_t const num_bytes)
+{
+    uint8_t const *p_src = (uint8_t const *)(uintptr_t)src_address;
+    bool code;
+    uint8_t *p_dst = sim_flash_range(flash_address, num_bytes, &code);
+    uint32_t unit = code ? OTA_WRITE_UNIT : SIM_DATA_FLASH_UNIT;
+
+    (void)p_ctrl;
+    if (NULL == p_dst)
+    {
+        return sim_violation("program outside the inactive bank and data flash", flash_address);
+    }
+    if ((0U != (flash_address % unit)) || (0U != (num_bytes % unit)))
+    {
+        return sim_violation("program not in whole units", flash_address);
+    }
+    for (uint32_t i = 0U; i < num_bytes; i++)
+    {
+        if (0xFFU != p_dst[i])
+        {
+            return sim_violation("program over unerased bytes", flash_address + i);
+        }
+    }
+
+    memcpy(p_dst, p_src, num_bytes);
+    if (code)
+    {
+        gs_flash.call_ops++;
+        gs_flash.programs++;
+        gs_flash.call_us += SIM_PROGRAM_US * (num_bytes / OTA_WRITE_UNIT);
+        if (gs_flash.programs == gs_flash.fault_program)
+        {
+            p_dst[num_bytes / 2U] ^= 0x10U;
+        }
+    }
+    else
+    {
+        gs_flash.call_other_ops++;
+        gs_flash.call_us += SIM_DATA_PROGRAM_US;
+        gs_flash.data_programs++;
+        if (gs_flash.data_programs == gs_flash.tear_program)
+        {
+            memset(&p_dst[SIM_TEAR_BYTES], 0xFF, num_bytes - SIM_TEAR_BYTES);
+            gs_resets++;
+            longjmp(gs_reset, 1);
+        }
+    }
+    return FSP_SUCCESS;
+}
+
+/* Block-aligned erase: 8 KB blocks in the first 64 KB of a bank, 32 KB above; 64-byte data flash blocks */
+fsp_err_t R_FLASH_HP_Erase(flash_ctrl_t * const p_ctrl, uint32_t const address, uint32_t const num_blocks)
+{
+    uint32_t block = address;
+
+    (void)p_ctrl;
+    for (uint32_t n = 0U; n < num_blocks; n++)
+    {
+        bool code;
+        uint32_t offset = block - OTA_BANK_INACTIVE_ADDR;
+        uint32_t size = (!(block >= OTA_BANK_INACTIVE_ADDR) || (offset < SIM_SMALL_BLOCKS_END)) ?
+                        OTA_SMALL_BLOCK_SIZE : OTA_LARGE_BLOCK_SIZE;
+        uint8_t *p_block;
+
+        size = (block >= SIM_DATA_FLASH_ADDR) ? SIM_DATA_FLASH_BLOCK : size;
+        p_block = sim_flash_range(block, size, &code);
+        if ((NULL == p_block) || (0U != ((code ? offset : (block - SIM_DATA_FLASH_ADDR)) % size)))
+        {
+            return sim_violation("erase not on a block boundary", block);
+        }
+
+        memset(p_block, 0xFF, size);
+        gs_flash.call_ops += code ? 1U : 0U;
+        gs_flash.call_other_ops += code ? 0U : 1U;
+        gs_flash.erases += code ? 1U : 0U;
+        gs_flash.call_us += !code ? SIM_DATA_ERASE_US :
+                            ((OTA_SMALL_BLOCK_SIZE == size) ? SIM_SMALL_ERASE_US : SIM_LARGE_ERASE_US);
+        block += size;
+    }
+    return FSP_SUCCESS;
+}
+
+/* Selects the other bank from the next reset */
+fsp_err_t R_FLASH_HP_BankSwap(flash_ctrl_t * const p_ctrl)
+{
+    uint32_t next = 1U - gs_flash.active_bank;
+
+    (void)p_ctrl;
+    if ((ssize_t)sizeof(next) != pwrite(gs_flash.fd, &next, sizeof(next), SIM_FILE_OPTION_OFFSET))
+    {
+        return FSP_ERR_WRITE_FAILED;
+    }
+    gs_flash.swaps++;
+    gs_flash.call_other_ops++;
+    gs_flash.call_us += SIM_BANK_SWAP_US;
+    return FSP_SUCCESS;
+}
+
+void NVIC_SystemReset(void)
+{
+    gs_resets++;
+    longjmp(gs_reset, 1);
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/* ==================================================================================================================
+ * DEVICE AND CENTRAL
+ * ================================================================================================================== */
+static uint32_t sim_crc32(uint8_t const *p_data, uint32_t len)
+{
+    uint32_t crc = 0xFFFFFFFFUL;
+
+    for (uint32_t i = 0U; i < len; i++)
+    {
+        crc ^= p_data[i];
+        for (uint32_t bit = 0U; bit < 8U; bit++)
+        {
+            crc = (crc & 1U) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+static void sim_image(uint8_t *p_image, uint32_t size, uint32_t version)
+{
+    for (uint32_t i = 0U; i < size; i++)
+    {
+        p_image[i] = (uint8_t)(rand() & 0xFF);
+    }
+    memcpy(p_image, &version, sizeof(version));
+}
+
+static void sim_call_begin(void)
+{
+    gs_flash.call_ops = 0U;
+    gs_flash.call_other_ops = 0U;
+    gs_flash.call_us = 0U;
+}
+
+/* Accounts a call and lets loop time pass - the call's flash time on top of the period */
+static void sim_call_end(bool service)
+{
+    if (service)
+    {
+        gs_xfer.service_calls++;
+        gs_xfer.multi_op_calls += (gs_flash.call_ops > 1U) ? 1U : 0U;
+    }
+    else
+    {
+        gs_xfer.callback_ops += gs_flash.call_ops + gs_flash.call_other_ops;
+    }
+    gs_xfer.max_call_us = (gs_flash.call_us > gs_xfer.max_call_us) ? gs_flash.call_us : gs_xfer.max_call_us;
+    gs_dwt.CYCCNT += ((service ? SIM_LOOP_US : 0U) + gs_flash.call_us) * (SystemCoreClock / 1000000U);
+}
+
+static void sim_service(void)
+{
+    uint32_t erases = gs_flash.erases;
+
+    sim_call_begin();
+    ble_ota_service();
+    gs_xfer.erase_calls += (gs_flash.erases != erases) ? 1U : 0U;
+    sim_call_end(true);
+}
+
+static fsp_err_t sim_control(uint8_t const *p_cmd, uint16_t len)
+{
+    fsp_err_t err;
+
+    sim_call_begin();
+    err = ble_ota_control(p_cmd, len);
+    sim_call_end(false);
+    return err;
+}
+
+static void sim_send(uint32_t seq)
+{
+    uint8_t packet[OTA_DATA_HEADER_LEN + SIM_PACKET_DATA];
+    uint32_t offset = seq * SIM_PACKET_DATA;
+    uint32_t len = ((gs_xfer.size - offset) < SIM_PACKET_DATA) ? (gs_xfer.size - offset) : SIM_PACKET_DATA;
+
+    if ((uint32_t)(rand() % 100) < gs_drop_pct)
+    {
+        gs_xfer.dropped++;
+        return;
+    }
+    packet[0] = (uint8_t)(seq & 0xFFU);
+    packet[1] = (uint8_t)(seq >> 8);
+    memcpy(&packet[OTA_DATA_HEADER_LEN], &gs_xfer.p_image[offset], len);
+
+    sim_call_begin();
+    gs_xfer.busy += (FSP_ERR_IN_USE == ble_ota_data(packet, (uint16_t)(OTA_DATA_HEADER_LEN + len))) ? 1U : 0U;
+    sim_call_end(false);
+}
+
+/**
+ * @brief Device running the transfer: each loop takes the status, lets the central react, services the module.
+ *        Returns on an error or timeout; success ends in the reset into the new bank.
+ */
+static void sim_transfer_app(void)
+{
+    uint32_t packets = (gs_xfer.size + SIM_PACKET_DATA - 1U) / SIM_PACKET_DATA;
+    uint8_t start[OTA_CMD_START_LEN] = { OTA_CMD_START };
+    uint8_t const finish = OTA_CMD_FINISH;
+    bool receiving = false;
+    bool finished = false;
+    uint32_t seq = 0U;
+    uint32_t waited = 0U;
+
+    for (uint32_t i = 0U; i < 4U; i++)
+    {
+        start[1U + i] = (uint8_t)(gs_xfer.size >> (8U * i));
+        start[5U + i] = (uint8_t)(gs_xfer.crc >> (8U * i));
+    }
+    (void)sim_control(start, sizeof(start));
+
+    for (gs_xfer.loops = 0U; gs_xfer.loops < SIM_MAX_LOOPS; gs_xfer.loops++)
+    {
+        uint8_t status[OTA_STATUS_WIRE_SIZE];
+
+        if (ble_ota_take_status(status) > 0U)
+        {
+            uint32_t next = (uint32_t)status[2] | ((uint32_t)status[3] << 8);
+            uint32_t bytes = (uint32_t)status[4] | ((uint32_t)status[5] << 8) | ((uint32_t)status[6] << 16) |
+                             ((uint32_t)status[7] << 24);
+
+            gs_xfer.state = status[0];
+            gs_xfer.error = status[1];
+            gs_xfer.bps = (uint32_t)status[8] | ((uint32_t)status[9] << 8) | ((uint32_t)status[10] << 16) |
+                          ((uint32_t)status[11] << 24);
+            if (OTA_STATE_ERROR == gs_xfer.state)
+            {
+                return;
+            }
+            receiving = (OTA_STATE_RECEIVING == gs_xfer.state);
+            if (receiving && ((OTA_ERROR_SEQUENCE == gs_xfer.error) || (OTA_ERROR_BUSY == gs_xfer.error)))
+            {
+                gs_xfer.rewinds++;
+                seq = next;
+            }
+            if (receiving && !finished && (bytes == gs_xfer.size))
+            {
+                (void)sim_control(&finish, 1U);
+                finished = true;
+            }
+        }
+
+        if (receiving && !finished && (0U == (gs_xfer.loops % gs_interval)))
+        {
+            if (seq >= packets)
+            {
+                /* Everything sent, completion not reported - the last packet may be lost */
+                if (++waited >= SIM_RESEND_EVENTS)
+                {
+                    seq = packets - 1U;
+                    waited = 0U;
+                    gs_xfer.resends++;
+                }
+            }
+            for (uint32_t k = 0U; (k < gs_burst) && (seq < packets); k++, seq++)
+            {
+                sim_send(seq);
+            }
+        }
+
+        sim_service();
+    }
+}
+
+/* Abort a few blocks into the erase, then keep servicing */
+static void sim_abort_app(void)
+{
+    uint8_t start[OTA_CMD_START_LEN] = { OTA_CMD_START, 0x00, 0x00, 0x01, 0x00 };
+    uint8_t const abort_cmd = OTA_CMD_ABORT;
+    uint32_t erases;
+
+    (void)sim_control(start, sizeof(start));
+    sim_service();
+    sim_service();
+    (void)sim_control(&abort_cmd, 1U);
+    erases = gs_flash.erases;
+    for (uint32_t i = 0U; i < 100U; i++)
+    {
+        sim_service();
+    }
+    gs_xfer.erase_calls = gs_flash.erases - erases;
+}
+
+/* A new image that runs - confirms as the firmware does after OTA_CONFIRM_SAMPLES */
+static void sim_good_app(void)
+{
+    ble_ota_confirm();
+}
+
+/* A new image that hangs before confirming - the watchdog resets it */
+static void sim_hung_app(void)
+{
+    for (uint32_t i = 0U; i < SIM_HANG_LOOPS; i++)
+    {
+        gs_dwt.CYCCNT += SIM_LOOP_US * (SystemCoreClock / 1000000U);
+    }
+    gs_resets++;
+    longjmp(gs_reset, 1);
+}
+
+/**
+ * @brief One power-on: boot path, then the application, until it returns or resets
+ * @return true if the run ended in a reset
+ */
+static bool sim_boot(void (*p_app)(void))
+{
+    uint32_t resets = gs_resets;
+
+    if (0 == setjmp(gs_reset))
+    {
+        sim_power_on();
+        ble_ota_init();
+        ble_ota_boot_check();
+        p_app();
+    }
+    return (gs_resets != resets);
+}
+
+/* ==================================================================================================================
+ * CHECKS
+ * ================================================================================================================== */
+static void check(bool ok, char const *p_what)
+{
+    printf("%-72s %s\n", p_what, ok ? "PASS" : "FAIL");
+    gs_failures += ok ? 0U : 1U;
+}
+
+/* Running bank holds the image, padded with erased bytes to the write unit */
+static bool sim_running(uint8_t const *p_image, uint32_t size)
+{
+    static uint8_t bank[OTA_BANK_SIZE];
+    uint32_t padded = ((size + OTA_WRITE_UNIT - 1U) / OTA_WRITE_UNIT) * OTA_WRITE_UNIT;
+    uint32_t active;
+
+    if (((ssize_t)sizeof(active) != pread(gs_flash.fd, &active, sizeof(active), SIM_FILE_OPTION_OFFSET)) ||
+        ((ssize_t)OTA_BANK_SIZE != pread(gs_flash.fd, bank, OTA_BANK_SIZE, (off_t)(active * OTA_BANK_SIZE))))
+    {
+        return false;
+    }
+    for (uint32_t i = size; i < padded; i++)
+    {
+        if (0xFFU != bank[i])
+        {
+            return false;
+        }
+    }
+    return (0 == memcmp(bank, p_image, size));
+}
+
+static sim_boot_record_t sim_record(void)
+{
+    sim_boot_record_t record;
+
+    memcpy(&record, (void const *)OTA_RECORD_FLASH_ADDR, sizeof(record));
+    return record;
+}
+
+static void sim_transfer_begin(uint8_t const *p_image, uint32_t size)
+{
+    memset(&gs_xfer, 0, sizeof(gs_xfer));
+    gs_xfer.p_image = p_image;
+    gs_xfer.size = size;
+    gs_xfer.crc = sim_crc32(p_image, size);
+}
+
+/* Blocks an image of this size covers */
+static uint32_t sim_blocks(uint32_t size)
+{
+    return (size <= SIM_SMALL_BLOCKS_END) ? ((size + OTA_SMALL_BLOCK_SIZE - 1U) / OTA_SMALL_BLOCK_SIZE) :
+           (OTA_SMALL_BLOCK_COUNT + ((size - SIM_SMALL_BLOCKS_END + OTA_LARGE_BLOCK_SIZE - 1U) / OTA_LARGE_BLOCK_SIZE));
+}
+
+static void sim_update(uint8_t const *p_v1, uint32_t v1_size, uint8_t const *p_v2, uint32_t v2_size)
+{
+    uint32_t whole_bank_us = (OTA_SMALL_BLOCK_COUNT * SIM_SMALL_ERASE_US) +
+                             (((OTA_BANK_SIZE - SIM_SMALL_BLOCKS_END) / OTA_LARGE_BLOCK_SIZE) * SIM_LARGE_ERASE_US);
+    bool reset;
+
+    check(!sim_boot(sim_good_app) && sim_running(p_v1, v1_size), "boot: v1 runs, no boot record");
+
+    sim_transfer_begin(p_v2, v2_size);
+    reset = sim_boot(sim_transfer_app);
+    printf("update: %u bytes in %u loops, %u packets dropped, %u queue-full, %u rewinds, %u resends, %.1f KB/s\n",
+           v2_size, gs_xfer.loops, gs_xfer.dropped, gs_xfer.busy, gs_xfer.rewinds, gs_xfer.resends,
+           (double)gs_xfer.bps / 1024.0);
+    printf("        longest call %.1f ms (whole-bank erase in START was %.1f ms), %u service calls\n",
+           (double)gs_xfer.max_call_us / 1000.0, (double)whole_bank_us / 1000.0, gs_xfer.service_calls);
+    check(reset && (OTA_STATE_READY == gs_xfer.state), "update: streamed, verified, reset into the new bank");
+    check(0U == gs_xfer.callback_ops, "update: no flash work in START, data or FINISH");
+    check(0U == gs_xfer.multi_op_calls, "update: at most one code flash erase or program per service call");
+    check(sim_blocks(v2_size) == gs_xfer.erase_calls,
+          "update: erased one block per call, only blocks the image covers");
+    check((gs_xfer.max_call_us <= SIM_LARGE_ERASE_US) && (gs_xfer.max_call_us < SIM_IWDT_TIMEOUT_US),
+          "update: longest stall is one block erase, inside the watchdog timeout");
+
+    check(!sim_boot(sim_good_app) && sim_running(p_v2, v2_size) && (OTA_BOOT_CONFIRMED == sim_record().state),
+          "update: v2 boots from the swapped bank as a trial and confirms");
+}
+
+static void sim_abort(uint8_t const *p_v2, uint32_t v2_size)
+{
+    ota_status_t status;
+
+    memset(&gs_xfer, 0, sizeof(gs_xfer));
+    check(!sim_boot(sim_abort_app) && (0U == gs_xfer.erase_calls) && (0U == gs_xfer.callback_ops),
+          "abort: during the erase, no flash work after it");
+    ble_ota_get_status(&status);
+    check((OTA_STATE_IDLE == status.state) && (OTA_ERROR_ABORTED == status.error) && sim_running(p_v2, v2_size),
+          "abort: idle, v2 still runs");
+}
+
+static void sim_fault(uint8_t const *p_v2, uint32_t v2_size, uint8_t const *p_v4, uint32_t v4_size)
+{
+    uint32_t swaps = gs_flash.swaps;
+
+    sim_transfer_begin(p_v4, v4_size);
+    gs_flash.fault_program = gs_flash.programs + (v4_size / OTA_WRITE_UNIT / 2U) + 1U;   /* Mid-image unit */
+    check(!sim_boot(sim_transfer_app) && (OTA_STATE_ERROR == gs_xfer.state) && (OTA_ERROR_CRC == gs_xfer.error),
+          "fault: bit flipped in flash caught by the re-read (CRC error)");
+    gs_flash.fault_program = 0U;
+    check((swaps == gs_flash.swaps) && sim_running(p_v2, v2_size) && (OTA_BOOT_CONFIRMED == sim_record().state),
+          "fault: no bank swap, v2 still runs confirmed");
+}
+
+static void sim_torn(uint8_t const *p_v2, uint32_t v2_size, uint8_t const *p_v4, uint32_t v4_size)
+{
+    uint32_t swaps = gs_flash.swaps;
+    uint32_t data_programs;
+    sim_boot_record_t record;
+    bool reset;
+
+    sim_transfer_begin(p_v4, v4_size);
+    gs_flash.tear_program = gs_flash.data_programs + 1U;     /* The trial record, after the verify */
+    reset = sim_boot(sim_transfer_app);
+    gs_flash.tear_program = 0U;
+    record = sim_record();
+    check(reset && (swaps == gs_flash.swaps) && (OTA_RECORD_MAGIC == record.magic) &&
+          (OTA_BOOT_TRIAL == record.state) &&
+          (sim_crc32((uint8_t const *)&record, offsetof(sim_boot_record_t, crc)) != record.crc),
+          "torn: power lost mid trial record, bank swap never armed");
+
+    data_programs = gs_flash.data_programs;
+    check(!sim_boot(sim_good_app) && sim_running(p_v2, v2_size) && (data_programs == gs_flash.data_programs),
+          "torn: record fails its CRC - no pending update, v2 runs, nothing counted");
+}
+
+static void sim_rollback(uint8_t const *p_v2, uint32_t v2_size, uint8_t const *p_v3, uint32_t v3_size)
+{
+    uint32_t boots = 0U;
+    bool ok;
+
+    sim_transfer_begin(p_v3, v3_size);
+    ok = sim_boot(sim_transfer_app) && (OTA_STATE_READY == gs_xfer.state) && sim_running(p_v3, v3_size);
+
+    /* v3 hangs every boot; the boot that finds the trial exhausted swaps back and resets */
+    while (sim_running(p_v3, v3_size) && (boots < SIM_MAX_BOOTS))
+    {
+        (void)sim_boot(sim_hung_app);
+        boots++;
+    }
+    printf("rollback: v3 hung %u boots before v2 was back\n", boots - 1U);
+    check(ok && ((OTA_MAX_TRIAL_BOOTS + 1U) == boots), "rollback: v3 installed, hangs, watchdog resets it");
+    check(sim_running(p_v2, v2_size) && (OTA_BOOT_ROLLED_BACK == sim_record().state) && !sim_boot(sim_good_app),
+          "rollback: v2 back after OTA_MAX_TRIAL_BOOTS, stays");
+}
+
+/* ==================================================================================================================
+ * MAIN
+ * ================================================================================================================== */
+/* Fresh flash: v1 in bank 0 (running), bank 1 unerased, data flash erased */
+static void sim_flash_create(uint8_t const *p_v1, uint32_t v1_size)
+{
+    static uint8_t buf[SIM_FILE_SIZE];
+    uint32_t active = 0U;
+
+    memset(buf, 0xFF, sizeof(buf));
+    memcpy(buf, p_v1, v1_size);
+    memset(&buf[OTA_BANK_SIZE], 0x00, OTA_BANK_SIZE);
+    memcpy(&buf[SIM_FILE_OPTION_OFFSET], &active, sizeof(active));
+
+    gs_flash.fd = open(gs_file, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((gs_flash.fd < 0) || ((ssize_t)sizeof(buf) != write(gs_flash.fd, buf, sizeof(buf))) ||
+        ((void *)SIM_DATA_FLASH_ADDR != mmap((void *)SIM_DATA_FLASH_ADDR, SIM_DATA_FLASH_SIZE, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_FIXED_NOREPLACE, gs_flash.fd, SIM_FILE_DATA_OFFSET)))
+    {
+        perror(gs_file);
+        exit(2);
+    }
+}
+
+static void *sim_device(void *p_arg)
+{
+    static uint8_t v1[OTA_BANK_SIZE];
+    static uint8_t v2[OTA_BANK_SIZE];
+    static uint8_t v3[OTA_BANK_SIZE];
+    static uint8_t v4[OTA_BANK_SIZE];
+    uint32_t v1_size = 60000U;
+    uint32_t v3_size = gs_image_size - (gs_image_size / 3U);
+    uint32_t v4_size = (gs_image_size / 2U) + 5U;
+
+    (void)p_arg;
+    sim_image(v1, v1_size, 1U);
+    sim_image(v2, gs_image_size, 2U);
+    sim_image(v3, v3_size, 3U);
+    sim_image(v4, v4_size, 4U);
+    sim_flash_create(v1, v1_size);
+
+    sim_update(v1, v1_size, v2, gs_image_size);
+    sim_abort(v2, gs_image_size);
+    sim_fault(v2, gs_image_size, v4, v4_size);
+    sim_torn(v2, gs_image_size, v4, v4_size);
+    sim_rollback(v2, gs_image_size, v3, v3_size);
+    check(0U == gs_flash.violations, "no program over unerased flash, misaligned or out-of-bank operation");
+    return NULL;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-f flash_file] [-s image_size] [-b burst] [-i interval_loops] [-d drop_pct] "
+            "[-r seed]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static char default_file[256];
+    uint32_t seed = SIM_DEFAULT_SEED;
+    pthread_attr_t attr;
+    pthread_t device;
+    void *p_stack;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "f:s:b:i:d:r:")))
+    {
+        switch (opt)
+        {
+            case 'f':
+                gs_file = optarg;
+                break;
+            case 's':
+                gs_image_size = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'b':
+                gs_burst = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'i':
+                gs_interval = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'd':
+                gs_drop_pct = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                seed = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((gs_image_size < 1024U) || (gs_image_size > OTA_BANK_SIZE) || (0U == gs_burst) || (0U == gs_interval) ||
+        (gs_drop_pct >= 100U))
+    {
+        usage(argv[0]);
+    }
+    if (NULL == gs_file)
+    {
+        snprintf(default_file, sizeof(default_file), "%s/ota_flash_sim.bin",
+                 (NULL != getenv("TMPDIR")) ? getenv("TMPDIR") : "/tmp");
+        gs_file = default_file;
+    }
+
+    /* Statics (non-PIE) and the device stack below 4 GB, so 32-bit buffer addresses survive */
+    p_stack = mmap((void *)SIM_STACK_ADDR, SIM_STACK_SIZE, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (((void *)SIM_STACK_ADDR != p_stack) || ((uintptr_t)&gs_flash > UINT32_MAX))
+    {
+        fprintf(stderr, "needs a non-PIE build and free address space below 4 GB\n");
+        return 2;
+    }
+
+    srand(seed);
+    printf("flash %s, image %u bytes, %u packets of %u every %u loops, %u%% dropped, seed %u\n", gs_file,
+           gs_image_size, gs_burst, SIM_PACKET_DATA, gs_interval, gs_drop_pct, seed);
+    pthread_attr_init(&attr);
+    pthread_attr_setstack(&attr, p_stack, SIM_STACK_SIZE);
+    if (0 != pthread_create(&device, &attr, sim_device, NULL))
+    {
+        perror("pthread_create");
+        return 2;
+    }
+    pthread_join(device, NULL);
+
+    return (0U == gs_failures) ? 0 : 1;
+}
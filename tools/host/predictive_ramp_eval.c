@@ -0,0 +1,169 @@
+/***********************************************************************************************************************
+ * File Name    : predictive_ramp_eval.c
+ * Description  : Host Evaluation - trend-predictive fan ramp versus the reactive level table, closed loop
+ *
+ * The rack model in rack_model.h is driven through each heat-load trace twice. Every control period the policy
+ * takes the probe reading through the firmware's rules - thermal_policy_level()/thermal_policy_duty() for the
+ * table, thermal_trend.c and thermal_policy_feedforward() for the ramp, with the build defaults - and commands
+ * the fans; intake and exhaust power come from fan_energy.c.
+ *
+ *   peak C    highest true rack temperature
+ *   >crit s   time above SYSTEM_CRITICAL_TEMP
+ *   energy kJ fan electrical energy, intake + exhaust
+ *   changes   duty changes commanded
+ *
+ *   cc -O2 -I../../src -o predictive_ramp_eval predictive_ramp_eval.c ../../src/thermal_trend.c \
+ *      ../../src/fan_energy.c -lm
+ *   predictive_ramp_eval [-H horizon_s] [-v]
+ *
+ * Exit status 1 if the ramp raises the peak (beyond the limit-cycle tolerance) or the time above critical on any
+ * trace.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "rack_model.h"
+#include "thermal_policy.h"
+#include "thermal_trend.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+/* Build Defaults - mirror src/main_application.h and src/system_config.h */
+#define EVAL_CRITICAL_C                 (58.0f)     /* SYSTEM_CRITICAL_TEMP */
+#define EVAL_HORIZON_S                  (60.0f)     /* PREDICT_HORIZON_S */
+#define EVAL_MIN_SLOPE_C_PER_S          (0.005f)    /* PREDICT_MIN_SLOPE_C_PER_S */
+#define EVAL_CONTROL_S                  (1.0f)      /* TEMP_SAMPLE_INTERVAL_MS */
+#define EVAL_PEAK_TOLERANCE_C           (0.1f)      /* The table limit-cycles around a threshold by about this */
+static float const gs_threshold[4] = { 30.0f, 40.0f, 50.0f, 55.0f };
+static uint8_t const gs_duty[THERMAL_POLICY_LEVELS] = { 0, 25, 50, 75, 100 };
+
+/* Policy Result */
+typedef struct {
+    float peak_c;
+    float above_critical_s;
+    double energy_kj;
+    uint32_t changes;
+} eval_result_t;
+
+/* Global Variables */
+static float gs_horizon_s = EVAL_HORIZON_S;
+static bool gs_verbose = false;
+
+/**
+ * @brief pwm_control_update() without the fail-safe, energy trim and autotune branches
+ */
+static uint8_t control_duty(thermal_trend_t const *p_trend, float reading, bool predictive)
+{
+    uint8_t level = thermal_policy_level(gs_threshold, reading);
+    uint8_t duty = thermal_policy_duty(gs_duty, level);
+
+    if (predictive && (level < 4U) && (p_trend->slope >= EVAL_MIN_SLOPE_C_PER_S))
+    {
+        float time_to_cross = thermal_trend_time_to_reach(p_trend, gs_threshold[level]);
+
+        duty = (uint8_t)(duty + thermal_policy_feedforward(gs_duty, level, time_to_cross, gs_horizon_s));
+    }
+    return duty;
+}
+
+/**
+ * @brief One trace under one policy
+ */
+static void eval_run(rack_trace_t const *p_trace, bool predictive, eval_result_t *p_result)
+{
+    rack_model_t model;
+    thermal_trend_t trend;
+    float next_control_s = 0.0f;
+    uint8_t duty = 50U;
+
+    rack_model_init(&model, rack_trace_load(p_trace, 0.0f));
+    thermal_trend_init(&trend);
+    *p_result = (eval_result_t){ .peak_c = model.temp };
+
+    for (float t = 0.0f; t < RACK_TRACE_END_S; t += RACK_MODEL_STEP_S)
+    {
+        if (t >= next_control_s)
+        {
+            float reading = rack_model_reading(&model);
+            uint8_t new_duty;
+
+            thermal_trend_update(&trend, reading, EVAL_CONTROL_S);
+            new_duty = control_duty(&trend, reading, predictive);
+            p_result->changes += (new_duty != duty) ? 1U : 0U;
+            duty = new_duty;
+            next_control_s += EVAL_CONTROL_S;
+        }
+
+        p_result->energy_kj += rack_model_step(&model, rack_trace_load(p_trace, t), duty) *
+                               RACK_MODEL_STEP_S / 1000.0;
+        p_result->peak_c = (model.temp > p_result->peak_c) ? model.temp : p_result->peak_c;
+        p_result->above_critical_s += (model.temp >= EVAL_CRITICAL_C) ? RACK_MODEL_STEP_S : 0.0f;
+        if (gs_verbose && (0 == ((uint32_t)(t / RACK_MODEL_STEP_S) % 600U)))
+        {
+            printf("  %-3s t=%5.0f load=%5.0f T=%6.2f probe=%6.2f slope=%+.4f duty=%3u\n", predictive ? "ff" : "tab",
+                   (double)t, (double)rack_trace_load(p_trace, t), (double)model.temp, (double)model.probe,
+                   (double)trend.slope, duty);
+        }
+    }
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-H horizon_s] [-v]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "H:v")))
+    {
+        switch (opt)
+        {
+            case 'H':
+                gs_horizon_s = strtof(optarg, NULL);
+                break;
+            case 'v':
+                gs_verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (!(gs_horizon_s > 0.0f))
+    {
+        usage(argv[0]);
+    }
+
+    printf("horizon %.0f s, control every %.0f s, fan lag %.0f s, probe lag %.0f s\n", (double)gs_horizon_s,
+           (double)EVAL_CONTROL_S, (double)RACK_MODEL_FAN_TAU_S, (double)RACK_MODEL_PROBE_TAU_S);
+    printf("%-12s %-10s %8s %8s %10s %8s\n", "trace", "policy", "peak C", ">crit s", "energy kJ", "changes");
+    for (uint32_t i = 0; i < RACK_TRACE_COUNT; i++)
+    {
+        eval_result_t reactive;
+        eval_result_t predictive;
+        bool ok;
+
+        eval_run(&gs_rack_traces[i], false, &reactive);
+        eval_run(&gs_rack_traces[i], true, &predictive);
+        ok = (predictive.peak_c <= (reactive.peak_c + EVAL_PEAK_TOLERANCE_C)) &&
+             (predictive.above_critical_s <= (reactive.above_critical_s + RACK_MODEL_STEP_S));
+        pass = pass && ok;
+
+        printf("%-12s %-10s %8.2f %8.1f %10.1f %8u\n", gs_rack_traces[i].p_name, "reactive", (double)reactive.peak_c,
+               (double)reactive.above_critical_s, reactive.energy_kj, reactive.changes);
+        printf("%-12s %-10s %8.2f %8.1f %10.1f %8u  %s  peak %+.2f C, energy %+.1f%%\n", "", "predictive",
+               (double)predictive.peak_c, (double)predictive.above_critical_s, predictive.energy_kj,
+               predictive.changes, ok ? "PASS" : "FAIL", (double)(predictive.peak_c - reactive.peak_c),
+               100.0 * ((predictive.energy_kj / reactive.energy_kj) - 1.0));
+    }
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/***********************************************************************************************************************
+ * File Name    : rack_model.h
+ * Description  : Host Rack Model - lumped thermal plant, fans and probe the closed-loop host evaluations run the
+ *                firmware's control rules against, plus the heat-load traces they share
+ *
+ * One thermal mass exchanges heat with the inlet air through a conductance that grows with airflow; the fans follow
+ * their commanded duty with a first-order lag (the exhaust at FAN_EXHAUST_RATIO_PCT below full), and the probe
+ * follows the air with its own lag and Gaussian noise. Header-only: each harness is one translation unit.
+ **********************************************************************************************************************/
+
+#ifndef RACK_MODEL_H_
+#define RACK_MODEL_H_
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "fan_energy.h"
+
+/* Model Parameters */
+#define RACK_MODEL_STEP_S               (0.1f)
+#define RACK_MODEL_AMBIENT_C            (25.0f)     /* Cold-aisle inlet */
+#define RACK_MODEL_CAPACITY_J_PER_C     (60000.0f)  /* Air, chassis and heat sinks of one rack */
+#define RACK_MODEL_G_NATURAL_W_PER_C    (15.0f)     /* Conductance with the fans stopped */
+#define RACK_MODEL_G_AIRFLOW_W_PER_C    (200.0f)    /* Added at full airflow (both fans at 100%) */
+#define RACK_MODEL_FAN_TAU_S            (8.0f)      /* Fan spin-up/down */
+#define RACK_MODEL_PROBE_TAU_S          (5.0f)      /* Probe and its mounting */
+#define RACK_MODEL_PROBE_NOISE_C        (0.05f)
+#define RACK_MODEL_EXHAUST_RATIO_PCT    (90U)       /* FAN_EXHAUST_RATIO_PCT */
+#define RACK_MODEL_SEED                 (0x9E3779B97F4A7C15ULL)
+
+/* Load Trace - piecewise linear heat load (W), the last point holds */
+#define RACK_TRACE_MAX_POINTS           (16U)
+#define RACK_TRACE_END_S                (7200.0f)
+
+typedef struct {
+    char const *p_name;
+    uint32_t points;
+    float t_s[RACK_TRACE_MAX_POINTS];
+    float load_w[RACK_TRACE_MAX_POINTS];
+} rack_trace_t;
+
+static rack_trace_t const gs_rack_traces[] = {
+    { "job start",   4U, { 0, 600, 601, 4200 },                 { 1200, 1200, 5200, 5200 } },
+    { "ramp 30min",  4U, { 0, 600, 2400, 4200 },                { 1200, 1200, 6000, 6000 } },
+    { "batch waves", 9U, { 0, 300, 301, 1200, 1201, 2100, 2101, 3000, 3001 },
+                         { 2000, 2000, 5800, 5800, 2000, 2000, 5800, 5800, 2000 } },
+    { "spikes",      8U, { 0, 900, 901, 1020, 1021, 1800, 1801, 1920 },
+                         { 2500, 2500, 9000, 9000, 2500, 2500, 9000, 9000 } },
+    { "diurnal",     5U, { 0, 1800, 3600, 5400, 7200 },          { 1500, 4500, 6200, 4000, 1500 } },
+};
+#define RACK_TRACE_COUNT                (sizeof(gs_rack_traces) / sizeof(gs_rack_traces[0]))
+
+/* Plant State */
+typedef struct {
+    float temp;                 /* True rack temperature (°C) */
+    float probe;                /* Probe temperature, before noise (°C) */
+    float airflow;              /* Fraction of full airflow */
+    uint8_t exhaust;            /* Exhaust duty for the commanded intake duty (%) */
+    uint64_t rng;
+} rack_model_t;
+
+/**
+ * @brief Heat load of a trace at a time
+ */
+static inline float rack_trace_load(rack_trace_t const *p_trace, float t_s)
+{
+    for (uint32_t i = 1; i < p_trace->points; i++)
+    {
+        if (t_s < p_trace->t_s[i])
+        {
+            float f = (t_s - p_trace->t_s[i - 1U]) / (p_trace->t_s[i] - p_trace->t_s[i - 1U]);
+
+            return p_trace->load_w[i - 1U] + (f * (p_trace->load_w[i] - p_trace->load_w[i - 1U]));
+        }
+    }
+    return p_trace->load_w[p_trace->points - 1U];
+}
+
+/**
+ * @brief Start in equilibrium with a load at half airflow; same seed every time, so runs compared against each
+ *        other see the same probe noise
+ */
+static inline void rack_model_init(rack_model_t *p_model, float load_w)
+{
+    p_model->airflow = 0.5f;
+    p_model->temp = RACK_MODEL_AMBIENT_C +
+                    (load_w / (RACK_MODEL_G_NATURAL_W_PER_C + (p_model->airflow * RACK_MODEL_G_AIRFLOW_W_PER_C)));
+    p_model->probe = p_model->temp;
+    p_model->exhaust = 0U;
+    p_model->rng = RACK_MODEL_SEED;
+}
+
+/**
+ * @brief Noisy probe reading, as the control loop samples it
+ */
+static inline float rack_model_reading(rack_model_t *p_model)
+{
+    double u1;
+    double u2;
+
+    p_model->rng ^= p_model->rng << 13;
+    p_model->rng ^= p_model->rng >> 7;
+    p_model->rng ^= p_model->rng << 17;
+    u1 = (double)(p_model->rng >> 11) * (1.0 / 9007199254740992.0);
+    p_model->rng ^= p_model->rng << 13;
+    p_model->rng ^= p_model->rng >> 7;
+    p_model->rng ^= p_model->rng << 17;
+    u2 = (double)(p_model->rng >> 11) * (1.0 / 9007199254740992.0);
+
+    return p_model->probe + (RACK_MODEL_PROBE_NOISE_C *
+                             (float)(sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2)));
+}
+
+/**
+ * @brief Advance the plant by RACK_MODEL_STEP_S with a commanded intake duty
+ * @return Intake + exhaust electrical power over the step (W)
+ */
+static inline double rack_model_step(rack_model_t *p_model, float load_w, uint8_t duty)
+{
+    float conductance;
+
+    p_model->exhaust = (duty < 100U) ? (uint8_t)(((uint16_t)duty * RACK_MODEL_EXHAUST_RATIO_PCT) / 100U) : duty;
+    p_model->airflow += (((((float)duty + (float)p_model->exhaust) / 200.0f) - p_model->airflow) *
+                         RACK_MODEL_STEP_S) / RACK_MODEL_FAN_TAU_S;
+    conductance = RACK_MODEL_G_NATURAL_W_PER_C + (RACK_MODEL_G_AIRFLOW_W_PER_C * p_model->airflow);
+
+    p_model->temp += ((load_w - (conductance * (p_model->temp - RACK_MODEL_AMBIENT_C))) * RACK_MODEL_STEP_S) /
+                     RACK_MODEL_CAPACITY_J_PER_C;
+    p_model->probe += ((p_model->temp - p_model->probe) * RACK_MODEL_STEP_S) / RACK_MODEL_PROBE_TAU_S;
+
+    return (double)(fan_energy_power_mw(duty) + fan_energy_power_mw(p_model->exhaust)) / 1000.0;
+}
+
+#endif /* RACK_MODEL_H_ */
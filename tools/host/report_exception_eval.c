@@ -0,0 +1,271 @@
+/***********************************************************************************************************************
+ * File Name    : report_exception_eval.c
+ * Description  : Host Evaluation - report-by-exception rack status (src/telemetry_report.c) versus the fixed
+ *                BLE_TX_INTERVAL_MS cadence
+ *
+ * A 1 ms main loop over a temperature profile with Gaussian probe noise: control samples at the adaptive rate
+ * (adaptive_sampling.c on thermal_trend.c), the cooling level, duty and alert bits from thermal_policy.h with the
+ * build defaults, and once per iteration telemetry_report_check()/telemetry_report_sent() with the timebase time,
+ * as ble_send_status() does. A receiver keeps the last frame. A central subscribes every hour.
+ *
+ *   frames    status frames over the trace, by reason, against one per BLE_TX_INTERVAL_MS
+ *   gap s     longest silence - receivers and the gateway mark a rack stale after twice REPORT_HEARTBEAT_MS
+ *   stale C   largest difference between the sampled temperature and the receiver's, held longer than
+ *             BLE_TX_INTERVAL_MS (a move past the deadband must go out by then)
+ *   late      iterations where the receiver's level, duty, alerts differ from the rack's after the report check,
+ *             or a new subscriber is waiting
+ *
+ *   cc -O2 -I../../src -o report_exception_eval report_exception_eval.c ../../src/telemetry_report.c \
+ *      ../../src/adaptive_sampling.c ../../src/thermal_trend.c -lm
+ *   report_exception_eval [-n noise_c] [-r seed]
+ *
+ * Exit status 1 if a state change or subscription is not reported in its iteration, a silence exceeds the
+ * heartbeat, a deadband move is held past the minimum gap, or a quiet trace saves less than EVAL_MIN_SAVING.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "adaptive_sampling.h"
+#include "telemetry_report.h"
+#include "thermal_policy.h"
+#include "thermal_trend.h"
+
+/* ==================================================================================================================
+ * EVALUATION CONFIGURATION
+ * ================================================================================================================== */
+/* Build Defaults - mirror src/main_application.h and src/system_config.h */
+#define EVAL_TX_INTERVAL_MS             (500U)      /* BLE_TX_INTERVAL_MS */
+#define EVAL_DEADBAND_C                 (0.3f)      /* REPORT_DEADBAND_C */
+#define EVAL_HEARTBEAT_MS               (5000U)     /* REPORT_HEARTBEAT_MS */
+#define EVAL_MIN_MS                     (250U)      /* ADAPTIVE_SAMPLE_MIN_MS */
+#define EVAL_MAX_MS                     (10000U)    /* ADAPTIVE_SAMPLE_MAX_MS */
+#define EVAL_CRITICAL_C                 (58.0f)     /* SYSTEM_CRITICAL_TEMP */
+#define EVAL_SHUTDOWN_C                 (65.0f)     /* SYSTEM_SHUTDOWN_TEMP */
+#define EVAL_HYSTERESIS_C               (1.0f)      /* TEMP_HYSTERESIS */
+static float const gs_threshold[4] = { 30.0f, 40.0f, 50.0f, 55.0f };       /* TEMP_*_THRESHOLD */
+static uint8_t const gs_duty[THERMAL_POLICY_LEVELS] = { 0U, 25U, 50U, 75U, 100U };     /* PWM_DUTY_CYCLE_* */
+static float const gs_boundary[6] = { 30.0f, 40.0f, 50.0f, 55.0f, EVAL_CRITICAL_C, EVAL_SHUTDOWN_C };
+
+#define EVAL_DEFAULT_NOISE_C            (0.05)      /* Probe noise after oversampling, 1 sigma */
+#define EVAL_DEFAULT_SEED               (1U)
+#define EVAL_SUBSCRIBE_MS               (3600000U)  /* A central enables notifications this often */
+#define EVAL_MIN_SAVING                 (5.0)       /* Fixed-cadence / by-exception frames on the quiet traces */
+
+/* Scenario */
+typedef double (*eval_profile_t)(double t);
+
+typedef struct {
+    char const *p_name;
+    eval_profile_t profile;
+    uint32_t duration_s;
+    bool quiet;                 /* Mostly inside one level - held to EVAL_MIN_SAVING */
+} eval_scenario_t;
+
+/* Receiver's copy - the last frame */
+typedef struct {
+    float temperature;
+    uint8_t cooling_level;
+    uint8_t pwm_duty_cycle;
+    uint8_t system_alert;
+    uint32_t at_ms;
+} eval_receiver_t;
+
+/* Result */
+typedef struct {
+    uint32_t frames;
+    uint32_t fixed_frames;
+    uint32_t max_gap_ms;
+    float max_stale_c;
+    uint32_t late;
+} eval_result_t;
+
+/* Global Variables */
+static uint64_t gs_rng;
+static uint64_t gs_seed = EVAL_DEFAULT_SEED;
+static double gs_noise_c = EVAL_DEFAULT_NOISE_C;
+
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    double u1 = rng_uniform();
+    double u2 = rng_uniform();
+
+    return sqrt(-2.0 * log(u1 + 1e-300)) * cos(2.0 * M_PI * u2);
+}
+
+/* Profiles */
+static double profile_steady(double t)
+{
+    return 28.0 + (0.3 * sin(t / 600.0));
+}
+
+static double profile_diurnal(double t)
+{
+    return 34.5 + (10.5 * sin(2.0 * M_PI * t / 86400.0));
+}
+
+/* Bursty load around the MEDIUM/HIGH thresholds */
+static double profile_busy(double t)
+{
+    return 45.0 + (4.0 * sin(t / 120.0)) + (2.0 * sin(t / 17.0));
+}
+
+/* Intake fan fails after an hour: 0.05 °C/s into the critical alert */
+static double profile_fan_failure(double t)
+{
+    return (t < 3600.0) ? 35.0 : fmin(35.0 + (0.05 * (t - 3600.0)), 62.0);
+}
+
+static eval_scenario_t const gs_scenarios[] = {
+    { "steady 28 C, 24 h",      profile_steady,      86400U, true  },
+    { "diurnal 24-45 C, 24 h",  profile_diurnal,     86400U, true  },
+    { "busy 45+/-6 C, 24 h",    profile_busy,        86400U, false },
+    { "fan failure, 2 h",       profile_fan_failure, 7200U,  false },
+};
+
+/**
+ * @brief Run one trace through the loop
+ */
+static void eval_run(eval_scenario_t const *p_scenario, telemetry_report_t *p_report, eval_result_t *p_result)
+{
+    thermal_trend_t trend;
+    adaptive_sampling_t sched;
+    eval_receiver_t rx = { 0 };
+    uint32_t interval_ms = EVAL_MIN_MS;
+    uint32_t next_sample_ms = 0U;
+    uint32_t stale_since_ms = 0U;
+    bool stale = false;
+    float temp = 0.0f;
+    uint8_t level = 0U;
+    uint8_t duty = 0U;
+    uint8_t alert = 0U;
+
+    thermal_trend_init(&trend);
+    adaptive_sampling_init(&sched, EVAL_MIN_MS, EVAL_MAX_MS);
+    telemetry_report_init(p_report);
+    *p_result = (eval_result_t){ 0 };
+    gs_rng = 0x9E3779B97F4A7C15ULL ^ gs_seed;
+
+    for (uint32_t now_ms = 0U; now_ms < (p_scenario->duration_s * 1000U); now_ms++)
+    {
+        bool subscribed = false;
+        report_reason_t reason;
+
+        /* Control sample */
+        if (now_ms >= next_sample_ms)
+        {
+            temp = (float)(p_scenario->profile((double)now_ms / 1000.0) + (gs_noise_c * rng_gauss()));
+            thermal_trend_update(&trend, temp, (float)interval_ms / 1000.0f);
+            level = thermal_policy_level(gs_threshold, temp);
+            duty = thermal_policy_duty(gs_duty, level);
+            alert = thermal_policy_alert(alert, temp, EVAL_CRITICAL_C, EVAL_HYSTERESIS_C, EVAL_SHUTDOWN_C);
+            interval_ms = adaptive_sampling_next(&sched, trend.level, trend.slope, gs_boundary, 6U);
+            next_sample_ms = now_ms + interval_ms;
+        }
+
+        /* Status report, once per iteration */
+        if ((now_ms > 0U) && (0U == (now_ms % EVAL_SUBSCRIBE_MS)))
+        {
+            telemetry_report_force(p_report);
+            subscribed = true;
+        }
+        reason = telemetry_report_check(p_report, temp, level, duty, alert, now_ms, EVAL_DEADBAND_C,
+                                        EVAL_TX_INTERVAL_MS, EVAL_HEARTBEAT_MS);
+        if (REPORT_NONE != reason)
+        {
+            (void)telemetry_report_sent(p_report, reason, temp, level, duty, alert, now_ms);
+            if (p_result->frames > 0U)
+            {
+                p_result->max_gap_ms = ((now_ms - rx.at_ms) > p_result->max_gap_ms) ? (now_ms - rx.at_ms)
+                                                                                      : p_result->max_gap_ms;
+            }
+            rx = (eval_receiver_t){ temp, level, duty, alert, now_ms };
+            p_result->frames++;
+        }
+        p_result->fixed_frames += (0U == (now_ms % EVAL_TX_INTERVAL_MS)) ? 1U : 0U;
+
+        /* What the receiver is missing */
+        p_result->late += ((rx.cooling_level != level) || (rx.pwm_duty_cycle != duty) || (rx.system_alert != alert) ||
+                           (subscribed && (REPORT_NONE == reason))) ? 1U : 0U;
+        if (fabsf(temp - rx.temperature) >= EVAL_DEADBAND_C)
+        {
+            stale_since_ms = stale ? stale_since_ms : now_ms;
+            stale = true;
+            if ((now_ms - stale_since_ms) > EVAL_TX_INTERVAL_MS)
+            {
+                p_result->max_stale_c = fmaxf(p_result->max_stale_c, fabsf(temp - rx.temperature));
+            }
+        }
+        else
+        {
+            stale = false;
+        }
+    }
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n noise_c] [-r seed]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:r:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                gs_noise_c = strtod(optarg, NULL);
+                break;
+            case 'r':
+                gs_seed = strtoull(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (gs_noise_c < 0.0)
+    {
+        usage(argv[0]);
+    }
+
+    printf("deadband %.1f °C, min gap %u ms, heartbeat %u ms, noise %.2f °C, seed %llu\n", (double)EVAL_DEADBAND_C,
+           EVAL_TX_INTERVAL_MS, EVAL_HEARTBEAT_MS, gs_noise_c, (unsigned long long)gs_seed);
+    printf("%-22s | %7s %7s %6s | %6s %6s %6s %6s | %6s %7s %4s\n", "trace", "fixed", "sent", "saving", "state",
+           "band", "beat", "forced", "gap s", "stale C", "late");
+    for (uint32_t s = 0U; s < (sizeof(gs_scenarios) / sizeof(gs_scenarios[0])); s++)
+    {
+        telemetry_report_t report;
+        eval_result_t result;
+        double saving;
+        bool ok;
+
+        eval_run(&gs_scenarios[s], &report, &result);
+        saving = (double)result.fixed_frames / (double)result.frames;
+        ok = (0U == result.late) && (result.max_gap_ms <= EVAL_HEARTBEAT_MS) && (0.0f == result.max_stale_c) &&
+             (!gs_scenarios[s].quiet || (saving >= EVAL_MIN_SAVING));
+        pass = pass && ok;
+
+        printf("%-22s | %7u %7u %5.1fx | %6u %6u %6u %6u | %6.1f %7.2f %4u  %s\n", gs_scenarios[s].p_name,
+               result.fixed_frames, result.frames, saving, report.reports[REPORT_STATE],
+               report.reports[REPORT_DEADBAND], report.reports[REPORT_HEARTBEAT], report.reports[REPORT_FORCED],
+               (double)result.max_gap_ms / 1000.0, (double)result.max_stale_c, result.late, ok ? "PASS" : "FAIL");
+    }
+
+    return pass ? 0 : 1;
+}
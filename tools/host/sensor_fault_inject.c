@@ -0,0 +1,282 @@
+/***********************************************************************************************************************
+ * File Name    : sensor_fault_inject.c
+ * Description  : Host Fault-Injection Test - src/sensor_fault.c driven the way temp_sensor_service() drives it
+ *
+ * Two probes are scanned at a fixed rate with LSB jitter on every conversion; scan results go through the real
+ * oversampling accumulator (src/temp_oversample.h) and the linear count/°C curve, and the plausibility layer
+ * sees raw counts per scan, readings per decimation and a timeout poll per millisecond - the main loop's
+ * pattern. Each scenario injects one fault (or none) and checks that the expected fault bit latches first,
+ * not before the injection, within the scenario's latency bound; and that faults auto-clear once the inputs
+ * have been plausible for SENSOR_FAULT_CLEAR_MS. Timestamps are 200 MHz cycle counts started just below the
+ * 32-bit wrap, as DWT->CYCCNT would be.
+ *
+ *   cc -O2 -I../../src -o sensor_fault_inject sensor_fault_inject.c ../../src/sensor_fault.c -lm
+ *   sensor_fault_inject [-j jitter_lsb] [-r scan_hz]
+ *
+ * The noise scenarios also count how often a reading-to-reading slew check (no window, no noise allowance)
+ * would have tripped - the false fail-safe the slew window exists to prevent. Exit status 1 on any failure.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "system_config.h"
+#include "sensor_fault.h"
+#include "temp_oversample.h"
+
+/* ==================================================================================================================
+ * TEST CONFIGURATION
+ * ================================================================================================================== */
+#define INJECT_CYCLES_PER_MS            (200000U)   /* 200 MHz core clock */
+#define INJECT_START_CYCLES             (0xFFFFFFFFU - (3000U * INJECT_CYCLES_PER_MS))
+#define INJECT_EXTRA_BITS               (2U)        /* TEMP_OVERSAMPLE_EXTRA_BITS */
+#define INJECT_DEFAULT_JITTER_LSB       (4U)        /* Peak conversion jitter at a fast scan rate */
+#define INJECT_DEFAULT_SCAN_HZ          (1000U)
+#define INJECT_PROBES                   (2U)
+#define INJECT_TIMEOUT_BOUND_MS         (TEMP_SENSOR_TIMEOUT_MS + 2U)   /* Timeout plus one poll */
+#define INJECT_COUNTS_PER_C             (4095.0 * 0.01 / 3.3)   /* Linear sensor: |TEMP_SENSOR_TC| / LSB */
+#define INJECT_COUNTS_AT_25C            (4095.0 * 0.75 / 3.3)   /* TEMP_SENSOR_V_25 */
+
+/* Scenario - one injected fault */
+typedef enum {
+    SCENARIO_NOISE,             /* Steady rack, jitter only */
+    SCENARIO_RAMP_OK,           /* Fast but physical warm-up (4 °C/s) */
+    SCENARIO_STEP,              /* Primary jumps 8 °C (connector glitch) */
+    SCENARIO_RAMP_FAST,         /* Primary drifts at 20 °C/s */
+    SCENARIO_OPEN,              /* Primary divider open - pinned at VREF */
+    SCENARIO_SHORT,             /* Primary shorted to GND */
+    SCENARIO_STUCK,             /* Primary converter returns one frozen value */
+    SCENARIO_STALE,             /* Redundant probe stops delivering */
+    SCENARIO_CROSSCHECK,        /* Redundant probe drifts away at 0.5 °C/s */
+    SCENARIO_COUNT
+} scenario_id_t;
+
+typedef struct {
+    char const *p_name;
+    uint32_t expect;            /* SENSOR_FAULT_* bit, SENSOR_FAULT_NONE for none */
+    uint32_t inject_ms;         /* Fault starts */
+    uint32_t bound_ms;          /* Latest acceptable detection after inject_ms */
+    uint32_t heal_ms;           /* Fault removed (0 = never) - auto-clear checked after this */
+    uint32_t run_ms;
+} scenario_t;
+
+static scenario_t const gs_scenarios[SCENARIO_COUNT] = {
+    /*                      name           expect                   inject  bound                    heal     run */
+    [SCENARIO_NOISE]      = { "noise",       SENSOR_FAULT_NONE,          0U,    0U,                      0U, 120000U },
+    [SCENARIO_RAMP_OK]    = { "ramp 4C/s",   SENSOR_FAULT_NONE,       2000U,    0U,                      0U,   8000U },
+    [SCENARIO_STEP]       = { "step 8C",     SENSOR_FAULT_SLEW,       5000U,   40U,                   6000U,  20000U },
+    [SCENARIO_RAMP_FAST]  = { "ramp 20C/s",  SENSOR_FAULT_SLEW,       5000U,  150U,                   5500U,  20000U },
+    [SCENARIO_OPEN]       = { "open",        SENSOR_FAULT_RAIL_HIGH,  5000U,    2U,                   6000U,  20000U },
+    [SCENARIO_SHORT]      = { "short",       SENSOR_FAULT_RAIL_LOW,   5000U,    2U,                   6000U,  20000U },
+    [SCENARIO_STUCK]      = { "stuck",       SENSOR_FAULT_STUCK,      5000U, INJECT_TIMEOUT_BOUND_MS, 12000U,  30000U },
+    [SCENARIO_STALE]      = { "stale",       SENSOR_FAULT_STALE,      5000U, INJECT_TIMEOUT_BOUND_MS, 12000U,  30000U },
+    [SCENARIO_CROSSCHECK] = { "cross-check", SENSOR_FAULT_CROSSCHECK, 5000U, 7000U,                  15000U,  35000U },
+};
+
+/* Global Variables */
+static uint32_t gs_jitter_lsb = INJECT_DEFAULT_JITTER_LSB;
+static uint32_t gs_scan_hz = INJECT_DEFAULT_SCAN_HZ;
+static uint64_t gs_rng = 0x2545F4914F6CDD1DULL;
+
+static inline uint32_t rng_next(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (uint32_t)(gs_rng >> 32);
+}
+
+/**
+ * @brief Rack air temperature a probe sees, faults that change the temperature included
+ */
+static double scenario_temp(scenario_id_t id, uint8_t probe, double t_ms, bool faulted)
+{
+    double temp = 35.0;
+
+    if ((SCENARIO_RAMP_OK == id) && (t_ms >= 2000.0))
+    {
+        temp += 4.0 * (((t_ms < 7000.0) ? t_ms : 7000.0) - 2000.0) / 1000.0;
+    }
+    if (faulted && (0U == probe) && (SCENARIO_STEP == id))
+    {
+        temp += 8.0;
+    }
+    if (faulted && (0U == probe) && (SCENARIO_RAMP_FAST == id))
+    {
+        temp += 20.0 * (t_ms - gs_scenarios[id].inject_ms) / 1000.0;
+    }
+    if (faulted && (1U == probe) && (SCENARIO_CROSSCHECK == id))
+    {
+        temp += 0.5 * (t_ms - gs_scenarios[id].inject_ms) / 1000.0;
+    }
+    return temp;
+}
+
+/**
+ * @brief One scan of one probe
+ * @return false if the probe delivers nothing (stale)
+ */
+static bool scenario_scan(scenario_id_t id, uint8_t probe, double t_ms, uint16_t *p_raw)
+{
+    scenario_t const *p_scenario = &gs_scenarios[id];
+    bool faulted = (SENSOR_FAULT_NONE != p_scenario->expect) && (t_ms >= p_scenario->inject_ms) &&
+                   ((0U == p_scenario->heal_ms) || (t_ms < p_scenario->heal_ms));
+    double temp = scenario_temp(id, probe, t_ms, faulted);
+    double counts = INJECT_COUNTS_AT_25C - ((temp - 25.0) * INJECT_COUNTS_PER_C);
+    int32_t jitter = (int32_t)(rng_next() % ((2U * gs_jitter_lsb) + 1U)) - (int32_t)gs_jitter_lsb;
+
+    *p_raw = (uint16_t)lround(counts + jitter);
+    if (faulted && (0U == probe))
+    {
+        switch (id)
+        {
+            case SCENARIO_OPEN:  *p_raw = 4095U;                     break;
+            case SCENARIO_SHORT: *p_raw = 0U;                        break;
+            case SCENARIO_STUCK: *p_raw = (uint16_t)lround(counts);  break;
+            default:                                                 break;
+        }
+    }
+    return !(faulted && (1U == probe) && (SCENARIO_STALE == id));
+}
+
+/**
+ * @brief Decimated counts to °C on the linear curve (temp_sensor_counts_to_celsius() with TEMP_SENSOR_TYPE_NTC 0)
+ */
+static float reading_celsius(uint32_t counts)
+{
+    return (float)(25.0 - ((((double)counts / (double)(1U << INJECT_EXTRA_BITS)) - INJECT_COUNTS_AT_25C) /
+                           INJECT_COUNTS_PER_C));
+}
+
+/**
+ * @brief Run one scenario and judge it
+ */
+static bool scenario_run(scenario_id_t id)
+{
+    scenario_t const *p_scenario = &gs_scenarios[id];
+    sensor_fault_ctx_t ctx;
+    temp_oversample_t os[INJECT_PROBES] = { 0 };
+    uint32_t scan_us = 1000000U / gs_scan_hz;
+    double detect_ms = -1.0;
+    double clear_ms = -1.0;
+    uint32_t first_bits = SENSOR_FAULT_NONE;
+    uint32_t seen = SENSOR_FAULT_NONE;
+    uint32_t naive_trips = 0;
+    float naive_temp[INJECT_PROBES] = { 0 };
+    double naive_ms[INJECT_PROBES] = { -1.0, -1.0 };
+    bool pass;
+
+    sensor_fault_init(&ctx, INJECT_CYCLES_PER_MS, 1U, INJECT_START_CYCLES);
+
+    for (uint64_t t_us = 0; t_us < ((uint64_t)p_scenario->run_ms * 1000U); t_us += scan_us)
+    {
+        double t_ms = (double)t_us / 1000.0;
+        uint32_t now = INJECT_START_CYCLES + (uint32_t)((t_us * INJECT_CYCLES_PER_MS) / 1000U);
+        uint32_t active;
+
+        for (uint8_t probe = 0; probe < INJECT_PROBES; probe++)
+        {
+            uint16_t raw;
+
+            if (!scenario_scan(id, probe, t_ms, &raw))
+            {
+                continue;
+            }
+            sensor_fault_check_raw(&ctx, probe, raw, now);
+            if (temp_oversample_feed(&os[probe], raw, 1U, INJECT_EXTRA_BITS))
+            {
+                float temp = reading_celsius(os[probe].counts);
+
+                /* Reading-to-reading check, for comparison only */
+                if (naive_ms[probe] >= 0.0)
+                {
+                    double elapsed_ms = ((t_ms - naive_ms[probe]) < 1.0) ? 1.0 : (t_ms - naive_ms[probe]);
+
+                    naive_trips += (fabs((double)(temp - naive_temp[probe])) * 1000.0 >
+                                    (double)SENSOR_MAX_SLEW_C_PER_S * elapsed_ms) ? 1U : 0U;
+                }
+                naive_temp[probe] = temp;
+                naive_ms[probe] = t_ms;
+
+                sensor_fault_check_reading(&ctx, probe, temp, now);
+            }
+        }
+        sensor_fault_check_timeout(&ctx, INJECT_PROBES, now);
+
+        active = sensor_fault_active(&ctx);
+        seen |= active;
+        if ((SENSOR_FAULT_NONE != active) && (detect_ms < 0.0))
+        {
+            detect_ms = t_ms;
+            first_bits = active;
+        }
+        if ((0U != p_scenario->heal_ms) && (t_ms >= p_scenario->heal_ms) && (detect_ms >= 0.0) &&
+            (SENSOR_FAULT_NONE == active) && (clear_ms < 0.0))
+        {
+            clear_ms = t_ms;
+        }
+    }
+
+    if (SENSOR_FAULT_NONE == p_scenario->expect)
+    {
+        pass = (SENSOR_FAULT_NONE == seen);
+        printf("%-12s %s  faults 0x%02x  (reading-to-reading slew check would have tripped %u times)\n",
+               p_scenario->p_name, pass ? "PASS" : "FAIL", seen, naive_trips);
+        return pass;
+    }
+
+    pass = (detect_ms >= (double)p_scenario->inject_ms) &&
+           ((detect_ms - (double)p_scenario->inject_ms) <= (double)p_scenario->bound_ms) &&
+           (0U != (first_bits & p_scenario->expect)) &&
+           (clear_ms >= ((double)p_scenario->heal_ms + (double)SENSOR_FAULT_CLEAR_MS - 1.0)) &&
+           (clear_ms <= ((double)p_scenario->heal_ms + (double)SENSOR_FAULT_CLEAR_MS + 1000.0));
+    printf("%-12s %s  expect 0x%02x, first 0x%02x after %.0f ms (bound %u ms), all 0x%02x, cleared %.0f ms "
+           "after healing\n",
+           p_scenario->p_name, pass ? "PASS" : "FAIL", p_scenario->expect, first_bits,
+           (detect_ms >= 0.0) ? (detect_ms - (double)p_scenario->inject_ms) : -1.0, p_scenario->bound_ms, seen,
+           (clear_ms >= 0.0) ? (clear_ms - (double)p_scenario->heal_ms) : -1.0);
+    return pass;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-j jitter_lsb] [-r scan_hz (1-10000)]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "j:r:")))
+    {
+        switch (opt)
+        {
+            case 'j':
+                gs_jitter_lsb = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 'r':
+                gs_scan_hz = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == gs_scan_hz) || (gs_scan_hz > 10000U))
+    {
+        usage(argv[0]);
+    }
+
+    printf("scan %u Hz per probe, jitter +/-%u LSB, reading every %u scans\n", gs_scan_hz, gs_jitter_lsb,
+           1U << (2U * INJECT_EXTRA_BITS));
+    for (uint32_t id = 0; id < SCENARIO_COUNT; id++)
+    {
+        pass = scenario_run((scenario_id_t)id) && pass;
+    }
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,524 @@
+/***********************************************************************************************************************
+ * File Name    : shutdown_window_sim.c
+ * Description  : Host Stand-in - src/thermal_shutdown.c driven by a model of ADC window A, the ELC and the port
+ *
+ * Each simulated scan converts the shutdown channel (NTC counts for the scenario's temperature plus Gaussian
+ * noise, or a faulted input), evaluates window A exactly as thermal_shutdown_window_cfg() configured it, and
+ * raises the compare and scan-complete events into thermal_shutdown_isr() / thermal_shutdown_scan_end_isr(),
+ * compare first as the interrupt priorities order them on the target. The ELC model forwards ADC0_WINDOW_A to
+ * the port event output while the firmware has it linked, so the shutdown GPIO level seen here is the one the
+ * hardware would drive, before any ISR runs.
+ *
+ * Every scenario runs in a forked child - the latch only clears on reset - and is checked for: trip or no
+ * trip, trip latency from the true 65 °C crossing, the GPIO set by the ELC path on the confirming conversion,
+ * and no GPIO activity without a trip. "1-event" shows when the previous single-event, one-sided comparator
+ * would have latched on the same input. "irq order" checks that thermal_shutdown_init() arms the window path only
+ * with the window A interrupt configured above scan end.
+ *
+ *   cc -O2 -I include -I../../src -o shutdown_window_sim shutdown_window_sim.c ../../src/thermal_shutdown.c \
+ *      ../../src/ntc_table.c -lm
+ *   shutdown_window_sim [-n scans] [-s noise_lsb]
+ *
+ * Exit status 0 if every scenario passed, 1 otherwise.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "main_application.h"
+#include "ntc_thermistor.h"
+#include "sensor_fault.h"
+#include "thermal_shutdown.h"
+#include "tlog.h"
+
+/* ==================================================================================================================
+ * SIMULATION CONFIGURATION
+ * ================================================================================================================== */
+#define SIM_SCAN_HZ                     (1000U)
+#define SIM_CYCLES_PER_SCAN             (200000000U / SIM_SCAN_HZ)
+#define SIM_DEFAULT_SCANS               (20000U)
+#define SIM_DEFAULT_NOISE_LSB           (3.0)
+#define SIM_TRIP_BOUND_SCANS            (100U)      /* True crossing -> latched, ramp scenarios */
+#define SIM_EARLY_MARGIN_C              (0.5f)      /* Latching further below 65 °C than this is a false trip */
+#define SIM_SCAN_END_IRQ                (4)
+#define SIM_WINDOW_A_IRQ                (5)
+#define SIM_SCAN_END_IPL                (12U)
+#define SIM_WINDOW_A_IPL                (11U)       /* Above scan end (lower value), as the target is configured */
+
+/* Scenario input */
+typedef enum {
+    SIM_INPUT_TEMP,             /* NTC at the scenario temperature */
+    SIM_INPUT_SHORT,            /* Probe shorted to GND */
+    SIM_INPUT_OPEN,             /* Probe open - divider pulls to VREF */
+} sim_input_t;
+
+typedef struct {
+    char const *p_name;
+    sim_input_t input;
+    float start_c;
+    float ramp_c_per_s;
+    float end_c;
+    uint32_t glitch_every;      /* Scans between in-band glitch runs (0 = none) */
+    uint32_t glitch_run;        /* Consecutive glitched conversions per run */
+    bool expect_trip;
+} sim_scenario_t;
+
+/* Scenario result, passed from the child */
+typedef struct {
+    bool tripped;
+    bool pin_by_elc;            /* GPIO went active on a conversion, ahead of the ISR */
+    bool pin_without_trip;
+    int64_t trip_scan;
+    int64_t crossing_scan;      /* First scan with the true temperature at or above shutdown */
+    int64_t naive_scan;         /* First scan the single-event one-sided comparator fires */
+    float trip_temp;
+    uint32_t events;
+} sim_result_t;
+
+static sim_scenario_t const gs_scenarios[] = {
+    { "normal 45C",     SIM_INPUT_TEMP,  45.0f, 0.0f, 45.0f,  0U, 0U, false },
+    { "near 64.5C",     SIM_INPUT_TEMP,  64.5f, 0.0f, 64.5f,  0U, 0U, false },
+    { "glitch 1",       SIM_INPUT_TEMP,  45.0f, 0.0f, 45.0f, 50U, 1U, false },
+    { "glitch N-1",     SIM_INPUT_TEMP,  45.0f, 0.0f, 45.0f, 200U, THERMAL_SHUTDOWN_CONFIRM_SCANS - 1U, false },
+    { "short GND",      SIM_INPUT_SHORT,  0.0f, 0.0f,  0.0f,  0U, 0U, false },
+    { "open",           SIM_INPUT_OPEN,   0.0f, 0.0f,  0.0f,  0U, 0U, false },
+    { "ramp 2C/s",      SIM_INPUT_TEMP,  60.0f, 2.0f, 80.0f,  0U, 0U, true  },
+    { "ramp 0.2C/s",    SIM_INPUT_TEMP,  64.0f, 0.2f, 80.0f,  0U, 0U, true  },
+    { "step 75C",       SIM_INPUT_TEMP,  75.0f, 0.0f, 75.0f,  0U, 0U, true  },
+};
+
+/* FSP instances and hardware state the firmware touches */
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+uint32_t SystemCoreClock = 200000000U;
+ioport_ctrl_t g_ioport_ctrl;
+poeg_ctrl_t g_poeg0_ctrl;
+const poeg_cfg_t g_poeg0_cfg = { .channel = 0U };
+elc_ctrl_t g_elc_ctrl;
+const elc_cfg_t g_elc_cfg = { .link = NULL };
+static adc_extended_cfg_t gs_adc0_extend = { .window_a_irq = SIM_WINDOW_A_IRQ, .window_a_ipl = SIM_WINDOW_A_IPL };
+const adc_cfg_t g_adc0_cfg = { .scan_end_irq = SIM_SCAN_END_IRQ, .scan_end_ipl = SIM_SCAN_END_IPL,
+                               .p_extend = &gs_adc0_extend };
+
+static bsp_io_level_t gs_pin_level;
+static bsp_io_level_t gs_pin_event_level;
+static bool gs_pin_event_set;
+static elc_event_t gs_ioport1_link;
+static bool gs_elc_enabled;
+static bool gs_poeg_forced;
+static bool gs_pin_by_elc;
+static uint64_t gs_rng = 0x2545F4914F6CDD1DULL;
+
+/* ==================================================================================================================
+ * FSP STAND-INS
+ * ================================================================================================================== */
+fsp_err_t R_IOPORT_PinWrite(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, bsp_io_level_t level)
+{
+    (void)p_ctrl;
+    if (THERMAL_SHUTDOWN_PIN == pin)
+    {
+        gs_pin_level = level;
+    }
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_IOPORT_PinRead(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin, bsp_io_level_t * p_pin_value)
+{
+    (void)p_ctrl;
+    *p_pin_value = (THERMAL_SHUTDOWN_PIN == pin) ? gs_pin_level : BSP_IO_LEVEL_LOW;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_IOPORT_PinEventOutputWrite(ioport_ctrl_t * const p_ctrl, bsp_io_port_pin_t pin,
+                                       bsp_io_level_t pin_value)
+{
+    (void)p_ctrl;
+    if (THERMAL_SHUTDOWN_PIN != pin)
+    {
+        return FSP_ERR_INVALID_ARGUMENT;
+    }
+    gs_pin_event_level = pin_value;
+    gs_pin_event_set = true;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_ELC_Open(elc_ctrl_t * const p_ctrl, elc_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_ELC_Enable(elc_ctrl_t * const p_ctrl)
+{
+    gs_elc_enabled = (0U != p_ctrl->open);
+    return gs_elc_enabled ? FSP_SUCCESS : FSP_ERR_NOT_OPEN;
+}
+
+fsp_err_t R_ELC_LinkSet(elc_ctrl_t * const p_ctrl, elc_peripheral_t peripheral, elc_event_t signal)
+{
+    if ((0U == p_ctrl->open) || (ELC_PERIPHERAL_IOPORT1 != peripheral))
+    {
+        return FSP_ERR_NOT_OPEN;
+    }
+    gs_ioport1_link = signal;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_ELC_LinkBreak(elc_ctrl_t * const p_ctrl, elc_peripheral_t peripheral)
+{
+    (void)p_ctrl;
+    if (ELC_PERIPHERAL_IOPORT1 == peripheral)
+    {
+        gs_ioport1_link = ELC_EVENT_NONE;
+    }
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_POEG_Open(poeg_ctrl_t * const p_ctrl, poeg_cfg_t const * const p_cfg)
+{
+    (void)p_cfg;
+    p_ctrl->open = 1U;
+    return FSP_SUCCESS;
+}
+
+fsp_err_t R_POEG_OutputDisable(poeg_ctrl_t * const p_ctrl)
+{
+    (void)p_ctrl;
+    gs_poeg_forced = true;
+    return FSP_SUCCESS;
+}
+
+void tlog_write(uint32_t level, uint32_t token, uint32_t nargs, uint32_t const *p_args)
+{
+    (void)level;
+    (void)token;
+    (void)nargs;
+    (void)p_args;
+}
+
+/**
+ * @brief temperature_sensor.c stand-in - uncalibrated table inverse (ntc_centi_celsius_to_counts)
+ */
+uint16_t temp_sensor_celsius_to_counts(uint16_t channel, float temperature)
+{
+    int32_t centi = (int32_t)(temperature * 100.0f);
+    uint32_t i;
+
+    (void)channel;
+    for (i = 1U; i < NTC_TABLE_ENTRIES; i++)
+    {
+        if (g_ntc_table[i] <= centi)
+        {
+            int32_t span = (int32_t)g_ntc_table[i - 1U] - (int32_t)g_ntc_table[i];
+            uint32_t counts = ((i - 1U) << NTC_TABLE_STEP_LOG2) +
+                              (uint32_t)((((int32_t)g_ntc_table[i - 1U] - centi) << NTC_TABLE_STEP_LOG2) / span);
+
+            return (counts > 4095U) ? 4095U : (uint16_t)counts;
+        }
+    }
+    return 4095U;
+}
+
+/* ==================================================================================================================
+ * HARDWARE MODEL
+ * ================================================================================================================== */
+static inline double rng_uniform(void)
+{
+    gs_rng ^= gs_rng << 13;
+    gs_rng ^= gs_rng >> 7;
+    gs_rng ^= gs_rng << 17;
+    return (double)(gs_rng >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double rng_gauss(void)
+{
+    return sqrt(-2.0 * log(rng_uniform() + 1e-300)) * cos(2.0 * M_PI * rng_uniform());
+}
+
+static uint16_t adc_clamp(double v)
+{
+    v = floor(v + 0.5);
+    return (v < 0.0) ? 0U : ((v > 4095.0) ? 4095U : (uint16_t)v);
+}
+
+/**
+ * @brief Window A as the ADC evaluates it for one channel
+ */
+static bool window_a_match(adc_window_cfg_t const *p_cfg, uint16_t raw)
+{
+    bool mode = 0U != (p_cfg->compare_mode_mask & (1UL << THERMAL_SHUTDOWN_CHANNEL));
+
+    if ((0U == (p_cfg->compare_cfg & ADC_COMPARE_CFG_A_ENABLE)) ||
+        (0U == (p_cfg->compare_mask & (1UL << THERMAL_SHUTDOWN_CHANNEL))))
+    {
+        return false;
+    }
+    if (0U != (p_cfg->compare_cfg & ADC_COMPARE_CFG_WINDOW_ENABLE))
+    {
+        bool inside = thermal_shutdown_in_band(raw, p_cfg->compare_ref_low, p_cfg->compare_ref_high);
+
+        return mode ? inside : !inside;
+    }
+    return mode ? (raw > p_cfg->compare_ref_low) : (raw < p_cfg->compare_ref_low);
+}
+
+/**
+ * @brief One scan: conversion, ELC forwarding, then the compare interrupt ahead of scan complete
+ */
+static bool sim_scan(adc_window_cfg_t const *p_cfg, uint16_t raw)
+{
+    bool match = window_a_match(p_cfg, raw);
+
+    DWT->CYCCNT += SIM_CYCLES_PER_SCAN;
+    if (match && gs_elc_enabled && (ELC_EVENT_ADC0_WINDOW_A == gs_ioport1_link) && gs_pin_event_set)
+    {
+        if (gs_pin_level != gs_pin_event_level)
+        {
+            gs_pin_by_elc = true;
+        }
+        gs_pin_level = gs_pin_event_level;
+    }
+    if (match)
+    {
+        thermal_shutdown_isr();
+    }
+    thermal_shutdown_scan_end_isr();
+    return match;
+}
+
+/* ==================================================================================================================
+ * SCENARIOS
+ * ================================================================================================================== */
+static void sim_run(sim_scenario_t const *p_sc, uint32_t scans, double noise_lsb, sim_result_t *p_result)
+{
+    adc_window_cfg_t cfg;
+    uint16_t naive_ref = temp_sensor_celsius_to_counts(THERMAL_SHUTDOWN_CHANNEL, SYSTEM_SHUTDOWN_TEMP);
+    uint32_t glitch_left = 0U;
+
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->trip_scan = -1;
+    p_result->crossing_scan = -1;
+    p_result->naive_scan = -1;
+
+    for (uint32_t s = 0; (SIM_INPUT_TEMP == p_sc->input) && (s < scans); s++)
+    {
+        float temp = p_sc->start_c + (p_sc->ramp_c_per_s * (float)s / (float)SIM_SCAN_HZ);
+
+        if (((temp > p_sc->end_c) ? p_sc->end_c : temp) >= SYSTEM_SHUTDOWN_TEMP)
+        {
+            p_result->crossing_scan = s;
+            break;
+        }
+    }
+
+    thermal_shutdown_init();
+    thermal_shutdown_window_cfg(&cfg);
+
+    for (uint32_t s = 0; (s < scans) && !p_result->tripped; s++)
+    {
+        float temp = p_sc->start_c + (p_sc->ramp_c_per_s * (float)s / (float)SIM_SCAN_HZ);
+        double level;
+        uint16_t raw;
+
+        temp = (temp > p_sc->end_c) ? p_sc->end_c : temp;
+
+        switch (p_sc->input)
+        {
+            case SIM_INPUT_SHORT:
+                level = fabs(noise_lsb * rng_gauss());
+                break;
+            case SIM_INPUT_OPEN:
+                level = 4095.0 - fabs(noise_lsb * rng_gauss());
+                break;
+            default:
+                level = (double)temp_sensor_celsius_to_counts(THERMAL_SHUTDOWN_CHANNEL, temp) +
+                        (noise_lsb * rng_gauss());
+                break;
+        }
+        if ((0U != p_sc->glitch_every) && (0U == (s % p_sc->glitch_every)) && (s > 0U))
+        {
+            glitch_left = p_sc->glitch_run;
+        }
+        if (0U != glitch_left)
+        {
+            /* Interference landing anywhere in the band */
+            level = (double)cfg.compare_ref_low + 1.0 + ((double)(cfg.compare_ref_high - cfg.compare_ref_low - 2U) *
+                                                         rng_uniform());
+            glitch_left--;
+        }
+        raw = adc_clamp(level);
+
+        if ((p_result->naive_scan < 0) && (raw < naive_ref))
+        {
+            p_result->naive_scan = s;
+        }
+        if (sim_scan(&cfg, raw))
+        {
+            p_result->events++;
+        }
+
+        if (thermal_shutdown_is_tripped())
+        {
+            p_result->tripped = true;
+            p_result->trip_scan = s;
+            p_result->trip_temp = temp;
+        }
+        else if (BSP_IO_LEVEL_LOW != gs_pin_level)
+        {
+            p_result->pin_without_trip = true;
+        }
+    }
+    p_result->pin_by_elc = gs_pin_by_elc;
+    p_result->tripped = p_result->tripped && gs_poeg_forced && (THERMAL_SHUTDOWN_PIN_ACTIVE == gs_pin_level);
+}
+
+/**
+ * @brief Run one scenario from reset in a child process
+ */
+static bool sim_scenario(sim_scenario_t const *p_sc, uint32_t scans, double noise_lsb)
+{
+    sim_result_t result;
+    int fds[2];
+    pid_t pid;
+    bool pass;
+
+    if (0 != pipe(fds))
+    {
+        perror("pipe");
+        exit(2);
+    }
+    pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        exit(2);
+    }
+    if (0 == pid)
+    {
+        close(fds[0]);
+        sim_run(p_sc, scans, noise_lsb, &result);
+        _exit((sizeof(result) == write(fds[1], &result, sizeof(result))) ? 0 : 1);
+    }
+    close(fds[1]);
+    if (sizeof(result) != read(fds[0], &result, sizeof(result)))
+    {
+        fprintf(stderr, "%s: child failed\n", p_sc->p_name);
+        exit(2);
+    }
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+
+    pass = (result.tripped == p_sc->expect_trip) && !result.pin_without_trip;
+    if (p_sc->expect_trip && result.tripped)
+    {
+        pass = pass && result.pin_by_elc &&
+               (result.trip_scan <= (result.crossing_scan + (int64_t)SIM_TRIP_BOUND_SCANS)) &&
+               (result.trip_temp >= (SYSTEM_SHUTDOWN_TEMP - SIM_EARLY_MARGIN_C));
+    }
+
+    printf("%-12s %s  %-7s", p_sc->p_name, pass ? "PASS" : "FAIL", result.tripped ? "trip" : "no trip");
+    if (result.tripped)
+    {
+        printf(" at %.2fC, %+lld scans from crossing, gpio by %s", (double)result.trip_temp,
+               (long long)(result.trip_scan - result.crossing_scan), result.pin_by_elc ? "ELC" : "ISR");
+    }
+    printf(", %u events, 1-event ", result.events);
+    if (result.naive_scan < 0)
+    {
+        printf("never\n");
+    }
+    else
+    {
+        printf("at scan %lld\n", (long long)result.naive_scan);
+    }
+    if (result.pin_without_trip)
+    {
+        printf("             shutdown GPIO asserted without a latched trip\n");
+    }
+    return pass;
+}
+
+/**
+ * @brief thermal_shutdown_init() with one window A interrupt setting: true if the window path was armed
+ */
+static bool sim_init_arms(IRQn_Type window_a_irq, uint8_t window_a_ipl, fsp_err_t *p_err)
+{
+    gs_adc0_extend.window_a_irq = window_a_irq;
+    gs_adc0_extend.window_a_ipl = window_a_ipl;
+    g_elc_ctrl.open = 0U;
+    g_poeg0_ctrl.open = 0U;
+    *p_err = thermal_shutdown_init();
+    return (0U != g_elc_ctrl.open) && (0U != g_poeg0_ctrl.open);
+}
+
+/**
+ * @brief Window A must preempt scan end, or every run breaks before it confirms - init refuses to arm otherwise
+ */
+static bool sim_irq_order(void)
+{
+    fsp_err_t err;
+    bool pass;
+
+    pass = sim_init_arms(SIM_WINDOW_A_IRQ, SIM_WINDOW_A_IPL, &err) && (FSP_SUCCESS == err);
+    pass = pass && !sim_init_arms(SIM_WINDOW_A_IRQ, SIM_SCAN_END_IPL, &err) && (FSP_ERR_INVALID_ARGUMENT == err) &&
+           (0U != g_poeg0_ctrl.open);
+    pass = pass && !sim_init_arms(SIM_WINDOW_A_IRQ, SIM_SCAN_END_IPL + 1U, &err) &&
+           (FSP_ERR_INVALID_ARGUMENT == err);
+    pass = pass && !sim_init_arms(FSP_INVALID_VECTOR, SIM_WINDOW_A_IPL, &err) && (FSP_ERR_INVALID_ARGUMENT == err);
+    gs_adc0_extend.window_a_irq = SIM_WINDOW_A_IRQ;
+    gs_adc0_extend.window_a_ipl = SIM_WINDOW_A_IPL;
+
+    printf("%-12s %s  window A ipl %u over scan end %u arms; equal, below or unlinked refused, POEG still open\n",
+           "irq order", pass ? "PASS" : "FAIL", SIM_WINDOW_A_IPL, SIM_SCAN_END_IPL);
+    return pass;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n scans] [-s noise_lsb]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t scans = SIM_DEFAULT_SCANS;
+    double noise_lsb = SIM_DEFAULT_NOISE_LSB;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:s:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                scans = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            case 's':
+                noise_lsb = strtod(optarg, NULL);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if ((0U == scans) || (noise_lsb < 0.0))
+    {
+        usage(argv[0]);
+    }
+
+    printf("band %u..%u counts (rail floor .. %.1fC), %u consecutive scans, noise %.1f LSB, %u scans at %u Hz\n",
+           SENSOR_RAIL_LOW_COUNTS + THERMAL_SHUTDOWN_RAIL_MARGIN_COUNTS,
+           temp_sensor_celsius_to_counts(THERMAL_SHUTDOWN_CHANNEL, SYSTEM_SHUTDOWN_TEMP),
+           (double)SYSTEM_SHUTDOWN_TEMP, THERMAL_SHUTDOWN_CONFIRM_SCANS, noise_lsb, scans, SIM_SCAN_HZ);
+    for (uint32_t i = 0; i < (sizeof(gs_scenarios) / sizeof(gs_scenarios[0])); i++)
+    {
+        pass = sim_scenario(&gs_scenarios[i], scans, noise_lsb) && pass;
+    }
+    pass = sim_irq_order() && pass;
+
+    return pass ? 0 : 1;
+}
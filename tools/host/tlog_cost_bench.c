@@ -0,0 +1,258 @@
+/***********************************************************************************************************************
+ * File Name    : tlog_cost_bench.c
+ * Description  : Host Benchmark - per-call cost of tokenized deferred logging (src/tlog.c) versus formatting at
+ *                the call site
+ *
+ * Each case is a log call the firmware makes, with its format string and argument types. The tokenized path is
+ * the real one: the log_info() macro of log_tokenized.h into tlog_write(), drained by tlog_flush() into an RTT
+ * stand-in. The formatted path is what log_info.h did before - format the message in place and write the text
+ * to RTT (SEGGER_RTT_printf() formats into a buffer and calls SEGGER_RTT_Write() the same way); vsnprintf()
+ * stands in for the formatter.
+ *
+ *   call ns   time at the call site per record (what an ISR or the control step pays)
+ *   flush ns  deferred drain per record (tokenized only - runs at idle)
+ *   bytes     bytes per record to RTT/UART
+ *
+ * Host times are relative: the ratio carries to the target, whose formatter (soft-float %f on a Cortex-M) is
+ * slower still. Calls are timed in batches that fit the ring, flushed between batches, so no record is dropped.
+ *
+ *   cc -O2 -I include -I../../src -o tlog_cost_bench tlog_cost_bench.c ../../src/tlog.c
+ *   tlog_cost_bench [-n calls]
+ *
+ * Exit status 1 if the tokenized call is not cheaper than formatting for every case, or a record is dropped.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "SEGGER_RTT.h"
+#include "hal_data.h"
+#include "log_tokenized.h"
+
+/* ==================================================================================================================
+ * BENCHMARK CONFIGURATION
+ * ================================================================================================================== */
+#define BENCH_DEFAULT_CALLS             (200000U)
+#define BENCH_BATCH                     (32U)       /* 32 x (3 + 6) words fits TLOG_RING_WORDS */
+#define BENCH_FORMAT_BUFFER             (256U)      /* Formatted message buffer */
+#define BENCH_SINK_BYTES                (4096U)
+
+/* Log call paths of one case */
+typedef struct {
+    char const *p_name;
+    void (*tokenized)(uint32_t i);
+    void (*formatted)(uint32_t i);
+} bench_case_t;
+
+/* Case Result */
+typedef struct {
+    double token_call_ns;
+    double flush_ns;
+    double token_bytes;
+    double format_call_ns;
+    double format_bytes;
+} bench_result_t;
+
+/* Global Variables */
+static DWT_Type gs_dwt;
+DWT_Type * DWT = &gs_dwt;
+
+static uint8_t gs_sink[BENCH_SINK_BYTES];
+static uint64_t gs_sink_bytes;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* RTT up-buffer - copies like the real one, never blocks */
+unsigned SEGGER_RTT_Write(unsigned BufferIndex, const void * pBuffer, unsigned NumBytes)
+{
+    (void)BufferIndex;
+    memcpy(gs_sink, pBuffer, (NumBytes < BENCH_SINK_BYTES) ? NumBytes : BENCH_SINK_BYTES);
+    gs_sink_bytes += NumBytes;
+    return NumBytes;
+}
+
+/**
+ * @brief Formatted logger - format in place, write the text
+ */
+static void __attribute__((format(printf, 1, 2))) bench_format_log(char const *p_fmt, ...)
+{
+    char buf[BENCH_FORMAT_BUFFER];
+    va_list args;
+    int len;
+
+    va_start(args, p_fmt);
+    len = vsnprintf(buf, sizeof(buf), p_fmt, args);
+    va_end(args);
+    if (len > 0)
+    {
+        SEGGER_RTT_Write(0, buf, ((uint32_t)len < sizeof(buf)) ? (uint32_t)len : (sizeof(buf) - 1U));
+    }
+}
+
+/* Cases - one firmware call site each, both paths with the same arguments */
+static char const * const gs_level_names[] = { "OFF", "LOW", "MEDIUM", "HIGH", "EMERGENCY" };
+
+static void thermal_control_tokenized(uint32_t i)
+{
+    log_info("THERMAL CONTROL: Temp=%.1f°C, Level=%s (PWM=%d%%)\r\n", 40.0f + (float)(i % 200U) / 10.0f,
+             gs_level_names[i % 5U], (int)(25U * (i % 5U)));
+}
+
+static void thermal_control_formatted(uint32_t i)
+{
+    bench_format_log("THERMAL CONTROL: Temp=%.1f°C, Level=%s (PWM=%d%%)\r\n", 40.0f + (float)(i % 200U) / 10.0f,
+                     gs_level_names[i % 5U], (int)(25U * (i % 5U)));
+}
+
+static void ble_connected_tokenized(uint32_t i)
+{
+    log_info("BLE Connected, handle: 0x%04x (%d/%d)\r\n", (unsigned)(i & 0xFFFFU), (int)(i % 3U), 3);
+}
+
+static void ble_connected_formatted(uint32_t i)
+{
+    bench_format_log("BLE Connected, handle: 0x%04x (%d/%d)\r\n", (unsigned)(i & 0xFFFFU), (int)(i % 3U), 3);
+}
+
+static void anomaly_tokenized(uint32_t i)
+{
+    log_warning("Thermal anomaly: 0x%02x (z=%.1f, residual=%.2f°C, cusum=%.1f)\r\n", (unsigned)(i & 0x7U),
+                3.0f + (float)(i % 10U) / 10.0f, 0.5f + (float)(i % 100U) / 100.0f, (float)(i % 50U));
+}
+
+static void anomaly_formatted(uint32_t i)
+{
+    bench_format_log("Thermal anomaly: 0x%02x (z=%.1f, residual=%.2f°C, cusum=%.1f)\r\n", (unsigned)(i & 0x7U),
+                     3.0f + (float)(i % 10U) / 10.0f, 0.5f + (float)(i % 100U) / 100.0f, (float)(i % 50U));
+}
+
+static void config_applied_tokenized(uint32_t i)
+{
+    (void)i;
+    log_info("Thermal config: applied\r\n");
+}
+
+static void config_applied_formatted(uint32_t i)
+{
+    (void)i;
+    bench_format_log("Thermal config: applied\r\n");
+}
+
+static bench_case_t const gs_cases[] = {
+    { "control (f,s,d)",     thermal_control_tokenized, thermal_control_formatted },
+    { "BLE conn (x,d,d)",    ble_connected_tokenized,   ble_connected_formatted   },
+    { "anomaly (x,f,f,f)",   anomaly_tokenized,         anomaly_formatted         },
+    { "config (no args)",    config_applied_tokenized,  config_applied_formatted  },
+};
+
+/**
+ * @brief Time one case on both paths
+ */
+static void bench_run(bench_case_t const *p_case, uint32_t calls, bench_result_t *p_result)
+{
+    uint64_t call_ns = 0U;
+    uint64_t flush_ns = 0U;
+    uint64_t start_ns;
+    uint32_t done = 0U;
+
+    tlog_init();
+    gs_sink_bytes = 0U;
+    while (done < calls)
+    {
+        start_ns = now_ns();
+        for (uint32_t k = 0U; k < BENCH_BATCH; k++)
+        {
+            p_case->tokenized(done + k);
+        }
+        call_ns += now_ns() - start_ns;
+
+        start_ns = now_ns();
+        while (0U != tlog_flush())
+        {
+        }
+        flush_ns += now_ns() - start_ns;
+        done += BENCH_BATCH;
+    }
+    p_result->token_call_ns = (double)call_ns / done;
+    p_result->flush_ns = (double)flush_ns / done;
+    p_result->token_bytes = (double)gs_sink_bytes / done;
+
+    gs_sink_bytes = 0U;
+    call_ns = 0U;
+    for (done = 0U; done < calls; done += BENCH_BATCH)
+    {
+        start_ns = now_ns();
+        for (uint32_t k = 0U; k < BENCH_BATCH; k++)
+        {
+            p_case->formatted(done + k);
+        }
+        call_ns += now_ns() - start_ns;
+    }
+    p_result->format_call_ns = (double)call_ns / done;
+    p_result->format_bytes = (double)gs_sink_bytes / done;
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr, "usage: %s [-n calls]\n", p_prog);
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t calls = BENCH_DEFAULT_CALLS;
+    tlog_stats_t stats;
+    uint32_t records = 0U;
+    bool pass = true;
+    int opt;
+
+    while (-1 != (opt = getopt(argc, argv, "n:")))
+    {
+        switch (opt)
+        {
+            case 'n':
+                calls = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                usage(argv[0]);
+        }
+    }
+    if (calls < BENCH_BATCH)
+    {
+        usage(argv[0]);
+    }
+
+    printf("%u calls per path and case, batches of %u\n", calls, BENCH_BATCH);
+    printf("%-20s | %-28s | %-16s | %7s\n", "case", "tokenized call/flush ns bytes", "formatted ns bytes", "speedup");
+    for (uint32_t c = 0U; c < (sizeof(gs_cases) / sizeof(gs_cases[0])); c++)
+    {
+        bench_result_t result;
+        bool ok;
+
+        bench_run(&gs_cases[c], calls, &result);
+        tlog_get_stats(&stats);
+        ok = (result.token_call_ns < result.format_call_ns) && (0U == stats.dropped);
+        pass = pass && ok;
+        records += stats.records;
+
+        printf("%-20s | %8.1f %8.1f %8.1f   | %7.1f %7.1f  | %6.1fx  %s\n", gs_cases[c].p_name,
+               result.token_call_ns, result.flush_ns, result.token_bytes, result.format_call_ns, result.format_bytes,
+               result.format_call_ns / result.token_call_ns, ok ? "PASS" : "FAIL");
+        if (0U != stats.dropped)
+        {
+            printf("  %u records dropped\n", stats.dropped);
+        }
+    }
+    printf("%u tokenized records, format strings in .tlog_fmt (not sent)\n", records);
+
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+File Name    : ntc_table_gen.py
+Description  : Generates src/ntc_table.c - NTC thermistor linearization table indexed by 12-bit ADC counts.
+
+Divider: VREF -- R_series -- ADC -- NTC -- GND, ADC referenced to the same VREF (ratiometric), so
+    R_ntc = R_series * x / (1 - x),   x = counts / 4096
+Temperature from the Beta model or, when coefficients are given, Steinhart-Hart:
+    1/T = 1/T0 + ln(R/R0)/B          1/T = A + B ln(R) + C ln(R)^3
+
+    ntc_table_gen.py [--beta 3950 --r0 10000 --t0 25] [--sh A B C] [--rseries 10000] [-o src/ntc_table.c]
+
+--report prints the interpolation error against the closed-form equation for every 12-bit count in
+the rack operating range.
+"""
+
+import argparse
+import math
+import sys
+
+ADC_COUNTS = 4096
+KELVIN = 273.15
+TABLE_MIN_C = -55.0
+TABLE_MAX_C = 150.0
+
+
+def closed_form(opts, counts):
+    """Temperature (°C) for fractional 12-bit counts, clamped to the table range."""
+    x = counts / ADC_COUNTS
+    if x <= 0.0:
+        return TABLE_MAX_C
+    if x >= 1.0:
+        return TABLE_MIN_C
+    r = opts.rseries * x / (1.0 - x)
+    if opts.sh:
+        a, b, c = opts.sh
+        ln_r = math.log(r)
+        t = 1.0 / (a + b * ln_r + c * ln_r ** 3) - KELVIN
+    else:
+        t = 1.0 / (1.0 / (opts.t0 + KELVIN) + math.log(r / opts.r0) / opts.beta) - KELVIN
+    return min(max(t, TABLE_MIN_C), TABLE_MAX_C)
+
+
+def build_table(opts):
+    step = ADC_COUNTS >> opts.entries_log2
+    return [int(round(closed_form(opts, i * step) * 100.0)) for i in range((1 << opts.entries_log2) + 1)]
+
+
+def interpolate(table, step, counts):
+    """Mirror of ntc_counts_to_centi_celsius() for 12-bit counts."""
+    i, frac = divmod(counts, step)
+    if i >= len(table) - 1:
+        return table[-1]
+    return table[i] + int((table[i + 1] - table[i]) * frac / step)     # C division truncates
+
+
+def report(opts, table):
+    step = ADC_COUNTS >> opts.entries_log2
+    worst = (0.0, 0)
+    for counts in range(1, ADC_COUNTS):
+        exact = closed_form(opts, counts)
+        if not (opts.report_min <= exact <= opts.report_max):
+            continue
+        err = abs(interpolate(table, step, counts) / 100.0 - exact)
+        worst = max(worst, (err, counts))
+    print("max |error| %.3f °C at %d counts over %.0f..%.0f °C (%d entries, %d bytes)"
+          % (worst[0], worst[1], opts.report_min, opts.report_max, len(table), 2 * len(table)))
+
+
+def emit(opts, table):
+    model = ("Steinhart-Hart A=%g B=%g C=%g" % tuple(opts.sh)) if opts.sh else \
+            ("Beta %g, R0 %g ohm at %g °C" % (opts.beta, opts.r0, opts.t0))
+    rows = []
+    for i in range(0, len(table), 8):
+        rows.append("    " + ", ".join("%6d" % v for v in table[i:i + 8]) + ",")
+    return """/***********************************************************************************************************************
+ * File Name    : ntc_table.c
+ * Description  : NTC Linearization Table - GENERATED by tools/ntc_table_gen.py, do not edit
+ *
+ * %s, series resistor %g ohm
+ * Entry i = temperature (°C x 100) at 12-bit counts i << NTC_TABLE_STEP_LOG2
+ **********************************************************************************************************************/
+
+#include "ntc_thermistor.h"
+
+_Static_assert(NTC_TABLE_STEP_LOG2 == %d, "regenerate ntc_table.c for this table step");
+
+const int16_t g_ntc_table[NTC_TABLE_ENTRIES] = {
+%s
+};
+""" % (model, opts.rseries, 12 - opts.entries_log2, "\n".join(rows))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--beta", type=float, default=3950.0)
+    parser.add_argument("--r0", type=float, default=10000.0, help="NTC resistance at t0 (ohm)")
+    parser.add_argument("--t0", type=float, default=25.0)
+    parser.add_argument("--sh", type=float, nargs=3, metavar=("A", "B", "C"), help="Steinhart-Hart coefficients")
+    parser.add_argument("--rseries", type=float, default=10000.0, help="Divider resistor (ohm)")
+    parser.add_argument("--entries-log2", type=int, default=7, help="Table intervals = 2^n (must match firmware)")
+    parser.add_argument("--report", action="store_true")
+    parser.add_argument("--report-min", type=float, default=0.0)
+    parser.add_argument("--report-max", type=float, default=65.0)
+    parser.add_argument("-o", "--output", default="-")
+    opts = parser.parse_args()
+
+    table = build_table(opts)
+    if opts.report:
+        report(opts, table)
+        return 0
+    text = emit(opts, table)
+    if opts.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(opts.output, "w") as f:
+            f.write(text)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
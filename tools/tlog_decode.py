@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""
+File Name    : tlog_decode.py
+Description  : Host-side decoder for the tokenized deferred logger (src/tlog.c).
+
+Reads the format strings from the firmware ELF's .tlog_fmt section (token = string address)
+and decodes a captured RTT/UART byte stream back into formatted text.
+
+    tlog_decode.py firmware.elf capture.bin [--cpu-hz 200000000]
+    tlog_decode.py firmware.elf --dump-tokens
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+HEADER_MARK = 0xA5
+LEVELS = {1: "ERR", 2: "WRN", 3: "INF", 4: "DBG"}
+SPEC_RE = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|j|t)?([diouxXcsfFeEgGp%])")
+
+
+class Elf32:
+    """Minimal little-endian ELF32 reader - sections and address lookups only."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("not an ELF32 file")
+        shoff, = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+        raw = [struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize) for i in range(shnum)]
+        strtab = raw[shstrndx]
+        self.sections = []
+        for name, stype, _flags, addr, offset, size, *_ in raw:
+            end = self.data.index(b"\0", strtab[4] + name)
+            self.sections.append((self.data[strtab[4] + name:end].decode(), stype, addr, offset, size))
+
+    def section(self, wanted):
+        for name, _stype, addr, offset, size in self.sections:
+            if name == wanted:
+                return addr, self.data[offset:offset + size]
+        return None, b""
+
+    def read_cstring(self, address):
+        for _name, stype, addr, offset, size in self.sections:
+            if stype != 8 and addr and addr <= address < addr + size:   # skip NOBITS
+                start = offset + (address - addr)
+                return self.data[start:self.data.index(b"\0", start)].decode(errors="replace")
+        return "<0x%08x>" % address
+
+
+def load_tokens(elf):
+    base, blob = elf.section(".tlog_fmt")
+    if base is None:
+        raise ValueError("no .tlog_fmt section - is the firmware built with log_tokenized.h?")
+    tokens = {}
+    pos = 0
+    while pos < len(blob):
+        end = blob.index(b"\0", pos)
+        if end > pos:
+            tokens[base + pos] = blob[pos:end].decode(errors="replace")
+        pos = end + 1
+    return tokens
+
+
+def render(fmt, args, elf):
+    """Apply C format specifiers to raw 32-bit words."""
+    words = iter(args)
+    out = []
+    last = 0
+    for m in SPEC_RE.finditer(fmt):
+        out.append(fmt[last:m.start()])
+        last = m.end()
+        flags, conv = m.group(1), m.group(3)
+        if conv == "%":
+            out.append("%")
+            continue
+        word = next(words, 0)
+        if conv in "fFeEgG":
+            value = struct.unpack("<f", struct.pack("<I", word))[0]
+        elif conv in "di":
+            value = word - (1 << 32) if word & 0x80000000 else word
+        elif conv == "s":
+            value = elf.read_cstring(word)
+        elif conv == "p":
+            conv, value = "x", word
+        else:
+            value = word
+        out.append(("%" + flags + conv) % value)
+    out.append(fmt[last:])
+    return "".join(out)
+
+
+def decode(stream, tokens, elf, cpu_hz):
+    words = struct.unpack("<%dI" % (len(stream) // 4), stream[:len(stream) & ~3])
+    i = 0
+    expected_seq = None
+    while i + 3 <= len(words):
+        header = words[i]
+        if header & 0xFF != HEADER_MARK:
+            i += 1                      # resynchronise on the next header
+            continue
+        level, nargs, seq = (header >> 8) & 0xF, (header >> 12) & 0xF, header >> 16
+        token, stamp = words[i + 1], words[i + 2]
+        args = words[i + 3:i + 3 + nargs]
+        i += 3 + nargs
+        if expected_seq is not None and seq != expected_seq:
+            yield "--- %d record(s) lost ---" % ((seq - expected_seq) & 0xFFFF)
+        expected_seq = (seq + 1) & 0xFFFF
+        fmt = tokens.get(token)
+        text = render(fmt, args, elf) if fmt is not None else "<unknown token 0x%08x> %s" % (token, list(args))
+        yield "[%10.6f] %s %s" % (stamp / cpu_hz, LEVELS.get(level, "?"), text.rstrip("\r\n"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("elf")
+    parser.add_argument("capture", nargs="?")
+    parser.add_argument("--cpu-hz", type=float, default=200e6, help="DWT cycle counter clock")
+    parser.add_argument("--dump-tokens", action="store_true")
+    opts = parser.parse_args()
+
+    elf = Elf32(opts.elf)
+    tokens = load_tokens(elf)
+    if opts.dump_tokens or not opts.capture:
+        for token, fmt in sorted(tokens.items()):
+            print("0x%08x %r" % (token, fmt))
+        return 0
+    with open(opts.capture, "rb") as f:
+        for line in decode(f.read(), tokens, elf, opts.cpu_hz):
+            print(line)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
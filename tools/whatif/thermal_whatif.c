@@ -0,0 +1,656 @@
+/***********************************************************************************************************************
+ * File Name    : thermal_whatif.c
+ * Description  : Fleet What-If Engine - scores candidate thermal configurations over recorded temperature traces
+ *
+ * Every (trace, configuration) pair is run through the firmware's own control rules (src/thermal_policy.c: cooling
+ * level, duty table, critical alert with hysteresis, shutdown latch) and scored on fan energy, peak temperature,
+ * fan speed changes, critical alerts and shutdowns. Totals per configuration are printed against the first one,
+ * the build defaults unless -n is given.
+ *
+ *   cc -O3 -march=native -pthread -I../../src -o thermal_whatif thermal_whatif.c ../../src/thermal_policy.c
+ *      ../../src/fan_energy.c
+ *   thermal_whatif [-c configs] [-n] [-s sample_ms] [-x exhaust_pct] [-T threads] [-v] trace...
+ *
+ * Traces: one rack each, evenly spaced samples (°C). "*.f32" files are raw little-endian float32 and are mapped,
+ * not parsed - use them for months of data. Anything else is text, one sample per line, '#' comments; "nan"
+ * marks a gap (the firmware goes to EMERGENCY on an implausible reading, and so does the kernel).
+ *
+ * Configurations: one per line, '#' comments, the runtime-configurable thermal_config_t fields:
+ *   name  off_c low_c medium_c high_c  critical_c hysteresis_c  duty_off duty_low duty_medium duty_high duty_emerg
+ * and validated as thermal_config_stage() would.
+ *
+ * Pairs are spread over a work-stealing pool, one worker per core by default: each worker pops pairs from the
+ * bottom of its own range, and an idle worker steals the top half of a busy one's - the lower indices, furthest
+ * from where the owner pops. Traces vary from days to months, so a static split would leave most cores idle behind
+ * the longest ones.
+ **********************************************************************************************************************/
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "fan_energy.h"
+#include "thermal_policy.h"
+
+/* ==================================================================================================================
+ * ENGINE CONFIGURATION
+ * ================================================================================================================== */
+#define WHATIF_MAX_THREADS              (256U)
+#define WHATIF_MAX_CONFIGS              (4096U)
+#define WHATIF_NAME_LEN                 (32U)
+#define WHATIF_DEFAULT_SAMPLE_MS        (1000U)
+#define WHATIF_CACHE_LINE               (64U)
+#define WHATIF_CHUNK                    (1U << 20)  /* Samples per kernel call - keeps a pair's loop interruptible */
+
+/* Build Defaults - mirror src/main_application.h and src/system_config.h */
+#define WHATIF_SHUTDOWN_C               (65.0f)     /* SYSTEM_SHUTDOWN_TEMP */
+#define WHATIF_MAX_HYSTERESIS_C         (5.0f)      /* THERMAL_CONFIG_MAX_HYSTERESIS */
+#define WHATIF_MIN_THRESHOLD_C          (0.0f)      /* TEMP_MIN_CELSIUS */
+#define WHATIF_EXHAUST_RATIO_PCT        (90U)       /* FAN_EXHAUST_RATIO_PCT */
+static thermal_policy_t const gs_default_policy = {
+    .level_threshold = { 30.0f, 40.0f, 50.0f, 55.0f },
+    .critical_temp = 58.0f,
+    .hysteresis = 1.0f,
+    .shutdown_temp = WHATIF_SHUTDOWN_C,
+    .duty = { 0, 25, 50, 75, 100 }
+};
+
+/* Recorded Trace */
+typedef struct {
+    char const *p_path;
+    float *p_temp;
+    uint64_t count;
+    bool mapped;                /* munmap() rather than free() */
+} whatif_trace_t;
+
+/* Candidate Configuration */
+typedef struct {
+    char name[WHATIF_NAME_LEN];
+    thermal_policy_t policy;
+    double level_power_w[THERMAL_POLICY_LEVELS];    /* Intake + exhaust electrical power at each level's duty */
+} whatif_config_t;
+
+/* Work-Stealing Deque - a range of pair indices [top, bottom) in one word, so the owner popping the bottom and
+ * thieves taking the top half agree with a single compare-and-swap; pairs are never added after start */
+typedef struct {
+    _Alignas(WHATIF_CACHE_LINE) _Atomic uint64_t range;     /* top << 32 | bottom */
+} whatif_deque_t;
+
+/* Worker */
+typedef struct {
+    _Alignas(WHATIF_CACHE_LINE) pthread_t thread;
+    uint32_t index;
+    uint64_t pairs;
+    uint64_t samples;
+    uint64_t steals;
+} whatif_worker_t;
+
+/* Engine Options */
+typedef struct {
+    char const *p_configs;
+    bool no_default;
+    uint32_t sample_ms;
+    uint32_t exhaust_pct;
+    uint32_t threads;
+    bool verbose;
+} whatif_options_t;
+
+/* Global Variables */
+static whatif_options_t gs_opt;
+static whatif_trace_t *gs_traces;
+static uint32_t gs_trace_count;
+static whatif_config_t *gs_configs;
+static uint32_t gs_config_count;
+static thermal_policy_metrics_t *gs_results;    /* [trace * gs_config_count + config] */
+static whatif_deque_t *gs_deques;
+static whatif_worker_t *gs_workers;
+
+static inline uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static inline uint64_t range_pack(uint32_t top, uint32_t bottom)
+{
+    return ((uint64_t)top << 32) | bottom;
+}
+
+/**
+ * @brief Take the next pair from the owner's end of a worker's own range
+ * @return true with *p_pair set, false once the range is empty
+ */
+static bool deque_pop(whatif_deque_t *p_deque, uint32_t *p_pair)
+{
+    uint64_t range = atomic_load_explicit(&p_deque->range, memory_order_relaxed);
+
+    for (;;)
+    {
+        uint32_t top = (uint32_t)(range >> 32);
+        uint32_t bottom = (uint32_t)range;
+
+        if (top >= bottom)
+        {
+            return false;
+        }
+        if (atomic_compare_exchange_weak_explicit(&p_deque->range, &range, range_pack(top, bottom - 1U),
+                                                  memory_order_acquire, memory_order_relaxed))
+        {
+            *p_pair = bottom - 1U;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Steal the top half (rounded up) - the lower indices - of another worker's range into our own, empty, one
+ * @return true if anything was stolen
+ */
+static bool deque_steal(whatif_deque_t *p_victim, whatif_deque_t *p_own)
+{
+    uint64_t range = atomic_load_explicit(&p_victim->range, memory_order_relaxed);
+
+    for (;;)
+    {
+        uint32_t top = (uint32_t)(range >> 32);
+        uint32_t bottom = (uint32_t)range;
+        uint32_t take = (bottom - top + 1U) / 2U;
+
+        if (top >= bottom)
+        {
+            return false;
+        }
+        if (atomic_compare_exchange_weak_explicit(&p_victim->range, &range, range_pack(top + take, bottom),
+                                                  memory_order_acquire, memory_order_relaxed))
+        {
+            atomic_store_explicit(&p_own->range, range_pack(top, top + take), memory_order_release);
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Score one (trace, configuration) pair
+ */
+static void whatif_run_pair(uint32_t pair, whatif_worker_t *p_worker)
+{
+    whatif_trace_t const *p_trace = &gs_traces[pair / gs_config_count];
+    whatif_config_t const *p_config = &gs_configs[pair % gs_config_count];
+    thermal_policy_metrics_t *p_metrics = &gs_results[pair];
+    thermal_policy_state_t state;
+
+    thermal_policy_batch_init(&state, p_metrics);
+    for (uint64_t i = 0; i < p_trace->count; i += WHATIF_CHUNK)
+    {
+        uint64_t n = ((p_trace->count - i) < WHATIF_CHUNK) ? (p_trace->count - i) : WHATIF_CHUNK;
+        thermal_policy_batch(&p_config->policy, &p_trace->p_temp[i], (uint32_t)n, &state, p_metrics);
+    }
+
+    p_worker->pairs++;
+    p_worker->samples += p_trace->count;
+}
+
+/**
+ * @brief Worker - drain the own range, then steal until every range is empty
+ * @note  No pair is ever added, so a full pass finding nothing to steal means the work is all claimed
+ */
+static void *whatif_worker(void *p_arg)
+{
+    whatif_worker_t *p_worker = p_arg;
+    whatif_deque_t *p_own = &gs_deques[p_worker->index];
+    uint32_t pair;
+
+    for (;;)
+    {
+        while (deque_pop(p_own, &pair))
+        {
+            whatif_run_pair(pair, p_worker);
+        }
+
+        bool stolen = false;
+        for (uint32_t k = 1U; (k < gs_opt.threads) && !stolen; k++)
+        {
+            stolen = deque_steal(&gs_deques[(p_worker->index + k) % gs_opt.threads], p_own);
+        }
+        if (!stolen)
+        {
+            break;
+        }
+        p_worker->steals++;
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Load a trace - map raw float32, parse text
+ * @return 0 on success
+ */
+static int trace_load(whatif_trace_t *p_trace, char const *p_path)
+{
+    size_t len = strlen(p_path);
+
+    p_trace->p_path = p_path;
+    if ((len > 4U) && (0 == strcmp(&p_path[len - 4U], ".f32")))
+    {
+        struct stat st;
+        int fd = open(p_path, O_RDONLY);
+
+        if ((fd < 0) || (0 != fstat(fd, &st)) || (0 != (st.st_size % (off_t)sizeof(float))))
+        {
+            fprintf(stderr, "thermal_whatif: %s: %s\n", p_path, (fd < 0) ? strerror(errno) : "not float32 samples");
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+            return -1;
+        }
+        p_trace->count = (uint64_t)st.st_size / sizeof(float);
+        p_trace->p_temp = (0U != p_trace->count) ? mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0)
+                                                 : NULL;
+        close(fd);
+        if (MAP_FAILED == p_trace->p_temp)
+        {
+            fprintf(stderr, "thermal_whatif: %s: %s\n", p_path, strerror(errno));
+            return -1;
+        }
+        (void)madvise(p_trace->p_temp, (size_t)st.st_size, MADV_SEQUENTIAL);
+        p_trace->mapped = true;
+        return 0;
+    }
+
+    FILE *p_file = fopen(p_path, "r");
+    char line[128];
+    uint64_t capacity = 0;
+
+    if (NULL == p_file)
+    {
+        fprintf(stderr, "thermal_whatif: %s: %s\n", p_path, strerror(errno));
+        return -1;
+    }
+    while (NULL != fgets(line, sizeof(line), p_file))
+    {
+        char *p_end;
+        float t = strtof(line, &p_end);
+
+        if ((p_end == line) || ('#' == line[0]))
+        {
+            continue;
+        }
+        if (p_trace->count == capacity)
+        {
+            capacity = (0U != capacity) ? (capacity * 2U) : 65536U;
+            float *p_grown = realloc(p_trace->p_temp, capacity * sizeof(float));
+            if (NULL == p_grown)
+            {
+                fclose(p_file);
+                return -1;
+            }
+            p_trace->p_temp = p_grown;
+        }
+        p_trace->p_temp[p_trace->count++] = t;
+    }
+    fclose(p_file);
+    return 0;
+}
+
+/**
+ * @brief Fan power per cooling level, as fan_apply_duty() splits a duty over intake and exhaust
+ */
+static void config_power(whatif_config_t *p_config)
+{
+    for (uint8_t k = 0; k < THERMAL_POLICY_LEVELS; k++)
+    {
+        uint8_t duty = p_config->policy.duty[k];
+        uint8_t exhaust = (duty < 100U) ? (uint8_t)(((uint32_t)duty * gs_opt.exhaust_pct) / 100U) : duty;
+
+        p_config->level_power_w[k] = (double)(fan_energy_power_mw(duty) + fan_energy_power_mw(exhaust)) / 1000.0;
+    }
+}
+
+/**
+ * @brief Check a candidate the way thermal_config_validate() does
+ * @return NULL if the firmware would accept it, otherwise why not
+ */
+static char const *config_invalid(thermal_policy_t const *p_policy)
+{
+    for (uint8_t i = 0; i < 4U; i++)
+    {
+        if ((p_policy->level_threshold[i] < WHATIF_MIN_THRESHOLD_C) || (p_policy->level_threshold[i] > WHATIF_SHUTDOWN_C))
+        {
+            return "threshold out of range";
+        }
+        if ((i > 0U) && (p_policy->level_threshold[i] <= p_policy->level_threshold[i - 1U]))
+        {
+            return "thresholds not ascending";
+        }
+    }
+    for (uint8_t i = 0; i < THERMAL_POLICY_LEVELS; i++)
+    {
+        if ((p_policy->duty[i] > 100U) || ((i > 0U) && (p_policy->duty[i] < p_policy->duty[i - 1U])))
+        {
+            return "duty table out of range or decreasing";
+        }
+    }
+    if (100U != p_policy->duty[4])
+    {
+        return "EMERGENCY duty must be 100";
+    }
+    if ((p_policy->critical_temp <= p_policy->level_threshold[0]) || (p_policy->critical_temp >= WHATIF_SHUTDOWN_C) ||
+        (p_policy->hysteresis < 0.0f) || (p_policy->hysteresis > WHATIF_MAX_HYSTERESIS_C))
+    {
+        return "critical temperature or hysteresis out of range";
+    }
+    return NULL;
+}
+
+/**
+ * @brief Read candidate configurations (after the build defaults unless -n)
+ * @return 0 on success
+ */
+static int configs_load(char const *p_path)
+{
+    FILE *p_file = NULL;
+    char line[256];
+    uint32_t line_no = 0;
+
+    gs_configs = calloc(WHATIF_MAX_CONFIGS, sizeof(whatif_config_t));
+    if (NULL == gs_configs)
+    {
+        return -1;
+    }
+    if (!gs_opt.no_default)
+    {
+        snprintf(gs_configs[0].name, WHATIF_NAME_LEN, "default");
+        gs_configs[0].policy = gs_default_policy;
+        gs_config_count = 1;
+    }
+    if (NULL == p_path)
+    {
+        return 0;
+    }
+
+    p_file = fopen(p_path, "r");
+    if (NULL == p_file)
+    {
+        fprintf(stderr, "thermal_whatif: %s: %s\n", p_path, strerror(errno));
+        return -1;
+    }
+    while (NULL != fgets(line, sizeof(line), p_file))
+    {
+        whatif_config_t *p_config = &gs_configs[gs_config_count];
+        thermal_policy_t *p_policy = &p_config->policy;
+        unsigned duty[THERMAL_POLICY_LEVELS];
+        char const *p_why;
+        char first = '#';
+        int fields;
+
+        line_no++;
+        sscanf(line, " %c", &first);
+        if ('#' == first)
+        {
+            continue;
+        }
+        if (gs_config_count == WHATIF_MAX_CONFIGS)
+        {
+            fprintf(stderr, "thermal_whatif: more than %u configurations\n", WHATIF_MAX_CONFIGS);
+            fclose(p_file);
+            return -1;
+        }
+
+        fields = sscanf(line, "%31s %f %f %f %f %f %f %u %u %u %u %u", p_config->name, &p_policy->level_threshold[0],
+                        &p_policy->level_threshold[1], &p_policy->level_threshold[2], &p_policy->level_threshold[3],
+                        &p_policy->critical_temp, &p_policy->hysteresis, &duty[0], &duty[1], &duty[2], &duty[3],
+                        &duty[4]);
+        for (uint8_t k = 0; k < THERMAL_POLICY_LEVELS; k++)
+        {
+            p_policy->duty[k] = (uint8_t)((duty[k] > 255U) ? 255U : duty[k]);
+        }
+        p_policy->shutdown_temp = WHATIF_SHUTDOWN_C;
+
+        p_why = (12 != fields) ? "expected name + 11 values" : config_invalid(p_policy);
+        if (NULL != p_why)
+        {
+            fprintf(stderr, "thermal_whatif: %s:%u: %s\n", p_path, line_no, p_why);
+            fclose(p_file);
+            return -1;
+        }
+        gs_config_count++;
+    }
+    fclose(p_file);
+    return 0;
+}
+
+/**
+ * @brief Print one line of results
+ */
+static void print_row(char const *p_name, thermal_policy_metrics_t const *p_total, double energy_kwh,
+                      double baseline_kwh, uint32_t shutdowns, double dt_s)
+{
+    double days = (double)p_total->samples * dt_s / 86400.0;
+    double vs = (baseline_kwh > 0.0) ? (100.0 * (energy_kwh - baseline_kwh) / baseline_kwh) : 0.0;
+
+    printf("%-24s %12.3f %+8.1f%% %8.2f %10.1f %8u %10.2f %9u\n", p_name, energy_kwh, vs, p_total->peak_temp,
+           (days > 0.0) ? ((double)p_total->level_changes / days) : 0.0, p_total->critical_alerts,
+           (double)p_total->critical_samples * dt_s / 3600.0, shutdowns);
+}
+
+/**
+ * @brief Fan energy of one pair - time at each level times that level's power
+ */
+static double pair_energy_kwh(uint32_t trace, uint32_t config)
+{
+    thermal_policy_metrics_t const *p_pair = &gs_results[(trace * gs_config_count) + config];
+    double dt_s = (double)gs_opt.sample_ms / 1000.0;
+    double kwh = 0.0;
+
+    for (uint8_t k = 0; k < THERMAL_POLICY_LEVELS; k++)
+    {
+        kwh += (double)p_pair->level_samples[k] * dt_s * gs_configs[config].level_power_w[k] / 3.6e6;
+    }
+    return kwh;
+}
+
+/**
+ * @brief Totals per configuration over every trace (in pair order, so the output never depends on scheduling)
+ */
+static void report(void)
+{
+    double dt_s = (double)gs_opt.sample_ms / 1000.0;
+    double baseline_kwh = 0.0;
+
+    printf("%-24s %12s %9s %8s %10s %8s %10s %9s\n", "config", "fan kWh", "vs first", "peak C", "changes/d",
+           "crit", "crit h", "shutdown");
+    printf("%s\n", "-----------------------------------------------------------------------------------------------");
+    for (uint32_t c = 0; c < gs_config_count; c++)
+    {
+        thermal_policy_metrics_t total;
+        thermal_policy_state_t unused;
+        double energy_kwh = 0.0;
+        uint32_t shutdowns = 0;
+
+        thermal_policy_batch_init(&unused, &total);
+        for (uint32_t t = 0; t < gs_trace_count; t++)
+        {
+            thermal_policy_metrics_t const *p_pair = &gs_results[(t * gs_config_count) + c];
+
+            for (uint8_t k = 0; k < THERMAL_POLICY_LEVELS; k++)
+            {
+                total.level_samples[k] += p_pair->level_samples[k];
+            }
+            total.samples += p_pair->samples;
+            total.level_changes += p_pair->level_changes;
+            total.critical_alerts += p_pair->critical_alerts;
+            total.critical_samples += p_pair->critical_samples;
+            total.peak_temp = (p_pair->peak_temp > total.peak_temp) ? p_pair->peak_temp : total.peak_temp;
+            shutdowns += (UINT64_MAX != p_pair->shutdown_sample) ? 1U : 0U;
+            energy_kwh += pair_energy_kwh(t, c);
+        }
+
+        baseline_kwh = (0U == c) ? energy_kwh : baseline_kwh;
+        print_row(gs_configs[c].name, &total, energy_kwh, baseline_kwh, shutdowns, dt_s);
+
+        /* Per trace, against the first configuration on the same trace */
+        for (uint32_t t = 0; gs_opt.verbose && (t < gs_trace_count); t++)
+        {
+            thermal_policy_metrics_t const *p_pair = &gs_results[(t * gs_config_count) + c];
+            char const *p_base = strrchr(gs_traces[t].p_path, '/');
+            char name[WHATIF_NAME_LEN];
+
+            snprintf(name, sizeof(name), "  %s", (NULL != p_base) ? (p_base + 1) : gs_traces[t].p_path);
+            print_row(name, p_pair, pair_energy_kwh(t, c), pair_energy_kwh(t, 0),
+                      (UINT64_MAX != p_pair->shutdown_sample) ? 1U : 0U, dt_s);
+        }
+    }
+}
+
+static void usage(char const *p_prog)
+{
+    fprintf(stderr,
+            "usage: %s [-c configs] [-n] [-s sample_ms] [-x exhaust_pct] [-T threads] [-v] trace...\n"
+            "  -c  candidate configurations, one per line:\n"
+            "      name off low medium high critical hysteresis duty_off duty_low duty_medium duty_high 100\n"
+            "  -n  leave out the build defaults (the first candidate becomes the baseline)\n"
+            "  -s  trace sample interval (default %u ms)\n"
+            "  -x  exhaust duty as %% of intake below full cooling (default %u)\n"
+            "  -T  worker threads (default: online cores, max %u)\n"
+            "  -v  per-trace rows\n"
+            "  traces: *.f32 raw float32 (mapped), otherwise text, one °C sample per line\n",
+            p_prog, WHATIF_DEFAULT_SAMPLE_MS, WHATIF_EXHAUST_RATIO_PCT, WHATIF_MAX_THREADS);
+}
+
+int main(int argc, char **argv)
+{
+    int opt;
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+    gs_opt.sample_ms = WHATIF_DEFAULT_SAMPLE_MS;
+    gs_opt.exhaust_pct = WHATIF_EXHAUST_RATIO_PCT;
+    gs_opt.threads = (cores > 0) ? (uint32_t)cores : 1U;
+
+    while (-1 != (opt = getopt(argc, argv, "c:ns:x:T:vh")))
+    {
+        switch (opt)
+        {
+            case 'c': gs_opt.p_configs = optarg; break;
+            case 'n': gs_opt.no_default = true; break;
+            case 's': gs_opt.sample_ms = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'x': gs_opt.exhaust_pct = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'T': gs_opt.threads = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'v': gs_opt.verbose = true; break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+
+    gs_opt.threads = (gs_opt.threads > WHATIF_MAX_THREADS) ? WHATIF_MAX_THREADS : gs_opt.threads;
+    if ((optind >= argc) || (0U == gs_opt.sample_ms) || (gs_opt.exhaust_pct > 100U) || (0U == gs_opt.threads))
+    {
+        usage(argv[0]);
+        return 2;
+    }
+    if (0 != configs_load(gs_opt.p_configs))
+    {
+        return 2;
+    }
+    if (0U == gs_config_count)
+    {
+        fprintf(stderr, "thermal_whatif: no configurations to score\n");
+        return 2;
+    }
+    for (uint32_t c = 0; c < gs_config_count; c++)
+    {
+        config_power(&gs_configs[c]);
+    }
+
+    gs_trace_count = (uint32_t)(argc - optind);
+    gs_traces = calloc(gs_trace_count, sizeof(whatif_trace_t));
+    if (NULL == gs_traces)
+    {
+        return 1;
+    }
+    uint64_t total_samples = 0;
+    for (uint32_t t = 0; t < gs_trace_count; t++)
+    {
+        if (0 != trace_load(&gs_traces[t], argv[optind + (int)t]))
+        {
+            return 1;
+        }
+        total_samples += gs_traces[t].count;
+    }
+
+    uint64_t pairs = (uint64_t)gs_trace_count * gs_config_count;
+    if (pairs > UINT32_MAX)
+    {
+        fprintf(stderr, "thermal_whatif: too many (trace, configuration) pairs\n");
+        return 2;
+    }
+    gs_results = calloc((size_t)pairs, sizeof(thermal_policy_metrics_t));
+    gs_deques = aligned_alloc(WHATIF_CACHE_LINE, gs_opt.threads * sizeof(whatif_deque_t));
+    gs_workers = aligned_alloc(WHATIF_CACHE_LINE, gs_opt.threads * sizeof(whatif_worker_t));
+    if ((NULL == gs_results) || (NULL == gs_deques) || (NULL == gs_workers))
+    {
+        return 1;
+    }
+
+    /* Contiguous starting ranges - a worker mostly stays on one trace; stealing evens out the rest */
+    uint32_t first = 0;
+    for (uint32_t w = 0; w < gs_opt.threads; w++)
+    {
+        uint32_t share = (uint32_t)(pairs / gs_opt.threads) + ((w < (pairs % gs_opt.threads)) ? 1U : 0U);
+
+        atomic_init(&gs_deques[w].range, range_pack(first, first + share));
+        memset(&gs_workers[w], 0, sizeof(whatif_worker_t));
+        gs_workers[w].index = w;
+        first += share;
+    }
+
+    uint64_t start_ns = now_ns();
+    for (uint32_t w = 0; w < gs_opt.threads; w++)
+    {
+        pthread_create(&gs_workers[w].thread, NULL, whatif_worker, &gs_workers[w]);
+    }
+    uint64_t evaluated = 0, steals = 0;
+    for (uint32_t w = 0; w < gs_opt.threads; w++)
+    {
+        pthread_join(gs_workers[w].thread, NULL);
+        evaluated += gs_workers[w].samples;
+        steals += gs_workers[w].steals;
+    }
+    double elapsed_s = (double)(now_ns() - start_ns) / 1e9;
+
+    report();
+    fprintf(stderr, "thermal_whatif: %u trace(s), %llu samples, %u config(s), %u worker(s): %.3f s, "
+            "%.0f Msamples/s, %llu steal(s)\n", gs_trace_count, (unsigned long long)total_samples, gs_config_count,
+            gs_opt.threads, elapsed_s, (double)evaluated / elapsed_s / 1e6, (unsigned long long)steals);
+
+    for (uint32_t t = 0; t < gs_trace_count; t++)
+    {
+        if (gs_traces[t].mapped)
+        {
+            munmap(gs_traces[t].p_temp, gs_traces[t].count * sizeof(float));
+        }
+        else
+        {
+            free(gs_traces[t].p_temp);
+        }
+    }
+    free(gs_workers);
+    free(gs_deques);
+    free(gs_results);
+    free(gs_configs);
+    free(gs_traces);
+    return 0;
+}